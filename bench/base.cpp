@@ -0,0 +1,146 @@
+#include "base.h"
+
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Per-thread, so that counting does not make the threads of multi-threaded benchmarks contend
+thread_local std::size_t allocation_count = 0;
+thread_local std::size_t allocation_bytes = 0;
+
+int subtract(const subtract_params& params)
+{
+    return params.minuend - params.subtrahend;
+}
+
+int subtract_p(int minuend, int subtrahend)
+{
+    return minuend - subtrahend;
+}
+
+int subtract_ex(const wwa::json_rpc::dispatcher::context_t& ctx, const subtract_params& params)
+{
+    return ctx.second.value("auth", std::string()).empty() ? 0 : params.minuend - params.subtrahend;
+}
+
+int sumv(const nlohmann::json& params)
+{
+    std::vector<int> v;
+    params.get_to(v);
+    return std::accumulate(v.begin(), v.end(), 0);
+}
+
+void add_methods(wwa::json_rpc::dispatcher& d)
+{
+    d.add("subtract", &subtract);
+    d.add("subtract_p", &subtract_p);
+    d.add("notification", []() { /* Do nothing */ });
+    d.add("no_params", []() { return 24; });  // NOLINT(readability-magic-numbers)
+    d.add("sum", [](int a, int b, int c) { return a + b + c; });
+    d.add("sumv", &sumv);
+    d.add("get_data", []() { return nlohmann::json::array({"hello", 5}); });  // NOLINT(readability-magic-numbers)
+    d.add("notify_hello", [](int) { /* Do nothing */ });
+    d.add("throwing", []() { throw std::invalid_argument("test"); });
+    d.add_ex("subtract_ex", &subtract_ex);
+}
+
+}  // namespace
+
+// NOLINTBEGIN(cppcoreguidelines-no-malloc,hicpp-no-malloc,misc-new-delete-overloads)
+void* operator new(std::size_t size)
+{
+    ++allocation_count;
+    allocation_bytes += size;
+    if (void* ptr = std::malloc(size != 0 ? size : 1); ptr != nullptr) {
+        return ptr;
+    }
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+// `std::pmr::new_delete_resource()` allocates through the aligned overloads
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    ++allocation_count;
+    allocation_bytes += size;
+
+    const auto align = static_cast<std::size_t>(alignment);
+    if (void* ptr = std::aligned_alloc(align, ((size != 0 ? size : 1) + align - 1) / align * align); ptr != nullptr) {
+        return ptr;
+    }
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept
+{
+    std::free(ptr);
+}
+// NOLINTEND(cppcoreguidelines-no-malloc,hicpp-no-malloc,misc-new-delete-overloads)
+
+allocation_stats allocations() noexcept
+{
+    return {allocation_count, allocation_bytes};
+}
+
+allocation_meter::allocation_meter(benchmark::State& state) noexcept : m_state(state), m_start(allocations()) {}
+
+allocation_meter::~allocation_meter()
+{
+    const auto end = allocations();
+
+    this->m_state.counters["allocs/op"] =
+        benchmark::Counter(static_cast<double>(end.count - this->m_start.count), benchmark::Counter::kAvgIterations);
+    this->m_state.counters["bytes/op"] =
+        benchmark::Counter(static_cast<double>(end.bytes - this->m_start.bytes), benchmark::Counter::kAvgIterations);
+}
+
+wwa::json_rpc::dispatcher& bench_dispatcher()
+{
+    static wwa::json_rpc::dispatcher dispatcher;
+    static const bool initialized = (add_methods(dispatcher), true);
+
+    static_cast<void>(initialized);
+    return dispatcher;
+}
+
+wwa::json_rpc::dispatcher& bench_dispatcher_with_sequential_ids()
+{
+    static wwa::json_rpc::dispatcher dispatcher;
+    static const bool initialized =
+        (add_methods(dispatcher),
+         dispatcher.set_id_generator(std::make_shared<wwa::json_rpc::sequential_id_generator>()), true);
+
+    static_cast<void>(initialized);
+    return dispatcher;
+}
+
+wwa::json_rpc::dispatcher& bench_dispatcher_with_metrics()
+{
+    static wwa::json_rpc::dispatcher dispatcher;
+    static const bool initialized = (add_methods(dispatcher), dispatcher.enable_metrics(), true);
+
+    static_cast<void>(initialized);
+    return dispatcher;
+}
@@ -0,0 +1,76 @@
+#ifndef A3F0C2D1_6B4E_4F7A_9C58_2E1D7B9064AF
+#define A3F0C2D1_6B4E_4F7A_9C58_2E1D7B9064AF
+
+#include <cstddef>
+#include <benchmark/benchmark.h>
+#include <nlohmann/json.hpp>
+#include "dispatcher.h"
+
+struct subtract_params {
+    int minuend;
+    int subtrahend;
+};
+
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(subtract_params, minuend, subtrahend);
+
+/**
+ * @brief Memory allocation statistics.
+ */
+struct allocation_stats {
+    std::size_t count; ///< The number of calls to `operator new`.
+    std::size_t bytes; ///< The total number of bytes requested.
+};
+
+/**
+ * @brief Returns the number of allocations made by the calling thread so far.
+ *
+ * @return Allocation statistics.
+ */
+allocation_stats allocations() noexcept;
+
+/**
+ * @brief Reports the number of allocations and allocated bytes per iteration of a benchmark.
+ *
+ * @details Create the meter right before the benchmark loop; when it goes out of scope, it adds the `allocs/op`
+ * and `bytes/op` counters to the benchmark state.
+ */
+class allocation_meter {
+public:
+    explicit allocation_meter(benchmark::State& state) noexcept;
+    ~allocation_meter();
+
+    allocation_meter(const allocation_meter&)            = delete;
+    allocation_meter& operator=(const allocation_meter&) = delete;
+    allocation_meter(allocation_meter&&)                 = delete;
+    allocation_meter& operator=(allocation_meter&&)      = delete;
+
+private:
+    benchmark::State& m_state;
+    allocation_stats m_start;
+};
+
+/**
+ * @brief Returns the dispatcher with the methods used by the benchmarks.
+ *
+ * @details The methods are the same as those of `BaseDispatcherTest`, plus `subtract_ex` (added with `add_ex()`)
+ * that reads the `auth` extra field.
+ *
+ * @return The dispatcher.
+ */
+wwa::json_rpc::dispatcher& bench_dispatcher();
+
+/**
+ * @brief Returns the dispatcher with the same methods as bench_dispatcher() that uses `sequential_id_generator`.
+ *
+ * @return The dispatcher.
+ */
+wwa::json_rpc::dispatcher& bench_dispatcher_with_sequential_ids();
+
+/**
+ * @brief Returns the dispatcher with the same methods as bench_dispatcher() and with the metrics enabled.
+ *
+ * @return The dispatcher.
+ */
+wwa::json_rpc::dispatcher& bench_dispatcher_with_metrics();
+
+#endif /* A3F0C2D1_6B4E_4F7A_9C58_2E1D7B9064AF */
@@ -0,0 +1,61 @@
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <benchmark/benchmark.h>
+#include <nlohmann/json.hpp>
+
+#include "base.h"
+#include "codec.h"
+
+using namespace std::string_view_literals;
+
+namespace {
+
+// clang-format off
+constexpr std::array<std::pair<std::string_view, std::string_view>, 5> codec_requests = {{
+    { "positional"sv, R"({"jsonrpc": "2.0", "method": "subtract_p", "params": [42, 23], "id": 1})"sv },
+    { "named"sv,      R"({"jsonrpc": "2.0", "method": "subtract", "params": {"minuend": 42, "subtrahend": 23}, "id": 1})"sv },
+    { "raw_params"sv, R"({"jsonrpc": "2.0", "method": "sumv", "params": [1, 2, 3, 4, 5, 6, 7, 8], "id": 1})"sv },
+    { "get_data"sv,   R"({"jsonrpc": "2.0", "method": "get_data", "id": "9"})"sv },
+    { "batch"sv,      R"([
+        {"jsonrpc": "2.0", "method": "sum", "params": [1, 2, 4], "id": "1"},
+        {"jsonrpc": "2.0", "method": "notify_hello", "params": [7]},
+        {"jsonrpc": "2.0", "method": "subtract_p", "params": [42, 23], "id": "2"},
+        {"jsonrpc": "2.0", "method": "get_data", "id": "9"}
+    ])"sv }
+}};
+// clang-format on
+
+/**
+ * @brief Decodes the request encoded with @a Codec, processes it, and encodes the response.
+ */
+template<typename Codec>
+void process_encoded(benchmark::State& state)
+{
+    const auto& [name, input] = codec_requests.at(static_cast<std::size_t>(state.range(0)));
+    auto& dispatcher          = bench_dispatcher();
+
+    std::string request;
+    Codec::encode(nlohmann::json::parse(input), request);
+
+    state.SetLabel(std::string(name));
+
+    std::string out;
+    const allocation_meter meter(state);
+    for (auto _ : state) {
+        out.clear();
+        const bool written = wwa::json_rpc::process_encoded_request<Codec>(dispatcher, request, out);
+        benchmark::DoNotOptimize(written);
+    }
+
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * (request.size() + out.size())));
+}
+
+}  // namespace
+
+BENCHMARK(process_encoded<wwa::json_rpc::json_codec>)->DenseRange(0, codec_requests.size() - 1);
+BENCHMARK(process_encoded<wwa::json_rpc::cbor_codec>)->DenseRange(0, codec_requests.size() - 1);
+BENCHMARK(process_encoded<wwa::json_rpc::msgpack_codec>)->DenseRange(0, codec_requests.size() - 1);
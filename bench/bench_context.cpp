@@ -0,0 +1,86 @@
+#include <any>
+#include <array>
+#include <string>
+#include <benchmark/benchmark.h>
+#include <nlohmann/json.hpp>
+
+#include "base.h"
+#include "dispatcher.h"
+
+namespace {
+
+/**
+ * @brief Per-connection state, large enough not to fit into the small buffer of `std::any`.
+ */
+struct connection {
+    std::string peer = "127.0.0.1";
+    std::array<char, 256> scratch{};
+    int user_id = 42;  // NOLINT(readability-magic-numbers)
+};
+
+using typed_dispatcher = wwa::json_rpc::basic_dispatcher<connection>;
+
+const std::string context_call = R"({"jsonrpc": "2.0", "method": "user", "params": [1], "id": 1})";
+
+int any_user(const wwa::json_rpc::dispatcher::context_t& ctx, int a)
+{
+    return std::any_cast<const connection&>(ctx.first).user_id + a;
+}
+
+int typed_user(const typed_dispatcher::context_t& ctx, int a)
+{
+    return ctx.first.user_id + a;
+}
+
+wwa::json_rpc::dispatcher& any_dispatcher()
+{
+    static wwa::json_rpc::dispatcher dispatcher;
+    static const bool initialized = (dispatcher.add_ex("user", &any_user), true);
+
+    static_cast<void>(initialized);
+    return dispatcher;
+}
+
+typed_dispatcher& context_dispatcher()
+{
+    static typed_dispatcher dispatcher;
+    static const bool initialized = (dispatcher.add_ex("user", &typed_user), true);
+
+    static_cast<void>(initialized);
+    return dispatcher;
+}
+
+/**
+ * @brief Processes a request with the connection passed as `std::any`.
+ */
+void process_any_context(benchmark::State& state)
+{
+    auto& dispatcher = any_dispatcher();
+    const std::any conn{connection{}};
+
+    const allocation_meter meter(state);
+    for (auto _ : state) {
+        auto response = dispatcher.process_request(context_call, conn);
+        benchmark::DoNotOptimize(response);
+    }
+}
+
+/**
+ * @brief Processes a request with the connection passed as a typed context.
+ */
+void process_typed_context(benchmark::State& state)
+{
+    auto& dispatcher = context_dispatcher();
+    const connection conn;
+
+    const allocation_meter meter(state);
+    for (auto _ : state) {
+        auto response = dispatcher.process_request(context_call, conn);
+        benchmark::DoNotOptimize(response);
+    }
+}
+
+}  // namespace
+
+BENCHMARK(process_any_context);
+BENCHMARK(process_typed_context);
@@ -0,0 +1,148 @@
+#include <array>
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+#include <benchmark/benchmark.h>
+#include <nlohmann/json.hpp>
+
+#include "base.h"
+#include "dispatcher.h"
+
+namespace {
+
+// clang-format off
+const std::string positional_call = R"({"jsonrpc": "2.0", "method": "subtract_p", "params": [42, 23], "id": 1})";
+const std::string named_call      = R"({"jsonrpc": "2.0", "method": "subtract", "params": {"minuend": 42, "subtrahend": 23}, "id": 1})";
+const std::string raw_params_call = R"({"jsonrpc": "2.0", "method": "sumv", "params": [1, 2, 3, 4, 5, 6, 7, 8], "id": 1})";
+const std::string notification    = R"({"jsonrpc": "2.0", "method": "notify_hello", "params": [7]})";
+const std::string extra_call      = R"({"jsonrpc": "2.0", "method": "subtract_ex", "params": {"minuend": 42, "subtrahend": 23}, "id": 1, "auth": "secret", "user": "admin"})";
+const std::string extra_ignored   = R"({"jsonrpc": "2.0", "method": "subtract", "params": {"minuend": 42, "subtrahend": 23}, "id": 1, "auth": "secret", "user": "admin"})";
+
+const std::string notification_batch = R"([
+    {"jsonrpc": "2.0", "method": "notify_hello", "params": [7]},
+    {"jsonrpc": "2.0", "method": "notification"},
+    {"jsonrpc": "2.0", "method": "subtract_p", "params": [42, 23]}
+])";
+
+const std::string mixed_batch = R"([
+    {"jsonrpc": "2.0", "method": "sum", "params": [1, 2, 4], "id": "1"},
+    {"jsonrpc": "2.0", "method": "notify_hello", "params": [7]},
+    {"jsonrpc": "2.0", "method": "subtract_p", "params": [42, 23], "id": "2"},
+    {"foo": "boo"},
+    {"jsonrpc": "2.0", "method": "foo.get", "params": {"name": "myself"}, "id": "5"},
+    {"jsonrpc": "2.0", "method": "get_data", "id": "9"}
+])";
+// clang-format on
+
+/**
+ * @brief Processes an already parsed request.
+ */
+void process_json(benchmark::State& state, const std::string& input)
+{
+    auto& dispatcher   = bench_dispatcher();
+    const auto request = nlohmann::json::parse(input);
+
+    const allocation_meter meter(state);
+    for (auto _ : state) {
+        auto response = dispatcher.process_request(request);
+        benchmark::DoNotOptimize(response);
+    }
+}
+
+/**
+ * @brief Parses and processes a request.
+ */
+void process_text(benchmark::State& state, const std::string& input)
+{
+    auto& dispatcher = bench_dispatcher();
+
+    const allocation_meter meter(state);
+    for (auto _ : state) {
+        auto response = dispatcher.process_request(input);
+        benchmark::DoNotOptimize(response);
+    }
+}
+
+/**
+ * @brief Parses and processes a request, and serializes the response into a reused buffer.
+ */
+void process_text_to(benchmark::State& state, const std::string& input)
+{
+    auto& dispatcher = bench_dispatcher();
+    std::string buffer;
+
+    const allocation_meter meter(state);
+    for (auto _ : state) {
+        buffer.clear();
+        const auto has_response = dispatcher.process_request_to(input, buffer);
+        benchmark::DoNotOptimize(has_response);
+        benchmark::DoNotOptimize(buffer.data());
+    }
+}
+
+/**
+ * @brief Same as process_text_to(), with the temporaries of each request allocated from a stack buffer.
+ */
+void process_text_to_arena(benchmark::State& state, const std::string& input)
+{
+    auto& dispatcher = bench_dispatcher();
+    std::string buffer;
+    std::array<std::byte, 4096> arena;  // NOLINT(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
+    std::pmr::monotonic_buffer_resource resource(arena.data(), arena.size());
+
+    const allocation_meter meter(state);
+    for (auto _ : state) {
+        buffer.clear();
+        const auto has_response = dispatcher.process_request_to(input, buffer, {}, &resource);
+        benchmark::DoNotOptimize(has_response);
+        benchmark::DoNotOptimize(buffer.data());
+        resource.release();
+    }
+}
+
+/**
+ * @brief Parses and processes a request with the metrics enabled.
+ */
+void process_text_metrics(benchmark::State& state, const std::string& input)
+{
+    auto& dispatcher = bench_dispatcher_with_metrics();
+
+    const allocation_meter meter(state);
+    for (auto _ : state) {
+        auto response = dispatcher.process_request(input);
+        benchmark::DoNotOptimize(response);
+    }
+}
+
+}  // namespace
+
+BENCHMARK_CAPTURE(process_json, positional, positional_call);
+BENCHMARK_CAPTURE(process_json, named, named_call);
+BENCHMARK_CAPTURE(process_json, raw_params, raw_params_call);
+BENCHMARK_CAPTURE(process_json, notification, notification);
+BENCHMARK_CAPTURE(process_json, notification_batch, notification_batch);
+BENCHMARK_CAPTURE(process_json, mixed_batch, mixed_batch);
+BENCHMARK_CAPTURE(process_json, extra, extra_call);
+BENCHMARK_CAPTURE(process_json, extra_ignored, extra_ignored);
+
+BENCHMARK_CAPTURE(process_text, positional, positional_call);
+BENCHMARK_CAPTURE(process_text, named, named_call);
+BENCHMARK_CAPTURE(process_text, raw_params, raw_params_call);
+BENCHMARK_CAPTURE(process_text, notification, notification);
+BENCHMARK_CAPTURE(process_text, notification_batch, notification_batch);
+BENCHMARK_CAPTURE(process_text, mixed_batch, mixed_batch);
+BENCHMARK_CAPTURE(process_text, extra, extra_call);
+BENCHMARK_CAPTURE(process_text, extra_ignored, extra_ignored);
+
+BENCHMARK_CAPTURE(process_text_to, positional, positional_call);
+BENCHMARK_CAPTURE(process_text_to, named, named_call);
+BENCHMARK_CAPTURE(process_text_to, mixed_batch, mixed_batch);
+BENCHMARK_CAPTURE(process_text_to, extra, extra_call);
+
+BENCHMARK_CAPTURE(process_text_to_arena, positional, positional_call);
+BENCHMARK_CAPTURE(process_text_to_arena, named, named_call);
+BENCHMARK_CAPTURE(process_text_to_arena, mixed_batch, mixed_batch);
+BENCHMARK_CAPTURE(process_text_to_arena, extra, extra_call);
+
+BENCHMARK_CAPTURE(process_text_metrics, positional, positional_call);
+BENCHMARK_CAPTURE(process_text_metrics, mixed_batch, mixed_batch);
@@ -0,0 +1,96 @@
+#include <array>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <benchmark/benchmark.h>
+#include <nlohmann/json.hpp>
+
+#include "base.h"
+#include "dispatcher.h"
+
+using namespace std::string_view_literals;
+
+namespace {
+
+// The requests from test_error_handling.cpp, plus a handler that throws
+// clang-format off
+constexpr std::array<std::pair<std::string_view, std::string_view>, 20> error_requests = {{
+    // RequestParsingFromStandard
+    { "invalid_request"sv,    R"({"jsonrpc": "2.0", "method": 1, "params": "bar"})"sv },
+    { "empty_batch"sv,        "[]"sv },
+    { "invalid_batch"sv,      "[1]"sv },
+    { "invalid_batch_3"sv,    "[1,2,3]"sv },
+    // RequestParsing
+    { "empty_method"sv,       R"({"jsonrpc": "2.0", "method": "", "id": 3})"sv },
+    { "bad_version"sv,        R"({"jsonrpc": "12.0", "method": ""})"sv },
+    { "missing_method"sv,     R"({"jsonrpc": "2.0"})"sv },
+    { "recursive_batch"sv,    "[[]]"sv },
+    { "bad_id"sv,             R"({"jsonrpc": "2.0", "method": "method", "id": true})"sv },
+    { "bad_params"sv,         R"({"jsonrpc": "2.0", "method": "method", "id": 3, "params": 1})"sv },
+    { "null_request"sv,       "null"sv },
+    // MethodInvocation
+    { "method_not_found"sv,   R"({"jsonrpc": "2.0", "method": "foobar", "id": "1"})"sv },
+    { "too_many_params"sv,    R"({"jsonrpc": "2.0", "method": "no_params", "id": 3, "params": [1]})"sv },
+    { "too_many_named"sv,     R"({"jsonrpc": "2.0", "method": "no_params", "id": 3, "params": {}})"sv },
+    { "wrong_param_type"sv,   R"({"jsonrpc": "2.0", "method": "subtract_p", "id": 3, "params": ["a", "b"]})"sv },
+    // RawRequestParsing
+    { "numeric_version"sv,    R"({"jsonrpc": 2, "method": "subtract_p", "params": [2, 1], "id": 1})"sv },
+    { "structured_method"sv,  R"({"jsonrpc": "2.0", "method": {"name": "subtract_p"}, "params": [2, 1], "id": 1})"sv },
+    { "duplicate_keys"sv,     R"({"jsonrpc": "2.0", "method": "subtract_p", "method": "foobar", "id": [1], "id": 2})"sv },
+    { "nested_batch"sv,       R"([[{"jsonrpc": "2.0", "method": "subtract_p", "params": [2, 1], "id": 1}], 1])"sv },
+    // Exception thrown by the handler
+    { "handler_throws"sv,     R"({"jsonrpc": "2.0", "method": "throwing", "id": 1})"sv }
+}};
+// clang-format on
+
+const auto& error_request(const benchmark::State& state)
+{
+    return error_requests.at(static_cast<std::size_t>(state.range(0)));
+}
+
+void process_error_json(benchmark::State& state)
+{
+    const auto& [name, input] = error_request(state);
+    auto& dispatcher          = bench_dispatcher();
+    const auto request        = nlohmann::json::parse(input);
+
+    state.SetLabel(std::string(name));
+
+    const allocation_meter meter(state);
+    for (auto _ : state) {
+        auto response = dispatcher.process_request(request);
+        benchmark::DoNotOptimize(response);
+    }
+}
+
+void process_error_text(benchmark::State& state)
+{
+    const auto& [name, input] = error_request(state);
+    auto& dispatcher          = bench_dispatcher();
+
+    state.SetLabel(std::string(name));
+
+    const allocation_meter meter(state);
+    for (auto _ : state) {
+        auto response = dispatcher.process_request(input);
+        benchmark::DoNotOptimize(response);
+    }
+}
+
+void process_parse_error(benchmark::State& state)
+{
+    auto& dispatcher = bench_dispatcher();
+
+    const allocation_meter meter(state);
+    for (auto _ : state) {
+        auto response = dispatcher.process_request(R"({"jsonrpc": "2.0", "method": "foobar, "params": "bar", "baz])"sv);
+        benchmark::DoNotOptimize(response);
+    }
+}
+
+}  // namespace
+
+BENCHMARK(process_error_json)->DenseRange(0, error_requests.size() - 1);
+BENCHMARK(process_error_text)->DenseRange(0, error_requests.size() - 1);
+BENCHMARK(process_parse_error);
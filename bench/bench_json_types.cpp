@@ -0,0 +1,146 @@
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory_resource>
+#include <string>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include <nlohmann/json.hpp>
+
+#include "base.h"
+#include "dispatcher.h"
+#include "static_dispatcher.h"
+
+namespace {
+
+/**
+ * @brief Returns the memory resource that arena_allocator allocates from in the calling thread.
+ *
+ * @return Reference to the pointer to the resource.
+ */
+std::pmr::memory_resource*& current_arena() noexcept
+{
+    thread_local std::pmr::memory_resource* resource = std::pmr::get_default_resource();
+    return resource;
+}
+
+/**
+ * @brief Stateless allocator that takes the memory from current_arena().
+ */
+template<typename T>
+struct arena_allocator {
+    using value_type = T;
+
+    arena_allocator() noexcept = default;
+
+    template<typename U>
+    arena_allocator(const arena_allocator<U>&) noexcept  // NOLINT(google-explicit-constructor)
+    {}
+
+    T* allocate(std::size_t n) { return static_cast<T*>(current_arena()->allocate(n * sizeof(T), alignof(T))); }
+
+    void deallocate(T* p, std::size_t n) noexcept { current_arena()->deallocate(p, n * sizeof(T), alignof(T)); }
+
+    friend bool operator==(const arena_allocator&, const arena_allocator&) noexcept { return true; }
+};
+
+using arena_json =
+    nlohmann::basic_json<std::map, std::vector, std::string, bool, std::int64_t, std::uint64_t, double, arena_allocator>;
+
+int subtract(int minuend, int subtrahend)
+{
+    return minuend - subtrahend;
+}
+
+template<typename BasicJsonType>
+int sum(const BasicJsonType& params)
+{
+    int result = 0;
+    for (const auto& value : params) {
+        result += value.template get<int>();
+    }
+
+    return result;
+}
+
+template<typename BasicJsonType>
+using bench_static_dispatcher = wwa::json_rpc::basic_static_dispatcher<
+    BasicJsonType, wwa::json_rpc::method<"subtract_p", &subtract>,
+    wwa::json_rpc::method<"sumv", &sum<BasicJsonType>>>;
+
+// clang-format off
+const std::string positional_call = R"({"jsonrpc": "2.0", "method": "subtract_p", "params": [42, 23], "id": 1})";
+const std::string raw_params_call = R"({"jsonrpc": "2.0", "method": "sumv", "params": [1, 2, 3, 4, 5, 6, 7, 8], "id": 1})";
+// clang-format on
+
+/**
+ * @brief Parses and processes a request with `nlohmann::json`.
+ */
+void parse_and_dispatch_json(benchmark::State& state, const std::string& input)
+{
+    const bench_static_dispatcher<nlohmann::json> dispatcher;
+
+    const allocation_meter meter(state);
+    for (auto _ : state) {
+        auto response = dispatcher.process_request(nlohmann::json::parse(input));
+        benchmark::DoNotOptimize(response);
+    }
+}
+
+/**
+ * @brief Parses and processes a request with a `basic_json` whose values come from a bump allocator.
+ *
+ * @details The arena is reset after every request.
+ */
+void parse_and_dispatch_arena(benchmark::State& state, const std::string& input)
+{
+    const bench_static_dispatcher<arena_json> dispatcher;
+
+    std::array<std::byte, 8192> buffer{};
+    std::pmr::monotonic_buffer_resource resource(buffer.data(), buffer.size());
+    current_arena() = &resource;
+
+    {
+        const allocation_meter meter(state);
+        for (auto _ : state) {
+            {
+                auto response = dispatcher.process_request(arena_json::parse(input));
+                benchmark::DoNotOptimize(response);
+            }
+
+            resource.release();
+        }
+    }
+
+    current_arena() = std::pmr::get_default_resource();
+}
+
+/**
+ * @brief Parses and processes a request with `ordered_dispatcher`.
+ */
+void process_text_ordered(benchmark::State& state, const std::string& input)
+{
+    static wwa::json_rpc::ordered_dispatcher dispatcher;
+    static const bool initialized =
+        (dispatcher.add("subtract_p", &subtract), dispatcher.add("sumv", &sum<nlohmann::ordered_json>), true);
+
+    static_cast<void>(initialized);
+
+    const allocation_meter meter(state);
+    for (auto _ : state) {
+        auto response = dispatcher.process_request(input);
+        benchmark::DoNotOptimize(response);
+    }
+}
+
+}  // namespace
+
+BENCHMARK_CAPTURE(parse_and_dispatch_json, positional, positional_call);
+BENCHMARK_CAPTURE(parse_and_dispatch_json, raw_params, raw_params_call);
+
+BENCHMARK_CAPTURE(parse_and_dispatch_arena, positional, positional_call);
+BENCHMARK_CAPTURE(parse_and_dispatch_arena, raw_params, raw_params_call);
+
+BENCHMARK_CAPTURE(process_text_ordered, positional, positional_call);
+BENCHMARK_CAPTURE(process_text_ordered, raw_params, raw_params_call);
@@ -0,0 +1,577 @@
+#include <arpa/inet.h>
+#include <malloc.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <benchmark/benchmark.h>
+
+#include "base.h"
+#include "server.h"
+
+namespace {
+
+// clang-format off
+const std::string positional_line = R"({"jsonrpc": "2.0", "method": "subtract_p", "params": [42, 23], "id": 1})" "\n";
+// clang-format on
+
+/**
+ * @brief The number of requests a client sends before reading the responses.
+ */
+constexpr std::size_t pipeline_depth = 64;
+
+/**
+ * @brief A running server shared by the benchmarks of a backend.
+ */
+struct bench_server {
+    wwa::json_rpc::server server;  ///< The server.
+    std::uint16_t port = 0;        ///< The TCP port.
+    std::string path;              ///< The path of the Unix-domain socket.
+
+    explicit bench_server(wwa::json_rpc::server_backend backend)
+        : server(
+              bench_dispatcher(), {},
+              {.threads = std::max(1U, std::thread::hardware_concurrency() / 2), .backend = backend}
+          ),
+          path(
+              "/tmp/bench_jsonrpc-" + std::to_string(::getpid()) +
+              (backend == wwa::json_rpc::server_backend::io_uring ? "-uring" : "") + ".sock"
+          )
+    {
+        this->port = this->server.listen_tcp("127.0.0.1", 0);
+        this->server.listen_unix(this->path);
+        this->server.start();
+    }
+};
+
+/**
+ * @brief Returns the server of a backend, starting it on first use.
+ *
+ * @param backend The backend.
+ * @return The server.
+ */
+bench_server& get_server(wwa::json_rpc::server_backend backend = wwa::json_rpc::server_backend::epoll)
+{
+    if (backend == wwa::json_rpc::server_backend::io_uring) {
+        static bench_server server(wwa::json_rpc::server_backend::io_uring);
+        return server;
+    }
+
+    static bench_server server(wwa::json_rpc::server_backend::epoll);
+    return server;
+}
+
+/**
+ * @brief A running server with a given number of reactors, used by the scaling benchmark.
+ */
+struct scaling_server {
+    wwa::json_rpc::server server;  ///< The server.
+    std::uint16_t port = 0;        ///< The TCP port.
+
+    scaling_server(std::size_t cores, bool per_core)
+        : server(bench_dispatcher(), {}, {.threads = cores, .thread_per_core = per_core, .pin_threads = per_core})
+    {
+        this->port = this->server.listen_tcp("127.0.0.1", 0);
+        this->server.start();
+    }
+};
+
+/**
+ * @brief Returns the server of the current scaling benchmark, replacing the server of the previous one.
+ *
+ * @param cores The number of reactors.
+ * @param per_core Whether to use the thread-per-core mode.
+ * @return The TCP port of the server.
+ */
+std::uint16_t get_scaling_server(std::size_t cores, bool per_core)
+{
+    static std::mutex mutex;
+    static std::unique_ptr<scaling_server> server;
+    static std::pair<std::size_t, bool> key;
+
+    const std::lock_guard lock(mutex);
+    if (!server || key != std::make_pair(cores, per_core)) {
+        server.reset();
+        server = std::make_unique<scaling_server>(cores, per_core);
+        key    = {cores, per_core};
+    }
+
+    return server->port;
+}
+
+/**
+ * @brief Returns the TCP port of a server that speaks HTTP, starting it on first use.
+ *
+ * @return The port.
+ */
+std::uint16_t get_http_server()
+{
+    static wwa::json_rpc::server server(
+        bench_dispatcher(), {},
+        {.threads = std::max(1U, std::thread::hardware_concurrency() / 2), .framing = wwa::json_rpc::framing_type::http}
+    );
+
+    static const std::uint16_t port = []() {
+        const auto p = server.listen_tcp("127.0.0.1", 0);
+        server.start();
+        return p;
+    }();
+
+    return port;
+}
+
+/**
+ * @brief Connects to a TCP port on the loopback interface.
+ *
+ * @param port The port.
+ * @return The socket, or `-1` on failure.
+ */
+int connect_tcp(std::uint16_t port)
+{
+    const int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    sockaddr_in addr{};
+    addr.sin_family      = AF_INET;
+    addr.sin_port        = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    const int one = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    if (::connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0) {  // NOLINT(*-reinterpret-cast)
+        ::close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+/**
+ * @brief Connects to the server.
+ *
+ * @param tcp Whether to use TCP instead of the Unix-domain socket.
+ * @param backend The backend of the server.
+ * @return The socket, or `-1` on failure.
+ */
+int connect_to_server(bool tcp, wwa::json_rpc::server_backend backend = wwa::json_rpc::server_backend::epoll)
+{
+    auto& srv = get_server(backend);
+    if (srv.server.backend() != backend) {
+        return -1;
+    }
+
+    if (tcp) {
+        return connect_tcp(srv.port);
+    }
+
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strncpy(static_cast<char*>(addr.sun_path), srv.path.c_str(), sizeof(addr.sun_path) - 1);
+    if (::connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0) {  // NOLINT(*-reinterpret-cast)
+        ::close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+/**
+ * @brief Returns the number of heap bytes in use by the process.
+ *
+ * @return The number of allocated bytes.
+ */
+std::size_t heap_in_use()
+{
+    return ::mallinfo2().uordblks;
+}
+
+/**
+ * @brief Returns the number of system calls the server has made per message since @a before.
+ *
+ * @param backend The backend.
+ * @param before The statistics at the beginning of the benchmark.
+ * @return The number of system calls per message.
+ */
+double syscalls_per_message(wwa::json_rpc::server_backend backend, const wwa::json_rpc::server_stats& before)
+{
+    const auto after    = get_server(backend).server.stats();
+    const auto messages = after.messages - before.messages;
+    return messages == 0 ? 0.0
+                         : static_cast<double>(after.syscalls - before.syscalls) / static_cast<double>(messages);
+}
+
+/**
+ * @brief Sends `pipeline_depth` requests and reads the responses.
+ *
+ * @param fd The socket.
+ * @param request The requests.
+ * @param buf The read buffer.
+ * @return Whether all responses have been received.
+ */
+bool exchange(int fd, std::string_view request, std::vector<char>& buf)
+{
+    while (!request.empty()) {
+        const auto n = ::send(fd, request.data(), request.size(), MSG_NOSIGNAL);
+        if (n <= 0) {
+            return false;
+        }
+
+        request.remove_prefix(static_cast<std::size_t>(n));
+    }
+
+    std::size_t responses = 0;
+    while (responses < pipeline_depth) {
+        const auto n = ::recv(fd, buf.data(), buf.size(), 0);
+        if (n <= 0) {
+            return false;
+        }
+
+        for (const char c : std::string_view(buf.data(), static_cast<std::size_t>(n))) {
+            responses += c == '\n' ? 1 : 0;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Returns `pipeline_depth` requests.
+ *
+ * @return The requests.
+ */
+const std::string& pipelined_requests()
+{
+    static const std::string request = []() {
+        std::string result;
+        for (std::size_t i = 0; i < pipeline_depth; ++i) {
+            result += positional_line;
+        }
+
+        return result;
+    }();
+
+    return request;
+}
+
+/**
+ * @brief Load test: every benchmark thread is a client that sends `pipeline_depth` requests and reads the responses.
+ *
+ * @details All clients talk to the same server; `items_per_second` is the total number of requests per second, and
+ * `syscalls/req` is the number of system calls made by the server per request.
+ */
+void serve_load(benchmark::State& state, bool tcp, wwa::json_rpc::server_backend backend)
+{
+    const int fd = connect_to_server(tcp, backend);
+    if (fd == -1) {
+        state.SkipWithError("Failed to connect to the server");
+        return;
+    }
+
+    const auto before = get_server(backend).server.stats();
+    std::vector<char> buf(64UL * 1024UL);
+    for (auto _ : state) {
+        if (!exchange(fd, pipelined_requests(), buf)) {
+            state.SkipWithError("Failed to exchange the messages");
+            break;
+        }
+    }
+
+    ::close(fd);
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(pipeline_depth));
+    if (state.thread_index() == 0) {
+        state.counters["syscalls/req"] = syscalls_per_message(backend, before);
+    }
+}
+
+/**
+ * @brief Scaling test: `scaling_clients()` benchmark threads load a TCP server with `state.range(0)` reactors.
+ *
+ * @details With @a per_core set, the server runs in the thread-per-core mode (`SO_REUSEPORT` listeners, pinned
+ * threads, per-core request IDs); otherwise, the reactors share one listening socket. `items_per_second` is the total
+ * number of requests per second. The clients run on the same machine and compete with the server for the CPUs.
+ */
+void core_scaling(benchmark::State& state, bool per_core)
+{
+    const auto port = get_scaling_server(static_cast<std::size_t>(state.range(0)), per_core);
+    const int fd    = connect_tcp(port);
+    if (fd == -1) {
+        state.SkipWithError("Failed to connect to the server");
+        return;
+    }
+
+    std::vector<char> buf(64UL * 1024UL);
+    for (auto _ : state) {
+        if (!exchange(fd, pipelined_requests(), buf)) {
+            state.SkipWithError("Failed to exchange the messages");
+            break;
+        }
+    }
+
+    ::close(fd);
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(pipeline_depth));
+}
+
+/**
+ * @brief Counts the complete HTTP responses at the beginning of a buffer and removes them.
+ *
+ * @param buf The received data.
+ * @return The number of responses, or `-1` if a response is not `200 OK` or `204 No Content`.
+ */
+int take_http_responses(std::string& buf)
+{
+    static constexpr std::string_view length_field = "Content-Length:";
+
+    int count       = 0;
+    std::size_t pos = 0;
+    while (true) {
+        const auto end = buf.find("\r\n\r\n", pos);
+        if (end == std::string::npos) {
+            break;
+        }
+
+        const std::string_view head(buf.data() + pos, end - pos);
+        if (!head.starts_with("HTTP/1.1 200") && !head.starts_with("HTTP/1.1 204")) {
+            return -1;
+        }
+
+        std::size_t length = 0;
+        if (const auto field = head.find(length_field); field != std::string_view::npos) {
+            auto value = head.substr(field + length_field.size());
+            value.remove_prefix(std::min(value.find_first_not_of(' '), value.size()));
+            std::from_chars(value.data(), value.data() + value.size(), length);
+        }
+
+        if (buf.size() < end + 4 + length) {
+            break;
+        }
+
+        pos = end + 4 + length;
+        ++count;
+    }
+
+    buf.erase(0, pos);
+    return count;
+}
+
+/**
+ * @brief HTTP load test: every benchmark thread is a keep-alive client that sends `state.range(0)` pipelined `POST`
+ * requests and reads the responses.
+ *
+ * @details The benchmark is its own load generator: it builds the requests once and parses just enough of
+ * the responses to find their ends. `items_per_second` is the total number of requests per second. An external
+ * generator (`wrk`, `h2load` and so on) can be pointed at a server started with `framing_type::http` instead.
+ */
+void http_load(benchmark::State& state)
+{
+    const auto depth = static_cast<std::size_t>(state.range(0));
+    const int fd     = connect_tcp(get_http_server());
+    if (fd == -1) {
+        state.SkipWithError("Failed to connect to the server");
+        return;
+    }
+
+    const auto body = std::string_view(positional_line).substr(0, positional_line.size() - 1);
+
+    std::string request;
+    for (std::size_t i = 0; i < depth; ++i) {
+        request.append("POST /rpc HTTP/1.1\r\nHost: localhost\r\nContent-Type: application/json\r\nContent-Length: ")
+            .append(std::to_string(body.size()))
+            .append("\r\n\r\n")
+            .append(body);
+    }
+
+    std::string received;
+    std::vector<char> buf(64UL * 1024UL);
+    for (auto _ : state) {
+        std::string_view data = request;
+        while (!data.empty()) {
+            const auto n = ::send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+            if (n <= 0) {
+                state.SkipWithError("Failed to send the requests");
+                break;
+            }
+
+            data.remove_prefix(static_cast<std::size_t>(n));
+        }
+
+        std::size_t responses = 0;
+        while (responses < depth) {
+            const auto n = ::recv(fd, buf.data(), buf.size(), 0);
+            if (n <= 0) {
+                state.SkipWithError("Failed to read the responses");
+                break;
+            }
+
+            received.append(buf.data(), static_cast<std::size_t>(n));
+            const auto count = take_http_responses(received);
+            if (count < 0) {
+                state.SkipWithError("Unexpected response");
+                break;
+            }
+
+            responses += static_cast<std::size_t>(count);
+        }
+    }
+
+    ::close(fd);
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(depth));
+}
+
+/**
+ * @brief Returns the number of clients of the scaling benchmark.
+ *
+ * @return Two clients per core.
+ */
+int scaling_clients()
+{
+    return static_cast<int>(2 * std::max(1U, std::thread::hardware_concurrency()));
+}
+
+/**
+ * @brief Registers the numbers of reactors of the scaling benchmark: the powers of two up to the number of cores,
+ * and the number of cores.
+ *
+ * @param b The benchmark.
+ */
+void scaling_args(benchmark::internal::Benchmark* b)
+{
+    const auto cores = static_cast<std::int64_t>(std::max(1U, std::thread::hardware_concurrency()));
+    for (std::int64_t n = 1; n < cores; n *= 2) {
+        b->Arg(n);
+    }
+
+    b->Arg(cores);
+}
+
+/**
+ * @brief Latency test: every benchmark thread is a TCP client that sends one request and waits for the response.
+ *
+ * @details `p99_us` is the 99th percentile of the round-trip time of the first client in microseconds, and
+ * `syscalls/req` is the number of system calls made by the server per request.
+ */
+void round_trip(benchmark::State& state, wwa::json_rpc::server_backend backend)
+{
+    const int fd = connect_to_server(true, backend);
+    if (fd == -1) {
+        state.SkipWithError("Failed to connect to the server");
+        return;
+    }
+
+    std::vector<double> latencies;
+    latencies.reserve(1UL << 20U);
+
+    const auto before = get_server(backend).server.stats();
+    std::array<char, 4096> buf{};
+    for (auto _ : state) {
+        const auto start = std::chrono::steady_clock::now();
+        if (::send(fd, positional_line.data(), positional_line.size(), MSG_NOSIGNAL) <= 0) {
+            state.SkipWithError("Failed to send the request");
+            break;
+        }
+
+        // The response is much smaller than the socket buffer and arrives in one segment
+        const auto n = ::recv(fd, buf.data(), buf.size(), 0);
+        if (n <= 0 || buf.at(static_cast<std::size_t>(n) - 1) != '\n') {
+            state.SkipWithError("Failed to read the response");
+            break;
+        }
+
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        latencies.push_back(std::chrono::duration<double, std::micro>(elapsed).count());
+    }
+
+    ::close(fd);
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index() == 0 && !latencies.empty()) {
+        const auto p99 = latencies.begin() + static_cast<std::ptrdiff_t>(latencies.size() * 99 / 100);
+        std::nth_element(latencies.begin(), p99, latencies.end());
+        state.counters["p99_us"]       = *p99;
+        state.counters["syscalls/req"] = syscalls_per_message(backend, before);
+    }
+}
+
+/**
+ * @brief Opens `state.range(0)` idle connections and reports the heap memory the server uses per connection
+ * (`bytes/conn`).
+ *
+ * @details The kernel socket buffers are not included.
+ */
+void idle_connections(benchmark::State& state)
+{
+    const auto count = static_cast<std::size_t>(state.range(0));
+
+    rlimit limit{};
+    ::getrlimit(RLIMIT_NOFILE, &limit);
+    limit.rlim_cur = limit.rlim_max;
+    ::setrlimit(RLIMIT_NOFILE, &limit);
+    if (limit.rlim_cur < 2 * count + 64) {
+        state.SkipWithError("Too few file descriptors");
+        return;
+    }
+
+    auto& srv       = get_server();
+    double per_conn = 0;
+    for (auto _ : state) {
+        const auto before = heap_in_use();
+        const auto open   = srv.server.stats().connections_open;
+
+        std::vector<int> fds;
+        fds.reserve(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            const int fd = connect_to_server(false);
+            if (fd == -1) {
+                state.SkipWithError("Failed to connect to the server");
+                break;
+            }
+
+            fds.push_back(fd);
+        }
+
+        while (srv.server.stats().connections_open < open + fds.size()) {
+            std::this_thread::yield();
+        }
+
+        per_conn = (static_cast<double>(heap_in_use()) - static_cast<double>(before)) / static_cast<double>(count);
+
+        for (const int fd : fds) {
+            ::close(fd);
+        }
+
+        while (srv.server.stats().connections_open > open) {
+            std::this_thread::yield();
+        }
+    }
+
+    state.counters["bytes/conn"] = per_conn;
+}
+
+}  // namespace
+
+using wwa::json_rpc::server_backend;
+
+BENCHMARK_CAPTURE(serve_load, unix_socket, false, server_backend::epoll)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK_CAPTURE(serve_load, tcp, true, server_backend::epoll)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK_CAPTURE(serve_load, unix_socket_io_uring, false, server_backend::io_uring)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK_CAPTURE(serve_load, tcp_io_uring, true, server_backend::io_uring)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK_CAPTURE(round_trip, epoll, server_backend::epoll)->Threads(1)->Threads(16)->UseRealTime();
+BENCHMARK_CAPTURE(round_trip, io_uring, server_backend::io_uring)->Threads(1)->Threads(16)->UseRealTime();
+BENCHMARK_CAPTURE(core_scaling, shared, false)->Apply(scaling_args)->Threads(scaling_clients())->UseRealTime();
+BENCHMARK_CAPTURE(core_scaling, thread_per_core, true)->Apply(scaling_args)->Threads(scaling_clients())->UseRealTime();
+BENCHMARK(http_load)->Arg(1)->Arg(static_cast<std::int64_t>(pipeline_depth))->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK(idle_connections)->Arg(5000)->Iterations(3)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,141 @@
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <benchmark/benchmark.h>
+
+#include "base.h"
+#include "stream.h"
+
+namespace {
+
+// clang-format off
+const std::string positional_line = R"({"jsonrpc": "2.0", "method": "subtract_p", "params": [42, 23], "id": 1})" "\n";
+const std::string notification_line = R"({"jsonrpc": "2.0", "method": "notify_hello", "params": [7]})" "\n";
+// clang-format on
+
+/**
+ * @brief Feeds a file with `state.range(0)` copies of @a line to the driver; the responses go to `/dev/null`.
+ *
+ * @details With @a dispatch set to `false`, the lines are answered with a constant response without being parsed,
+ * which measures the overhead of the driver itself.
+ */
+void process_ndjson(benchmark::State& state, const std::string& line, bool dispatch)
+{
+    auto& dispatcher = bench_dispatcher();
+
+    const wwa::json_rpc::message_handler echo = [](std::string_view, std::string& out) {
+        out.append(R"({"jsonrpc":"2.0","result":19,"id":1})");
+        return true;
+    };
+
+    const std::unique_ptr<std::FILE, decltype(&std::fclose)> input(std::tmpfile(), &std::fclose);
+    const int in_fd = ::fileno(input.get());
+    const int lines = static_cast<int>(state.range(0));
+
+    std::string chunk;
+    for (int i = 0; i < 1000; ++i) {
+        chunk += line;
+    }
+
+    for (int i = 0; i < lines / 1000; ++i) {
+        if (::write(in_fd, chunk.data(), chunk.size()) != static_cast<ssize_t>(chunk.size())) {
+            state.SkipWithError("Failed to write the input");
+            return;
+        }
+    }
+
+    const int out_fd = ::open("/dev/null", O_WRONLY | O_CLOEXEC);
+    std::int64_t bytes = 0;
+
+    const allocation_meter meter(state);
+    for (auto _ : state) {
+        ::lseek(in_fd, 0, SEEK_SET);
+        const auto stats = dispatch ? wwa::json_rpc::process_ndjson_stream(dispatcher, in_fd, out_fd)
+                                    : wwa::json_rpc::run_ndjson_stream(in_fd, out_fd, echo);
+        bytes += static_cast<std::int64_t>(stats.bytes_read);
+    }
+
+    ::close(out_fd);
+    state.SetBytesProcessed(bytes);
+    state.SetItemsProcessed(state.iterations() * lines);
+}
+
+/**
+ * @brief Pushes `state.range(0)` `Content-Length` framed copies of @a body through a pipe to the driver;
+ * the responses go to `/dev/null`.
+ *
+ * @details The requests are written to the pipe by another thread, so that partial reads are common.
+ * With @a dispatch set to `false`, the bodies are answered with a constant response without being parsed,
+ * which measures the overhead of the driver itself.
+ */
+void process_framed(benchmark::State& state, std::string_view body, bool dispatch)
+{
+    auto& dispatcher = bench_dispatcher();
+
+    const wwa::json_rpc::message_handler echo = [](std::string_view, std::string& out) {
+        out.append(R"({"jsonrpc":"2.0","result":19,"id":1})");
+        return true;
+    };
+
+    const int messages = static_cast<int>(state.range(0));
+    const std::string message = "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n" + std::string(body);
+
+    std::string chunk;
+    for (int i = 0; i < 1000; ++i) {
+        chunk += message;
+    }
+
+    const int out_fd = ::open("/dev/null", O_WRONLY | O_CLOEXEC);
+    std::int64_t bytes = 0;
+
+    const allocation_meter meter(state);
+    for (auto _ : state) {
+        std::array<int, 2> fds{};
+        if (::pipe(fds.data()) != 0) {
+            state.SkipWithError("Failed to create a pipe");
+            break;
+        }
+
+        std::thread writer([fd = fds[1], &chunk, messages]() {
+            for (int i = 0; i < messages / 1000; ++i) {
+                std::string_view data = chunk;
+                while (!data.empty()) {
+                    const auto n = ::write(fd, data.data(), data.size());
+                    if (n <= 0) {
+                        break;
+                    }
+
+                    data.remove_prefix(static_cast<std::size_t>(n));
+                }
+            }
+
+            ::close(fd);
+        });
+
+        const auto stats = dispatch ? wwa::json_rpc::process_framed_stream(dispatcher, fds[0], out_fd)
+                                    : wwa::json_rpc::run_framed_stream(fds[0], out_fd, echo);
+        writer.join();
+        ::close(fds[0]);
+        bytes += static_cast<std::int64_t>(stats.bytes_read);
+    }
+
+    ::close(out_fd);
+    state.SetBytesProcessed(bytes);
+    state.SetItemsProcessed(state.iterations() * messages);
+}
+
+}  // namespace
+
+BENCHMARK_CAPTURE(process_ndjson, positional, positional_line, true)->Arg(100000)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(process_ndjson, notification, notification_line, true)->Arg(100000)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(process_ndjson, framing_only, positional_line, false)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_CAPTURE(process_framed, positional, positional_line, true)->Arg(100000)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(process_framed, framing_only, positional_line, false)->Arg(100000)->Unit(benchmark::kMillisecond);
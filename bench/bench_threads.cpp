@@ -0,0 +1,39 @@
+#include <string>
+#include <benchmark/benchmark.h>
+#include <nlohmann/json.hpp>
+
+#include "base.h"
+#include "dispatcher.h"
+
+namespace {
+
+// clang-format off
+const std::string positional_call = R"({"jsonrpc": "2.0", "method": "subtract_p", "params": [42, 23], "id": 1})";
+const std::string notification    = R"({"jsonrpc": "2.0", "method": "notify_hello", "params": [7]})";
+// clang-format on
+
+/**
+ * @brief Processes an already parsed request from every benchmark thread.
+ *
+ * @details All threads share @a dispatcher; the throughput (`items_per_second`) is the total over the threads.
+ */
+void process_json_threads(benchmark::State& state, wwa::json_rpc::dispatcher& (*dispatcher)(), const std::string& input)
+{
+    auto& d            = dispatcher();
+    const auto request = nlohmann::json::parse(input);
+
+    for (auto _ : state) {
+        auto response = d.process_request(request);
+        benchmark::DoNotOptimize(response);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+}  // namespace
+
+// clang-format off
+BENCHMARK_CAPTURE(process_json_threads, block_ids, &bench_dispatcher, positional_call)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK_CAPTURE(process_json_threads, sequential_ids, &bench_dispatcher_with_sequential_ids, positional_call)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK_CAPTURE(process_json_threads, notification, &bench_dispatcher, notification)->ThreadRange(1, 64)->UseRealTime();
+// clang-format on
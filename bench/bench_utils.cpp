@@ -0,0 +1,37 @@
+#include <string>
+#include <benchmark/benchmark.h>
+#include <nlohmann/json.hpp>
+
+#include "base.h"
+#include "utils.h"
+
+namespace {
+
+void serialize_response(benchmark::State& state, const nlohmann::json& response)
+{
+    const allocation_meter meter(state);
+    for (auto _ : state) {
+        auto result = wwa::json_rpc::serialize_repsonse(response);
+        benchmark::DoNotOptimize(result);
+    }
+}
+
+const nlohmann::json success = nlohmann::json::parse(R"({"jsonrpc": "2.0", "result": 19, "id": 1})");
+const nlohmann::json error   = nlohmann::json::parse(
+    R"({"jsonrpc": "2.0", "error": {"code": -32601, "message": "Method not found"}, "id": "1"})"
+);
+const nlohmann::json batch = nlohmann::json::parse(R"([
+    {"jsonrpc": "2.0", "result": 7, "id": "1"},
+    {"jsonrpc": "2.0", "result": 19, "id": "2"},
+    {"jsonrpc": "2.0", "error": {"code": -32600, "message": "Invalid Request"}, "id": null},
+    {"jsonrpc": "2.0", "error": {"code": -32601, "message": "Method not found"}, "id": "5"},
+    {"jsonrpc": "2.0", "result": ["hello", 5], "id": "9"}
+])");
+const nlohmann::json discarded(nlohmann::json::value_t::discarded);
+
+}  // namespace
+
+BENCHMARK_CAPTURE(serialize_response, success, success);
+BENCHMARK_CAPTURE(serialize_response, error, error);
+BENCHMARK_CAPTURE(serialize_response, batch, batch);
+BENCHMARK_CAPTURE(serialize_response, discarded, discarded);
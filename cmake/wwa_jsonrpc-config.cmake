@@ -4,6 +4,7 @@ list(APPEND CMAKE_MODULE_PATH ${JSONRPC_CMAKE_DIR})
 
 include(CMakeFindDependencyMacro)
 find_dependency(nlohmann_json)
+find_dependency(Threads)
 
 if(NOT TARGET wwa_jsonrpc)
     include("${JSONRPC_CMAKE_DIR}/wwa_jsonrpc-target.cmake")
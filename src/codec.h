@@ -0,0 +1,198 @@
+#ifndef C4F8E2A7_3D51_4B96_8E0C_71A9F5D2B36E
+#define C4F8E2A7_3D51_4B96_8E0C_71A9F5D2B36E
+
+/**
+ * @file
+ * @brief Codecs for the JSON RPC messages encoded as JSON text, CBOR, or MessagePack.
+ */
+
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <nlohmann/json.hpp>
+
+#include "dispatcher.h"
+#include "exception.h"
+#include "utils.h"
+
+namespace wwa::json_rpc {
+
+/**
+ * @brief Encodes the messages as JSON text.
+ *
+ * @details A codec is a type with two static member function templates:
+ * @li `BasicJsonType decode<BasicJsonType>(std::string_view input)` decodes a message and throws
+ * `BasicJsonType::exception` if @a input is malformed;
+ * @li `void encode(const BasicJsonType& value, std::string& out)` appends the encoded @a value to @a out.
+ *
+ * If the encoding is supported by `nlohmann::basic_json::sax_parse()`, the codec also has the static `format` member,
+ * and the requests are decoded without building a DOM for them (see `basic_dispatcher::process_request_as()`).
+ *
+ * Binary encodings use `std::string` as a byte buffer, so that the same buffers work for all codecs.
+ *
+ * @see process_encoded_request()
+ */
+struct json_codec {
+    static constexpr auto format = nlohmann::json::input_format_t::json;  ///< The input format of `sax_parse()`.
+
+    /**
+     * @brief Decodes a message.
+     *
+     * @tparam BasicJsonType The JSON type (a `nlohmann::basic_json` specialization).
+     * @param input The encoded message.
+     * @return The decoded message.
+     * @throws typename BasicJsonType::parse_error If @a input is not a valid JSON.
+     */
+    template<typename BasicJsonType>
+    static BasicJsonType decode(std::string_view input)
+    {
+        return BasicJsonType::parse(input);
+    }
+
+    /**
+     * @brief Encodes a message.
+     *
+     * @tparam BasicJsonType The JSON type (a `nlohmann::basic_json` specialization).
+     * @param value The message.
+     * @param out The output buffer; the encoded message is appended to it.
+     */
+    template<typename BasicJsonType>
+    static void encode(const BasicJsonType& value, std::string& out)
+    {
+        out += value.dump();
+    }
+};
+
+/**
+ * @brief Encodes the messages as [CBOR](https://json.nlohmann.me/features/binary_formats/cbor/).
+ * @see json_codec
+ */
+struct cbor_codec {
+    static constexpr auto format = nlohmann::json::input_format_t::cbor;  ///< The input format of `sax_parse()`.
+
+    /**
+     * @brief Decodes a message.
+     *
+     * @tparam BasicJsonType The JSON type (a `nlohmann::basic_json` specialization).
+     * @param input The encoded message.
+     * @return The decoded message.
+     * @throws typename BasicJsonType::parse_error If @a input is not a valid CBOR.
+     */
+    template<typename BasicJsonType>
+    static BasicJsonType decode(std::string_view input)
+    {
+        return BasicJsonType::from_cbor(input.begin(), input.end());
+    }
+
+    /**
+     * @brief Encodes a message.
+     *
+     * @tparam BasicJsonType The JSON type (a `nlohmann::basic_json` specialization).
+     * @param value The message.
+     * @param out The output buffer; the encoded message is appended to it.
+     */
+    template<typename BasicJsonType>
+    static void encode(const BasicJsonType& value, std::string& out)
+    {
+        BasicJsonType::to_cbor(value, out);
+    }
+};
+
+/**
+ * @brief Encodes the messages as [MessagePack](https://json.nlohmann.me/features/binary_formats/messagepack/).
+ * @see json_codec
+ */
+struct msgpack_codec {
+    static constexpr auto format = nlohmann::json::input_format_t::msgpack;  ///< The input format of `sax_parse()`.
+
+    /**
+     * @brief Decodes a message.
+     *
+     * @tparam BasicJsonType The JSON type (a `nlohmann::basic_json` specialization).
+     * @param input The encoded message.
+     * @return The decoded message.
+     * @throws typename BasicJsonType::parse_error If @a input is not a valid MessagePack.
+     */
+    template<typename BasicJsonType>
+    static BasicJsonType decode(std::string_view input)
+    {
+        return BasicJsonType::from_msgpack(input.begin(), input.end());
+    }
+
+    /**
+     * @brief Encodes a message.
+     *
+     * @tparam BasicJsonType The JSON type (a `nlohmann::basic_json` specialization).
+     * @param value The message.
+     * @param out The output buffer; the encoded message is appended to it.
+     */
+    template<typename BasicJsonType>
+    static void encode(const BasicJsonType& value, std::string& out)
+    {
+        BasicJsonType::to_msgpack(value, out);
+    }
+};
+
+/**
+ * @brief Decodes a JSON RPC request, processes it, and encodes the response.
+ *
+ * @tparam Codec The codec (json_codec, cbor_codec, msgpack_codec, or a user-defined one).
+ * @tparam Context The type of the data passed to the handlers.
+ * @tparam BasicJsonType The JSON type (a `nlohmann::basic_json` specialization).
+ * @param dispatcher The dispatcher.
+ * @param request The encoded request.
+ * @param out The output buffer; the encoded response is appended to it.
+ * @param data Optional data that can be passed to the handler function (only for handlers added with @a add_ex()).
+ * @return Whether a response has been written. If the request is a [Notification](https://www.jsonrpc.org/specification#notification)
+ * (or a batch of notifications), nothing is written and the function returns `false`.
+ *
+ * @details The responses are the same as the responses of `basic_dispatcher::process_request()` for the decoded
+ * request. If @a request cannot be decoded, the response is an error with code `-32700` (exception::PARSE_ERROR).
+ *
+ * JSON text is processed with `basic_dispatcher::process_request_to()`, which does not build a DOM for the request
+ * and for the response. The encodings supported by `sax_parse()` are processed with
+ * `basic_dispatcher::process_request_as()`. Requests in other encodings are decoded into a DOM, which is then passed
+ * to `basic_dispatcher::process_request()`, so that the overrides of `do_process_request()`
+ * and `process_batch_request()` are called for them.
+ */
+template<typename Codec, typename Context, typename BasicJsonType>
+bool process_encoded_request(
+    basic_dispatcher<Context, BasicJsonType>& dispatcher, std::string_view request, std::string& out,
+    const std::type_identity_t<Context>& data = {}
+)
+{
+    if constexpr (std::is_same_v<Codec, json_codec>) {
+        return dispatcher.process_request_to(request, out, data);
+    }
+    else {
+        BasicJsonType response;
+        if constexpr (requires { Codec::format; }) {
+            response = dispatcher.process_request_as(request, Codec::format, data);
+        }
+        else {
+            BasicJsonType decoded;
+            try {
+                decoded = Codec::template decode<BasicJsonType>(request);
+            }
+            catch (const typename BasicJsonType::exception& e) {
+                const exception error(exception::PARSE_ERROR, e.what());
+                Codec::encode(generate_error_response<BasicJsonType>(error), out);
+                return true;
+            }
+
+            response = dispatcher.process_request(decoded, data);
+        }
+
+        if (response.is_discarded()) {
+            return false;
+        }
+
+        Codec::encode(response, out);
+        return true;
+    }
+}
+
+}  // namespace wwa::json_rpc
+
+#endif /* C4F8E2A7_3D51_4B96_8E0C_71A9F5D2B36E */
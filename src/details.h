@@ -17,12 +17,22 @@
  * @internal
  */
 
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <initializer_list>
+#include <span>
+#include <string>
+#include <string_view>
 #include <tuple>
 #include <type_traits>
 #include <utility>
+#include <vector>
 #include <nlohmann/json.hpp>
 #include "exception.h"
+#include "expected.h"
+#include "task.h"
 
 /**
  * @brief Contains the implementation details of the JSON RPC library.
@@ -250,54 +260,89 @@ requires(std::is_class_v<std::remove_pointer_t<C>> || std::is_null_pointer_v<C>)
 /**
  * @brief Creates a tuple from the provided context object based on the type of @a Context.
  *
- * @tparam Context The type of the context.
+ * @tparam Context The type of the context parameter of the handler (can be `void` or `basic_dispatcher::context_t`).
+ * @tparam Ctx The type of the context object.
  * @param ctx The context object from which the tuple is created.
- * @return A tuple containing the context object.
+ * @return A tuple containing a reference to the context object (the context is not copied).
  *
  * @throws wwa::json_rpc::exception If the extraction of @a Extra from the JSON object @a extra fails.
  */
-template<typename Context>
-constexpr auto make_context_tuple([[maybe_unused]] const std::pair<std::any, nlohmann::json>& ctx)
+template<typename Context, typename Ctx>
+constexpr auto make_context_tuple([[maybe_unused]] const Ctx& ctx)
 {
     if constexpr (std::is_void_v<Context>) {
         return std::make_tuple();
     }
     else {
-        return std::make_tuple(ctx);
+        return std::tie(ctx);
+    }
+}
+
+/**
+ * @brief Converts the value returned by a handler to the result of the method.
+ *
+ * @tparam BasicJsonType The JSON type (a `nlohmann::basic_json` specialization).
+ * @tparam R The type of the value.
+ * @param value The value returned by the handler.
+ * @return The value converted to a JSON value, or the error if @a value is an `expected` that holds an error.
+ *
+ * @details If @a value is an `expected` (see is_expected), its error is passed through, and its value
+ * (`null` for `expected<void>`) is converted to a JSON value. Any other value is converted to a JSON value directly.
+ */
+template<typename BasicJsonType, typename R>
+expected<BasicJsonType> make_result(R&& value)
+{
+    using T = std::remove_cvref_t<R>;
+
+    if constexpr (is_expected_v<T>) {
+        if (!value.has_value()) {
+            return unexpected(std::forward<R>(value).error());
+        }
+
+        if constexpr (std::is_void_v<typename T::value_type>) {
+            return BasicJsonType(nullptr);
+        }
+        else {
+            return BasicJsonType(*std::forward<R>(value));
+        }
+    }
+    else {
+        return BasicJsonType(std::forward<R>(value));
     }
 }
 
 /**
  * @brief Invokes a function with the provided arguments handling `void` return type.
  *
+ * @tparam BasicJsonType The JSON type (a `nlohmann::basic_json` specialization).
  * @tparam F The type of the function.
  * @tparam Tuple The type of the arguments tuple.
  * @param f The function.
  * @param tuple The arguments as a tuple.
- * @return The result of the function converted to a JSON value.
- * @retval nlohmann::json::null_t If the function returns void.
+ * @return The result of the function converted to a JSON value, or the error returned by the function.
+ * @retval null If the function returns void.
  *
  * @details This helper invokes the function with the arguments passed as a tuple.
+ * The result is converted with make_result().
  * It uses the `if constexpr` construct to handle the case when the handler function returns void.
  *
  * The `if constexpr` construct allows for determinining at compile time whether @a f returns `void`.
  * If the return type is `void`, `invoke_function` calls @a f and returns a JSON `null` value.
  * If the return type is not `void`, `invoke_function` calls @a f and returns the result converted to a JSON value.
  */
-template<typename F, typename Tuple>
-nlohmann::json invoke_function(F&& f, Tuple&& tuple)
+template<typename BasicJsonType, typename F, typename Tuple>
+expected<BasicJsonType> invoke_function(F&& f, Tuple&& tuple)
 {
     using ReturnType = typename details::function_traits<std::decay_t<F>>::return_type;
 
     if constexpr (std::is_void_v<ReturnType>) {
         std::apply(std::forward<F>(f), std::forward<Tuple>(tuple));
-        return nullptr;
+        return BasicJsonType(nullptr);
     }
     else {
-        return std::apply(std::forward<F>(f), std::forward<Tuple>(tuple));
+        return make_result<BasicJsonType>(std::apply(std::forward<F>(f), std::forward<Tuple>(tuple)));
     }
 }
-
 /**
  * @brief Type alias for a tuple element with decay applied.
  *
@@ -310,16 +355,310 @@ nlohmann::json invoke_function(F&& f, Tuple&& tuple)
 template<std::size_t I, typename A>
 using tuple_element = std::decay_t<std::tuple_element_t<I, A>>;
 
+/**
+ * @brief Reference to a value stored inside the parameters of the request.
+ *
+ * @tparam T The type of the value (`BasicJsonType::string_t`, `BasicJsonType::array_t`, or `BasicJsonType`).
+ *
+ * @details Stored in the tuple of arguments instead of a copy of the value when the handler accepts `const T&`;
+ * converts to `const T&` when the handler is invoked. Unlike `std::reference_wrapper`, it is default constructible,
+ * so that the tuple of arguments can be created before the conversion.
+ */
+template<typename T>
+class param_ref {
+public:
+    using type = T;  ///< The type of the value.
+
+    param_ref() noexcept = default;
+
+    /**
+     * @brief Constructs a reference to @a value.
+     *
+     * @param value The value.
+     */
+    explicit param_ref(const T& value) noexcept : m_value(&value) {}
+
+    /**
+     * @brief Returns the referenced value.
+     *
+     * @return The value.
+     */
+    operator const T&() const noexcept  // NOLINT(google-explicit-constructor,hicpp-explicit-conversions)
+    {
+        assert(this->m_value != nullptr);
+        return *this->m_value;
+    }
+
+private:
+    const T* m_value = nullptr;  ///< The referenced value.
+};
+
+/**
+ * @brief Checks whether the handler parameter of type @a Arg is bound directly to the storage inside the parameters.
+ *
+ * @tparam Arg The type of the parameter of the handler.
+ * @tparam BasicJsonType The JSON type (a `nlohmann::basic_json` specialization).
+ *
+ * @details These are `const BasicJsonType::string_t&`, `const BasicJsonType::array_t&`, and `const BasicJsonType&`.
+ */
+template<typename Arg, typename BasicJsonType>
+constexpr bool binds_to_params_v =
+    std::is_lvalue_reference_v<Arg> && std::is_const_v<std::remove_reference_t<Arg>> &&
+    (std::is_same_v<std::remove_cvref_t<Arg>, typename BasicJsonType::string_t> ||
+     std::is_same_v<std::remove_cvref_t<Arg>, typename BasicJsonType::array_t> ||
+     std::is_same_v<std::remove_cvref_t<Arg>, BasicJsonType>);
+
+/**
+ * @brief The type of the @a I-th element of the tuple of converted arguments.
+ *
+ * @tparam I The index of the argument.
+ * @tparam A The tuple of the parameter types of the handler.
+ * @tparam BasicJsonType The JSON type (a `nlohmann::basic_json` specialization).
+ *
+ * @details param_ref for the parameters that bind to the parameters of the request (see binds_to_params_v),
+ * and tuple_element otherwise.
+ */
+template<std::size_t I, typename A, typename BasicJsonType>
+using param_type = std::conditional_t<
+    binds_to_params_v<std::tuple_element_t<I, A>, BasicJsonType>,
+    param_ref<std::remove_cvref_t<std::tuple_element_t<I, A>>>, tuple_element<I, A>>;
+
+/**
+ * @brief Checks whether a JSON value can be converted to @a T by convert_value().
+ *
+ * @tparam T The type of the argument.
+ * @tparam BasicJsonType The JSON type (a `nlohmann::basic_json` specialization).
+ *
+ * @details These are arithmetic types, `bool`, `BasicJsonType::string_t`, `std::string_view`,
+ * `std::span<const BasicJsonType>`, param_ref, and `std::vector` of any of these types.
+ */
+template<typename T, typename BasicJsonType>
+struct is_fast_convertible
+    : std::bool_constant<
+          std::is_arithmetic_v<T> || std::is_same_v<T, typename BasicJsonType::string_t> ||
+          std::is_same_v<T, std::string_view> || std::is_same_v<T, std::span<const BasicJsonType>>> {};
+
+/**
+ * @brief Specialization for param_ref.
+ *
+ * @tparam T The type of the referenced value.
+ * @tparam BasicJsonType The JSON type (a `nlohmann::basic_json` specialization).
+ */
+template<typename T, typename BasicJsonType>
+struct is_fast_convertible<param_ref<T>, BasicJsonType> : std::true_type {};
+
+/**
+ * @brief Specialization for vectors.
+ *
+ * @tparam T The type of the elements.
+ * @tparam Allocator The allocator of the vector.
+ * @tparam BasicJsonType The JSON type (a `nlohmann::basic_json` specialization).
+ */
+template<typename T, typename Allocator, typename BasicJsonType>
+struct is_fast_convertible<std::vector<T, Allocator>, BasicJsonType> : is_fast_convertible<T, BasicJsonType> {};
+
+/**
+ * @brief Helper variable template for is_fast_convertible.
+ *
+ * @tparam T The type of the argument.
+ * @tparam BasicJsonType The JSON type (a `nlohmann::basic_json` specialization).
+ */
+template<typename T, typename BasicJsonType>
+constexpr bool is_fast_convertible_v = is_fast_convertible<T, BasicJsonType>::value;
+
+/**
+ * @brief Describes why convert_value() failed.
+ */
+struct conversion_error {
+    const char* expected = nullptr;  ///< The name of the expected JSON type.
+    const char* actual   = nullptr;  ///< The name of the actual JSON type.
+
+    /**
+     * @brief Returns the error message.
+     *
+     * @return The same message as the one of `nlohmann::json::type_error` thrown by `get()` for the same value.
+     */
+    [[nodiscard]] std::string message() const
+    {
+        return std::string("[json.exception.type_error.302] type must be ")
+            .append(this->expected)
+            .append(", but is ")
+            .append(this->actual);
+    }
+};
+
+/**
+ * @brief Converts a JSON value to an argument without throwing exceptions.
+ *
+ * @tparam T The type of the argument (see is_fast_convertible).
+ * @tparam BasicJsonType The JSON type (a `nlohmann::basic_json` specialization).
+ * @param value The JSON value.
+ * @param out The converted value.
+ * @param error The reason of the failure.
+ * @return Whether the conversion succeeded.
+ *
+ * @details The type of @a value is checked once, and the value is copied directly from the JSON value.
+ * The conversion rules are the same as those of `value.get<T>()`: any number can be converted to an arithmetic type,
+ * and a boolean can be converted to an arithmetic type other than `number_integer_t`, `number_unsigned_t`,
+ * and `number_float_t`. `std::string_view`, `std::span<const BasicJsonType>`, and param_ref refer to the data
+ * stored in @a value.
+ */
+template<typename T, typename BasicJsonType>
+bool convert_value(const BasicJsonType& value, T& out, conversion_error& error)
+requires(is_fast_convertible_v<T, BasicJsonType>)
+{
+    using value_t = typename BasicJsonType::value_t;
+
+    if constexpr (std::is_same_v<T, typename BasicJsonType::boolean_t>) {
+        if (value.is_boolean()) {
+            out = *value.template get_ptr<const typename BasicJsonType::boolean_t*>();
+            return true;
+        }
+
+        error = {"boolean", value.type_name()};
+        return false;
+    }
+    else if constexpr (std::is_arithmetic_v<T>) {
+        constexpr bool accepts_boolean = !std::is_same_v<T, typename BasicJsonType::number_integer_t> &&
+                                         !std::is_same_v<T, typename BasicJsonType::number_unsigned_t> &&
+                                         !std::is_same_v<T, typename BasicJsonType::number_float_t>;
+
+        if constexpr (accepts_boolean) {
+            if (value.is_boolean()) {
+                out = static_cast<T>(*value.template get_ptr<const typename BasicJsonType::boolean_t*>());
+                return true;
+            }
+        }
+
+        switch (value.type()) {
+            case value_t::number_integer:
+                out = static_cast<T>(*value.template get_ptr<const typename BasicJsonType::number_integer_t*>());
+                return true;
+
+            case value_t::number_unsigned:
+                out = static_cast<T>(*value.template get_ptr<const typename BasicJsonType::number_unsigned_t*>());
+                return true;
+
+            case value_t::number_float:
+                out = static_cast<T>(*value.template get_ptr<const typename BasicJsonType::number_float_t*>());
+                return true;
+
+            case value_t::null:
+            case value_t::object:
+            case value_t::array:
+            case value_t::string:
+            case value_t::boolean:
+            case value_t::binary:
+            case value_t::discarded:
+                break;
+        }
+
+        error = {"number", value.type_name()};
+        return false;
+    }
+    else if constexpr (std::is_same_v<T, typename BasicJsonType::string_t> || std::is_same_v<T, std::string_view>) {
+        if (value.is_string()) {
+            out = *value.template get_ptr<const typename BasicJsonType::string_t*>();
+            return true;
+        }
+
+        error = {"string", value.type_name()};
+        return false;
+    }
+    else if constexpr (std::is_same_v<T, std::span<const BasicJsonType>>) {
+        if (value.is_array()) {
+            const auto& array = *value.template get_ptr<const typename BasicJsonType::array_t*>();
+            out               = T(array.data(), array.size());
+            return true;
+        }
+
+        error = {"array", value.type_name()};
+        return false;
+    }
+    else if constexpr (std::is_same_v<T, param_ref<BasicJsonType>>) {
+        out = T(value);
+        return true;
+    }
+    else if constexpr (std::is_same_v<T, param_ref<typename BasicJsonType::string_t>>) {
+        if (value.is_string()) {
+            out = T(*value.template get_ptr<const typename BasicJsonType::string_t*>());
+            return true;
+        }
+
+        error = {"string", value.type_name()};
+        return false;
+    }
+    else if constexpr (std::is_same_v<T, param_ref<typename BasicJsonType::array_t>>) {
+        if (value.is_array()) {
+            out = T(*value.template get_ptr<const typename BasicJsonType::array_t*>());
+            return true;
+        }
+
+        error = {"array", value.type_name()};
+        return false;
+    }
+    else {
+        if (!value.is_array()) {
+            error = {"array", value.type_name()};
+            return false;
+        }
+
+        out.clear();
+        out.reserve(value.size());
+        for (const auto& element : value) {
+            typename T::value_type item{};
+            if (!convert_value(element, item, error)) {
+                return false;
+            }
+
+            out.push_back(std::move(item));
+        }
+
+        return true;
+    }
+}
+
+/**
+ * @brief Converts a JSON value to an argument.
+ *
+ * @tparam T The type of the argument.
+ * @tparam BasicJsonType The JSON type (a `nlohmann::basic_json` specialization).
+ * @param value The JSON value.
+ * @return The converted value.
+ * @throws wwa::json_rpc::exception If @a T is supported by convert_value() and the conversion fails
+ * (`exception::INVALID_PARAMS`).
+ * @throws typename BasicJsonType::exception If the conversion of any other type fails.
+ *
+ * @details The types supported by convert_value() are converted with it; any other type is converted
+ * with `value.get<T>()`.
+ */
+template<typename T, typename BasicJsonType>
+T get_arg(const BasicJsonType& value)
+{
+    if constexpr (is_fast_convertible_v<T, BasicJsonType>) {
+        T result{};
+        conversion_error error;
+        if (!convert_value(value, result, error)) {
+            throw wwa::json_rpc::exception(wwa::json_rpc::exception::INVALID_PARAMS, error.message());
+        }
+
+        return result;
+    }
+    else {
+        return value.template get<T>();
+    }
+}
+
 /**
  * @brief Converts JSON parameters to a tuple of arguments based on the specified types.
  *
  * @tparam Extra An additional type that may be included in the conversion. If Extra is void, it is ignored.
  * @tparam Args A tuple of argument types to which the JSON parameters will be converted.
+ * @tparam BasicJsonType The JSON type (a `nlohmann::basic_json` specialization).
  * @tparam Indices A parameter pack representing the indices of the arguments.
  * @param params The JSON object containing the parameters to be converted.
- * @return A tuple containing the converted arguments.
- *
- * @throws wwa::json_rpc::exception If the conversion of any parameter from the JSON object fails.
+ * @return A tuple containing the converted arguments, or the `exception::INVALID_PARAMS` error if the conversion
+ * of any parameter from the JSON object fails.
  *
  * @details The function attempts to convert each parameter in the JSON object @a params to the corresponding type in @a Args and returns them as a tuple.
  * It uses `std::index_sequence` to unpack the indices and access the corresponding parameters in @a params.
@@ -330,17 +669,283 @@ using tuple_element = std::decay_t<std::tuple_element_t<I, A>>;
  *
  * Because @a Args correspond to the function arguments, @a Args contains both @a Extra and @a Arguments for the first type of handler; therefore, `Args[i]` will be the type of the `params[i-1]`.
  * For the second type of handler, @a Args contains only @a Arguments, and `Args[i]` will be the type of the `params[i]`.
+ *
+ * The elements of the resulting tuple are of param_type: the parameters declared as `const std::string&`,
+ * `const BasicJsonType::array_t&`, or `const BasicJsonType&` refer to the values inside @a params, which must outlive
+ * the call of the handler.
+ *
+ * If all arguments are of the types supported by convert_value(), no exceptions are thrown, even if the conversion fails.
+ * Otherwise, the arguments are converted with get_arg(), and the exceptions it throws are turned into errors.
  */
-template<typename Extra, typename Args, std::size_t... Indices>
-constexpr auto convert_args(const nlohmann::json& params, std::index_sequence<Indices...>)
+template<typename Extra, typename Args, typename BasicJsonType, std::size_t... Indices>
+auto convert_args(const BasicJsonType& params, std::index_sequence<Indices...>)
+    -> expected<std::tuple<param_type<Indices, Args, BasicJsonType>...>>
 {
+    using result_t = std::tuple<param_type<Indices, Args, BasicJsonType>...>;
+
     constexpr std::size_t offset = std::is_void_v<Extra> ? 0 : 1;
-    try {
-        return std::make_tuple(params[Indices - offset].template get<tuple_element<Indices, Args>>()...);
+    if constexpr ((is_fast_convertible_v<param_type<Indices, Args, BasicJsonType>, BasicJsonType> && ...)) {
+        result_t args;
+        conversion_error error;
+        if ((convert_value(params[Indices - offset], std::get<Indices - offset>(args), error) && ...)) {
+            return args;
+        }
+
+        return unexpected(wwa::json_rpc::exception(wwa::json_rpc::exception::INVALID_PARAMS, error.message()));
+    }
+    else {
+        try {
+            return result_t(get_arg<param_type<Indices, Args, BasicJsonType>>(params[Indices - offset])...);
+        }
+        catch (const wwa::json_rpc::exception& e) {
+            return unexpected(e);
+        }
+        catch (const typename BasicJsonType::exception& e) {
+            return unexpected(wwa::json_rpc::exception(wwa::json_rpc::exception::INVALID_PARAMS, e.what()));
+        }
     }
-    catch (const nlohmann::json::exception& e) {
-        throw wwa::json_rpc::exception(wwa::json_rpc::exception::INVALID_PARAMS, e.what());
+}
+/**
+ * @brief Checks whether the handler accepts the raw parameters as a single JSON argument.
+ *
+ * @tparam Context The type of the context parameter (can be `void` or `basic_dispatcher::context_t`).
+ * @tparam Args The type of the arguments tuple.
+ * @tparam BasicJsonType The JSON type (a `nlohmann::basic_json` specialization).
+ * @return Whether the only argument of the handler (besides the context) is @a BasicJsonType.
+ */
+template<typename Context, typename Args, typename BasicJsonType>
+constexpr bool takes_raw_params()
+{
+    constexpr auto args_size = std::tuple_size<std::decay_t<Args>>::value;
+    constexpr auto arg_pos   = std::is_void_v<Context> ? 0 : 1;
+
+    if constexpr (args_size == arg_pos + 1) {
+        return std::is_same_v<std::decay_t<std::tuple_element_t<arg_pos, Args>>, BasicJsonType>;
+    }
+    else {
+        return false;
+    }
+}
+
+/**
+ * @brief Builds the arguments for a method handler.
+ *
+ * @tparam C The type of the class instance (can be a pointer or null pointer).
+ * @tparam Context The type of the context parameter (can be `void` or `basic_dispatcher::context_t`).
+ * @tparam Args The type of the arguments tuple.
+ * @tparam Ctx The type of the context object.
+ * @tparam BasicJsonType The JSON type (a `nlohmann::basic_json` specialization).
+ * @param inst The instance of the class (can be a pointer or null pointer).
+ * @param ctx The context.
+ * @param params The parameters of the method (a JSON array).
+ * @return The tuple of arguments to pass to the handler (including the instance if @a inst is not a null pointer),
+ * or the `exception::INVALID_PARAMS` error if the parameters cannot be converted to the arguments of the handler.
+ *
+ * @details If the handler accepts a single @a BasicJsonType argument, it receives @a params as is.
+ * Otherwise, the number of elements in @a params must match the number of arguments, and every element is converted
+ * to the type of the corresponding argument.
+ */
+template<typename C, typename Context, typename Args, typename Ctx, typename BasicJsonType>
+auto make_call_args(C inst, const Ctx& ctx, const BasicJsonType& params)
+{
+    assert(params.is_array());
+    constexpr auto args_size = std::tuple_size<std::decay_t<Args>>::value;
+    constexpr auto arg_pos   = std::is_void_v<Context> ? 0 : 1;
+
+    if constexpr (takes_raw_params<Context, Args, BasicJsonType>()) {
+        auto args = std::tuple_cat(make_inst_tuple(inst), make_context_tuple<Context>(ctx), std::tie(params));
+        return expected<decltype(args)>(std::move(args));
+    }
+    else {
+        constexpr auto offset = std::is_void_v<Context> ? 0U : 1U;
+        using indices_t       = offset_sequence_t<offset, std::make_index_sequence<args_size - offset>>;
+        using converted_t     = typename decltype(convert_args<Context, Args>(params, indices_t{}))::value_type;
+        using result_t        = expected<decltype(std::tuple_cat(
+            make_inst_tuple(inst), make_context_tuple<Context>(ctx), std::declval<converted_t>()
+        ))>;
+
+        if (params.size() + arg_pos != args_size) {
+            return result_t(unexpected(exception(exception::INVALID_PARAMS, err_invalid_params_passed_to_method)));
+        }
+
+        auto args = convert_args<Context, Args>(params, indices_t{});
+        if (!args) {
+            return result_t(unexpected(std::move(args).error()));
+        }
+
+        return result_t(std::tuple_cat(make_inst_tuple(inst), make_context_tuple<Context>(ctx), std::move(*args)));
+    }
+}
+/**
+ * @brief Awaits an asynchronous handler and converts its result to a JSON value.
+ *
+ * @tparam BasicJsonType The JSON type (a `nlohmann::basic_json` specialization).
+ * @tparam F The type of the function.
+ * @tparam Tuple The type of the arguments tuple.
+ * @param f The function.
+ * @param tuple The arguments as a tuple.
+ * @return Task that produces the result of the function converted with make_result() (`null` for `task<void>`).
+ *
+ * @details The arguments are stored in the frame of this coroutine, so that the handler coroutine can safely
+ * refer to them until it completes.
+ */
+template<typename BasicJsonType, typename F, typename Tuple>
+task<expected<BasicJsonType>> await_function(const F& f, Tuple tuple)
+{
+    using ReturnType = typename details::function_traits<std::decay_t<F>>::return_type;
+
+    if constexpr (std::is_void_v<typename ReturnType::value_type>) {
+        co_await std::apply(f, std::move(tuple));
+        co_return BasicJsonType(nullptr);
+    }
+    else {
+        co_return make_result<BasicJsonType>(co_await std::apply(f, std::move(tuple)));
+    }
+}
+/**
+ * @brief Creates a closure for invoking a member function with JSON parameters.
+ *
+ * @tparam C The type of the class instance (can be a pointer or null pointer).
+ * @tparam F The type of the member function (if C is not `std::nullptr_t`) or the function.
+ * @tparam Context The type of the context parameter that can be passed to the member function (can be `void` or `basic_dispatcher::context_t`).
+ * @tparam Args The type of the arguments tuple.
+ * @tparam BasicJsonType The JSON type (a `nlohmann::basic_json` specialization).
+ *
+ * @param inst The instance of the class (can be a pointer or null pointer).
+ * @param f The member function to be invoked.
+ *
+ * @return A lambda function that takes the context and a JSON object as parameters and invokes the member function with the appropriate arguments.
+ * The type of the context is deduced from the call, so that the same closure works with any `basic_dispatcher::context_t`.
+ *
+ * @details This method creates a closure (lambda function) that can be used to invoke a member function with arguments extracted from a JSON object.
+ *
+ * The closure performs the following steps:
+ * 1. Checks if the JSON object is an array.
+ * 2. If the JSON object is an array and the member function takes a single argument of type @a BasicJsonType, it directly passes the JSON object to the member function.
+ * 3. If the JSON object is an array and the number of elements matches the number of arguments expected by the member function, it extracts the arguments from the JSON array and invokes the member function.
+ * 4. If the JSON object is not an array or the number of elements does not match the number of arguments, it returns a json_rpc::exception with the `exception::INVALID_PARAMS` code as the error.
+ *
+ * The `invoke_function` method is used to invoke the member function with the extracted arguments.
+ *
+ * The `std::apply` function is used to unpack the tuple and pass the arguments to the member function.
+ *
+ * The closure returns `expected<BasicJsonType>`: the errors (invalid parameters, or the errors returned by the handler
+ * as `expected`) are returned rather than thrown. Exceptions thrown by the handler itself propagate to the caller.
+ *
+ * If the function returns a `task`, the closure is a coroutine that returns `task<expected<BasicJsonType>>`;
+ * the conversion errors are reported when the task is awaited.
+ *
+ * Compile-time checks ensure that the code is type-safe and that certain conditions are met before the code is compiled.
+ * This helps catch potential errors early in the development process and improves the overall robustness of the code.
+ */
+template<typename C, typename F, typename Context, typename Args, typename BasicJsonType>
+constexpr auto create_closure(C inst, F&& f)
+{
+    static_assert((std::is_pointer_v<C> && std::is_class_v<std::remove_pointer_t<C>>) || std::is_null_pointer_v<C>);
+    using ReturnType = typename details::function_traits<std::decay_t<F>>::return_type;
+
+    if constexpr (is_task_v<ReturnType>) {
+        return [func = std::forward<F>(f), inst](const auto& ctx,
+                                                 const BasicJsonType& params) -> task<expected<BasicJsonType>> {
+            auto args = make_call_args<C, Context, Args>(inst, ctx, params);
+            if (!args) {
+                co_return unexpected(std::move(args).error());
+            }
+
+            co_return co_await await_function<BasicJsonType>(func, std::move(*args));
+        };
+    }
+    else {
+        return [func = std::forward<F>(f), inst](const auto& ctx,
+                                                 const BasicJsonType& params) -> expected<BasicJsonType> {
+            auto args = make_call_args<C, Context, Args>(inst, ctx, params);
+            if (!args) {
+                return unexpected(std::move(args).error());
+            }
+
+            return invoke_function<BasicJsonType>(func, std::move(*args));
+        };
+    }
+}
+
+/** @} */
+
+/**
+ * @defgroup static_names Compile-Time Method Names
+ * @brief Utilities for using method names as template arguments.
+ * @internal
+ * @{
+ */
+
+/**
+ * @brief A string literal that can be used as a template argument.
+ *
+ * @tparam N The size of the string literal, including the terminating null character.
+ */
+template<std::size_t N>
+struct fixed_string {
+    /**
+     * @brief Constructs the string from a string literal.
+     *
+     * @param str The string literal.
+     */
+    // NOLINTNEXTLINE(*-avoid-c-arrays,hicpp-explicit-conversions)
+    constexpr fixed_string(const char (&str)[N]) noexcept
+    {
+        for (std::size_t i = 0; i < N; ++i) {
+            this->value[i] = str[i];  // NOLINT(*-pro-bounds-constant-array-index)
+        }
     }
+
+    /**
+     * @brief Returns the string without the terminating null character.
+     *
+     * @return The string.
+     */
+    [[nodiscard]] constexpr std::string_view view() const noexcept { return {this->value, N - 1}; }
+
+    char value[N] = {};  ///< The characters of the string. NOLINT(*-avoid-c-arrays)
+};
+
+/**
+ * @brief Computes the FNV-1a hash of a method name.
+ *
+ * @param name The method name.
+ * @return The hash value.
+ *
+ * @details The function is `constexpr`, so that the hashes of the method names known at compile time
+ * can be computed by the compiler and compared against the hash of the method name in the request.
+ */
+constexpr std::uint64_t hash_method_name(std::string_view name) noexcept
+{
+    // NOLINTBEGIN(readability-magic-numbers)
+    std::uint64_t h = 0xCBF29CE484222325ULL;
+    for (const char c : name) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 0x100000001B3ULL;
+    }
+
+    return h;
+    // NOLINTEND(readability-magic-numbers)
+}
+
+/**
+ * @brief Checks whether all method names are distinct.
+ *
+ * @param names The method names.
+ * @return Whether there are no duplicate names.
+ */
+constexpr bool are_unique_names(std::initializer_list<std::string_view> names) noexcept
+{
+    for (const auto* i = names.begin(); i != names.end(); ++i) {
+        for (const auto* j = i + 1; j != names.end(); ++j) {
+            if (*i == *j) {
+                return false;
+            }
+        }
+    }
+
+    return true;
 }
 
 /** @} */
@@ -5,17 +5,23 @@
  * @file dispatcher.h
  * @brief Defines the JSON RPC dispatcher class.
  *
- * This file contains the definition of the `dispatcher` class, which is responsible for managing JSON RPC method handlers
- * and processing JSON RPC requests. The dispatcher supports adding various types of handlers, including plain functions,
- * static class methods, lambda functions, and member functions. These handlers can accept and return values that are
- * convertible to and from `nlohmann::json` values.
+ * This file contains the definition of the `basic_dispatcher` class template and its `dispatcher` specialization,
+ * which are responsible for managing JSON RPC method handlers and processing JSON RPC requests. The dispatcher supports
+ * adding various types of handlers, including plain functions, static class methods, lambda functions, and member
+ * functions. These handlers can accept and return values that are convertible to and from `nlohmann::json` values.
+ *
+ * The dispatcher is a template on the JSON type. The library compiles it for `nlohmann::json` (`dispatcher`) and
+ * `nlohmann::ordered_json` (`ordered_dispatcher`); other `nlohmann::basic_json` specializations (for example, one with
+ * a custom allocator) can be used with `basic_static_dispatcher`.
  */
 
 #include <any>
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <memory_resource>
 #include <string>
 #include <string_view>
 #include <tuple>
@@ -26,19 +32,442 @@
 
 #include "details.h"
 #include "exception.h"
+#include "executor.h"
+#include "expected.h"
 #include "export.h"
+#include "id_generator.h"
+#include "metrics.h"
+#include "request.h"
+#include "task.h"
 
 /**
  * @brief Library namespace.
  */
 namespace wwa::json_rpc {
 
+template<typename BasicJsonType>
 class dispatcher_private;
-struct jsonrpc_request;
+
+template<typename Context, typename BasicJsonType = nlohmann::json>
+class basic_dispatcher;
+
+/**
+ * @brief The part of the JSON RPC dispatcher that does not depend on the type of the context.
+ *
+ * @details This class owns the method handlers and the settings of the dispatcher, and implements the processing
+ * of the requests. The data passed to `basic_dispatcher::process_request()` travels to the handlers and the hooks
+ * as an opaque pointer, and basic_dispatcher restores its type. Therefore, the request processing code is compiled
+ * once, in the library, for all types of the context.
+ *
+ * The class cannot be used on its own; use basic_dispatcher (or `dispatcher`) instead.
+ *
+ * @tparam BasicJsonType The JSON type: `nlohmann::json` or `nlohmann::ordered_json`.
+ */
+template<typename BasicJsonType>
+class WWA_JSONRPC_EXPORT dispatcher_base {
+private:
+    friend class dispatcher_private<BasicJsonType>;
+
+    template<typename, typename>
+    friend class basic_dispatcher;
+
+    /**
+     * @brief Method handler type.
+     *
+     * @details This type alias defines a method handler function that takes two parameters:
+     * - `ctx`: A pointer to the `basic_dispatcher::context_t` object; its type is known to the basic_dispatcher
+     *   that has registered the handler.
+     * - `params`: A JSON object containing the parameters for the method.
+     *
+     * The handler function returns a JSON object as a result, or the error.
+     */
+    using handler_t = std::function<expected<BasicJsonType>(const void* ctx, const BasicJsonType& params)>;
+
+    /**
+     * @brief Asynchronous method handler type.
+     *
+     * @details The same as `handler_t`, but the handler returns a task that produces the result.
+     */
+    using async_handler_t =
+        std::function<task<expected<BasicJsonType>>(const void* ctx, const BasicJsonType& params)>;
+
+public:
+    /** @brief The JSON type of the requests, the responses, and the parameters of the methods. */
+    using json_type = BasicJsonType;
+
+    /** @brief Class destructor. */
+    virtual ~dispatcher_base();
+
+    dispatcher_base(const dispatcher_base&)            = delete;
+    dispatcher_base& operator=(const dispatcher_base&) = delete;
+
+    /**
+     * @brief Freezes the set of methods.
+     *
+     * @details Servers usually register all their methods at startup and never change them afterwards.
+     * This method compiles the names of the registered methods into an immutable perfect hash table:
+     * looking up a method takes one hash computation and one comparison.
+     *
+     * After the dispatcher has been frozen, add() and add_ex() throw `std::logic_error`.
+     * Calling this method more than once has no effect.
+     */
+    void freeze();
+
+    /**
+     * @brief Checks whether the dispatcher is frozen.
+     *
+     * @return Whether freeze() has been called.
+     */
+    [[nodiscard]] bool is_frozen() const noexcept;
+
+    /**
+     * @brief Sets the executor used to process batch requests in parallel.
+     *
+     * @param exec The executor; `nullptr` disables parallel processing (the default).
+     *
+     * @details When an executor is set, the elements of batch requests with at least
+     * `set_parallel_batch_threshold()` elements are processed concurrently: the calling thread and up to
+     * `executor::concurrency()` tasks submitted to @a exec take the elements one by one until all of them are processed.
+     * The order of the responses, the handling of notifications, and the unique request IDs passed to the hooks
+     * are the same as for sequential processing.
+     *
+     * @warning Method handlers and overridden request_parsed(), invoke(), try_invoke(), request_failed(), and
+     * do_process_request() are called from several threads at the same time and must be thread-safe.
+     *
+     * @par Sample Usage:
+     * ```cpp
+     * dispatcher.set_executor(std::make_shared<wwa::json_rpc::thread_pool>(4));
+     * ```
+     */
+    void set_executor(std::shared_ptr<executor> exec);
+
+    /**
+     * @brief Sets the minimum size of a batch request that is processed in parallel.
+     *
+     * @param threshold The minimum number of elements; smaller batches are processed by the calling thread.
+     *
+     * @details Submitting tasks to the executor has a cost that small batches do not recoup.
+     * The default threshold is 16 elements.
+     *
+     * @see set_executor()
+     */
+    void set_parallel_batch_threshold(std::size_t threshold) noexcept;
+
+    /**
+     * @brief Sets the generator of the unique request IDs passed to the hooks.
+     *
+     * @param gen The generator; `nullptr` restores the default one.
+     *
+     * @details By default, all dispatchers share `block_id_generator::instance()`: every thread takes IDs from its own
+     * block, so threads processing requests concurrently do not contend for a shared counter. A thread can override
+     * the generators of all dispatchers with an `id_generator_scope`.
+     *
+     * @warning This method must not be called while requests are being processed.
+     *
+     * @par Sample Usage:
+     * ```cpp
+     * dispatcher.set_id_generator(std::make_shared<wwa::json_rpc::sequential_id_generator>());
+     * ```
+     */
+    void set_id_generator(std::shared_ptr<id_generator> gen);
+
+    /**
+     * @brief Enables or disables the collection of metrics.
+     *
+     * @param enable Whether to collect metrics. Disabling the collection discards the metrics collected so far.
+     *
+     * @details The metrics are disabled by default. When they are enabled, the dispatcher records:
+     * - the number of calls, the number of failed calls, and the invocation latency of every method;
+     * - the number of errors by JSON RPC error code;
+     * - the time spent parsing the requests and serializing the responses.
+     *
+     * The latencies are recorded into log-linear histograms (see `latency_histogram`), so that percentiles like
+     * p99 and p99.9 can be computed. Every thread records into its own shard of the metrics, so the threads
+     * processing requests do not contend with each other; metrics() merges the shards.
+     *
+     * When the metrics are disabled, the only overhead is a null pointer check per processing step.
+     *
+     * @warning This method must not be called while requests are being processed.
+     *
+     * @par Sample Usage:
+     * ```cpp
+     * dispatcher.enable_metrics();
+     * // ...
+     * const auto metrics = dispatcher.metrics();
+     * for (const auto& [name, m] : metrics.methods) {
+     *     std::cout << name << ": " << m.calls << " calls, p99 = " << m.invoke.value_at_percentile(99) << " ns\n";
+     * }
+     * ```
+     */
+    void enable_metrics(bool enable = true);
+
+    /**
+     * @brief Returns the metrics collected so far.
+     *
+     * @return The metrics; empty if the collection of metrics is disabled.
+     *
+     * @details This method can be called while requests are being processed, from any thread.
+     * The values recorded concurrently with the call may or may not be included.
+     *
+     * @see enable_metrics()
+     */
+    [[nodiscard]] metrics_snapshot metrics() const;
+
+protected:
+    /** @brief Class constructor. */
+    dispatcher_base();
+
+    /**
+     * @brief Move constructor.
+     * @param rhs Right-hand side object.
+     */
+    dispatcher_base(dispatcher_base&& rhs) noexcept;
+
+    /**
+     * @brief Move assignment operator.
+     * @param rhs Right-hand side object.
+     * @return Reference to this object.
+     */
+    dispatcher_base& operator=(dispatcher_base&& rhs) noexcept;
+
+    /**
+     * @brief Invoked when a request fails.
+     * 
+     * @param request_id JSON RPC request ID.
+     * @param e Exception that is the reason for the failure.
+     * @param is_batch Whether this is a top-level batch request.
+     * @param unique_id Unique request ID.
+     */
+    virtual void
+    request_failed(const BasicJsonType& request_id, const std::exception* e, bool is_batch, std::uint64_t unique_id);
+
+private:
+    /**
+     * @brief Pointer to the implementation (Pimpl idiom).
+     *
+     * @details This unique pointer holds the private implementation details of the dispatcher class.
+     * It is used to hide the implementation details and reduce compilation dependencies.
+     */
+    std::unique_ptr<dispatcher_private<BasicJsonType>> d_ptr;
+
+    /** @brief The type of the private implementation. */
+    using private_t = dispatcher_private<BasicJsonType>;
+
+    /**
+     * @brief Adds a method handler for the specified method.
+     *
+     * @param method The name of the method.
+     * @param handler The handler function.
+     * @param with_context Whether the handler uses the context (that is, it has been added with add_ex()).
+     *
+     * @details This method registers a handler function for a given method name.
+     * The handler function will be invoked when a request for the specified method is received.
+     *
+     * @throws std::logic_error If the dispatcher is frozen.
+     */
+    void add_internal_method(std::string_view method, handler_t&& handler, bool with_context);
+
+    /**
+     * @brief Adds an asynchronous method handler for the specified method.
+     *
+     * @param method The name of the method.
+     * @param handler The handler function.
+     * @param with_context Whether the handler uses the context (that is, it has been added with add_ex()).
+     *
+     * @throws std::logic_error If the dispatcher is frozen.
+     * @overload
+     */
+    void add_internal_method(std::string_view method, async_handler_t&& handler, bool with_context);
+
+    /**
+     * @brief Calls basic_dispatcher::request_parsed() with the data of its type.
+     *
+     * @param request The parsed request.
+     * @param data Pointer to the data passed to `basic_dispatcher::process_request()`.
+     * @param unique_id The unique request ID.
+     */
+    virtual void erased_request_parsed(
+        const basic_jsonrpc_request<BasicJsonType>& request, const void* data, std::uint64_t unique_id
+    ) = 0;
+
+    /**
+     * @brief Builds the context and calls basic_dispatcher::try_invoke().
+     *
+     * @param method The name of the method to invoke.
+     * @param params The parameters for the method.
+     * @param data Pointer to the data passed to `basic_dispatcher::process_request()`.
+     * @param extra The extra fields of the request; `null` if the handler does not accept the context.
+     * @param unique_id The unique request ID.
+     * @return The result of the method invocation as a JSON object, or the error.
+     */
+    virtual expected<BasicJsonType> erased_invoke(
+        const std::string& method, const BasicJsonType& params, const void* data, BasicJsonType&& extra,
+        std::uint64_t unique_id
+    ) = 0;
+
+    /**
+     * @brief Builds the context and calls basic_dispatcher::try_invoke_async().
+     *
+     * @param method The name of the method to invoke.
+     * @param params The parameters for the method.
+     * @param data Pointer to the data passed to `basic_dispatcher::process_request_async()`.
+     * @param extra The extra fields of the request; `null` if the handler does not accept the context.
+     * @param unique_id The unique request ID.
+     * @return Task that produces the result of the method invocation as a JSON object, or the error.
+     */
+    virtual task<expected<BasicJsonType>> erased_invoke_async(
+        const std::string& method, const BasicJsonType& params, const void* data, BasicJsonType extra,
+        std::uint64_t unique_id
+    ) = 0;
+
+    /**
+     * @brief Calls basic_dispatcher::do_process_request() with the data of its type.
+     *
+     * @param request The JSON RPC request as a JSON object.
+     * @param data Pointer to the data passed to `basic_dispatcher::process_request()`.
+     * @param is_batch Indicates whether the request is a part of a batch request.
+     * @param unique_id The unique request ID.
+     * @return JSON response.
+     */
+    virtual BasicJsonType erased_do_process_request(
+        const BasicJsonType& request, const void* data, bool is_batch, std::uint64_t unique_id
+    ) = 0;
+
+    /**
+     * @brief Calls basic_dispatcher::process_batch_request() with the data of its type.
+     *
+     * @param request The batch request as a JSON array.
+     * @param data Pointer to the data passed to `basic_dispatcher::process_request()`.
+     * @param unique_id The unique request ID.
+     * @return The response as a JSON array.
+     */
+    virtual BasicJsonType
+    erased_process_batch_request(const BasicJsonType& request, const void* data, std::uint64_t unique_id) = 0;
+
+    /**
+     * @brief Processes a JSON RPC request.
+     *
+     * @param request The JSON RPC request.
+     * @param data Pointer to the data passed to `basic_dispatcher::process_request()`.
+     * @return The response.
+     * @see basic_dispatcher::process_request(const BasicJsonType&, const Context&)
+     */
+    BasicJsonType erased_process_request(const BasicJsonType& request, const void* data);
+
+    /**
+     * @brief Processes a JSON RPC request, consuming it.
+     *
+     * @param request The JSON RPC request.
+     * @param data Pointer to the data passed to `basic_dispatcher::consume_request()`.
+     * @return The response.
+     * @see basic_dispatcher::consume_request()
+     */
+    BasicJsonType erased_consume_request(BasicJsonType&& request, const void* data);
+
+    /**
+     * @brief Parses and processes a JSON RPC request.
+     *
+     * @param request The encoded JSON RPC request.
+     * @param data Pointer to the data passed to `basic_dispatcher::process_request()`.
+     * @param resource The memory resource for the temporaries of the request; `nullptr` for the default one.
+     * @param format The encoding of @a request.
+     * @return The response.
+     * @see basic_dispatcher::process_request(std::string_view, const Context&, std::pmr::memory_resource*)
+     * @see basic_dispatcher::process_request_as()
+     */
+    BasicJsonType erased_process_request(
+        std::string_view request, const void* data, std::pmr::memory_resource* resource,
+        typename BasicJsonType::input_format_t format = BasicJsonType::input_format_t::json
+    );
+
+    /**
+     * @brief Processes a JSON RPC request and serializes the response into a buffer.
+     *
+     * @param request The JSON RPC request.
+     * @param out The output buffer.
+     * @param data Pointer to the data passed to `basic_dispatcher::process_request_to()`.
+     * @return Whether a response has been written.
+     * @see basic_dispatcher::process_request_to(const BasicJsonType&, std::string&, const Context&)
+     */
+    bool erased_process_request_to(const BasicJsonType& request, std::string& out, const void* data);
+
+    /**
+     * @brief Parses and processes a JSON RPC request and serializes the response into a buffer.
+     *
+     * @param request The JSON RPC request as text.
+     * @param out The output buffer.
+     * @param data Pointer to the data passed to `basic_dispatcher::process_request_to()`.
+     * @param resource The memory resource for the temporaries of the request; `nullptr` for the default one.
+     * @return Whether a response has been written.
+     * @see basic_dispatcher::process_request_to(std::string_view, std::string&, const Context&, std::pmr::memory_resource*)
+     */
+    bool erased_process_request_to(
+        std::string_view request, std::string& out, const void* data, std::pmr::memory_resource* resource
+    );
+
+    /**
+     * @brief Processes a JSON RPC request asynchronously.
+     *
+     * @param request The JSON RPC request.
+     * @param data Pointer to the data passed to `basic_dispatcher::process_request_async()`; it must stay valid
+     * until the task completes.
+     * @return Task that produces the response.
+     * @see basic_dispatcher::process_request_async()
+     */
+    task<BasicJsonType> erased_process_request_async(BasicJsonType request, const void* data);
+
+    /**
+     * @brief The default implementation of basic_dispatcher::do_process_request().
+     *
+     * @param request The JSON RPC request as a JSON object.
+     * @param data Pointer to the data passed to `basic_dispatcher::process_request()`.
+     * @param unique_id The unique request ID.
+     * @return JSON response.
+     */
+    BasicJsonType default_do_process_request(const BasicJsonType& request, const void* data, std::uint64_t unique_id);
+
+    /**
+     * @brief The default implementation of basic_dispatcher::process_batch_request().
+     *
+     * @param request The batch request as a JSON array.
+     * @param data Pointer to the data passed to `basic_dispatcher::process_request()`.
+     * @param unique_id The unique request ID.
+     * @return The response as a JSON array.
+     */
+    BasicJsonType
+    default_process_batch_request(const BasicJsonType& request, const void* data, std::uint64_t unique_id);
+
+    /**
+     * @brief Finds and calls the handler for a method.
+     *
+     * @param method The name of the method.
+     * @param params The parameters for the method.
+     * @param ctx Pointer to the `basic_dispatcher::context_t` object.
+     * @return The result of the handler, or the `exception::METHOD_NOT_FOUND` error if there is no handler.
+     *
+     * @details Asynchronous handlers are run to completion with sync_wait().
+     */
+    expected<BasicJsonType> call_handler(std::string_view method, const BasicJsonType& params, const void* ctx);
+
+    /**
+     * @brief Finds the asynchronous handler for a method.
+     *
+     * @param method The name of the method.
+     * @return Pointer to the handler; `nullptr` if there is no handler, or if the handler is synchronous.
+     */
+    [[nodiscard]] const async_handler_t* find_async_handler(std::string_view method) const noexcept;
+};
+
+extern template class WWA_JSONRPC_EXPORT dispatcher_base<nlohmann::json>;
+extern template class WWA_JSONRPC_EXPORT dispatcher_base<nlohmann::ordered_json>;
 
 /**
  * @brief A class that manages JSON RPC method handlers and processes JSON RPC requests.
  *
+ * @tparam Context The type of the data passed to process_request() and, as a part of the context,
+ * to the method handlers added with add_ex() and to the hooks.
+ * @tparam BasicJsonType The JSON type: `nlohmann::json` (the default) or `nlohmann::ordered_json`.
+ *
  * The dispatcher class allows adding method handlers for JSON RPC methods and processes JSON RPC requests.
  * It supports adding plain functions, static class methods, lambda functions, and member functions as handlers.
  * The handlers can accept and return values that can be converted to and from `nlohmann::json` values.
@@ -73,57 +502,72 @@ struct jsonrpc_request;
  * @par Handling Exceptions:
  * If a handler function throws an exception derived from `std::exception`, the exception will be caught and
  * an appropriate JSON RPC error response will be returned.
+ *
+ * @par Typed Context:
+ * `dispatcher` passes the data to the handlers as `std::any`. If all requests come with the data of the same type
+ * (for example, the state of the connection), use that type as @a Context: the handlers receive a reference
+ * to the object passed to process_request(), without copying it and without `std::any_cast`.
+ * ```cpp
+ * struct connection {
+ *     std::string peer;
+ *     // ...
+ * };
+ *
+ * using conn_dispatcher = wwa::json_rpc::basic_dispatcher<connection>;
+ *
+ * conn_dispatcher d;
+ * d.add_ex("whoami", [](const conn_dispatcher::context_t& ctx) { return ctx.first.peer; });
+ *
+ * connection conn{"127.0.0.1"};
+ * const auto response = d.process_request(request, conn);
+ * ```
  */
-class WWA_JSONRPC_EXPORT dispatcher {
+template<typename Context, typename BasicJsonType>
+class basic_dispatcher : public dispatcher_base<BasicJsonType> {
+    static_assert(
+        std::is_same_v<Context, std::remove_cvref_t<Context>>, "Context must be a non-const, non-reference type"
+    );
+    static_assert(
+        std::is_same_v<BasicJsonType, nlohmann::json> || std::is_same_v<BasicJsonType, nlohmann::ordered_json>,
+        "The dispatcher is compiled only for nlohmann::json and nlohmann::ordered_json; "
+        "use basic_static_dispatcher with other JSON types"
+    );
+
 public:
     /**
      * @brief Optional context data for method handlers.
      *
      * @details This type alias defines a context data type that can be passed to method handlers.
      * The context data is a pair of two values:
-     *   - The first value is an `std::any` object that is passed to the `process_request()` method;
+     *   - The first value is the data passed to the `process_request()` method: a constant reference to it,
+     *     or a copy of it if @a Context is `std::any` (the type used by `dispatcher`);
      *   - The second value is a `nlohmann::json` object that contains additional fields extracted from the JSON RPC request.
      */
-    using context_t = std::pair<std::any, nlohmann::json>;
-
-private:
-    friend class dispatcher_private;
-
-    /**
-     * @brief Method handler type.
-     *
-     * @details This type alias defines a method handler function that takes two parameters:
-     * - `ctx`: An additional parameter that can be used to pass additional information to the handler.
-     * - `params`: A JSON object containing the parameters for the method.
-     *
-     * The handler function returns a JSON object as a result.
-     *
-     * This type alias is used to define the signature of functions that handle method calls in the dispatcher.
-     */
-    using handler_t = std::function<nlohmann::json(const context_t& ctx, const nlohmann::json& params)>;
+    using context_t = std::conditional_t<
+        std::is_same_v<Context, std::any>, std::pair<std::any, BasicJsonType>,
+        std::pair<const Context&, BasicJsonType>>;
 
-public:
     /** @brief Class constructor. */
-    dispatcher();
+    basic_dispatcher() = default;
 
     /** @brief Class destructor. */
-    virtual ~dispatcher();
+    ~basic_dispatcher() override = default;
 
-    dispatcher(const dispatcher&)            = delete;
-    dispatcher& operator=(const dispatcher&) = delete;
+    basic_dispatcher(const basic_dispatcher&)            = delete;
+    basic_dispatcher& operator=(const basic_dispatcher&) = delete;
 
     /**
      * @brief Move constructor.
      * @param rhs Right-hand side object.
      */
-    dispatcher(dispatcher&& rhs) = default;
+    basic_dispatcher(basic_dispatcher&& rhs) noexcept = default;
 
     /**
      * @brief Move assignment operator.
      * @param rhs Right-hand side object.
      * @return Reference to this object.
      */
-    dispatcher& operator=(dispatcher&& rhs) = default;
+    basic_dispatcher& operator=(basic_dispatcher&& rhs) noexcept = default;
 
     /**
      * @brief Adds a method handler @a f for the method @a method.
@@ -192,6 +636,8 @@ public:
      * the handler can either return a `nlohmann::json` value directly,
      * or use [a custom `to_json()` function](https://github.com/nlohmann/json?tab=readme-ov-file#arbitrary-types-conversions).
      * 2. If the handler function returns `void`, it will be automatically converted to `null` in the JSON response.
+     * 3. The handler can be a coroutine that returns `task<T>` (see task.h); the same rules apply to `T`.
+     * Such handlers are awaited by process_request_async(); the synchronous process_request() blocks until they complete.
      *
      * @par Exception Handling:
      * If the hander function throws an exception (derived from `std::exception`), the exception will be caught, and the error will be returned in the JSON response:
@@ -223,8 +669,9 @@ public:
         using traits    = details::function_traits<std::decay_t<F>>;
         using ArgsTuple = typename traits::args_tuple;
 
-        const auto&& closure = this->create_closure<C, F, void, ArgsTuple>(instance, std::forward<F>(f));
-        this->add_internal_method(method, std::forward<decltype(closure)>(closure));
+        this->add_closure(
+            method, details::create_closure<C, F, void, ArgsTuple, BasicJsonType>(instance, std::forward<F>(f)), false
+        );
     }
 
     /**
@@ -294,8 +741,10 @@ public:
             "argument."
         );
 
-        const auto&& closure = this->create_closure<C, F, context_t, ArgsTuple>(instance, std::forward<F>(f));
-        this->add_internal_method(method, std::forward<decltype(closure)>(closure));
+        this->add_closure(
+            method,
+            details::create_closure<C, F, context_t, ArgsTuple, BasicJsonType>(instance, std::forward<F>(f)), true
+        );
     }
 
     /**
@@ -329,10 +778,259 @@ public:
      * }
      * ```
      * and `data` set to `std::string("some_data")`, the `context` parameter passed to the handler will be a pair of values:
-     *   - `std::string("some_data")` as `std::any`;
+     *   - `std::string("some_data")` as `std::any` (for `dispatcher`);
      *   - `nlohmann::json` representing the object `{ "auth": "secret", "user": "admin" }`.
      */
-    nlohmann::json process_request(const nlohmann::json& request, const std::any& data = {});
+    BasicJsonType process_request(const BasicJsonType& request, const Context& data = {})
+    {
+        return this->erased_process_request(request, std::addressof(data));
+    }
+
+    /**
+     * @brief Processes a JSON RPC request, consuming it.
+     *
+     * @param request The JSON RPC request as a `nlohmann::json` object.
+     * @param data Optional data that can be passed to the handler function (only for handlers added with @a add_ex()).
+     * @return The response as a `nlohmann::json` object. If the request is a [Notification](https://www.jsonrpc.org/specification#notification),
+     * it will be of the [discarded_t](https://json.nlohmann.me/api/basic_json/is_discarded/) type.
+     *
+     * @details This method produces the same responses as process_request(const BasicJsonType&, const Context&),
+     * but moves `params`, `id`, and the extra members out of @a request instead of copying them. This matters
+     * for requests with large parameters. The state of @a request after the call is unspecified.
+     *
+     * @note Because the request is consumed, this method does not call do_process_request()
+     * and process_batch_request(): they receive the request by a const reference. Use process_request()
+     * if the dispatcher overrides them.
+     * The request_parsed(), invoke(), and request_failed() hooks are called as usual.
+     */
+    BasicJsonType consume_request(BasicJsonType&& request, const Context& data = {})
+    {
+        return this->erased_consume_request(std::move(request), std::addressof(data));
+    }
+
+    /**
+     * @brief Parses and processes a JSON RPC request.
+     *
+     * @param request The JSON RPC request as text.
+     * @param data Optional data that can be passed to the handler function (only for handlers added with @a add_ex()).
+     * @param resource The memory resource for the temporaries of the request; `nullptr` for the default one.
+     * @return The response as a `nlohmann::json` object. If the request is a [Notification](https://www.jsonrpc.org/specification#notification),
+     * it will be of the [discarded_t](https://json.nlohmann.me/api/basic_json/is_discarded/) type.
+     * @overload
+     *
+     * @details This overload does not build a DOM for the entire request. Instead, it uses the
+     * [SAX interface](https://json.nlohmann.me/features/parsing/sax_interface/) to extract the `jsonrpc`, `method`,
+     * and `id` fields in one pass, and builds JSON values only for `params` and the extra fields of the request.
+     *
+     * If @a request is not a valid JSON, the method returns an error response with code `-32700` (exception::PARSE_ERROR).
+     *
+     * The bookkeeping of the request (the parsed batch elements, the state of the parser, the buffers of parallel
+     * batch processing) is allocated from @a resource, and nothing allocated from it outlives the call. This allows
+     * a server to pass a `std::pmr::monotonic_buffer_resource` over a per-connection buffer and release it after
+     * each request. The JSON values (`params`, `id`, the results) use the allocator of @a BasicJsonType.
+     *
+     * @note Because there is no request DOM, this overload does not call do_process_request() and process_batch_request().
+     * The request_parsed(), invoke(), and request_failed() hooks are called as usual.
+     */
+    BasicJsonType
+    process_request(std::string_view request, const Context& data = {}, std::pmr::memory_resource* resource = nullptr)
+    {
+        return this->erased_process_request(request, std::addressof(data), resource);
+    }
+
+    /**
+     * @brief Parses and processes a JSON RPC request.
+     *
+     * @param request The JSON RPC request as text.
+     * @param data Optional data that can be passed to the handler function (only for handlers added with @a add_ex()).
+     * @param resource The memory resource for the temporaries of the request; `nullptr` for the default one.
+     * @return The response as a `nlohmann::json` object.
+     * @overload
+     * @see process_request(std::string_view, const Context&, std::pmr::memory_resource*)
+     */
+    BasicJsonType
+    process_request(const std::string& request, const Context& data = {}, std::pmr::memory_resource* resource = nullptr)
+    {
+        return this->process_request(std::string_view(request), data, resource);
+    }
+
+    /**
+     * @brief Parses and processes a JSON RPC request.
+     *
+     * @param request The JSON RPC request as a null-terminated string.
+     * @param data Optional data that can be passed to the handler function (only for handlers added with @a add_ex()).
+     * @param resource The memory resource for the temporaries of the request; `nullptr` for the default one.
+     * @return The response as a `nlohmann::json` object.
+     * @overload
+     * @see process_request(std::string_view, const Context&, std::pmr::memory_resource*)
+     */
+    BasicJsonType
+    process_request(const char* request, const Context& data = {}, std::pmr::memory_resource* resource = nullptr)
+    {
+        return this->process_request(std::string_view(request), data, resource);
+    }
+
+    /**
+     * @brief Decodes and processes a JSON RPC request encoded as JSON text or in a binary format.
+     *
+     * @param request The encoded JSON RPC request.
+     * @param format The encoding of @a request (`json`, `cbor`, `msgpack`, `ubjson`, `bson`, or `bjdata`).
+     * @param data Optional data that can be passed to the handler function (only for handlers added with @a add_ex()).
+     * @param resource The memory resource for the temporaries of the request; `nullptr` for the default one.
+     * @return The response as a `nlohmann::json` object. If the request is a [Notification](https://www.jsonrpc.org/specification#notification),
+     * it will be of the [discarded_t](https://json.nlohmann.me/api/basic_json/is_discarded/) type.
+     *
+     * @details This method works like process_request(std::string_view, const Context&, std::pmr::memory_resource*),
+     * but the request is decoded from @a format: the envelope is extracted by the same SAX parser, and there is
+     * no DOM for the entire request. The response can be encoded with `BasicJsonType::to_cbor()` and similar functions.
+     *
+     * If @a request cannot be decoded, the method returns an error response with code `-32700` (exception::PARSE_ERROR).
+     *
+     * @see process_encoded_request()
+     */
+    BasicJsonType process_request_as(
+        std::string_view request, typename BasicJsonType::input_format_t format, const Context& data = {},
+        std::pmr::memory_resource* resource = nullptr
+    )
+    {
+        return this->erased_process_request(request, std::addressof(data), resource, format);
+    }
+
+    /**
+     * @brief Processes a JSON RPC request and serializes the response into a buffer.
+     *
+     * @param request The JSON RPC request as a `nlohmann::json` object.
+     * @param out The output buffer; the response is appended to it.
+     * @param data Optional data that can be passed to the handler function (only for handlers added with @a add_ex()).
+     * @return Whether a response has been written. If the request is a [Notification](https://www.jsonrpc.org/specification#notification)
+     * (or a batch of notifications), nothing is written and the method returns `false`.
+     *
+     * @details This method processes the request like process_request() does but does not build a DOM for the response.
+     * The constant parts of the response object are written directly to @a out, and only the result of the method and
+     * the request ID are serialized. Because @a out is owned by the caller, it can be reused for multiple requests
+     * to avoid reallocations.
+     *
+     * The order of members in the serialized response is `jsonrpc`, `result` (or `error`), `id`.
+     *
+     * A result that cannot be serialized (for example, a string that is not valid UTF-8) is answered with
+     * an `exception::INTERNAL_ERROR` error, like an exception thrown by the handler. If an exception escapes anyway,
+     * @a out is restored to its original size.
+     *
+     * @note This method does not call do_process_request() and process_batch_request().
+     * The request_parsed(), invoke(), and request_failed() hooks are called as usual.
+     * @see process_request(const BasicJsonType&, const Context&)
+     */
+    bool process_request_to(const BasicJsonType& request, std::string& out, const Context& data = {})
+    {
+        return this->erased_process_request_to(request, out, std::addressof(data));
+    }
+
+    /**
+     * @brief Parses and processes a JSON RPC request and serializes the response into a buffer.
+     *
+     * @param request The JSON RPC request as text.
+     * @param out The output buffer; the response is appended to it.
+     * @param data Optional data that can be passed to the handler function (only for handlers added with @a add_ex()).
+     * @param resource The memory resource for the temporaries of the request; `nullptr` for the default one.
+     * @return Whether a response has been written.
+     * @overload
+     * @see process_request(std::string_view, const Context&, std::pmr::memory_resource*)
+     */
+    bool process_request_to(
+        std::string_view request, std::string& out, const Context& data = {},
+        std::pmr::memory_resource* resource = nullptr
+    )
+    {
+        return this->erased_process_request_to(request, out, std::addressof(data), resource);
+    }
+
+    /**
+     * @brief Parses and processes a JSON RPC request and serializes the response into a buffer.
+     *
+     * @param request The JSON RPC request as text.
+     * @param out The output buffer; the response is appended to it.
+     * @param data Optional data that can be passed to the handler function (only for handlers added with @a add_ex()).
+     * @param resource The memory resource for the temporaries of the request; `nullptr` for the default one.
+     * @return Whether a response has been written.
+     * @overload
+     */
+    bool process_request_to(
+        const std::string& request, std::string& out, const Context& data = {}, std::pmr::memory_resource* resource = nullptr
+    )
+    {
+        return this->process_request_to(std::string_view(request), out, data, resource);
+    }
+
+    /**
+     * @brief Parses and processes a JSON RPC request and serializes the response into a buffer.
+     *
+     * @param request The JSON RPC request as a null-terminated string.
+     * @param out The output buffer; the response is appended to it.
+     * @param data Optional data that can be passed to the handler function (only for handlers added with @a add_ex()).
+     * @param resource The memory resource for the temporaries of the request; `nullptr` for the default one.
+     * @return Whether a response has been written.
+     * @overload
+     */
+    bool process_request_to(
+        const char* request, std::string& out, const Context& data = {}, std::pmr::memory_resource* resource = nullptr
+    )
+    {
+        return this->process_request_to(std::string_view(request), out, data, resource);
+    }
+
+    /**
+     * @brief Processes a JSON RPC request asynchronously.
+     *
+     * @param request The JSON RPC request as a `nlohmann::json` object.
+     * @param data Data that can be passed to the handler function (only for handlers added with @a add_ex());
+     * it must outlive the returned task.
+     * @return Task that produces the response. If the request is a [Notification](https://www.jsonrpc.org/specification#notification),
+     * the response will be of the [discarded_t](https://json.nlohmann.me/api/basic_json/is_discarded/) type.
+     *
+     * @details This method produces the same responses as process_request(), but it does not block while
+     * asynchronous handlers (the ones returning a `task`) are waiting: the calling coroutine is suspended instead,
+     * and resumed by the thread that completes the handler. Synchronous handlers are called inline.
+     *
+     * The elements of a batch request are awaited concurrently: when the handler for one element suspends,
+     * the next element is started.
+     *
+     * The request is taken by value, because the task may outlive the caller's objects. The data is not copied:
+     * like with process_request(), it can be of a type that cannot be copied. A temporary passed as @a data lives
+     * until the end of the full expression, so it is safe to `co_await` the task in the same expression only.
+     *
+     * @par Sample Usage:
+     * ```cpp
+     * wwa::json_rpc::task<> serve(connection& conn)
+     * {
+     *     auto response = co_await dispatcher.process_request_async(co_await conn.read_request());
+     *     if (!response.is_discarded()) {
+     *         co_await conn.write(wwa::json_rpc::serialize_repsonse(response));
+     *     }
+     * }
+     * ```
+     *
+     * @note This method does not call do_process_request() and process_batch_request().
+     * The request_parsed(), invoke_async(), and request_failed() hooks are called as usual.
+     */
+    task<BasicJsonType> process_request_async(BasicJsonType request, const Context& data)
+    {
+        co_return co_await this->erased_process_request_async(std::move(request), std::addressof(data));
+    }
+
+    /**
+     * @brief Processes a JSON RPC request asynchronously without data.
+     *
+     * @param request The JSON RPC request as a `nlohmann::json` object.
+     * @return Task that produces the response.
+     *
+     * @details The handlers receive a default-constructed @a Context, which the task owns.
+     * @see process_request_async(BasicJsonType, const Context&)
+     */
+    task<BasicJsonType> process_request_async(BasicJsonType request)
+    {
+        const Context data{};
+        co_return co_await this->erased_process_request_async(std::move(request), std::addressof(data));
+    }
 
 protected:
     /**
@@ -347,8 +1045,12 @@ protected:
      * @details This method processes a JSON RPC request by invoking the method handlers for the specified method.
      * If the request is a batch request, it will call `process_batch_request()`.
      */
-    virtual nlohmann::json
-    do_process_request(const nlohmann::json& request, const std::any& data, bool is_batch, std::uint64_t unique_id);
+    virtual BasicJsonType do_process_request(
+        const BasicJsonType& request, const Context& data, [[maybe_unused]] bool is_batch, std::uint64_t unique_id
+    )
+    {
+        return this->default_do_process_request(request, std::addressof(data), unique_id);
+    }
 
     /**
      * @brief Processes a batch request.
@@ -360,8 +1062,11 @@ protected:
      *
      * @details This method processes a batch request by invoking the method handlers for each request in the batch.
      */
-    virtual nlohmann::json
-    process_batch_request(const nlohmann::json& request, const std::any& data, std::uint64_t unique_id);
+    virtual BasicJsonType
+    process_batch_request(const BasicJsonType& request, const Context& data, std::uint64_t unique_id)
+    {
+        return this->default_process_batch_request(request, std::addressof(data), unique_id);
+    }
 
     /**
      * @brief Invoked after the request has been parsed.
@@ -369,8 +1074,18 @@ protected:
      * @param request The parsed request.
      * @param data Additional information to pass to the method handlers as a part of the context.
      * @param unique_id The unique request ID.
+     *
+     * @details For handlers added with add(), the extra fields are collected only when `request.extra()` is first
+     * called, so an override that does not look at them does not pay for them. @a request must not be kept after
+     * the call: it may refer to the original request.
      */
-    virtual void request_parsed(const jsonrpc_request& request, const std::any& data, std::uint64_t unique_id);
+    virtual void request_parsed(
+        [[maybe_unused]] const basic_jsonrpc_request<BasicJsonType>& request, [[maybe_unused]] const Context& data,
+        [[maybe_unused]] std::uint64_t unique_id
+    )
+    {
+        // Do nothing
+    }
 
     /**
      * @brief Invokes a method handler.
@@ -382,110 +1097,219 @@ protected:
      * @return The result of the method invocation as a JSON object.
      *
      * @details This method finds the handler for the specified method and invokes it with the provided parameters.
+     * Asynchronous handlers are run to completion with sync_wait().
+     *
+     * The extra fields of the request are collected only if the handler for @a method has been added with add_ex();
+     * otherwise, the second element of @a ctx is `null`.
+     *
+     * The handler and the conversion of the parameters report the errors without throwing; the error is thrown
+     * only here, and the default try_invoke() turns it back into a value.
      * @throws exception If the method is not found or the invocation fails.
-     * @see exception::METHOD_NOT_FOUND
+     * @see exception::METHOD_NOT_FOUND, try_invoke()
      */
-    virtual nlohmann::json invoke(
-        const std::string& method, const nlohmann::json& params, const dispatcher::context_t& ctx,
-        std::uint64_t unique_id
-    );
+    virtual BasicJsonType invoke(
+        const std::string& method, const BasicJsonType& params, const context_t& ctx,
+        [[maybe_unused]] std::uint64_t unique_id
+    )
+    {
+        return this->call_method(method, params, ctx).value();
+    }
 
     /**
-     * @brief Invoked when a request fails.
-     * 
-     * @param request_id JSON RPC request ID.
-     * @param e Exception that is the reason for the failure.
-     * @param is_batch Whether this is a top-level batch request.
-     * @param unique_id Unique request ID.
+     * @brief Invokes a method handler asynchronously.
+     *
+     * @param method The name of the method to invoke.
+     * @param params The parameters for the method.
+     * @param ctx The context to pass to the method handlers.
+     * @param unique_id The unique request ID.
+     * @return Task that produces the result of the method invocation as a JSON object.
+     *
+     * @details This method is used by process_request_async(). It awaits asynchronous handlers;
+     * for synchronous handlers (and unknown methods), it calls invoke().
+     * @throws exception If the method is not found or the invocation fails.
+     * @see try_invoke_async()
      */
-    virtual void
-    request_failed(const nlohmann::json& request_id, const std::exception* e, bool is_batch, std::uint64_t unique_id);
+    virtual task<BasicJsonType> invoke_async(
+        const std::string& method, const BasicJsonType& params, const context_t& ctx, std::uint64_t unique_id
+    )
+    {
+        if (const auto* handler = this->find_async_handler(method); handler != nullptr) {
+            auto result = co_await (*handler)(std::addressof(ctx), params);
+            co_return std::move(result).value();
+        }
+
+        co_return this->invoke(method, params, ctx, unique_id);
+    }
 
-private:
     /**
-     * @brief Pointer to the implementation (Pimpl idiom).
+     * @brief Calls the handler for a method without throwing exceptions for JSON RPC errors.
      *
-     * @details This unique pointer holds the private implementation details of the dispatcher class.
-     * It is used to hide the implementation details and reduce compilation dependencies.
+     * @param method The name of the method.
+     * @param params The parameters for the method.
+     * @param ctx The context to pass to the method handler.
+     * @return The result of the handler, or the error.
+     *
+     * @details This is what the default invoke() does before it throws the error. An unknown method results in
+     * `exception::METHOD_NOT_FOUND`, parameters that cannot be converted to the arguments of the handler result in
+     * `exception::INVALID_PARAMS`, and the errors returned by the handlers as `expected` are passed through.
+     * Asynchronous handlers are run to completion with sync_wait().
      */
-    std::unique_ptr<dispatcher_private> d_ptr;
+    expected<BasicJsonType> call_method(const std::string& method, const BasicJsonType& params, const context_t& ctx)
+    {
+        return this->call_handler(method, params, std::addressof(ctx));
+    }
 
     /**
-     * @brief Adds a method handler for the specified method.
+     * @brief Calls the handler for a method asynchronously without throwing exceptions for JSON RPC errors.
      *
      * @param method The name of the method.
-     * @param handler The handler function.
+     * @param params The parameters for the method.
+     * @param ctx The context to pass to the method handler.
+     * @return Task that produces the result of the handler, or the error.
      *
-     * @details This method registers a handler function for a given method name.
-     * The handler function will be invoked when a request for the specified method is received.
+     * @details Awaits asynchronous handlers; for synchronous handlers (and unknown methods), it calls call_method().
      */
-    void add_internal_method(std::string_view method, handler_t&& handler);
+    task<expected<BasicJsonType>>
+    call_method_async(const std::string& method, const BasicJsonType& params, const context_t& ctx)
+    {
+        if (const auto* handler = this->find_async_handler(method); handler != nullptr) {
+            co_return co_await (*handler)(std::addressof(ctx), params);
+        }
+
+        co_return this->call_method(method, params, ctx);
+    }
 
     /**
-     * @brief Creates a closure for invoking a member function with JSON parameters.
-     *
-     * @tparam C The type of the class instance (can be a pointer or null pointer).
-     * @tparam F The type of the member function (if C is not `std::nullptr_t`) or the function.
-     * @tparam Context The type of the context parameter that can be passed to the member function (can be `void` or `context_t`).
-     * @tparam Args The type of the arguments tuple.
+     * @brief Invokes a method handler without throwing exceptions for JSON RPC errors.
      *
-     * @param inst The instance of the class (can be a pointer or null pointer).
-     * @param f The member function to be invoked.
+     * @param method The name of the method to invoke.
+     * @param params The parameters for the method.
+     * @param ctx The context to pass to the method handlers.
+     * @param unique_id The unique request ID.
+     * @return The result of the method invocation as a JSON object, or the error.
      *
-     * @return A lambda function that takes a JSON object as a parameter and invokes the member function with the appropriate arguments.
+     * @details This is the method the dispatcher calls to process a request. By default, it calls invoke() and
+     * returns the `exception` it throws as the error, so that the overrides of invoke() keep working. A subclass
+     * that wants no exceptions at all for JSON RPC errors overrides this method to call call_method() instead.
      *
-     * @details This method creates a closure (lambda function) that can be used to invoke a member function with arguments extracted from a JSON object.
+     * Exceptions other than `exception` propagate to the caller; the dispatcher reports them as
+     * `exception::INTERNAL_ERROR`.
+     */
+    virtual expected<BasicJsonType> try_invoke(
+        const std::string& method, const BasicJsonType& params, const context_t& ctx, std::uint64_t unique_id
+    )
+    {
+        try {
+            return this->invoke(method, params, ctx, unique_id);
+        }
+        catch (const exception& e) {
+            return unexpected(e);
+        }
+    }
+
+    /**
+     * @brief Invokes a method handler asynchronously without throwing exceptions for JSON RPC errors.
      *
-     * The closure performs the following steps:
-     * 1. Checks if the JSON object is an array.
-     * 2. If the JSON object is an array and the member function takes a single argument of type `nlohmann::json`, it directly passes the JSON object to the member function.
-     * 3. If the JSON object is an array and the number of elements matches the number of arguments expected by the member function, it extracts the arguments from the JSON array and invokes the member function.
-     * 4. If the JSON object is not an array or the number of elements does not match the number of arguments, it throws a json_rpc::exception with the  `exception::INVALID_PARAMS` code.
+     * @param method The name of the method to invoke.
+     * @param params The parameters for the method.
+     * @param ctx The context to pass to the method handlers.
+     * @param unique_id The unique request ID.
+     * @return Task that produces the result of the method invocation as a JSON object, or the error.
      *
-     * The `invoke_function` method is used to invoke the member function with the extracted arguments.
+     * @details This is the method process_request_async() calls. It relates to invoke_async() the same way
+     * try_invoke() relates to invoke(); the non-throwing counterpart of invoke_async() is call_method_async().
+     */
+    virtual task<expected<BasicJsonType>> try_invoke_async(
+        const std::string& method, const BasicJsonType& params, const context_t& ctx, std::uint64_t unique_id
+    )
+    {
+        try {
+            co_return co_await this->invoke_async(method, params, ctx, unique_id);
+        }
+        catch (const exception& e) {
+            co_return unexpected(e);
+        }
+    }
+
+private:
+    /**
+     * @brief Adds a closure created by details::create_closure() as a method handler.
      *
-     * The `std::apply` function is used to unpack the tuple and pass the arguments to the member function.
+     * @tparam Closure The type of the closure.
+     * @param method The name of the method.
+     * @param closure The closure; it accepts `const context_t&` and the parameters of the method.
+     * @param with_context Whether the handler uses the context (that is, it has been added with add_ex()).
      *
-     * Compile-time checks ensure that the code is type-safe and that certain conditions are met before the code is compiled.
-     * This helps catch potential errors early in the development process and improves the overall robustness of the code.
+     * @details The closure is wrapped into a handler that restores the type of the context, and the wrapper is stored
+     * in place of the closure: calling the handler costs the same as before.
      */
-    template<typename C, typename F, typename Context, typename Args>
-    constexpr auto create_closure(C inst, F&& f) const
+    template<typename Closure>
+    void add_closure(std::string_view method, Closure&& closure, bool with_context)
+    {
+        this->add_internal_method(
+            method,
+            [func = std::forward<Closure>(closure)](const void* ctx, const BasicJsonType& params) {
+                return func(*static_cast<const context_t*>(ctx), params);
+            },
+            with_context
+        );
+    }
+
+    void erased_request_parsed(
+        const basic_jsonrpc_request<BasicJsonType>& request, const void* data, std::uint64_t unique_id
+    ) final
+    {
+        this->request_parsed(request, *static_cast<const Context*>(data), unique_id);
+    }
+
+
+    expected<BasicJsonType> erased_invoke(
+        const std::string& method, const BasicJsonType& params, const void* data, BasicJsonType&& extra,
+        std::uint64_t unique_id
+    ) final
+    {
+        const context_t ctx{*static_cast<const Context*>(data), std::move(extra)};
+        return this->try_invoke(method, params, ctx, unique_id);
+    }
+
+    task<expected<BasicJsonType>> erased_invoke_async(
+        const std::string& method, const BasicJsonType& params, const void* data, BasicJsonType extra,
+        std::uint64_t unique_id
+    ) final
     {
-        static_assert((std::is_pointer_v<C> && std::is_class_v<std::remove_pointer_t<C>>) || std::is_null_pointer_v<C>);
-        return [func = std::forward<F>(f), inst](const context_t& ctx, const nlohmann::json& params) {
-            assert(params.is_array());
-            constexpr auto args_size = std::tuple_size<std::decay_t<Args>>::value;
-            constexpr auto arg_pos   = std::is_void_v<Context> ? 0 : 1;
-
-            if constexpr (args_size == arg_pos + 1) {
-                if constexpr (std::is_same_v<std::decay_t<std::tuple_element_t<arg_pos, Args>>, nlohmann::json>) {
-                    auto&& tuple_args = std::tuple_cat(
-                        details::make_inst_tuple(inst), details::make_context_tuple<Context>(ctx),
-                        std::make_tuple(params)
-                    );
-
-                    return details::invoke_function(func, std::forward<decltype(tuple_args)>(tuple_args));
-                }
-            }
-
-            if (params.size() + arg_pos == args_size) {
-                constexpr auto offset = std::is_void_v<Context> ? 0U : 1U;
-                auto&& tuple_args     = std::tuple_cat(
-                    details::make_inst_tuple(inst), details::make_context_tuple<Context>(ctx),
-                    details::convert_args<Context, Args>(
-                        params, details::offset_sequence_t<offset, std::make_index_sequence<args_size - offset>>{}
-                    )
-                );
-
-                return details::invoke_function(func, std::forward<decltype(tuple_args)>(tuple_args));
-            }
-
-            throw exception(exception::INVALID_PARAMS, err_invalid_params_passed_to_method);
-        };
+        const context_t ctx{*static_cast<const Context*>(data), std::move(extra)};
+        co_return co_await this->try_invoke_async(method, params, ctx, unique_id);
+    }
+
+    BasicJsonType erased_do_process_request(
+        const BasicJsonType& request, const void* data, bool is_batch, std::uint64_t unique_id
+    ) final
+    {
+        return this->do_process_request(request, *static_cast<const Context*>(data), is_batch, unique_id);
+    }
+
+    BasicJsonType
+    erased_process_batch_request(const BasicJsonType& request, const void* data, std::uint64_t unique_id) final
+    {
+        return this->process_batch_request(request, *static_cast<const Context*>(data), unique_id);
     }
 };
 
+/**
+ * @brief The dispatcher that passes the data to the method handlers as `std::any`.
+ *
+ * @see basic_dispatcher
+ */
+using dispatcher = basic_dispatcher<std::any>;
+
+/**
+ * @brief JSON RPC dispatcher that uses `nlohmann::ordered_json`.
+ *
+ * @details The members of the objects (the results of the methods, the extra fields of the requests) keep
+ * their insertion order.
+ */
+using ordered_dispatcher = basic_dispatcher<std::any, nlohmann::ordered_json>;
+
 }  // namespace wwa::json_rpc
 
 #endif /* FAB131EA_3F90_43B6_833D_EB89DA373735 */
@@ -0,0 +1,937 @@
+#ifndef C7E2A9D4_1B6F_4E83_A5D0_3F8B2C61E947
+#define C7E2A9D4_1B6F_4E83_A5D0_3F8B2C61E947
+
+/**
+ * @file
+ * @brief Implementation of the dispatcher_base class.
+ * @internal
+ *
+ * The definitions are templates on the JSON type; `dispatcher.cpp` instantiates them for `nlohmann::json`
+ * and `nlohmann::ordered_json`.
+ */
+
+#include "dispatcher.h"
+#include "dispatcher_p.h"
+#include "exception.h"
+#include "executor_p.h"
+#include "request.h"
+#include "request_parser_impl.h"
+#include "utils.h"
+
+namespace wwa::json_rpc::details {
+
+/**
+ * @brief The outcome of processing a single request.
+ * @internal
+ *
+ * @tparam BasicJsonType The JSON type.
+ */
+template<typename BasicJsonType>
+using outcome_t = typename dispatcher_private<BasicJsonType>::outcome;
+
+/**
+ * @brief Serializes @a value and appends it to @a out.
+ * @internal
+ *
+ * @tparam BasicJsonType The JSON type.
+ * @param out The output buffer.
+ * @param value The value to serialize.
+ */
+template<typename BasicJsonType>
+void append_json(std::string& out, const BasicJsonType& value)
+{
+    out += value.dump();
+}
+
+/**
+ * @brief Collects the responses to the elements of a batch request into a JSON array.
+ * @internal
+ *
+ * @tparam BasicJsonType The JSON type.
+ */
+template<typename BasicJsonType>
+class json_sink {
+public:
+    /**
+     * @brief Constructs the sink.
+     *
+     * @param q The dispatcher.
+     */
+    explicit json_sink(const dispatcher_base<BasicJsonType>& q) : m_dispatcher(q) {}
+
+    /**
+     * @brief Adds the response to a batch element.
+     *
+     * @param res The outcome of the batch element.
+     */
+    void add(outcome_t<BasicJsonType>&& res)
+    {
+        auto response = dispatcher_private<BasicJsonType>::to_json(this->m_dispatcher, std::move(res));
+        if (!response.is_discarded()) {
+            this->m_response.push_back(std::move(response));
+        }
+    }
+
+    /**
+     * @brief Returns the response to the batch request.
+     *
+     * @return The array of responses; a discarded value if all elements are notifications.
+     */
+    BasicJsonType finish()
+    {
+        return this->m_response.empty() ? BasicJsonType(BasicJsonType::value_t::discarded)
+                                        : std::move(this->m_response);
+    }
+
+private:
+    const dispatcher_base<BasicJsonType>& m_dispatcher;  ///< The dispatcher.
+    BasicJsonType m_response = BasicJsonType::array();   ///< Responses.
+};
+
+/**
+ * @brief Serializes the responses to the elements of a batch request into a buffer.
+ * @internal
+ *
+ * @tparam BasicJsonType The JSON type.
+ *
+ * @details If the sink is destroyed before finish() is called (that is, an exception escapes the processing
+ * of the batch), the buffer is restored: the caller never sees a partial response.
+ */
+template<typename BasicJsonType>
+class text_sink {
+public:
+    /**
+     * @brief Constructs the sink.
+     *
+     * @param q The dispatcher.
+     * @param out The output buffer.
+     */
+    text_sink(dispatcher_base<BasicJsonType>& q, std::string& out) : m_dispatcher(q), m_out(out), m_start(out.size())
+    {
+        this->m_out.push_back('[');
+    }
+
+    text_sink(const text_sink&)            = delete;
+    text_sink& operator=(const text_sink&) = delete;
+
+    /**
+     * @brief Destroys the sink, restoring the buffer if the response is not complete.
+     */
+    ~text_sink()
+    {
+        if (!this->m_finished) {
+            this->m_out.resize(this->m_start);
+        }
+    }
+
+    /**
+     * @brief Adds the response to a batch element.
+     *
+     * @param res The outcome of the batch element.
+     */
+    void add(const outcome_t<BasicJsonType>& res)
+    {
+        const auto pos = this->m_out.size();
+        if (this->m_count != 0) {
+            this->m_out.push_back(',');
+        }
+
+        if (dispatcher_private<BasicJsonType>::write(this->m_dispatcher, res, this->m_out)) {
+            ++this->m_count;
+        }
+        else {
+            this->m_out.resize(pos);
+        }
+    }
+
+    /**
+     * @brief Completes the response to the batch request.
+     *
+     * @return Whether a response has been written. If all elements are notifications, the buffer is restored.
+     */
+    bool finish()
+    {
+        this->m_finished = true;
+        if (this->m_count == 0) {
+            this->m_out.resize(this->m_start);
+            return false;
+        }
+
+        this->m_out.push_back(']');
+        return true;
+    }
+
+private:
+    dispatcher_base<BasicJsonType>& m_dispatcher;  ///< The dispatcher.
+    std::string& m_out;                            ///< The output buffer.
+    std::size_t m_start;                           ///< The size of the buffer before the response was written.
+    std::size_t m_count = 0;                       ///< The number of responses written.
+    bool m_finished     = false;                   ///< Whether the response is complete.
+};
+
+/**
+ * @brief Processes a request represented by a JSON object.
+ * @internal
+ *
+ * @tparam BasicJsonType The JSON type.
+ * @param q The dispatcher.
+ * @param request The request.
+ * @param data Pointer to the data to pass to the method handlers as a part of the context.
+ * @param unique_id The unique request ID.
+ * @return The outcome of the request.
+ */
+template<typename BasicJsonType>
+outcome_t<BasicJsonType> process_element(
+    dispatcher_base<BasicJsonType>& q, const BasicJsonType& request, const void* data, std::uint64_t unique_id
+)
+{
+    return dispatcher_private<BasicJsonType>::process(
+        q, [&request]() { return wwa::json_rpc::details::try_parse_envelope(request); },
+        [&request]() { return wwa::json_rpc::details::collect_extra(request); }, request,
+        wwa::json_rpc::get_request_id(request), data, unique_id
+    );
+}
+
+/**
+ * @brief Processes a request represented by a JSON object, consuming it.
+ * @internal
+ *
+ * @tparam BasicJsonType The JSON type.
+ * @param q The dispatcher.
+ * @param request The request; its `params`, `id`, and extra members are moved out.
+ * @param data Pointer to the data to pass to the method handlers as a part of the context.
+ * @param unique_id The unique request ID.
+ * @return The outcome of the request.
+ */
+template<typename BasicJsonType>
+outcome_t<BasicJsonType>
+process_element(dispatcher_base<BasicJsonType>& q, BasicJsonType& request, const void* data, std::uint64_t unique_id)
+{
+    return dispatcher_private<BasicJsonType>::process(
+        q, [&request]() { return wwa::json_rpc::details::try_parse_envelope(std::move(request)); },
+        [&request]() { return std::move(request); }, request, wwa::json_rpc::get_request_id(request), data, unique_id
+    );
+}
+
+/**
+ * @brief Processes a request extracted by the SAX parser.
+ * @internal
+ *
+ * @tparam BasicJsonType The JSON type.
+ * @param q The dispatcher.
+ * @param entry The request.
+ * @param data Pointer to the data to pass to the method handlers as a part of the context.
+ * @param unique_id The unique request ID.
+ * @return The outcome of the request.
+ */
+template<typename BasicJsonType>
+outcome_t<BasicJsonType> process_element(
+    dispatcher_base<BasicJsonType>& q, typename request_parser<BasicJsonType>::entry& entry, const void* data,
+    std::uint64_t unique_id
+)
+{
+    return dispatcher_private<BasicJsonType>::process(
+        q, [&entry]() { return entry.to_request(); }, [&entry]() { return entry.take_extra(); }, entry.extra,
+        entry.response_id(), data, unique_id
+    );
+}
+
+/**
+ * @brief Checks whether an element of a batch request is an object.
+ * @internal
+ *
+ * @tparam Element The type of the batch element: a JSON value or `request_parser::entry`.
+ * @param element The batch element.
+ * @return Whether the element is an object.
+ */
+template<typename Element>
+bool is_object(const Element& element)
+{
+    if constexpr (requires { element.is_object(); }) {
+        return element.is_object();
+    }
+    else {
+        return element.is_object;
+    }
+}
+
+/**
+ * @brief Processes an element of a batch request.
+ * @internal
+ *
+ * @tparam BasicJsonType The JSON type.
+ * @tparam Element The type of the batch element.
+ * @param q The dispatcher.
+ * @param element The batch element.
+ * @param data Pointer to the data to pass to the method handlers as a part of the context.
+ * @param batch_id The unique ID of the batch request.
+ * @param unique_id The unique ID of the element; only used if the element is an object.
+ * @return The outcome of the element.
+ */
+template<typename BasicJsonType, typename Element>
+outcome_t<BasicJsonType> process_batch_element(
+    dispatcher_base<BasicJsonType>& q, Element& element, const void* data, std::uint64_t batch_id,
+    std::uint64_t unique_id
+)
+{
+    if (!is_object(element)) {
+        return dispatcher_private<BasicJsonType>::fail(
+            q, wwa::json_rpc::exception::INVALID_REQUEST, wwa::json_rpc::err_not_jsonrpc_2_0_request, false, batch_id
+        );
+    }
+
+    return process_element(q, element, data, unique_id);
+}
+
+/**
+ * @brief Processes an element of a batch request asynchronously.
+ * @internal
+ *
+ * @tparam BasicJsonType The JSON type.
+ * @param q The dispatcher.
+ * @param element The batch element; it is consumed.
+ * @param data Pointer to the data to pass to the method handlers as a part of the context.
+ * @param batch_id The unique ID of the batch request.
+ * @param unique_id The unique ID of the element; only used if the element is an object.
+ * @return Task that produces the outcome of the element.
+ */
+template<typename BasicJsonType>
+wwa::json_rpc::task<outcome_t<BasicJsonType>> process_batch_element_async(
+    dispatcher_base<BasicJsonType>& q, BasicJsonType& element, const void* data, std::uint64_t batch_id,
+    std::uint64_t unique_id
+)
+{
+    if (!element.is_object()) {
+        co_return dispatcher_private<BasicJsonType>::fail(
+            q, wwa::json_rpc::exception::INVALID_REQUEST, wwa::json_rpc::err_not_jsonrpc_2_0_request, false, batch_id
+        );
+    }
+
+    co_return co_await dispatcher_private<BasicJsonType>::process_async(q, element, data, unique_id);
+}
+
+/**
+ * @brief Assigns unique IDs to the elements of a batch request that are objects.
+ * @internal
+ *
+ * @tparam BasicJsonType The JSON type.
+ * @tparam Elements The type of the range of batch elements.
+ * @param q The dispatcher.
+ * @param elements The batch elements.
+ * @param resource The memory resource to allocate the result from.
+ * @return The unique IDs, in the same order as sequential processing would assign them.
+ */
+template<typename BasicJsonType, typename Elements>
+std::pmr::vector<std::uint64_t> assign_unique_ids(
+    const dispatcher_base<BasicJsonType>& q, const Elements& elements, std::pmr::memory_resource* resource
+)
+{
+    std::pmr::vector<std::uint64_t> ids(resource);
+    ids.reserve(elements.size());
+    for (const auto& element : elements) {
+        ids.push_back(is_object(element) ? dispatcher_private<BasicJsonType>::next_id(q) : 0);
+    }
+
+    return ids;
+}
+
+/**
+ * @brief Processes the elements of a batch request.
+ * @internal
+ *
+ * @tparam BasicJsonType The JSON type.
+ * @tparam Elements The type of the range of batch elements.
+ * @tparam Sink The type of the sink for the responses.
+ * @param q The dispatcher.
+ * @param exec The executor to process the elements in parallel; `nullptr` to process them sequentially.
+ * @param elements The batch elements.
+ * @param data Pointer to the data to pass to the method handlers as a part of the context.
+ * @param unique_id The unique ID of the batch request.
+ * @param resource The memory resource for the temporary buffers of parallel processing.
+ * @param sink The sink for the responses.
+ */
+template<typename BasicJsonType, typename Elements, typename Sink>
+void process_batch(
+    dispatcher_base<BasicJsonType>& q, wwa::json_rpc::executor* exec, Elements& elements, const void* data,
+    std::uint64_t unique_id, std::pmr::memory_resource* resource, Sink& sink
+)
+{
+    if (exec == nullptr) {
+        for (auto& element : elements) {
+            const auto id = is_object(element) ? dispatcher_private<BasicJsonType>::next_id(q) : 0;
+            sink.add(process_batch_element(q, element, data, unique_id, id));
+        }
+
+        return;
+    }
+
+    const auto ids = assign_unique_ids(q, elements, resource);
+    std::pmr::vector<outcome_t<BasicJsonType>> outcomes(ids.size(), resource);
+    wwa::json_rpc::parallel_for(*exec, ids.size(), [&](std::size_t i) {
+        outcomes[i] = process_batch_element(q, elements[i], data, unique_id, ids[i]);
+    });
+
+    for (auto& res : outcomes) {
+        sink.add(std::move(res));
+    }
+}
+
+}  // namespace wwa::json_rpc::details
+
+namespace wwa::json_rpc {
+
+template<typename BasicJsonType>
+BasicJsonType dispatcher_private<BasicJsonType>::outcome::to_json() &&
+{
+    if (!this->is_result) {
+        return std::move(this->response);
+    }
+
+    // clang-format off
+    return {
+        {"jsonrpc", "2.0"},
+        {"result", std::move(this->response)},
+        {"id", std::move(this->id)}
+    };
+    // clang-format on
+}
+
+template<typename BasicJsonType>
+bool dispatcher_private<BasicJsonType>::outcome::write(std::string& out) const
+{
+    if (!this->is_result && this->response.is_discarded()) {
+        return false;
+    }
+
+    const auto pos = out.size();
+    try {
+        if (this->is_result) {
+            out.append(R"({"jsonrpc":"2.0","result":)");
+            details::append_json(out, this->response);
+            out.append(R"(,"id":)");
+            details::append_json(out, this->id);
+            out.push_back('}');
+        }
+        else {
+            details::append_json(out, this->response);
+        }
+    }
+    catch (...) {
+        out.resize(pos);
+        throw;
+    }
+
+    return true;
+}
+
+template<typename BasicJsonType>
+BasicJsonType dispatcher_private<BasicJsonType>::to_json(const dispatcher_t& q, outcome&& res)
+{
+    auto* metrics = q.d_ptr->metrics();
+    if (metrics == nullptr) {
+        return std::move(res).to_json();
+    }
+
+    const stopwatch serialize_time(true);
+    auto response = std::move(res).to_json();
+    metrics->local().record_serialize(serialize_time.elapsed());
+    return response;
+}
+
+template<typename BasicJsonType>
+bool dispatcher_private<BasicJsonType>::write(dispatcher_t& q, const outcome& res, std::string& out)
+{
+    auto* metrics = q.d_ptr->metrics();
+    const stopwatch serialize_time(metrics != nullptr);
+
+    bool written = false;
+    try {
+        written = res.write(out);
+    }
+    catch (const std::exception& e) {
+        // outcome::write() has rolled `out` back
+        const outcome failure{
+            dispatcher_private::handle_exception(q, res.id, e, false, res.unique_id), nullptr, false, res.unique_id
+        };
+        try {
+            written = failure.write(out);
+        }
+        catch (const std::exception&) {
+            // The request ID cannot be serialized either
+            const exception error(exception::INTERNAL_ERROR, e.what());
+            const outcome fallback{
+                generate_error_response<BasicJsonType>(error, nullptr), nullptr, false, res.unique_id
+            };
+            written = fallback.write(out);
+        }
+    }
+
+    if (metrics != nullptr) {
+        metrics->local().record_serialize(serialize_time.elapsed());
+    }
+
+    return written;
+}
+
+template<typename BasicJsonType>
+void dispatcher_private<BasicJsonType>::record_error(const dispatcher_t& q, int code)
+{
+    if (auto* metrics = q.d_ptr->metrics(); metrics != nullptr) {
+        metrics->local().record_error(code);
+    }
+}
+
+template<typename BasicJsonType>
+bool dispatcher_private<BasicJsonType>::execute_request(
+    dispatcher_t& q, request_t& req, bool with_context, const BasicJsonType& request_id, const void* data,
+    std::uint64_t unique_id, BasicJsonType& response
+)
+{
+    bool is_discarded = false;
+    try {
+        q.erased_request_parsed(req, data, unique_id);
+        is_discarded = req.id.is_discarded();
+
+        call_recorder call(q.d_ptr->metrics(), req.method);
+        auto result = q.erased_invoke(
+            req.method, req.params, data, with_context ? req.take_extra() : BasicJsonType(nullptr), unique_id
+        );
+        if (!result) {
+            call.failed(result.error().code());
+            response = dispatcher_private::handle_error(q, request_id, result.error(), is_discarded, unique_id);
+            return false;
+        }
+
+        call.succeeded();
+
+        if (!request_id.is_null()) {
+            response = std::move(*result);
+            return true;
+        }
+
+        response = BasicJsonType::value_t::discarded;
+    }
+    catch (const exception& e) {
+        response = dispatcher_private::handle_error(q, request_id, e, is_discarded, unique_id);
+    }
+    catch (const std::exception& e) {
+        response = dispatcher_private::handle_exception(q, request_id, e, is_discarded, unique_id);
+    }
+
+    return false;
+}
+
+template<typename BasicJsonType>
+BasicJsonType dispatcher_private<BasicJsonType>::handle_error(
+    dispatcher_t& q, const BasicJsonType& request_id, const exception& e, bool is_discarded, std::uint64_t unique_id
+)
+{
+    dispatcher_private::record_error(q, e.code());
+    q.request_failed(request_id, &e, false, unique_id);
+    if (is_discarded) {
+        return BasicJsonType::value_t::discarded;
+    }
+
+    return generate_error_response<BasicJsonType>(e, request_id);
+}
+
+template<typename BasicJsonType>
+BasicJsonType dispatcher_private<BasicJsonType>::handle_exception(
+    dispatcher_t& q, const BasicJsonType& request_id, const std::exception& e, bool is_discarded,
+    std::uint64_t unique_id
+)
+{
+    dispatcher_private::record_error(q, exception::INTERNAL_ERROR);
+    q.request_failed(request_id, &e, false, unique_id);
+    if (is_discarded) {
+        return BasicJsonType::value_t::discarded;
+    }
+
+    return generate_error_response<BasicJsonType>(exception(exception::INTERNAL_ERROR, e.what()), request_id);
+}
+
+template<typename BasicJsonType>
+typename dispatcher_private<BasicJsonType>::outcome dispatcher_private<BasicJsonType>::fail(
+    dispatcher_t& q, int code, std::string_view message, bool is_batch, std::uint64_t unique_id
+)
+{
+    dispatcher_private::record_error(q, code);
+    const exception e(code, message);
+    q.request_failed(nullptr, &e, is_batch, unique_id);
+    return {generate_error_response<BasicJsonType>(e, nullptr), nullptr};
+}
+
+template<typename BasicJsonType>
+task<typename dispatcher_private<BasicJsonType>::outcome> dispatcher_private<BasicJsonType>::process_async(
+    dispatcher_t& q, BasicJsonType& request, const void* data, std::uint64_t unique_id
+)
+{
+    outcome res{{}, get_request_id(request), false, unique_id};
+
+    auto* metrics = q.d_ptr->metrics();
+    const stopwatch parse_time(metrics != nullptr);
+    auto req = details::try_parse_envelope(std::move(request));
+    if (metrics != nullptr) {
+        metrics->local().record_parse(parse_time.elapsed());
+    }
+
+    if (!req) {
+        res.response = dispatcher_private::handle_error(q, res.id, req.error(), false, unique_id);
+        co_return res;
+    }
+
+    const bool with_context =
+        dispatcher_private::collect_extra(q, *req, [&request]() { return std::move(request); }, request);
+
+    bool is_discarded = false;
+    try {
+        q.erased_request_parsed(*req, data, unique_id);
+        is_discarded = req->id.is_discarded();
+
+        // A temporary in the conditional expression would not survive co_await with GCC 12
+        auto extra = with_context ? req->take_extra() : BasicJsonType(nullptr);
+
+        call_recorder call(q.d_ptr->metrics(), req->method);
+        auto result =
+            co_await q.erased_invoke_async(req->method, req->params, data, std::move(extra), unique_id);
+        if (!result) {
+            call.failed(result.error().code());
+            res.response = dispatcher_private::handle_error(q, res.id, result.error(), is_discarded, unique_id);
+            co_return res;
+        }
+
+        call.succeeded();
+
+        if (!res.id.is_null()) {
+            res.response  = std::move(*result);
+            res.is_result = true;
+            co_return res;
+        }
+
+        res.response = BasicJsonType::value_t::discarded;
+    }
+    catch (const exception& e) {
+        res.response = dispatcher_private::handle_error(q, res.id, e, is_discarded, unique_id);
+    }
+    catch (const std::exception& e) {
+        res.response = dispatcher_private::handle_exception(q, res.id, e, is_discarded, unique_id);
+    }
+
+    co_return res;
+}
+
+template<typename BasicJsonType>
+dispatcher_base<BasicJsonType>::dispatcher_base() : d_ptr(std::make_unique<private_t>()) {}
+
+template<typename BasicJsonType>
+dispatcher_base<BasicJsonType>::~dispatcher_base() = default;
+
+template<typename BasicJsonType>
+dispatcher_base<BasicJsonType>::dispatcher_base(dispatcher_base&& rhs) noexcept = default;
+
+template<typename BasicJsonType>
+dispatcher_base<BasicJsonType>& dispatcher_base<BasicJsonType>::operator=(dispatcher_base&& rhs) noexcept = default;
+
+template<typename BasicJsonType>
+void dispatcher_base<BasicJsonType>::add_internal_method(
+    std::string_view method, handler_t&& handler, bool with_context
+)
+{
+    this->d_ptr->add_handler(std::string(method), {std::move(handler), {}}, with_context);
+}
+
+template<typename BasicJsonType>
+void dispatcher_base<BasicJsonType>::add_internal_method(
+    std::string_view method, async_handler_t&& handler, bool with_context
+)
+{
+    this->d_ptr->add_handler(std::string(method), {{}, std::move(handler)}, with_context);
+}
+
+template<typename BasicJsonType>
+void dispatcher_base<BasicJsonType>::freeze()
+{
+    this->d_ptr->freeze();
+}
+
+template<typename BasicJsonType>
+bool dispatcher_base<BasicJsonType>::is_frozen() const noexcept
+{
+    return this->d_ptr->is_frozen();
+}
+
+template<typename BasicJsonType>
+void dispatcher_base<BasicJsonType>::set_executor(std::shared_ptr<executor> exec)
+{
+    this->d_ptr->set_executor(std::move(exec));
+}
+
+template<typename BasicJsonType>
+void dispatcher_base<BasicJsonType>::set_parallel_batch_threshold(std::size_t threshold) noexcept
+{
+    this->d_ptr->set_batch_threshold(threshold);
+}
+
+template<typename BasicJsonType>
+void dispatcher_base<BasicJsonType>::set_id_generator(std::shared_ptr<id_generator> gen)
+{
+    this->d_ptr->set_id_generator(std::move(gen));
+}
+
+template<typename BasicJsonType>
+void dispatcher_base<BasicJsonType>::enable_metrics(bool enable)
+{
+    this->d_ptr->enable_metrics(enable);
+}
+
+template<typename BasicJsonType>
+metrics_snapshot dispatcher_base<BasicJsonType>::metrics() const
+{
+    const auto* registry = this->d_ptr->metrics();
+    return registry != nullptr ? registry->snapshot() : metrics_snapshot{};
+}
+
+template<typename BasicJsonType>
+BasicJsonType dispatcher_base<BasicJsonType>::erased_process_request(const BasicJsonType& request, const void* data)
+{
+    const auto unique_id = private_t::next_id(*this);
+    if (request.is_array()) {
+        return this->erased_process_batch_request(request, data, unique_id);
+    }
+
+    return this->erased_do_process_request(request, data, false, unique_id);
+}
+
+template<typename BasicJsonType>
+BasicJsonType dispatcher_base<BasicJsonType>::erased_consume_request(BasicJsonType&& request, const void* data)
+{
+    const auto unique_id = private_t::next_id(*this);
+    if (!request.is_array()) {
+        return private_t::to_json(*this, details::process_element(*this, request, data, unique_id));
+    }
+
+    if (request.empty()) {
+        return private_t::fail(*this, exception::INVALID_REQUEST, err_empty_batch, true, unique_id).to_json();
+    }
+
+    details::json_sink sink(*this);
+    details::process_batch(
+        *this, this->d_ptr->batch_executor(request.size()), request, data, unique_id, std::pmr::get_default_resource(),
+        sink
+    );
+    return sink.finish();
+}
+
+template<typename BasicJsonType>
+BasicJsonType dispatcher_base<BasicJsonType>::erased_process_request(
+    std::string_view request, const void* data, std::pmr::memory_resource* resource,
+    typename BasicJsonType::input_format_t format
+)
+{
+    const auto unique_id = private_t::next_id(*this);
+    if (resource == nullptr) {
+        resource = std::pmr::get_default_resource();
+    }
+
+    auto* metrics = this->d_ptr->metrics();
+    const stopwatch parse_time(metrics != nullptr);
+
+    request_parser<BasicJsonType> parser(resource);
+    const auto parsed = parser.parse(request, format);
+    if (metrics != nullptr) {
+        metrics->local().record_parse(parse_time.elapsed());
+    }
+
+    if (!parsed) {
+        return private_t::fail(*this, exception::PARSE_ERROR, parser.error(), false, unique_id).to_json();
+    }
+
+    auto& entries = parser.entries();
+    if (!parser.is_batch()) {
+        return private_t::to_json(*this, details::process_element(*this, entries.front(), data, unique_id));
+    }
+
+    if (entries.empty()) {
+        return private_t::fail(*this, exception::INVALID_REQUEST, err_empty_batch, true, unique_id).to_json();
+    }
+
+    details::json_sink sink(*this);
+    details::process_batch(
+        *this, this->d_ptr->batch_executor(entries.size()), entries, data, unique_id, resource, sink
+    );
+    return sink.finish();
+}
+
+template<typename BasicJsonType>
+bool dispatcher_base<BasicJsonType>::erased_process_request_to(
+    const BasicJsonType& request, std::string& out, const void* data
+)
+{
+    const auto unique_id = private_t::next_id(*this);
+    if (!request.is_array()) {
+        return private_t::write(*this, details::process_element(*this, request, data, unique_id), out);
+    }
+
+    if (request.empty()) {
+        return private_t::fail(*this, exception::INVALID_REQUEST, err_empty_batch, true, unique_id).write(out);
+    }
+
+    details::text_sink sink(*this, out);
+    details::process_batch(
+        *this, this->d_ptr->batch_executor(request.size()), request, data, unique_id, std::pmr::get_default_resource(),
+        sink
+    );
+    return sink.finish();
+}
+
+template<typename BasicJsonType>
+bool dispatcher_base<BasicJsonType>::erased_process_request_to(
+    std::string_view request, std::string& out, const void* data, std::pmr::memory_resource* resource
+)
+{
+    const auto unique_id = private_t::next_id(*this);
+    if (resource == nullptr) {
+        resource = std::pmr::get_default_resource();
+    }
+
+    auto* metrics = this->d_ptr->metrics();
+    const stopwatch parse_time(metrics != nullptr);
+
+    request_parser<BasicJsonType> parser(resource);
+    const auto parsed = parser.parse(request);
+    if (metrics != nullptr) {
+        metrics->local().record_parse(parse_time.elapsed());
+    }
+
+    if (!parsed) {
+        return private_t::fail(*this, exception::PARSE_ERROR, parser.error(), false, unique_id).write(out);
+    }
+
+    auto& entries = parser.entries();
+    if (!parser.is_batch()) {
+        return private_t::write(*this, details::process_element(*this, entries.front(), data, unique_id), out);
+    }
+
+    if (entries.empty()) {
+        return private_t::fail(*this, exception::INVALID_REQUEST, err_empty_batch, true, unique_id).write(out);
+    }
+
+    details::text_sink sink(*this, out);
+    details::process_batch(
+        *this, this->d_ptr->batch_executor(entries.size()), entries, data, unique_id, resource, sink
+    );
+    return sink.finish();
+}
+
+template<typename BasicJsonType>
+task<BasicJsonType>
+dispatcher_base<BasicJsonType>::erased_process_request_async(BasicJsonType request, const void* data)
+{
+    const auto unique_id = private_t::next_id(*this);
+    if (!request.is_array()) {
+        auto res = co_await private_t::process_async(*this, request, data, unique_id);
+        co_return private_t::to_json(*this, std::move(res));
+    }
+
+    if (request.empty()) {
+        co_return private_t::fail(*this, exception::INVALID_REQUEST, err_empty_batch, true, unique_id).to_json();
+    }
+
+    std::vector<task<details::outcome_t<BasicJsonType>>> tasks;
+    tasks.reserve(request.size());
+    for (auto& element : request) {
+        const auto id = element.is_object() ? private_t::next_id(*this) : 0;
+        tasks.push_back(details::process_batch_element_async(*this, element, data, unique_id, id));
+    }
+
+    details::json_sink sink(*this);
+    for (auto& res : co_await when_all(std::move(tasks))) {
+        sink.add(std::move(res));
+    }
+
+    co_return sink.finish();
+}
+
+template<typename BasicJsonType>
+BasicJsonType dispatcher_base<BasicJsonType>::default_do_process_request(
+    const BasicJsonType& request, const void* data, std::uint64_t unique_id
+)
+{
+    return private_t::to_json(*this, details::process_element(*this, request, data, unique_id));
+}
+
+template<typename BasicJsonType>
+BasicJsonType dispatcher_base<BasicJsonType>::default_process_batch_request(
+    const BasicJsonType& request, const void* data, std::uint64_t unique_id
+)
+{
+    if (request.empty()) {
+        const exception e(exception::INVALID_REQUEST, err_empty_batch);
+        private_t::record_error(*this, e.code());
+        this->request_failed(nullptr, &e, true, unique_id);
+        return generate_error_response<BasicJsonType>(e, nullptr);
+    }
+
+    const auto process = [this, &data, unique_id](const BasicJsonType& req, std::uint64_t id) -> BasicJsonType {
+        if (!req.is_object()) {
+            const exception e(exception::INVALID_REQUEST, err_not_jsonrpc_2_0_request);
+            private_t::record_error(*this, e.code());
+            this->request_failed(nullptr, &e, false, unique_id);
+            return generate_error_response<BasicJsonType>(e, nullptr);
+        }
+
+        return this->erased_do_process_request(req, data, true, id);
+    };
+
+    auto response = BasicJsonType::array();
+    if (auto* exec = this->d_ptr->batch_executor(request.size()); exec != nullptr) {
+        const auto ids = details::assign_unique_ids(*this, request, std::pmr::get_default_resource());
+        std::vector<BasicJsonType> results(ids.size());
+        parallel_for(*exec, ids.size(), [&](std::size_t i) { results[i] = process(request[i], ids[i]); });
+
+        for (auto& res : results) {
+            if (!res.is_discarded()) {
+                response.push_back(std::move(res));
+            }
+        }
+    }
+    else {
+        for (const auto& req : request) {
+            const auto id = req.is_object() ? private_t::next_id(*this) : 0;
+            if (auto res = process(req, id); !res.is_discarded()) {
+                response.push_back(std::move(res));
+            }
+        }
+    }
+
+    return response.empty() ? BasicJsonType(BasicJsonType::value_t::discarded) : response;
+}
+
+template<typename BasicJsonType>
+expected<BasicJsonType>
+dispatcher_base<BasicJsonType>::call_handler(std::string_view method, const BasicJsonType& params, const void* ctx)
+{
+    if (const auto* handler = this->d_ptr->find_handler(method); handler != nullptr) {
+        return handler->sync ? handler->sync(ctx, params) : sync_wait(handler->async(ctx, params));
+    }
+
+    return unexpected(method_not_found_exception());
+}
+
+template<typename BasicJsonType>
+const typename dispatcher_base<BasicJsonType>::async_handler_t*
+dispatcher_base<BasicJsonType>::find_async_handler(std::string_view method) const noexcept
+{
+    const auto* handler = this->d_ptr->find_handler(method);
+    return handler != nullptr && handler->async ? &handler->async : nullptr;
+}
+
+template<typename BasicJsonType>
+void dispatcher_base<BasicJsonType>::request_failed(const BasicJsonType&, const std::exception*, bool, std::uint64_t)
+{
+    // Do nothing
+}
+
+}  // namespace wwa::json_rpc
+
+#endif /* C7E2A9D4_1B6F_4E83_A5D0_3F8B2C61E947 */
@@ -7,12 +7,27 @@
  * @internal
  */
 
-#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <utility>
+#include <vector>
+
+#include <nlohmann/json.hpp>
 
 #include "dispatcher.h"
+#include "executor.h"
+#include "id_generator.h"
+#include "metrics.h"
+#include "metrics_p.h"
+#include "perfect_hash_p.h"
+#include "request.h"
 
 namespace wwa::json_rpc {
 
@@ -20,62 +35,450 @@ namespace wwa::json_rpc {
  * @brief Private implementation of the JSON RPC dispatcher class.
  * @internal
  *
- * This class contains the private members and methods used by the `dispatcher` class to manage method handlers.
+ * This class contains the private members and methods used by the `dispatcher_base` class to manage method handlers.
+ * Because `dispatcher_private` is a friend of `dispatcher_base`, its static methods also implement the request
+ * processing steps shared by the different `basic_dispatcher::process_request()` overloads.
+ *
+ * @tparam BasicJsonType The JSON type (a `nlohmann::basic_json` specialization).
  */
+template<typename BasicJsonType>
 class dispatcher_private {
 public:
+    using dispatcher_t = dispatcher_base<BasicJsonType>;      ///< The dispatcher this class implements.
+    using request_t    = basic_jsonrpc_request<BasicJsonType>;  ///< The type of parsed requests.
+
+    /**
+     * @brief The outcome of processing a single (non-batch) request.
+     */
+    struct outcome {
+        /**
+         * @brief The response.
+         *
+         * @details If `is_result` is `true`, this is the value returned by the method handler;
+         * otherwise, this is either an error response or a discarded value.
+         */
+        BasicJsonType response;
+        BasicJsonType id;                 ///< The request ID to use in the response.
+        bool is_result          = false;  ///< Whether `response` holds the result of the method.
+        std::uint64_t unique_id = 0;      ///< The unique request ID.
+
+        /**
+         * @brief Converts the outcome into a JSON RPC response.
+         *
+         * @return JSON RPC response; a discarded value if there must be no response.
+         */
+        BasicJsonType to_json() &&;
+
+        /**
+         * @brief Serializes the outcome as a JSON RPC response and appends it to @a out.
+         *
+         * @param out The output buffer.
+         * @return Whether anything has been written.
+         *
+         * @details Successful responses are written without building a DOM for the response object:
+         * only the result and the ID are serialized.
+         */
+        bool write(std::string& out) const;
+    };
+
+    /**
+     * @brief A registered method handler.
+     *
+     * @details Exactly one of `sync` and `async` is set.
+     */
+    struct method_handler {
+        typename dispatcher_t::handler_t sync;         ///< Synchronous handler.
+        typename dispatcher_t::async_handler_t async;  ///< Asynchronous handler.
+        bool with_context = false;                     ///< Whether the handler has been added with `add_ex()`.
+    };
+
     /**
      * @brief Adds a method handler.
      *
      * @param method The name of the method.
      * @param handler The handler function.
+     * @param with_context Whether the handler accepts the context (that is, it has been added with `add_ex()`).
      *
      * @details This method registers a handler function for a given method name.
      * The handler function will be invoked when a request for the specified method is received.
      */
-    void add_handler(std::string&& method, dispatcher::handler_t&& handler)
+    void add_handler(std::string&& method, method_handler&& handler, bool with_context)
+    {
+        if (this->m_frozen) {
+            throw std::logic_error("Cannot add methods to a frozen dispatcher");
+        }
+
+        handler.with_context = with_context;
+        if (this->m_methods.try_emplace(std::move(method), std::move(handler)).second && with_context) {
+            this->m_needs_context = true;
+        }
+    }
+
+    /**
+     * @brief Checks whether the handler for @a method accepts the context.
+     *
+     * @param method The name of the method.
+     * @return Whether the handler has been added with `add_ex()`; `false` if there is no such handler.
+     *
+     * @details Unless some handler has been added with `add_ex()`, this does not even look the method up.
+     */
+    [[nodiscard]] bool accepts_context(std::string_view method) const noexcept
+    {
+        if (!this->m_needs_context) {
+            return false;
+        }
+
+        const auto* handler = this->find_handler(method);
+        return handler != nullptr && handler->with_context;
+    }
+
+    /**
+     * @brief Collects the extra fields of a request if the handler is going to look at them.
+     *
+     * @tparam Extra The type of the function that returns the extra fields.
+     * @param q The dispatcher.
+     * @param req The parsed request without the extra fields.
+     * @param extra The function that returns the extra fields of the request.
+     * @param source The object to collect the extra fields from on demand; it must outlive @a req.
+     * @return Whether the handler for the request accepts the context.
+     *
+     * @details If the handler accepts the context, the result of @a extra is stored into @a req. Otherwise,
+     * @a extra is not called at all, and @a req collects the extra fields from @a source only if
+     * `basic_dispatcher::request_parsed()` asks for them: handlers added with `add()` do not pay for the extra fields.
+     */
+    template<typename Extra>
+    static bool collect_extra(const dispatcher_t& q, request_t& req, Extra&& extra, const BasicJsonType& source)
     {
-        this->m_methods.try_emplace(std::move(method), std::move(handler));
+        const bool with_context = q.d_ptr->accepts_context(req.method);
+        if (with_context) {
+            req.set_extra(std::forward<Extra>(extra)());
+        }
+        else {
+            req.set_extra_source(source);
+        }
+
+        return with_context;
+    }
+
+    /**
+     * @brief Freezes the set of method handlers.
+     *
+     * @details Compiles the registered method names into a perfect hash table, which find_handler() uses from now on.
+     * After this point, add_handler() throws.
+     */
+    void freeze()
+    {
+        if (this->m_frozen) {
+            return;
+        }
+
+        std::vector<std::pair<std::string_view, const method_handler*>> items;
+        items.reserve(this->m_methods.size());
+        for (const auto& [name, handler] : this->m_methods) {
+            items.emplace_back(name, &handler);
+        }
+
+        this->m_table.build(items);
+        this->m_frozen = true;
+    }
+
+    /**
+     * @brief Checks whether the set of method handlers is frozen.
+     *
+     * @return Whether freeze() has been called.
+     */
+    [[nodiscard]] bool is_frozen() const noexcept { return this->m_frozen; }
+
+    /**
+     * @brief Sets the executor for batch requests.
+     *
+     * @param exec The executor; `nullptr` disables parallel processing.
+     */
+    void set_executor(std::shared_ptr<executor>&& exec) noexcept { this->m_executor = std::move(exec); }
+
+    /**
+     * @brief Sets the minimum size of a batch request that is processed in parallel.
+     *
+     * @param threshold The minimum number of elements.
+     */
+    void set_batch_threshold(std::size_t threshold) noexcept { this->m_batch_threshold = threshold; }
+
+    /**
+     * @brief Returns the executor to process a batch request with.
+     *
+     * @param batch_size The number of elements in the batch.
+     * @return The executor; `nullptr` if the batch must be processed sequentially.
+     */
+    [[nodiscard]] executor* batch_executor(std::size_t batch_size) const noexcept
+    {
+        return batch_size >= this->m_batch_threshold && batch_size > 1 ? this->m_executor.get() : nullptr;
+    }
+
+    /**
+     * @brief Enables or disables the collection of metrics.
+     *
+     * @param enable Whether to collect metrics; disabling the collection discards the collected metrics.
+     */
+    void enable_metrics(bool enable)
+    {
+        if (!enable) {
+            this->m_metrics.reset();
+        }
+        else if (!this->m_metrics) {
+            this->m_metrics = std::make_unique<metrics_registry>();
+        }
     }
 
+    /**
+     * @brief Returns the metrics.
+     *
+     * @return The metrics; `nullptr` if the collection of metrics is disabled.
+     */
+    [[nodiscard]] metrics_registry* metrics() const noexcept { return this->m_metrics.get(); }
+
     /**
      * @brief Finds a method handler.
      *
      * @param method The name of the method.
-     * @return The handler function for the specified method.
+     * @return Pointer to the handler function for the specified method.
      * @retval nullptr Handler not found
      *
-     * @details This method returns the handler function for the specified method name.
+     * @details This method returns a pointer to the handler function for the specified method name,
+     * so that the handler can be invoked in place without copying it.
      * If no handler is found, it returns a null pointer.
+     *
+     * The lookup is heterogeneous: it does not require the method name to be a `std::string`.
+     * Once the dispatcher is frozen, the lookup uses the perfect hash table.
      */
-    dispatcher::handler_t find_handler(const std::string& method) const
+    const method_handler* find_handler(std::string_view method) const noexcept
     {
+        if (this->m_frozen) {
+            return this->m_table.find(method);
+        }
+
         if (const auto it = this->m_methods.find(method); it != this->m_methods.end()) {
-            return it->second;
+            return &it->second;
         }
 
         return nullptr;
     }
 
+    /**
+     * @brief Sets the generator of unique request IDs.
+     *
+     * @param gen The generator; `nullptr` restores the default one.
+     */
+    void set_id_generator(std::shared_ptr<id_generator>&& gen)
+    {
+        this->m_id_generator = gen ? std::move(gen) : block_id_generator::instance();
+    }
+
     /**
      * @brief Generates a unique request ID.
      *
+     * @param q The dispatcher.
      * @return A unique request ID.
      *
-     * @details This method generates a unique request ID by incrementing an atomic counter.
+     * @details The ID comes from the generator of the current `id_generator_scope` of the thread, if any; otherwise,
+     * from the generator set with `dispatcher_base::set_id_generator()`. By default, this is the process-wide
+     * block_id_generator, which touches shared state only once per block of IDs.
+     */
+    static std::uint64_t next_id(const dispatcher_t& q)
+    {
+        if (auto* gen = id_generator_scope::current(); gen != nullptr) {
+            return gen->next();
+        }
+
+        return q.d_ptr->m_id_generator->next();
+    }
+
+    /**
+     * @brief Parses and executes a single request.
+     *
+     * @tparam Parse The type of the parser function.
+     * @tparam Extra The type of the function that returns the extra fields.
+     * @param q The dispatcher.
+     * @param parse The function that returns the parsed request without the extra fields,
+     * or the error if the request is invalid.
+     * @param extra The function that returns the extra fields of the request; see collect_extra().
+     * @param source The object to collect the extra fields from on demand; see collect_extra().
+     * @param request_id The request ID to use in the response.
+     * @param data Pointer to the data to pass to the method handlers as a part of the context.
+     * @param unique_id The unique request ID.
+     * @return The outcome of the request.
      */
-    static std::uint64_t get_and_increment_counter() noexcept
+    template<typename Parse, typename Extra>
+    static outcome process(
+        dispatcher_t& q, Parse&& parse, Extra&& extra, const BasicJsonType& source, BasicJsonType&& request_id,
+        const void* data, std::uint64_t unique_id
+    )
     {
-        return dispatcher_private::m_id_counter.fetch_add(1, std::memory_order_relaxed);
+        outcome res{{}, std::move(request_id), false, unique_id};
+
+        auto* metrics = q.d_ptr->metrics();
+        const stopwatch parse_time(metrics != nullptr);
+        auto req = std::forward<Parse>(parse)();
+        if (metrics != nullptr) {
+            metrics->local().record_parse(parse_time.elapsed());
+        }
+
+        if (!req) {
+            res.response = dispatcher_private::handle_error(q, res.id, req.error(), false, unique_id);
+            return res;
+        }
+
+        const bool with_context = dispatcher_private::collect_extra(q, *req, std::forward<Extra>(extra), source);
+        res.is_result =
+            dispatcher_private::execute_request(q, *req, with_context, res.id, data, unique_id, res.response);
+        return res;
     }
 
+    /**
+     * @brief Parses and executes a single request asynchronously.
+     *
+     * @param q The dispatcher.
+     * @param request The request; its `params`, `id`, and extra members are moved out.
+     * @param data Pointer to the data to pass to the method handlers as a part of the context.
+     * @param unique_id The unique request ID.
+     * @return Task that produces the outcome of the request.
+     *
+     * @details This is the asynchronous counterpart of process() and execute_request().
+     */
+    static task<outcome>
+    process_async(dispatcher_t& q, BasicJsonType& request, const void* data, std::uint64_t unique_id);
+
+    /**
+     * @brief Converts the outcome into a JSON RPC response.
+     *
+     * @param q The dispatcher.
+     * @param res The outcome.
+     * @return JSON RPC response; a discarded value if there must be no response.
+     *
+     * @details This is outcome::to_json() that records the time it takes if the metrics are enabled.
+     */
+    static BasicJsonType to_json(const dispatcher_t& q, outcome&& res);
+
+    /**
+     * @brief Serializes the outcome as a JSON RPC response and appends it to @a out.
+     *
+     * @param q The dispatcher.
+     * @param res The outcome.
+     * @param out The output buffer.
+     * @return Whether anything has been written.
+     *
+     * @details This is outcome::write() that records the time it takes if the metrics are enabled.
+     * If the response cannot be serialized (for example, the result has a string that is not valid UTF-8),
+     * the failure is reported like an exception thrown by the handler, and an `exception::INTERNAL_ERROR`
+     * response is written instead.
+     */
+    static bool write(dispatcher_t& q, const outcome& res, std::string& out);
+
+    /**
+     * @brief Counts an error if the metrics are enabled.
+     *
+     * @param q The dispatcher.
+     * @param code JSON RPC error code.
+     */
+    static void record_error(const dispatcher_t& q, int code);
+
+    /**
+     * @brief Invokes the handler for a parsed request.
+     *
+     * @param q The dispatcher.
+     * @param req The parsed request; its extra fields are moved out if @a with_context is `true`.
+     * @param with_context Whether the handler accepts the context (see collect_extra()).
+     * @param request_id The request ID to use in the response.
+     * @param data Pointer to the data to pass to the method handlers as a part of the context.
+     * @param unique_id The unique request ID.
+     * @param response Receives the result of the method, the error response, or a discarded value.
+     * @return Whether @a response holds the result of the method.
+     */
+    static bool execute_request(
+        dispatcher_t& q, request_t& req, bool with_context, const BasicJsonType& request_id, const void* data,
+        std::uint64_t unique_id, BasicJsonType& response
+    );
+
+    /**
+     * @brief Reports a failed request and generates an error response.
+     *
+     * @param q The dispatcher.
+     * @param request_id The request ID to use in the response.
+     * @param e The JSON RPC error that caused the failure.
+     * @param is_discarded Whether the response must be discarded (the request is a notification).
+     * @param unique_id The unique request ID.
+     * @return Error response, or a discarded value if @a is_discarded is `true`.
+     */
+    static BasicJsonType handle_error(
+        dispatcher_t& q, const BasicJsonType& request_id, const exception& e, bool is_discarded,
+        std::uint64_t unique_id
+    );
+
+    /**
+     * @brief Reports a request that failed because of an exception other than `json_rpc::exception`.
+     *
+     * @param q The dispatcher.
+     * @param request_id The request ID to use in the response.
+     * @param e The exception that caused the failure.
+     * @param is_discarded Whether the response must be discarded (the request is a notification).
+     * @param unique_id The unique request ID.
+     * @return `exception::INTERNAL_ERROR` error response, or a discarded value if @a is_discarded is `true`.
+     */
+    static BasicJsonType handle_exception(
+        dispatcher_t& q, const BasicJsonType& request_id, const std::exception& e, bool is_discarded,
+        std::uint64_t unique_id
+    );
+
+    /**
+     * @brief Reports a failure that is not related to a particular request.
+     *
+     * @param q The dispatcher.
+     * @param code Error code.
+     * @param message Error message.
+     * @param is_batch Whether this is a top-level batch request.
+     * @param unique_id The unique request ID.
+     * @return The outcome with the error response.
+     */
+    static outcome fail(dispatcher_t& q, int code, std::string_view message, bool is_batch, std::uint64_t unique_id);
+
 private:
+    /**
+     * @brief Transparent string hash.
+     *
+     * @details Allows looking up `m_methods` by `std::string_view` without constructing a `std::string`.
+     */
+    struct string_hash {
+        using is_transparent = void;  ///< Enables heterogeneous lookup.
+
+        /**
+         * @brief Computes the hash of @a s.
+         *
+         * @param s The string.
+         * @return The hash value.
+         */
+        std::size_t operator()(std::string_view s) const noexcept { return std::hash<std::string_view>{}(s); }
+    };
+
     /** @brief Map of method names to handler functions. */
-    std::unordered_map<std::string, dispatcher::handler_t> m_methods;
+    std::unordered_map<std::string, method_handler, string_hash, std::equal_to<>> m_methods;
+
+    /** @brief Perfect hash table built by freeze(); it points into `m_methods`. */
+    perfect_hash_map<method_handler> m_table;
 
-    static inline std::atomic_uint64_t m_id_counter = 0;  ///< Counter for generating unique request IDs.
+    bool m_frozen        = false;  ///< Whether the set of method handlers is frozen.
+    bool m_needs_context = false;  ///< Whether any of the handlers accepts the context.
+
+    std::shared_ptr<executor> m_executor;  ///< The executor for batch requests.
+    std::size_t m_batch_threshold = 16;    ///< The minimum size of a batch request processed in parallel.
+
+    std::unique_ptr<metrics_registry> m_metrics;  ///< The metrics; `nullptr` if they are not collected.
+
+    /** @brief The generator of unique request IDs. */
+    std::shared_ptr<id_generator> m_id_generator = block_id_generator::instance();
 };
 
+extern template class dispatcher_private<nlohmann::json>;
+extern template class dispatcher_private<nlohmann::ordered_json>;
+
 }  // namespace wwa::json_rpc
 
 #endif /* FB656817_7041_48D5_80B2_347168163158 */
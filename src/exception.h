@@ -75,6 +75,20 @@ static constexpr std::string_view err_bad_id_type = "ID must be either a number,
  * @see https://www.jsonrpc.org/specification#batch
  */
 static constexpr std::string_view err_empty_batch = "Empty batch request";
+
+/**
+ * @brief Error message for when the request exceeds the size limit of a stream driver.
+ * @see exception::INVALID_REQUEST
+ * @see stream_options::max_message_size
+ */
+static constexpr std::string_view err_request_too_large = "Request is too large";
+
+/**
+ * @brief Error message for when the header of a framed message is malformed or has no `Content-Length`.
+ * @see exception::PARSE_ERROR
+ * @see run_framed_stream()
+ */
+static constexpr std::string_view err_bad_message_header = "Invalid message header";
 /** @} */
 
 /**
@@ -235,7 +249,7 @@ private:
 /**
  * @brief Exception thrown when the method is not found.
  */
-class method_not_found_exception : public exception {
+class WWA_JSONRPC_EXPORT method_not_found_exception : public exception {
 public:
     method_not_found_exception() : exception(exception::METHOD_NOT_FOUND, err_method_not_found) {}
     method_not_found_exception(const method_not_found_exception&)            = default;
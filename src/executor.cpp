@@ -0,0 +1,170 @@
+/**
+ * @file
+ * @brief Implementation of the thread pool and the parallel loop.
+ */
+
+#include "executor.h"
+#include "executor_p.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+/**
+ * @brief Shared state of a parallel loop.
+ * @internal
+ *
+ * @details The state is owned jointly by the calling thread and the submitted tasks, so that the tasks that start
+ * after the loop has completed can still safely find out that there is nothing left to do.
+ */
+struct loop_state {
+    std::size_t count;                             ///< The number of iterations.
+    const std::function<void(std::size_t)>* body;  ///< The loop body; valid only while `next < count`.
+    std::atomic_size_t next{0};                    ///< The next unclaimed index.
+    std::size_t done = 0;                          ///< The number of completed iterations.
+    std::exception_ptr error;                      ///< The first exception thrown by the body.
+    std::mutex mutex;                              ///< Protects `done` and `error`.
+    std::condition_variable cv;                    ///< Signals the completion of the loop.
+
+    /**
+     * @brief Constructs the state.
+     *
+     * @param n The number of iterations.
+     * @param f The loop body.
+     */
+    loop_state(std::size_t n, const std::function<void(std::size_t)>* f) : count(n), body(f) {}
+
+    /**
+     * @brief Claims and runs iterations until there are none left.
+     */
+    void work()
+    {
+        std::size_t completed = 0;
+        std::exception_ptr err;
+        for (auto i = this->next.fetch_add(1, std::memory_order_relaxed); i < this->count;
+             i      = this->next.fetch_add(1, std::memory_order_relaxed))
+        {
+            try {
+                (*this->body)(i);
+            }
+            catch (...) {
+                if (!err) {
+                    err = std::current_exception();
+                }
+            }
+
+            ++completed;
+        }
+
+        if (completed != 0) {
+            const std::lock_guard lock(this->mutex);
+            if (err && !this->error) {
+                this->error = std::move(err);
+            }
+
+            this->done += completed;
+            if (this->done == this->count) {
+                this->cv.notify_all();
+            }
+        }
+    }
+};
+
+}  // namespace
+
+namespace wwa::json_rpc {
+
+executor::~executor() = default;
+
+thread_pool_private::thread_pool_private(std::size_t threads)
+{
+    this->m_threads.reserve(threads);
+    for (std::size_t i = 0; i < threads; ++i) {
+        this->m_threads.emplace_back([this]() { this->run(); });
+    }
+}
+
+thread_pool_private::~thread_pool_private()
+{
+    {
+        const std::lock_guard lock(this->m_mutex);
+        this->m_stop = true;
+    }
+
+    this->m_cv.notify_all();
+    for (auto& thread : this->m_threads) {
+        thread.join();
+    }
+}
+
+void thread_pool_private::push(std::function<void()>&& task)
+{
+    {
+        const std::lock_guard lock(this->m_mutex);
+        this->m_tasks.push_back(std::move(task));
+    }
+
+    this->m_cv.notify_one();
+}
+
+void thread_pool_private::run()
+{
+    while (true) {
+        std::function<void()> task;
+
+        {
+            std::unique_lock lock(this->m_mutex);
+            this->m_cv.wait(lock, [this]() { return this->m_stop || !this->m_tasks.empty(); });
+            if (this->m_tasks.empty()) {
+                return;
+            }
+
+            task = std::move(this->m_tasks.front());
+            this->m_tasks.pop_front();
+        }
+
+        task();
+    }
+}
+
+thread_pool::thread_pool(std::size_t threads)
+    : d_ptr(std::make_unique<thread_pool_private>(
+          threads != 0 ? threads : std::max<std::size_t>(std::thread::hardware_concurrency(), 1)
+      ))
+{}
+
+thread_pool::~thread_pool() = default;
+
+void thread_pool::execute(std::function<void()> task)
+{
+    this->d_ptr->push(std::move(task));
+}
+
+std::size_t thread_pool::concurrency() const noexcept
+{
+    return this->d_ptr->size();
+}
+
+void parallel_for(executor& exec, std::size_t count, const std::function<void(std::size_t)>& body)
+{
+    if (count == 0) {
+        return;
+    }
+
+    auto state         = std::make_shared<loop_state>(count, &body);
+    const auto helpers = std::min(exec.concurrency(), count - 1);
+    for (std::size_t i = 0; i < helpers; ++i) {
+        exec.execute([state]() { state->work(); });
+    }
+
+    state->work();
+
+    std::unique_lock lock(state->mutex);
+    state->cv.wait(lock, [&state]() { return state->done == state->count; });
+    if (state->error) {
+        std::rethrow_exception(state->error);
+    }
+}
+
+}  // namespace wwa::json_rpc
@@ -0,0 +1,109 @@
+#ifndef B61E0F2D_7C34_4A95_8E1B_93F5D2A6C478
+#define B61E0F2D_7C34_4A95_8E1B_93F5D2A6C478
+
+/**
+ * @file
+ * @brief Defines the executor interface used to process batch requests in parallel, and a fixed thread pool.
+ */
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+
+#include "export.h"
+
+namespace wwa::json_rpc {
+
+/**
+ * @brief Executor interface.
+ *
+ * @details An executor runs tasks submitted by the dispatcher. The dispatcher uses it to process the elements of
+ * large batch requests concurrently (see `dispatcher::set_executor()`).
+ *
+ * Implementations must not run the task synchronously inside execute() unless this is the only option:
+ * the dispatcher does not wait for the tasks it submits to start; the calling thread processes the batch elements
+ * as well, and the tasks only help it.
+ *
+ * The class can be used to plug an external thread pool or an event loop into the dispatcher.
+ */
+class WWA_JSONRPC_EXPORT executor {
+public:
+    /** @brief Class constructor. */
+    executor() = default;
+
+    /** @brief Class destructor. */
+    virtual ~executor();
+
+    executor(const executor&)            = delete;
+    executor& operator=(const executor&) = delete;
+    executor(executor&&)                 = delete;
+    executor& operator=(executor&&)      = delete;
+
+    /**
+     * @brief Schedules a task for execution.
+     *
+     * @param task The task.
+     */
+    virtual void execute(std::function<void()> task) = 0;
+
+    /**
+     * @brief Returns the number of tasks the executor can run concurrently.
+     *
+     * @return The number of threads of the executor.
+     *
+     * @details The dispatcher does not submit more tasks per batch than this number.
+     */
+    [[nodiscard]] virtual std::size_t concurrency() const noexcept = 0;
+};
+
+class thread_pool_private;
+
+/**
+ * @brief Executor with a fixed number of threads.
+ *
+ * @details The threads are started by the constructor and stopped by the destructor. The tasks are taken from
+ * a single FIFO queue. The destructor runs the tasks that are still in the queue before stopping the threads.
+ */
+class WWA_JSONRPC_EXPORT thread_pool : public executor {
+public:
+    /**
+     * @brief Class constructor.
+     *
+     * @param threads The number of threads; `0` means `std::thread::hardware_concurrency()`.
+     */
+    explicit thread_pool(std::size_t threads = 0);
+
+    /** @brief Class destructor. */
+    ~thread_pool() override;
+
+    thread_pool(const thread_pool&)            = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+    thread_pool(thread_pool&&)                 = delete;
+    thread_pool& operator=(thread_pool&&)      = delete;
+
+    /**
+     * @brief Schedules a task for execution.
+     *
+     * @param task The task.
+     */
+    void execute(std::function<void()> task) override;
+
+    /**
+     * @brief Returns the number of threads in the pool.
+     *
+     * @return The number of threads.
+     */
+    [[nodiscard]] std::size_t concurrency() const noexcept override;
+
+private:
+    /**
+     * @brief Pointer to the implementation (Pimpl idiom).
+     *
+     * @details This unique pointer holds the private implementation details of the thread_pool class.
+     */
+    std::unique_ptr<thread_pool_private> d_ptr;
+};
+
+}  // namespace wwa::json_rpc
+
+#endif /* B61E0F2D_7C34_4A95_8E1B_93F5D2A6C478 */
@@ -0,0 +1,95 @@
+#ifndef E2F47A91_3B6C_4D08_A5E7_1C9D84B2F630
+#define E2F47A91_3B6C_4D08_A5E7_1C9D84B2F630
+
+/**
+ * @file
+ * @brief Contains the private implementation details of the thread pool and the parallel loop used by the dispatcher.
+ * @internal
+ */
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "executor.h"
+
+namespace wwa::json_rpc {
+
+/**
+ * @brief Private implementation of the thread pool.
+ * @internal
+ */
+class thread_pool_private {
+public:
+    /**
+     * @brief Starts the threads.
+     *
+     * @param threads The number of threads.
+     */
+    explicit thread_pool_private(std::size_t threads);
+
+    /**
+     * @brief Runs the remaining tasks and stops the threads.
+     */
+    ~thread_pool_private();
+
+    thread_pool_private(const thread_pool_private&)            = delete;
+    thread_pool_private& operator=(const thread_pool_private&) = delete;
+    thread_pool_private(thread_pool_private&&)                 = delete;
+    thread_pool_private& operator=(thread_pool_private&&)      = delete;
+
+    /**
+     * @brief Adds a task to the queue.
+     *
+     * @param task The task.
+     */
+    void push(std::function<void()>&& task);
+
+    /**
+     * @brief Returns the number of threads.
+     *
+     * @return The number of threads.
+     */
+    [[nodiscard]] std::size_t size() const noexcept { return this->m_threads.size(); }
+
+private:
+    std::vector<std::thread> m_threads;         ///< Worker threads.
+    std::deque<std::function<void()>> m_tasks;  ///< Pending tasks.
+    std::mutex m_mutex;                         ///< Protects `m_tasks` and `m_stop`.
+    std::condition_variable m_cv;               ///< Signals new tasks and the stop request.
+    bool m_stop = false;                        ///< Whether the threads must exit once the queue is empty.
+
+    /**
+     * @brief The body of a worker thread.
+     */
+    void run();
+};
+
+/**
+ * @brief Runs @a body for every index in `[0, count)` using the calling thread and the executor.
+ * @internal
+ *
+ * @param exec The executor.
+ * @param count The number of iterations.
+ * @param body The loop body; it is called concurrently for different indices.
+ *
+ * @details The calling thread takes part in the loop, and the tasks submitted to the executor only help it:
+ * every thread (including the calling one) claims the next unprocessed index until there are none left.
+ * Therefore, the loop completes even if the executor never runs the submitted tasks, and calling this function from
+ * a thread of the executor does not deadlock.
+ *
+ * The function returns when all iterations are complete. Tasks that start later do nothing.
+ * If @a body throws, the first exception is rethrown in the calling thread after all iterations are complete.
+ */
+void parallel_for(executor& exec, std::size_t count, const std::function<void(std::size_t)>& body);
+
+}  // namespace wwa::json_rpc
+
+#endif /* E2F47A91_3B6C_4D08_A5E7_1C9D84B2F630 */
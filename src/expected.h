@@ -0,0 +1,321 @@
+#ifndef E4B1C9A7_2D6F_4E83_A5C0_7F3D8B12E6A4
+#define E4B1C9A7_2D6F_4E83_A5C0_7F3D8B12E6A4
+
+/**
+ * @file
+ * @brief Defines the type that holds either a value or a JSON RPC error.
+ */
+
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <version>
+
+#if defined(__cpp_lib_expected)
+#    include <expected>
+#endif
+
+#include "exception.h"
+
+namespace wwa::json_rpc {
+
+/**
+ * @brief Wraps an error to construct an `expected` that holds it.
+ *
+ * @see expected
+ */
+class unexpected {
+public:
+    /**
+     * @brief Constructs the wrapper.
+     *
+     * @param error The error.
+     */
+    explicit unexpected(exception error) noexcept : m_error(std::move(error)) {}
+
+    /**
+     * @brief Returns the error.
+     *
+     * @return The error.
+     */
+    [[nodiscard]] const exception& error() const& noexcept { return this->m_error; }
+
+    /**
+     * @brief Returns the error.
+     *
+     * @return The error.
+     * @overload
+     */
+    [[nodiscard]] exception&& error() && noexcept { return std::move(this->m_error); }
+
+private:
+    exception m_error;  ///< The error.
+};
+
+/**
+ * @brief Holds either a value or a JSON RPC error.
+ *
+ * @tparam T The type of the value.
+ *
+ * @details This is a subset of C++23 `std::expected<T, exception>`. Method handlers can return it to report errors
+ * without throwing exceptions:
+ * ```cpp
+ * using namespace wwa::json_rpc;
+ *
+ * dispatcher.add("div", [](int a, int b) -> expected<int> {
+ *     if (b == 0) {
+ *         return unexpected(exception(exception::INVALID_PARAMS, "Division by zero"));
+ *     }
+ *
+ *     return a / b;
+ * });
+ * ```
+ * The dispatcher uses it internally to report protocol errors (invalid requests, unknown methods, invalid parameters).
+ */
+template<typename T = void>
+class expected {
+public:
+    using value_type = T;          ///< The type of the value.
+    using error_type = exception;  ///< The type of the error.
+
+    /**
+     * @brief Constructs an object that holds a value-initialized value.
+     */
+    expected()
+        requires std::is_default_constructible_v<T>
+        : m_storage(std::in_place_index<0>)
+    {}
+
+    /**
+     * @brief Constructs an object that holds a value.
+     *
+     * @tparam U The type of the value.
+     * @param value The value.
+     */
+    template<typename U = T>
+        requires(
+            std::is_constructible_v<T, U> && !std::is_same_v<std::remove_cvref_t<U>, expected> &&
+            !std::is_same_v<std::remove_cvref_t<U>, unexpected>
+        )
+    // NOLINTNEXTLINE(hicpp-explicit-conversions)
+    expected(U&& value) : m_storage(std::in_place_index<0>, std::forward<U>(value))
+    {}
+
+    /**
+     * @brief Constructs an object that holds an error.
+     *
+     * @param error The error.
+     */
+    // NOLINTNEXTLINE(hicpp-explicit-conversions)
+    expected(unexpected&& error) noexcept : m_storage(std::in_place_index<1>, std::move(error).error()) {}
+
+    /**
+     * @brief Constructs an object that holds an error.
+     *
+     * @param error The error.
+     * @overload
+     */
+    // NOLINTNEXTLINE(hicpp-explicit-conversions)
+    expected(const unexpected& error) : m_storage(std::in_place_index<1>, error.error()) {}
+
+    /**
+     * @brief Checks whether the object holds a value.
+     *
+     * @return Whether the object holds a value.
+     */
+    [[nodiscard]] bool has_value() const noexcept { return this->m_storage.index() == 0; }
+
+    /**
+     * @brief Checks whether the object holds a value.
+     *
+     * @return Whether the object holds a value.
+     */
+    explicit operator bool() const noexcept { return this->has_value(); }
+
+    /**
+     * @brief Returns the value.
+     *
+     * @return The value.
+     * @throws exception The error if the object does not hold a value.
+     */
+    [[nodiscard]] T& value() &
+    {
+        this->check();
+        return *std::get_if<0>(&this->m_storage);
+    }
+
+    /** @copydoc value() & */
+    [[nodiscard]] const T& value() const&
+    {
+        this->check();
+        return *std::get_if<0>(&this->m_storage);
+    }
+
+    /** @copydoc value() & */
+    [[nodiscard]] T&& value() &&
+    {
+        this->check();
+        return std::move(*std::get_if<0>(&this->m_storage));
+    }
+
+    /**
+     * @brief Returns the error.
+     *
+     * @return The error.
+     * @pre The object does not hold a value.
+     */
+    [[nodiscard]] const exception& error() const& noexcept { return *std::get_if<1>(&this->m_storage); }
+
+    /** @copydoc error() const & */
+    [[nodiscard]] exception&& error() && noexcept { return std::move(*std::get_if<1>(&this->m_storage)); }
+
+    /**
+     * @brief Returns the value.
+     *
+     * @return The value.
+     * @pre The object holds a value.
+     */
+    [[nodiscard]] T& operator*() & noexcept { return *std::get_if<0>(&this->m_storage); }
+
+    /** @copydoc operator*() & */
+    [[nodiscard]] const T& operator*() const& noexcept { return *std::get_if<0>(&this->m_storage); }
+
+    /** @copydoc operator*() & */
+    [[nodiscard]] T&& operator*() && noexcept { return std::move(*std::get_if<0>(&this->m_storage)); }
+
+    /**
+     * @brief Accesses the members of the value.
+     *
+     * @return Pointer to the value.
+     * @pre The object holds a value.
+     */
+    [[nodiscard]] T* operator->() noexcept { return std::get_if<0>(&this->m_storage); }
+
+    /** @copydoc operator->() */
+    [[nodiscard]] const T* operator->() const noexcept { return std::get_if<0>(&this->m_storage); }
+
+private:
+    std::variant<T, exception> m_storage;  ///< The value or the error.
+
+    /**
+     * @brief Throws the error if the object does not hold a value.
+     *
+     * @throws exception The error.
+     */
+    void check() const
+    {
+        if (!this->has_value()) {
+            throw this->error();
+        }
+    }
+};
+
+/**
+ * @brief Holds either nothing or a JSON RPC error.
+ *
+ * @details The specialization for functions that do not return a value.
+ */
+template<>
+class expected<void> {
+public:
+    using value_type = void;       ///< The type of the value.
+    using error_type = exception;  ///< The type of the error.
+
+    /**
+     * @brief Constructs an object that does not hold an error.
+     */
+    expected() noexcept = default;
+
+    /**
+     * @brief Constructs an object that holds an error.
+     *
+     * @param error The error.
+     */
+    // NOLINTNEXTLINE(hicpp-explicit-conversions)
+    expected(unexpected&& error) noexcept : m_error(std::move(error).error()) {}
+
+    /**
+     * @brief Constructs an object that holds an error.
+     *
+     * @param error The error.
+     * @overload
+     */
+    // NOLINTNEXTLINE(hicpp-explicit-conversions)
+    expected(const unexpected& error) : m_error(error.error()) {}
+
+    /**
+     * @brief Checks whether the object does not hold an error.
+     *
+     * @return Whether the object does not hold an error.
+     */
+    [[nodiscard]] bool has_value() const noexcept { return !this->m_error.has_value(); }
+
+    /**
+     * @brief Checks whether the object does not hold an error.
+     *
+     * @return Whether the object does not hold an error.
+     */
+    explicit operator bool() const noexcept { return this->has_value(); }
+
+    /**
+     * @brief Throws the error, if any.
+     *
+     * @throws exception The error.
+     */
+    void value() const
+    {
+        if (this->m_error.has_value()) {
+            throw *this->m_error;
+        }
+    }
+
+    /**
+     * @brief Returns the error.
+     *
+     * @return The error.
+     * @pre The object holds an error.
+     */
+    // NOLINTNEXTLINE(bugprone-unchecked-optional-access)
+    [[nodiscard]] const exception& error() const& noexcept { return *this->m_error; }
+
+    /** @copydoc error() const & */
+    // NOLINTNEXTLINE(bugprone-unchecked-optional-access)
+    [[nodiscard]] exception&& error() && noexcept { return std::move(*this->m_error); }
+
+private:
+    std::optional<exception> m_error;  ///< The error.
+};
+
+/**
+ * @brief Checks whether @a T is an `expected` type.
+ *
+ * @tparam T The type to check.
+ *
+ * @details Both `wwa::json_rpc::expected<U>` and (if available) `std::expected<U, wwa::json_rpc::exception>`
+ * are recognized.
+ */
+template<typename T>
+struct is_expected : std::false_type {};
+
+/** @copydoc is_expected */
+template<typename T>
+struct is_expected<expected<T>> : std::true_type {};
+
+#if defined(__cpp_lib_expected)
+/** @copydoc is_expected */
+template<typename T>
+struct is_expected<std::expected<T, exception>> : std::true_type {};
+#endif
+
+/**
+ * @brief Checks whether @a T is an `expected` type.
+ *
+ * @tparam T The type to check.
+ */
+template<typename T>
+inline constexpr bool is_expected_v = is_expected<T>::value;
+
+}  // namespace wwa::json_rpc
+
+#endif /* E4B1C9A7_2D6F_4E83_A5C0_7F3D8B12E6A4 */
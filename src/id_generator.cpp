@@ -0,0 +1,124 @@
+/**
+ * @file
+ * @brief Implementation of the generators of unique request IDs.
+ */
+
+#include "id_generator.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+
+namespace {
+
+/**
+ * @brief A block of IDs owned by a thread.
+ * @internal
+ */
+struct id_block {
+    std::uint64_t generator = 0;  ///< The unique ID of the generator the block belongs to; `0` if the slot is free.
+    std::uint64_t next      = 0;  ///< The next ID to return.
+    std::uint64_t end       = 0;  ///< One past the last ID of the block.
+};
+
+/**
+ * @brief The number of generators a thread can use without dropping blocks.
+ * @internal
+ */
+constexpr std::size_t cached_blocks = 4;
+
+/**
+ * @brief The blocks of IDs of the calling thread.
+ * @internal
+ *
+ * @details When all slots are taken, the block in the slot `thread_victim` is dropped. Dropping a block only
+ * loses the IDs that remain in it: they are never returned by anyone.
+ */
+// NOLINTBEGIN(cppcoreguidelines-avoid-non-const-global-variables)
+thread_local std::array<id_block, cached_blocks> thread_blocks;
+thread_local std::size_t thread_victim = 0;
+// NOLINTEND(cppcoreguidelines-avoid-non-const-global-variables)
+
+/**
+ * @brief The generator set by the innermost `id_generator_scope` of the calling thread.
+ * @internal
+ */
+thread_local wwa::json_rpc::id_generator* thread_generator = nullptr;  // NOLINT(*-avoid-non-const-global-variables)
+
+/**
+ * @brief The number of block generators created so far; used to assign their unique IDs.
+ * @internal
+ */
+std::atomic_uint64_t generator_count{0};  // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+
+}  // namespace
+
+namespace wwa::json_rpc {
+
+id_generator::~id_generator() = default;
+
+std::uint64_t sequential_id_generator::next()
+{
+    return this->m_counter.fetch_add(1, std::memory_order_relaxed);
+}
+
+block_id_generator::block_id_generator(std::uint64_t block_size) noexcept
+    : m_block_size(std::max<std::uint64_t>(block_size, 1)),
+      m_id(generator_count.fetch_add(1, std::memory_order_relaxed) + 1)
+{}
+
+std::uint64_t block_id_generator::next()
+{
+    id_block* block = nullptr;
+    for (auto& b : thread_blocks) {
+        if (b.generator == this->m_id) {
+            block = &b;
+            break;
+        }
+    }
+
+    if (block == nullptr) {
+        block            = &thread_blocks.at(thread_victim);
+        thread_victim    = (thread_victim + 1) % cached_blocks;
+        block->generator = this->m_id;
+        block->next      = 0;
+        block->end       = 0;
+    }
+
+    if (block->next == block->end) {
+        block->next = this->m_next_block.fetch_add(this->m_block_size, std::memory_order_relaxed);
+        block->end  = block->next + this->m_block_size;
+    }
+
+    return block->next++;
+}
+
+std::shared_ptr<block_id_generator> block_id_generator::instance()
+{
+    static const auto generator = std::make_shared<block_id_generator>();
+    return generator;
+}
+
+core_id_generator::core_id_generator(std::uint64_t index) noexcept : m_next(((index + 1) & 0xFFFFU) << 48U) {}
+
+std::uint64_t core_id_generator::next()
+{
+    return this->m_next++;
+}
+
+id_generator_scope::id_generator_scope(id_generator& gen) noexcept : m_previous(thread_generator)
+{
+    thread_generator = &gen;
+}
+
+id_generator_scope::~id_generator_scope()
+{
+    thread_generator = this->m_previous;
+}
+
+id_generator* id_generator_scope::current() noexcept
+{
+    return thread_generator;
+}
+
+}  // namespace wwa::json_rpc
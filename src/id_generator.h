@@ -0,0 +1,186 @@
+#ifndef D8E3B1F6_4A29_4C7D_9E05_6B2F8A4C1D73
+#define D8E3B1F6_4A29_4C7D_9E05_6B2F8A4C1D73
+
+/**
+ * @file
+ * @brief Defines the interface of the generators of unique request IDs, and the generators provided by the library.
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "export.h"
+
+namespace wwa::json_rpc {
+
+/**
+ * @brief Generator of unique request IDs.
+ *
+ * @details The dispatcher takes a unique ID for every request and every element of a batch request, and passes it to
+ * the hooks (`dispatcher::request_parsed()`, `dispatcher::invoke()`, `dispatcher::request_failed()`) so that they can
+ * correlate the events of one request. The IDs are not related to the JSON RPC request IDs.
+ *
+ * Implement this interface to plug in a different source of IDs (see `dispatcher::set_id_generator()`).
+ */
+class WWA_JSONRPC_EXPORT id_generator {
+public:
+    /** @brief Class constructor. */
+    id_generator() = default;
+
+    /** @brief Class destructor. */
+    virtual ~id_generator();
+
+    id_generator(const id_generator&)            = delete;
+    id_generator& operator=(const id_generator&) = delete;
+    id_generator(id_generator&&)                 = delete;
+    id_generator& operator=(id_generator&&)      = delete;
+
+    /**
+     * @brief Returns a new ID.
+     *
+     * @return An ID that this generator has not returned before.
+     *
+     * @note The method is called concurrently from all threads that process requests and must be thread-safe.
+     */
+    virtual std::uint64_t next() = 0;
+};
+
+/**
+ * @brief Generator that increments a shared atomic counter.
+ *
+ * @details The IDs are strictly increasing in the order of the calls. Because every call modifies the same
+ * counter, the cache line holding it moves between the CPU cores on every request when many threads
+ * process requests.
+ */
+class WWA_JSONRPC_EXPORT sequential_id_generator : public id_generator {
+public:
+    /**
+     * @brief Returns a new ID.
+     *
+     * @return The value of the counter before the increment.
+     */
+    std::uint64_t next() override;
+
+private:
+    std::atomic_uint64_t m_counter = 0;  ///< The next ID.
+};
+
+/**
+ * @brief Generator that hands out blocks of IDs to the threads.
+ *
+ * @details Every thread takes a block of consecutive IDs from a shared counter and returns the IDs from its block
+ * until it is exhausted; only then the thread touches the shared counter again. Therefore, the threads modify
+ * the shared counter once per `block_size` IDs.
+ *
+ * The IDs are unique, and the IDs returned to one thread are increasing, but the IDs returned to different threads
+ * interleave. If a thread uses many generators at once, it may drop the unused part of a block; the IDs stay unique.
+ *
+ * This is the default generator of the dispatcher.
+ */
+class WWA_JSONRPC_EXPORT block_id_generator : public id_generator {
+public:
+    /**
+     * @brief Class constructor.
+     *
+     * @param block_size The number of IDs a thread takes at once; `0` is treated as `1`.
+     */
+    explicit block_id_generator(std::uint64_t block_size = 1024) noexcept;
+
+    /**
+     * @brief Returns a new ID.
+     *
+     * @return The next ID from the block of the calling thread.
+     */
+    std::uint64_t next() override;
+
+    /**
+     * @brief Returns the generator shared by all dispatchers that do not have their own generator.
+     *
+     * @return The process-wide generator.
+     */
+    static std::shared_ptr<block_id_generator> instance();
+
+private:
+    std::uint64_t m_block_size;             ///< The number of IDs in a block.
+    std::uint64_t m_id;                     ///< The unique ID of the generator; identifies its blocks in the threads.
+    std::atomic_uint64_t m_next_block = 0;  ///< The first ID of the next block.
+};
+
+/**
+ * @brief Generator of the IDs of a single core of a thread-per-core server.
+ *
+ * @details The generator with index `i` returns `((i + 1) << 48) + n` for `n` = 0, 1, 2, and so on. The generators
+ * with different indices never return the same ID, and they do not share any state. Their IDs do not collide with
+ * the IDs of `sequential_id_generator` and `block_id_generator` unless these return more than 2<sup>48</sup> IDs.
+ *
+ * The generator is not thread-safe: it must only be used by one thread, usually through an `id_generator_scope`.
+ */
+class WWA_JSONRPC_EXPORT core_id_generator : public id_generator {
+public:
+    /**
+     * @brief Class constructor.
+     *
+     * @param index The index of the core; only the lower 16 bits of `index + 1` are used.
+     */
+    explicit core_id_generator(std::uint64_t index) noexcept;
+
+    /**
+     * @brief Returns a new ID.
+     *
+     * @return The next ID.
+     */
+    std::uint64_t next() override;
+
+private:
+    std::uint64_t m_next;  ///< The next ID.
+};
+
+/**
+ * @brief Makes the dispatchers take the unique request IDs of the calling thread from another generator.
+ *
+ * @details While the scope exists, the dispatchers called from this thread ignore their own generators
+ * (see `dispatcher::set_id_generator()`) and take the IDs from the generator of the scope. The destructor restores
+ * the previous generator of the thread, so scopes can be nested.
+ *
+ * The thread-per-core mode of the socket server uses this to give every reactor thread its own source of IDs.
+ *
+ * ```cpp
+ * wwa::json_rpc::core_id_generator gen(core);
+ * wwa::json_rpc::id_generator_scope scope(gen);
+ * // dispatcher.process_request(...) takes the IDs from gen
+ * ```
+ */
+class WWA_JSONRPC_EXPORT id_generator_scope {
+public:
+    /**
+     * @brief Class constructor.
+     *
+     * @param gen The generator; it must outlive the scope.
+     */
+    explicit id_generator_scope(id_generator& gen) noexcept;
+
+    /**
+     * @brief Class destructor; restores the previous generator.
+     */
+    ~id_generator_scope();
+
+    id_generator_scope(const id_generator_scope&)            = delete;
+    id_generator_scope& operator=(const id_generator_scope&) = delete;
+    id_generator_scope(id_generator_scope&&)                 = delete;
+    id_generator_scope& operator=(id_generator_scope&&)      = delete;
+
+    /**
+     * @brief Returns the generator of the calling thread.
+     *
+     * @return The generator of the innermost scope of the thread; `nullptr` if there is none.
+     */
+    [[nodiscard]] static id_generator* current() noexcept;
+
+private:
+    id_generator* m_previous;  ///< The generator of the enclosing scope.
+};
+
+}  // namespace wwa::json_rpc
+
+#endif /* D8E3B1F6_4A29_4C7D_9E05_6B2F8A4C1D73 */
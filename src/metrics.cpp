@@ -0,0 +1,198 @@
+/**
+ * @file
+ * @brief Implementation of the metrics collected by the dispatcher.
+ */
+
+#include "metrics.h"
+#include "metrics_p.h"
+
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <memory>
+#include <vector>
+
+#include "exception.h"
+
+namespace {
+
+using wwa::json_rpc::metrics_shard;
+
+/**
+ * @brief A shard cached by a thread.
+ * @internal
+ */
+struct cached_shard {
+    std::uint64_t registry;                ///< The unique ID of the registry that owns the shard.
+    std::shared_ptr<metrics_shard> shard;  ///< The shard.
+};
+
+/**
+ * @brief The shards of the calling thread.
+ * @internal
+ *
+ * @details Registry IDs are never reused, so an entry of a destroyed registry never matches again.
+ * Such entries are removed the next time the thread gets a new shard.
+ */
+thread_local std::vector<cached_shard> thread_shards;  // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+
+}  // namespace
+
+namespace wwa::json_rpc {
+
+void latency_histogram::merge(const latency_histogram& other) noexcept
+{
+    for (std::size_t i = 0; i < bucket_count; ++i) {
+        this->m_buckets[i] += other.m_buckets[i];
+    }
+
+    this->m_count += other.m_count;
+    this->m_sum   += other.m_sum;
+    this->m_min    = std::min(this->m_min, other.m_min);
+    this->m_max    = std::max(this->m_max, other.m_max);
+}
+
+std::uint64_t latency_histogram::value_at_percentile(double percentile) const noexcept
+{
+    if (this->m_count == 0) {
+        return 0;
+    }
+
+    const double clamped = std::clamp(percentile, 0.0, 100.0);
+    const auto rank      = std::max<std::uint64_t>(
+        1, static_cast<std::uint64_t>(std::ceil(clamped / 100.0 * static_cast<double>(this->m_count)))
+    );
+
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < bucket_count; ++i) {
+        seen += this->m_buckets[i];
+        if (seen >= rank) {
+            return std::min(bucket_upper_bound(i), this->m_max);
+        }
+    }
+
+    return this->m_max;
+}
+
+void atomic_histogram::merge_into(latency_histogram& h) const noexcept
+{
+    for (std::size_t i = 0; i < latency_histogram::bucket_count; ++i) {
+        h.m_buckets[i] += this->m_buckets[i].load(std::memory_order_relaxed);
+    }
+
+    h.m_count += this->m_count.load(std::memory_order_relaxed);
+    h.m_sum   += this->m_sum.load(std::memory_order_relaxed);
+    h.m_min    = std::min(h.m_min, this->m_min.load(std::memory_order_relaxed));
+    h.m_max    = std::max(h.m_max, this->m_max.load(std::memory_order_relaxed));
+}
+
+void metrics_shard::record_error(int code)
+{
+    auto it = this->m_errors.find(code);
+    if (it == this->m_errors.end()) {
+        const std::lock_guard lock(this->m_mutex);
+        it = this->m_errors.try_emplace(code).first;
+    }
+
+    add_to_counter(it->second);
+}
+
+void metrics_shard::record_call(std::string_view method, std::uint64_t ns, bool failed)
+{
+    auto it = this->m_methods.find(method);
+    if (it == this->m_methods.end()) {
+        const std::lock_guard lock(this->m_mutex);
+        it = this->m_methods.try_emplace(std::string(method)).first;
+    }
+
+    auto& stats = it->second;
+    add_to_counter(stats.calls);
+    if (failed) {
+        add_to_counter(stats.errors);
+    }
+
+    stats.invoke.record(ns);
+}
+
+void metrics_shard::merge_into(metrics_snapshot& snapshot) const
+{
+    this->m_parse.merge_into(snapshot.parse);
+    this->m_serialize.merge_into(snapshot.serialize);
+
+    const std::lock_guard lock(this->m_mutex);
+    for (const auto& [code, count] : this->m_errors) {
+        snapshot.errors[code] += count.load(std::memory_order_relaxed);
+    }
+
+    for (const auto& [name, stats] : this->m_methods) {
+        auto& m   = snapshot.methods[name];
+        m.calls  += stats.calls.load(std::memory_order_relaxed);
+        m.errors += stats.errors.load(std::memory_order_relaxed);
+        stats.invoke.merge_into(m.invoke);
+    }
+}
+
+metrics_registry::metrics_registry() : m_id(m_next_id.fetch_add(1, std::memory_order_relaxed)) {}
+
+metrics_registry::~metrics_registry() = default;
+
+metrics_shard& metrics_registry::local()
+{
+    // The most recently added shard is the most likely one: usually, a thread serves only one dispatcher
+    for (auto it = thread_shards.rbegin(); it != thread_shards.rend(); ++it) {
+        if (it->registry == this->m_id) {
+            return *it->shard;
+        }
+    }
+
+    auto shard = this->add_shard();
+
+    // Drop the shards of the destroyed registries: their owners hold no references anymore
+    std::erase_if(thread_shards, [](const cached_shard& entry) { return entry.shard.use_count() == 1; });
+    thread_shards.push_back({this->m_id, shard});
+    return *shard;
+}
+
+metrics_snapshot metrics_registry::snapshot() const
+{
+    metrics_snapshot result;
+
+    const std::lock_guard lock(this->m_mutex);
+    for (const auto& shard : this->m_shards) {
+        shard->merge_into(result);
+    }
+
+    return result;
+}
+
+std::shared_ptr<metrics_shard> metrics_registry::add_shard()
+{
+    auto shard = std::make_shared<metrics_shard>();
+
+    const std::lock_guard lock(this->m_mutex);
+    this->m_shards.push_back(shard);
+    return shard;
+}
+
+call_recorder::~call_recorder()
+{
+    if (this->m_registry != nullptr) {
+        try {
+            this->m_registry->local().record_call(this->m_method, this->m_stopwatch.elapsed(), this->m_failed);
+        }
+        catch (const std::exception&) {  // NOLINT(bugprone-empty-catch)
+            // Out of memory: the call is not recorded
+        }
+    }
+}
+
+void call_recorder::failed(int code) noexcept
+{
+    this->m_failed = true;
+    if (code == exception::METHOD_NOT_FOUND) {
+        // The method does not exist; the error is counted by the dispatcher anyway
+        this->m_registry = nullptr;
+    }
+}
+
+}  // namespace wwa::json_rpc
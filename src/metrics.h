@@ -0,0 +1,238 @@
+#ifndef C7D2A9E4_1F35_4B8C_96E0_3A5B7D1C2F48
+#define C7D2A9E4_1F35_4B8C_96E0_3A5B7D1C2F48
+
+/**
+ * @file
+ * @brief Defines the types that hold the metrics collected by the dispatcher.
+ */
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <map>
+#include <string>
+
+#include "export.h"
+
+namespace wwa::json_rpc {
+
+class atomic_histogram;
+
+/**
+ * @brief Log-linear latency histogram.
+ *
+ * @details The histogram records values (durations in nanoseconds) into buckets in the same way
+ * as [HdrHistogram](https://hdrhistogram.github.io/HdrHistogram/) does: every power of two is split into
+ * 2<sup>`sub_bucket_bits`</sup> equal buckets, so that the relative error of a percentile is at most
+ * 1/2<sup>`sub_bucket_bits`</sup> (about 3%), no matter how large the value is. Values below
+ * 2<sup>`sub_bucket_bits`</sup> are recorded exactly; values of 2<sup>`max_value_bits`</sup> or more
+ * (about 68 seconds) are recorded into the last bucket.
+ *
+ * Histograms can be merged: the dispatcher records the latencies per thread and merges the histograms
+ * when `dispatcher::metrics()` is called.
+ */
+class WWA_JSONRPC_EXPORT latency_histogram {
+public:
+    static constexpr unsigned int sub_bucket_bits = 5;   ///< Log2 of the number of buckets per power of two.
+    static constexpr unsigned int max_value_bits  = 36;  ///< Log2 of the smallest value beyond the range.
+
+    /** @brief The number of buckets. */
+    static constexpr std::size_t bucket_count = (max_value_bits - sub_bucket_bits + 1) << sub_bucket_bits;
+
+    /**
+     * @brief Returns the index of the bucket for @a value.
+     *
+     * @param value The value.
+     * @return The index of the bucket.
+     */
+    static constexpr std::size_t bucket_index(std::uint64_t value) noexcept
+    {
+        constexpr std::uint64_t sub_buckets = std::uint64_t{1} << sub_bucket_bits;
+
+        value = std::min(value, (std::uint64_t{1} << max_value_bits) - 1);
+        if (value < sub_buckets) {
+            return static_cast<std::size_t>(value);
+        }
+
+        const auto shift = static_cast<unsigned int>(std::bit_width(value)) - 1 - sub_bucket_bits;
+        return static_cast<std::size_t>(((shift + 1) << sub_bucket_bits) + ((value >> shift) - sub_buckets));
+    }
+
+    /**
+     * @brief Returns the smallest value recorded into the bucket @a index.
+     *
+     * @param index The index of the bucket.
+     * @return The lower bound of the bucket.
+     */
+    static constexpr std::uint64_t bucket_lower_bound(std::size_t index) noexcept
+    {
+        constexpr std::size_t sub_buckets = std::size_t{1} << sub_bucket_bits;
+
+        if (index < sub_buckets) {
+            return index;
+        }
+
+        const auto shift = (index >> sub_bucket_bits) - 1;
+        return static_cast<std::uint64_t>(sub_buckets + (index & (sub_buckets - 1))) << shift;
+    }
+
+    /**
+     * @brief Returns the largest value recorded into the bucket @a index.
+     *
+     * @param index The index of the bucket.
+     * @return The upper bound of the bucket.
+     */
+    static constexpr std::uint64_t bucket_upper_bound(std::size_t index) noexcept
+    {
+        return index + 1 < bucket_count ? bucket_lower_bound(index + 1) - 1
+                                        : std::numeric_limits<std::uint64_t>::max();
+    }
+
+    /**
+     * @brief Records a value.
+     *
+     * @param value The value.
+     */
+    void record(std::uint64_t value) noexcept
+    {
+        ++this->m_buckets[bucket_index(value)];
+        ++this->m_count;
+        this->m_sum += value;
+        this->m_min  = std::min(this->m_min, value);
+        this->m_max  = std::max(this->m_max, value);
+    }
+
+    /**
+     * @brief Adds the values recorded by @a other to this histogram.
+     *
+     * @param other The histogram to merge.
+     */
+    void merge(const latency_histogram& other) noexcept;
+
+    /**
+     * @brief Returns the number of recorded values.
+     *
+     * @return The number of values.
+     */
+    [[nodiscard]] std::uint64_t count() const noexcept { return this->m_count; }
+
+    /**
+     * @brief Returns the sum of the recorded values.
+     *
+     * @return The sum of the values.
+     */
+    [[nodiscard]] std::uint64_t sum() const noexcept { return this->m_sum; }
+
+    /**
+     * @brief Returns the smallest recorded value.
+     *
+     * @return The smallest value; `0` if there are no values.
+     */
+    [[nodiscard]] std::uint64_t min() const noexcept { return this->m_count != 0 ? this->m_min : 0; }
+
+    /**
+     * @brief Returns the largest recorded value.
+     *
+     * @return The largest value; `0` if there are no values.
+     */
+    [[nodiscard]] std::uint64_t max() const noexcept { return this->m_max; }
+
+    /**
+     * @brief Returns the mean of the recorded values.
+     *
+     * @return The mean; `0` if there are no values.
+     */
+    [[nodiscard]] double mean() const noexcept
+    {
+        return this->m_count != 0 ? static_cast<double>(this->m_sum) / static_cast<double>(this->m_count) : 0.0;
+    }
+
+    /**
+     * @brief Returns the value at the given percentile.
+     *
+     * @param percentile The percentile, from `0` to `100` (for example, `99.9`).
+     * @return The largest value that is equivalent to the value at @a percentile (that is, the upper bound of its
+     * bucket, but not more than max()); `0` if there are no values.
+     */
+    [[nodiscard]] std::uint64_t value_at_percentile(double percentile) const noexcept;
+
+    /**
+     * @brief Returns the number of values recorded into the bucket @a index.
+     *
+     * @param index The index of the bucket.
+     * @return The number of values.
+     */
+    [[nodiscard]] std::uint64_t bucket(std::size_t index) const noexcept { return this->m_buckets.at(index); }
+
+private:
+    friend class atomic_histogram;
+
+    std::array<std::uint64_t, bucket_count> m_buckets{};                ///< The number of values in every bucket.
+    std::uint64_t m_count = 0;                                          ///< The number of values.
+    std::uint64_t m_sum   = 0;                                          ///< The sum of the values.
+    std::uint64_t m_min   = std::numeric_limits<std::uint64_t>::max();  ///< The smallest value.
+    std::uint64_t m_max   = 0;                                          ///< The largest value.
+};
+
+/**
+ * @brief Metrics of a method.
+ *
+ * @details Only the handler invocation is tracked per method. The errors by error code and the time spent parsing
+ * requests and serializing responses are tracked for the dispatcher as a whole (see `metrics_snapshot::errors`,
+ * `metrics_snapshot::parse`, and `metrics_snapshot::serialize`): when they are recorded, the dispatcher either
+ * does not know the method yet, or no longer keeps track of it.
+ */
+struct method_metrics {
+    std::uint64_t calls  = 0;  ///< The number of calls.
+    std::uint64_t errors = 0;  ///< The number of calls that resulted in an error, whatever the error code.
+    latency_histogram invoke;  ///< The time spent invoking the handler, in nanoseconds.
+};
+
+/**
+ * @brief Metrics collected by the dispatcher.
+ *
+ * @see dispatcher::enable_metrics()
+ */
+struct metrics_snapshot {
+    /**
+     * @brief The time spent parsing requests, in nanoseconds.
+     *
+     * @details There is one value per request (or batch element): the time taken to validate it and convert it
+     * into a `jsonrpc_request`. For the requests passed as text, the time taken to parse the text is recorded as
+     * a separate value.
+     */
+    latency_histogram parse;
+
+    /**
+     * @brief The time spent serializing responses, in nanoseconds.
+     *
+     * @details There is one value per request (or batch element): the time taken to build the response object,
+     * or to write it into the output buffer with `dispatcher::process_request_to()`. The responses to the requests
+     * that fail as a whole (parse errors and empty batches) are not timed.
+     */
+    latency_histogram serialize;
+
+    /**
+     * @brief The number of errors by JSON RPC error code.
+     *
+     * @details Exceptions other than `json_rpc::exception` thrown by the handlers are counted as
+     * `exception::INTERNAL_ERROR`.
+     */
+    std::map<int, std::uint64_t> errors;
+
+    /**
+     * @brief Metrics of the methods, by method name.
+     *
+     * @details Only the calls of the methods that exist are counted: calls to unknown methods are counted
+     * in `errors` as `exception::METHOD_NOT_FOUND`.
+     */
+    std::map<std::string, method_metrics, std::less<>> methods;
+};
+
+}  // namespace wwa::json_rpc
+
+#endif /* C7D2A9E4_1F35_4B8C_96E0_3A5B7D1C2F48 */
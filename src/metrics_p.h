@@ -0,0 +1,305 @@
+#ifndef F1A86C3B_5D27_4E9A_B0C4_8E2F6D3A9B15
+#define F1A86C3B_5D27_4E9A_B0C4_8E2F6D3A9B15
+
+/**
+ * @file
+ * @brief Contains the private implementation details of the metrics collected by the dispatcher.
+ * @internal
+ */
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "metrics.h"
+
+namespace wwa::json_rpc {
+
+/**
+ * @brief Adds @a n to a counter that has only one writer.
+ * @internal
+ *
+ * @param counter The counter.
+ * @param n The value to add.
+ *
+ * @details The counter is atomic only so that the readers see consistent values; because only the owning thread
+ * writes to it, a relaxed load and store are enough, and there is no read-modify-write instruction.
+ */
+inline void add_to_counter(std::atomic_uint64_t& counter, std::uint64_t n = 1) noexcept
+{
+    counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Latency histogram that is written by one thread and can be read by other threads.
+ * @internal
+ *
+ * @see latency_histogram
+ */
+class atomic_histogram {
+public:
+    /**
+     * @brief Records a value.
+     *
+     * @param value The value.
+     * @note Only the owning thread may call this method.
+     */
+    void record(std::uint64_t value) noexcept
+    {
+        add_to_counter(this->m_buckets[latency_histogram::bucket_index(value)]);
+        add_to_counter(this->m_count);
+        add_to_counter(this->m_sum, value);
+
+        if (value < this->m_min.load(std::memory_order_relaxed)) {
+            this->m_min.store(value, std::memory_order_relaxed);
+        }
+
+        if (value > this->m_max.load(std::memory_order_relaxed)) {
+            this->m_max.store(value, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Adds the recorded values to @a h.
+     *
+     * @param h The histogram.
+     */
+    void merge_into(latency_histogram& h) const noexcept;
+
+private:
+    std::array<std::atomic_uint64_t, latency_histogram::bucket_count> m_buckets{};  ///< Values per bucket.
+    std::atomic_uint64_t m_count{0};                                                 ///< The number of values.
+    std::atomic_uint64_t m_sum{0};                                                   ///< The sum of the values.
+    std::atomic_uint64_t m_min{UINT64_MAX};                                          ///< The smallest value.
+    std::atomic_uint64_t m_max{0};                                                   ///< The largest value.
+};
+
+/**
+ * @brief Metrics recorded by one thread.
+ * @internal
+ *
+ * @details Only the owning thread records the metrics, so recording does not contend with other threads.
+ * The maps are modified only by the owning thread and only under `m_mutex`; lookups by the owning thread do not
+ * need the lock because nobody else modifies the maps. merge_into() holds the lock while it reads the maps.
+ */
+class metrics_shard {
+public:
+    /**
+     * @brief Records the time spent parsing a request.
+     *
+     * @param ns The time in nanoseconds.
+     */
+    void record_parse(std::uint64_t ns) noexcept { this->m_parse.record(ns); }
+
+    /**
+     * @brief Records the time spent serializing a response.
+     *
+     * @param ns The time in nanoseconds.
+     */
+    void record_serialize(std::uint64_t ns) noexcept { this->m_serialize.record(ns); }
+
+    /**
+     * @brief Records an error.
+     *
+     * @param code JSON RPC error code.
+     */
+    void record_error(int code);
+
+    /**
+     * @brief Records a method call.
+     *
+     * @param method The name of the method.
+     * @param ns The time spent invoking the method, in nanoseconds.
+     * @param failed Whether the call resulted in an error.
+     */
+    void record_call(std::string_view method, std::uint64_t ns, bool failed);
+
+    /**
+     * @brief Adds the recorded metrics to @a snapshot.
+     *
+     * @param snapshot The snapshot.
+     */
+    void merge_into(metrics_snapshot& snapshot) const;
+
+private:
+    /**
+     * @brief Metrics of a method.
+     */
+    struct method_stats {
+        std::atomic_uint64_t calls{0};   ///< The number of calls.
+        std::atomic_uint64_t errors{0};  ///< The number of failed calls.
+        atomic_histogram invoke;         ///< Invocation latency.
+    };
+
+    /**
+     * @brief Transparent string hash.
+     */
+    struct string_hash {
+        using is_transparent = void;  ///< Enables heterogeneous lookup.
+
+        /**
+         * @brief Computes the hash of @a s.
+         *
+         * @param s The string.
+         * @return The hash value.
+         */
+        std::size_t operator()(std::string_view s) const noexcept { return std::hash<std::string_view>{}(s); }
+    };
+
+    atomic_histogram m_parse;      ///< Parse latency.
+    atomic_histogram m_serialize;  ///< Serialization latency.
+
+    /** @brief Metrics of the methods. The nodes of `std::unordered_map` are stable, so the values are never moved. */
+    std::unordered_map<std::string, method_stats, string_hash, std::equal_to<>> m_methods;
+
+    /** @brief Errors by error code. */
+    std::unordered_map<int, std::atomic_uint64_t> m_errors;
+
+    mutable std::mutex m_mutex;  ///< Serializes modifications of the maps with merge_into().
+};
+
+/**
+ * @brief The metrics of a dispatcher, split into per-thread shards.
+ * @internal
+ *
+ * @details Every thread that processes requests gets its own shard on first use. The thread caches the pointer
+ * to its shard in thread-local storage, keyed by the unique ID of the registry, so finding the shard does not
+ * take a lock. snapshot() merges all shards.
+ */
+class metrics_registry {
+public:
+    /** @brief Class constructor. */
+    metrics_registry();
+
+    /** @brief Class destructor. */
+    ~metrics_registry();
+
+    metrics_registry(const metrics_registry&)            = delete;
+    metrics_registry& operator=(const metrics_registry&) = delete;
+    metrics_registry(metrics_registry&&)                 = delete;
+    metrics_registry& operator=(metrics_registry&&)      = delete;
+
+    /**
+     * @brief Returns the shard of the calling thread.
+     *
+     * @return The shard.
+     */
+    metrics_shard& local();
+
+    /**
+     * @brief Merges the shards.
+     *
+     * @return The metrics recorded by all threads.
+     */
+    [[nodiscard]] metrics_snapshot snapshot() const;
+
+private:
+    std::uint64_t m_id;                                    ///< The unique ID of the registry.
+    mutable std::mutex m_mutex;                            ///< Protects `m_shards`.
+    std::vector<std::shared_ptr<metrics_shard>> m_shards;  ///< The shards; the threads share the ownership.
+
+    static inline std::atomic_uint64_t m_next_id = 1;  ///< The ID of the next registry.
+
+    /**
+     * @brief Creates the shard for the calling thread.
+     *
+     * @return The shard.
+     */
+    std::shared_ptr<metrics_shard> add_shard();
+};
+
+/**
+ * @brief Measures the time elapsed since its construction.
+ * @internal
+ *
+ * @details The stopwatch does not read the clock if it is disabled, so that there is no overhead when the metrics
+ * are not collected.
+ */
+class stopwatch {
+public:
+    /**
+     * @brief Starts the stopwatch.
+     *
+     * @param enabled Whether to measure the time.
+     */
+    explicit stopwatch(bool enabled) noexcept
+        : m_start(enabled ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{})
+    {}
+
+    /**
+     * @brief Returns the time elapsed since the construction.
+     *
+     * @return The time in nanoseconds.
+     */
+    [[nodiscard]] std::uint64_t elapsed() const noexcept
+    {
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - this->m_start
+        );
+
+        return static_cast<std::uint64_t>(ns.count());
+    }
+
+private:
+    std::chrono::steady_clock::time_point m_start;  ///< The start time.
+};
+
+/**
+ * @brief Records a method call when it goes out of scope.
+ * @internal
+ *
+ * @details The call is considered failed unless succeeded() is called, so that exceptions thrown by
+ * `dispatcher::invoke()` are counted as errors. Calls that failed with `exception::METHOD_NOT_FOUND` are not
+ * recorded, because the method does not exist.
+ *
+ * The shard is looked up when the call completes: an asynchronous call may complete on a different thread.
+ */
+class call_recorder {
+public:
+    /**
+     * @brief Starts measuring the call.
+     *
+     * @param registry The metrics; `nullptr` if the metrics are disabled.
+     * @param method The name of the method; it must outlive the recorder.
+     */
+    call_recorder(metrics_registry* registry, std::string_view method) noexcept
+        : m_registry(registry), m_method(method), m_stopwatch(registry != nullptr)
+    {}
+
+    /** @brief Records the call. */
+    ~call_recorder();
+
+    call_recorder(const call_recorder&)            = delete;
+    call_recorder& operator=(const call_recorder&) = delete;
+    call_recorder(call_recorder&&)                 = delete;
+    call_recorder& operator=(call_recorder&&)      = delete;
+
+    /** @brief Marks the call as successful. */
+    void succeeded() noexcept { this->m_failed = false; }
+
+    /**
+     * @brief Marks the call as failed.
+     *
+     * @param code JSON RPC error code.
+     */
+    void failed(int code) noexcept;
+
+private:
+    metrics_registry* m_registry;  ///< The metrics.
+    std::string_view m_method;     ///< The name of the method.
+    stopwatch m_stopwatch;         ///< Measures the duration of the call.
+    bool m_failed = true;          ///< Whether the call failed.
+};
+
+}  // namespace wwa::json_rpc
+
+#endif /* F1A86C3B_5D27_4E9A_B0C4_8E2F6D3A9B15 */
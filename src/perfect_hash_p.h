@@ -0,0 +1,237 @@
+#ifndef D4A7E2C9_61B8_4F0D_8C3E_5A9F1B2E7D64
+#define D4A7E2C9_61B8_4F0D_8C3E_5A9F1B2E7D64
+
+/**
+ * @file
+ * @brief Immutable perfect hash map from strings to values.
+ * @internal
+ */
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace wwa::json_rpc {
+
+/**
+ * @brief Immutable perfect hash map from string keys to pointers to values.
+ * @internal
+ *
+ * @tparam T The type of the values.
+ *
+ * @details The map is built once from a set of keys and cannot be modified afterwards.
+ * It uses the *hash and displace* scheme: the keys are split into buckets by their hash, and every bucket gets
+ * a displacement chosen so that all keys land into distinct slots. A lookup computes one hash of the key,
+ * reads the displacement of its bucket, and compares the key with the only slot it can occupy.
+ *
+ * Slots are stored in a flat array and hold the full hash of the key, so that a mismatch is usually detected
+ * without comparing the strings.
+ *
+ * The map does not own the keys and the values; they must outlive the map.
+ */
+template<typename T>
+class perfect_hash_map {
+public:
+    /**
+     * @brief Builds the map.
+     *
+     * @param items Key-value pairs; keys must be unique.
+     */
+    void build(const std::vector<std::pair<std::string_view, const T*>>& items)
+    {
+        const std::size_t bucket_count = std::bit_ceil(std::max<std::size_t>(items.size() / 2, 1));
+        std::size_t slot_count         = std::bit_ceil(std::max<std::size_t>(items.size() * 2, 1));
+
+        for (std::uint64_t seed = 0;; ++seed) {
+            if (this->try_build(items, seed, bucket_count, slot_count)) {
+                return;
+            }
+
+            // Give the displacement search more room
+            slot_count *= 2;
+        }
+    }
+
+    /**
+     * @brief Finds the value for @a key.
+     *
+     * @param key The key.
+     * @return Pointer to the value; `nullptr` if @a key is not in the map.
+     */
+    [[nodiscard]] const T* find(std::string_view key) const noexcept
+    {
+        if (this->m_slots.empty()) {
+            return nullptr;
+        }
+
+        const auto hash  = perfect_hash_map::hash_of(key, this->m_seed);
+        const auto& slot = this->m_slots[this->slot_of(hash, this->m_displacements[this->bucket_of(hash)])];
+        return slot.hash == hash && slot.key == key ? slot.value : nullptr;
+    }
+
+    /**
+     * @brief Returns the number of keys in the map.
+     *
+     * @return The number of keys.
+     */
+    [[nodiscard]] std::size_t size() const noexcept { return this->m_size; }
+
+private:
+    /**
+     * @brief A slot of the table.
+     */
+    struct slot {
+        std::uint64_t hash = 0;    ///< The hash of the key.
+        std::string_view key;      ///< The key.
+        const T* value = nullptr;  ///< The value; `nullptr` if the slot is empty.
+    };
+
+    std::vector<slot> m_slots;                   ///< Slots.
+    std::vector<std::uint32_t> m_displacements;  ///< Displacements of the buckets.
+    std::uint64_t m_seed        = 0;             ///< Hash seed.
+    std::size_t m_slot_mask     = 0;             ///< `m_slots.size() - 1`.
+    unsigned int m_bucket_shift = 64;            ///< `64 - log2(m_displacements.size())`.
+    std::size_t m_size          = 0;             ///< The number of keys.
+
+    /**
+     * @brief Hashes @a key.
+     *
+     * @param key The key.
+     * @param seed The seed.
+     * @return The hash value.
+     *
+     * @details FNV-1a followed by the SplitMix64 finalizer to spread the bits.
+     */
+    static std::uint64_t hash_of(std::string_view key, std::uint64_t seed) noexcept
+    {
+        // NOLINTBEGIN(readability-magic-numbers)
+        std::uint64_t h = 0xCBF29CE484222325ULL ^ seed;
+        for (const char c : key) {
+            h ^= static_cast<unsigned char>(c);
+            h *= 0x100000001B3ULL;
+        }
+
+        h ^= h >> 30U;
+        h *= 0xBF58476D1CE4E5B9ULL;
+        h ^= h >> 27U;
+        h *= 0x94D049BB133111EBULL;
+        return h ^ (h >> 31U);
+        // NOLINTEND(readability-magic-numbers)
+    }
+
+    /**
+     * @brief Returns the bucket of the key with the given hash.
+     *
+     * @param hash The hash of the key.
+     * @return Bucket index.
+     */
+    [[nodiscard]] std::size_t bucket_of(std::uint64_t hash) const noexcept
+    {
+        // Multiplicative hashing: take the top bits of the product
+        constexpr std::uint64_t multiplier = 0x9E3779B97F4A7C15ULL;
+        return this->m_bucket_shift >= 64 ? 0 : static_cast<std::size_t>((hash * multiplier) >> this->m_bucket_shift);
+    }
+
+    /**
+     * @brief Returns the slot of the key with the given hash and displacement.
+     *
+     * @param hash The hash of the key.
+     * @param displacement The displacement of the bucket.
+     * @return Slot index.
+     */
+    [[nodiscard]] std::size_t slot_of(std::uint64_t hash, std::uint32_t displacement) const noexcept
+    {
+        const auto lo = hash & 0xFFFFFFFFU;  // NOLINT(readability-magic-numbers)
+        const auto hi = (hash >> 32U) | 1U;  // NOLINT(readability-magic-numbers)
+        return static_cast<std::size_t>(lo + displacement * hi) & this->m_slot_mask;
+    }
+
+    /**
+     * @brief Attempts to build the map with the given parameters.
+     *
+     * @param items Key-value pairs.
+     * @param seed Hash seed.
+     * @param bucket_count The number of buckets (a power of two).
+     * @param slot_count The number of slots (a power of two).
+     * @return Whether the map has been built.
+     */
+    bool try_build(
+        const std::vector<std::pair<std::string_view, const T*>>& items, std::uint64_t seed, std::size_t bucket_count,
+        std::size_t slot_count
+    )
+    {
+        constexpr std::uint32_t max_displacement = 1U << 16U;
+
+        this->m_seed         = seed;
+        this->m_slot_mask    = slot_count - 1;
+        this->m_bucket_shift = 64U - static_cast<unsigned int>(std::countr_zero(bucket_count));
+        this->m_size         = items.size();
+        this->m_slots.assign(slot_count, slot{});
+        this->m_displacements.assign(bucket_count, 0);
+
+        std::vector<std::vector<std::pair<std::uint64_t, std::size_t>>> buckets(bucket_count);
+        for (std::size_t i = 0; i < items.size(); ++i) {
+            const auto hash = perfect_hash_map::hash_of(items[i].first, seed);
+            buckets[this->bucket_of(hash)].emplace_back(hash, i);
+        }
+
+        std::vector<std::size_t> order(bucket_count);
+        for (std::size_t i = 0; i < bucket_count; ++i) {
+            order[i] = i;
+        }
+
+        // Place the largest buckets first, while there is plenty of free slots
+        std::stable_sort(order.begin(), order.end(), [&buckets](std::size_t a, std::size_t b) {
+            return buckets[a].size() > buckets[b].size();
+        });
+
+        std::vector<std::size_t> positions;
+        for (const auto b : order) {
+            const auto& bucket = buckets[b];
+            if (bucket.empty()) {
+                break;
+            }
+
+            std::uint32_t d = 0;
+            for (; d < max_displacement; ++d) {
+                positions.clear();
+                bool ok = true;
+                for (const auto& [hash, index] : bucket) {
+                    const auto pos = this->slot_of(hash, d);
+                    if (this->m_slots[pos].value != nullptr ||
+                        std::find(positions.begin(), positions.end(), pos) != positions.end())
+                    {
+                        ok = false;
+                        break;
+                    }
+
+                    positions.push_back(pos);
+                }
+
+                if (ok) {
+                    break;
+                }
+            }
+
+            if (d == max_displacement) {
+                return false;
+            }
+
+            this->m_displacements[b] = d;
+            for (std::size_t i = 0; i < bucket.size(); ++i) {
+                const auto& [hash, index]   = bucket[i];
+                this->m_slots[positions[i]] = slot{hash, items[index].first, items[index].second};
+            }
+        }
+
+        return true;
+    }
+};
+
+}  // namespace wwa::json_rpc
+
+#endif /* D4A7E2C9_61B8_4F0D_8C3E_5A9F1B2E7D64 */
@@ -6,30 +6,179 @@
  * @brief Defines the structure and functionality for handling JSON RPC requests.
  */
 
+#include <algorithm>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
 #include <nlohmann/json.hpp>
 
+#include "exception.h"
+#include "expected.h"
+#include "export.h"
+#include "utils.h"
+
 namespace wwa::json_rpc {
 
+namespace details {
+
+/**
+ * @brief Checks whether @a key is one of the members of the request defined by the specification.
+ * @internal
+ *
+ * @param key The name of the member.
+ * @return Whether @a key is `jsonrpc`, `method`, `params`, or `id`.
+ */
+inline bool is_envelope_member(std::string_view key)
+{
+    return key == "jsonrpc" || key == "method" || key == "params" || key == "id";
+}
+
+/**
+ * @brief Finds a member of a JSON object by its name.
+ * @internal
+ *
+ * @tparam Members The type of the members of the object (`BasicJsonType::object_t`, possibly const).
+ * @param members The members of the object.
+ * @param key The name of the member.
+ * @return Iterator to the member; `members.end()` if there is no such member.
+ *
+ * @details `std::map` with a transparent comparator looks the key up without constructing a string;
+ * containers that do not support heterogeneous lookup (like the const `nlohmann::ordered_map`) are searched linearly.
+ */
+template<typename Members>
+auto find_member(Members& members, std::string_view key)
+{
+    if constexpr (requires { members.find(key); }) {
+        return members.find(key);
+    }
+    else {
+        return std::find_if(members.begin(), members.end(), [key](const auto& member) { return member.first == key; });
+    }
+}
+
+/**
+ * @brief Finds a member of a JSON object that must be a string.
+ * @internal
+ *
+ * @tparam BasicJsonType The JSON type (a `nlohmann::basic_json` specialization).
+ * @tparam Members The type of the members of the object (`BasicJsonType::object_t`, possibly const).
+ * @param members The members of the object.
+ * @param key The name of the member.
+ * @return Pointer to the value of the member; `nullptr` if there is no such member or it is not a string.
+ */
+template<typename BasicJsonType, typename Members>
+auto* find_string_member(Members& members, std::string_view key)
+{
+    using string_t = std::conditional_t<
+        std::is_const_v<Members>, const typename BasicJsonType::string_t, typename BasicJsonType::string_t>;
+
+    const auto it = find_member(members, key);
+    return it != members.end() && it->second.is_string() ? &it->second.template get_ref<string_t&>()
+                                                          : static_cast<string_t*>(nullptr);
+}
+
+/**
+ * @brief Copies a member of a JSON object.
+ * @internal
+ *
+ * @tparam BasicJsonType The JSON type (a `nlohmann::basic_json` specialization).
+ * @param members The members of the object.
+ * @param key The name of the member.
+ * @return The value of the member; a discarded value if there is no such member.
+ */
+template<typename BasicJsonType>
+BasicJsonType copy_member(const typename BasicJsonType::object_t& members, std::string_view key)
+{
+    const auto it = find_member(members, key);
+    return it != members.end() ? it->second : BasicJsonType(BasicJsonType::value_t::discarded);
+}
+
+/**
+ * @brief Moves a member out of a JSON object.
+ * @internal
+ *
+ * @tparam BasicJsonType The JSON type (a `nlohmann::basic_json` specialization).
+ * @param members The members of the object.
+ * @param key The name of the member.
+ * @return The value of the member; a discarded value if there is no such member.
+ */
+template<typename BasicJsonType>
+BasicJsonType take_member(typename BasicJsonType::object_t& members, std::string_view key)
+{
+    const auto it = find_member(members, key);
+    if (it == members.end()) {
+        return BasicJsonType::value_t::discarded;
+    }
+
+    auto value = std::move(it->second);
+    members.erase(it);
+    return value;
+}
+
+}  // namespace details
+
 /**
  * @brief Represents a JSON RPC request.
  * @internal
  *
  * This struct holds the components of a JSON RPC request, including the JSON RPC version, method name, parameters, and ID.
  *
+ * @tparam BasicJsonType The JSON type (a `nlohmann::basic_json` specialization); its `string_t` must be `std::string`.
  * @see https://www.jsonrpc.org/specification#request_object
  */
-struct jsonrpc_request {
-    std::string jsonrpc;    ///< The JSON RPC version.
-    std::string method;     ///< The name of the method to be invoked.
-    nlohmann::json params;  ///< The parameters for the method.
-    nlohmann::json id;      ///< The ID of the request.
-    nlohmann::json extra;   ///< Extra fields from the JSON RPC request.
+template<typename BasicJsonType>
+struct WWA_JSONRPC_EXPORT basic_jsonrpc_request {
+    static_assert(std::is_same_v<typename BasicJsonType::string_t, std::string>, "string_t must be std::string");
+
+    std::string jsonrpc;   ///< The JSON RPC version.
+    std::string method;    ///< The name of the method to be invoked.
+    BasicJsonType params;  ///< The parameters for the method.
+    BasicJsonType id;      ///< The ID of the request.
+
+    /**
+     * @brief Returns the extra fields of the request.
+     *
+     * @return The object with the members of the request other than `jsonrpc`, `method`, `params`, and `id`;
+     * `null` if the extra fields have not been set.
+     *
+     * @details The dispatcher does not collect the extra fields for the handlers that do not accept the context:
+     * the request it passes to `basic_dispatcher::request_parsed()` refers to the source of the extra fields instead
+     * (see set_extra_source()), and the fields are collected on the first call to this method.
+     */
+    [[nodiscard]] const BasicJsonType& extra() const;
+
+    /**
+     * @brief Sets the extra fields of the request.
+     *
+     * @param extra The object with the extra fields.
+     */
+    void set_extra(BasicJsonType&& extra) noexcept
+    {
+        this->m_extra  = std::move(extra);
+        this->m_source = nullptr;
+    }
+
+    /**
+     * @brief Makes extra() collect the extra fields from @a source when it is first called.
+     *
+     * @param source The JSON RPC request, or the object with the extra fields; the members of the envelope
+     * (`jsonrpc`, `method`, `params`, and `id`) are skipped.
+     * @warning @a source must outlive the calls to extra() and take_extra().
+     */
+    void set_extra_source(const BasicJsonType& source) noexcept { this->m_source = &source; }
+
+    /**
+     * @brief Moves the extra fields out of the request.
+     *
+     * @return The object with the extra fields (see extra()).
+     */
+    BasicJsonType take_extra();
 
     /**
      * @brief Parses and validates a JSON RPC request.
      *
-     * @param request The JSON RPC request as a `nlohmann::json` object.
+     * @param request The JSON RPC request as a JSON object.
      * @return The parsed JSON RPC request.
      *
      * @details This method extracts the components of a JSON RPC request from the provided JSON object and validates the request,
@@ -37,9 +186,273 @@ struct jsonrpc_request {
      * @throws exception If the request is invalid.
      * @see exception::INVALID_REQUEST, exception::INVALID_PARAMS
      */
-    static jsonrpc_request from_json(const nlohmann::json& request);
+    static basic_jsonrpc_request from_json(const BasicJsonType& request);
+
+    /**
+     * @brief Parses and validates a JSON RPC request, consuming it.
+     *
+     * @param request The JSON RPC request as a JSON object.
+     * @return The parsed JSON RPC request.
+     *
+     * @details This overload does the same as from_json(const BasicJsonType&), but instead of copying `params`, `id`,
+     * and the extra members of the request, it moves them out of @a request. The state of @a request after the call
+     * is unspecified.
+     * @throws exception If the request is invalid.
+     * @overload
+     */
+    static basic_jsonrpc_request from_json(BasicJsonType&& request);
+
+    /**
+     * @brief Parses and validates a JSON RPC request without throwing exceptions.
+     *
+     * @param request The JSON RPC request as a JSON object.
+     * @return The parsed JSON RPC request, or the error if the request is invalid.
+     *
+     * @details This is the same as from_json(const BasicJsonType&), but the error is returned instead of thrown.
+     * The dispatcher uses it to reject invalid requests without the cost of stack unwinding.
+     */
+    static expected<basic_jsonrpc_request> try_from_json(const BasicJsonType& request);
+
+    /**
+     * @brief Parses and validates a JSON RPC request without throwing exceptions, consuming it.
+     *
+     * @param request The JSON RPC request as a JSON object.
+     * @return The parsed JSON RPC request, or the error if the request is invalid.
+     *
+     * @details This is the same as from_json(BasicJsonType&&), but the error is returned instead of thrown.
+     * @overload
+     */
+    static expected<basic_jsonrpc_request> try_from_json(BasicJsonType&& request);
+
+    /**
+     * @brief Normalizes and validates the request.
+     *
+     * @details This method is used when the components of the request have been extracted by other means
+     * (for example, by the SAX parser used by `dispatcher::process_request(std::string_view, const std::any&)`).
+     * It converts omitted `params` to an empty array, wraps named parameters into an array, and validates the request
+     * the same way as from_json() does.
+     * @throws exception If the request is invalid.
+     * @see exception::INVALID_REQUEST, exception::INVALID_PARAMS
+     */
+    void validate();
+
+    /**
+     * @brief Normalizes and validates the request without throwing exceptions.
+     *
+     * @return Nothing, or the error if the request is invalid.
+     *
+     * @details This is the same as validate(), but the error is returned instead of thrown.
+     */
+    expected<> try_validate();
+
+private:
+    mutable BasicJsonType m_extra;                    ///< Extra fields from the JSON RPC request.
+    mutable const BasicJsonType* m_source = nullptr;  ///< The object to collect `m_extra` from.
 };
 
+namespace details {
+
+/**
+ * @brief Parses and validates the envelope of a JSON RPC request, leaving out the extra fields.
+ * @internal
+ *
+ * @tparam BasicJsonType The JSON type (a `nlohmann::basic_json` specialization).
+ * @param request The JSON RPC request as a JSON object.
+ * @return The parsed JSON RPC request with `null` extra fields, or the error if the request is invalid.
+ *
+ * @details The dispatchers use this function to avoid collecting the extra fields for handlers that never see them;
+ * they call collect_extra() when the fields are needed, while @a request is still alive.
+ */
+template<typename BasicJsonType>
+expected<basic_jsonrpc_request<BasicJsonType>> try_parse_envelope(const BasicJsonType& request)
+{
+    if (!request.is_object()) {
+        return unexpected(exception(exception::INVALID_REQUEST, err_bad_request));
+    }
+
+    const auto& members = request.template get_ref<const typename BasicJsonType::object_t&>();
+    const auto* jsonrpc = find_string_member<BasicJsonType>(members, "jsonrpc");
+    const auto* method  = find_string_member<BasicJsonType>(members, "method");
+    if (jsonrpc == nullptr || method == nullptr) {
+        return unexpected(exception(exception::INVALID_REQUEST, err_bad_request));
+    }
+
+    basic_jsonrpc_request<BasicJsonType> req;
+    req.jsonrpc = *jsonrpc;
+    req.method  = *method;
+    req.params  = copy_member<BasicJsonType>(members, "params");
+    req.id      = copy_member<BasicJsonType>(members, "id");
+    if (auto res = req.try_validate(); !res) {
+        return unexpected(std::move(res).error());
+    }
+
+    return req;
+}
+
+/**
+ * @brief Parses and validates the envelope of a JSON RPC request, consuming it.
+ * @internal
+ *
+ * @tparam BasicJsonType The JSON type (a `nlohmann::basic_json` specialization).
+ * @param request The JSON RPC request as a JSON object.
+ * @return The parsed JSON RPC request with `null` extra fields, or the error if the request is invalid.
+ *
+ * @details The members of the envelope are moved out of @a request; if the request is valid,
+ * only the extra fields remain in it.
+ */
+template<typename BasicJsonType>
+expected<basic_jsonrpc_request<BasicJsonType>> try_parse_envelope(BasicJsonType&& request)
+{
+    if (!request.is_object()) {
+        return unexpected(exception(exception::INVALID_REQUEST, err_bad_request));
+    }
+
+    auto& members = request.template get_ref<typename BasicJsonType::object_t&>();
+    auto* jsonrpc = find_string_member<BasicJsonType>(members, "jsonrpc");
+    auto* method  = find_string_member<BasicJsonType>(members, "method");
+    if (jsonrpc == nullptr || method == nullptr) {
+        return unexpected(exception(exception::INVALID_REQUEST, err_bad_request));
+    }
+
+    basic_jsonrpc_request<BasicJsonType> req;
+    req.jsonrpc = std::move(*jsonrpc);
+    req.method  = std::move(*method);
+    req.params  = take_member<BasicJsonType>(members, "params");
+    req.id      = take_member<BasicJsonType>(members, "id");
+    if (auto res = req.try_validate(); !res) {
+        return unexpected(std::move(res).error());
+    }
+
+    members.erase("jsonrpc");
+    members.erase("method");
+    return req;
+}
+
+/**
+ * @brief Collects the extra fields of a JSON RPC request.
+ * @internal
+ *
+ * @tparam BasicJsonType The JSON type (a `nlohmann::basic_json` specialization).
+ * @param request The JSON RPC request as a JSON object.
+ * @return The object with the members of the request other than `jsonrpc`, `method`, `params`, and `id`.
+ */
+template<typename BasicJsonType>
+BasicJsonType collect_extra(const BasicJsonType& request)
+{
+    auto extra = BasicJsonType::object();
+    for (const auto& [key, value] : request.items()) {
+        if (!is_envelope_member(key)) {
+            extra.emplace(std::string(key), BasicJsonType(value));
+        }
+    }
+
+    return extra;
+}
+
+}  // namespace details
+
+template<typename BasicJsonType>
+const BasicJsonType& basic_jsonrpc_request<BasicJsonType>::extra() const
+{
+    if (this->m_source != nullptr) {
+        this->m_extra  = details::collect_extra(*this->m_source);
+        this->m_source = nullptr;
+    }
+
+    return this->m_extra;
+}
+
+template<typename BasicJsonType>
+BasicJsonType basic_jsonrpc_request<BasicJsonType>::take_extra()
+{
+    if (const auto* source = std::exchange(this->m_source, nullptr); source != nullptr) {
+        return details::collect_extra(*source);
+    }
+
+    return std::move(this->m_extra);
+}
+
+template<typename BasicJsonType>
+expected<basic_jsonrpc_request<BasicJsonType>>
+basic_jsonrpc_request<BasicJsonType>::try_from_json(const BasicJsonType& request)
+{
+    auto req = details::try_parse_envelope(request);
+    if (req) {
+        req->set_extra(details::collect_extra(request));
+    }
+
+    return req;
+}
+
+template<typename BasicJsonType>
+expected<basic_jsonrpc_request<BasicJsonType>>
+basic_jsonrpc_request<BasicJsonType>::try_from_json(BasicJsonType&& request)
+{
+    auto req = details::try_parse_envelope(std::move(request));
+    if (req) {
+        req->set_extra(std::move(request));
+    }
+
+    return req;
+}
+
+template<typename BasicJsonType>
+basic_jsonrpc_request<BasicJsonType> basic_jsonrpc_request<BasicJsonType>::from_json(const BasicJsonType& request)
+{
+    return try_from_json(request).value();
+}
+
+template<typename BasicJsonType>
+basic_jsonrpc_request<BasicJsonType> basic_jsonrpc_request<BasicJsonType>::from_json(BasicJsonType&& request)
+{
+    return try_from_json(std::move(request)).value();
+}
+
+template<typename BasicJsonType>
+expected<> basic_jsonrpc_request<BasicJsonType>::try_validate()
+{
+    if (this->params.is_discarded()) {
+        this->params = BasicJsonType::array();
+    }
+    else if (this->params.is_object()) {
+        this->params = BasicJsonType::array({std::move(this->params)});
+    }
+
+    if (this->jsonrpc != "2.0") {
+        return unexpected(exception(exception::INVALID_REQUEST, err_not_jsonrpc_2_0_request));
+    }
+
+    if (!this->params.is_array()) {
+        return unexpected(exception(exception::INVALID_PARAMS, err_bad_params_type));
+    }
+
+    if (this->method.empty()) {
+        return unexpected(exception(exception::INVALID_REQUEST, err_empty_method));
+    }
+
+    if (!is_valid_request_id(this->id)) {
+        return unexpected(exception(exception::INVALID_REQUEST, err_bad_id_type));
+    }
+
+    return {};
+}
+
+template<typename BasicJsonType>
+void basic_jsonrpc_request<BasicJsonType>::validate()
+{
+    this->try_validate().value();
+}
+
+extern template struct WWA_JSONRPC_EXPORT basic_jsonrpc_request<nlohmann::json>;
+extern template struct WWA_JSONRPC_EXPORT basic_jsonrpc_request<nlohmann::ordered_json>;
+
+/**
+ * @brief JSON RPC request that uses `nlohmann::json`.
+ *
+ * @note This is an alias and cannot be forward-declared as a class.
+ */
+using jsonrpc_request = basic_jsonrpc_request<nlohmann::json>;
+
 }  // namespace wwa::json_rpc
 
 #endif /* C8EEBB64_DA22_4649_BD6D_8BF0AE756F87 */
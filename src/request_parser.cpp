@@ -0,0 +1,14 @@
+/**
+ * @file
+ * @brief Instantiates the request parser for the JSON types supported by the library.
+ * @internal
+ */
+
+#include "request_parser_impl.h"
+
+namespace wwa::json_rpc {
+
+template class request_parser<nlohmann::json>;
+template class request_parser<nlohmann::ordered_json>;
+
+}  // namespace wwa::json_rpc
@@ -0,0 +1,266 @@
+#ifndef E4A81F3C_6D27_4B95_8C0E_92D5B7A3F610
+#define E4A81F3C_6D27_4B95_8C0E_92D5B7A3F610
+
+/**
+ * @file
+ * @brief Implementation of the SAX-based JSON RPC request parser.
+ * @internal
+ */
+
+#include "request_parser_p.h"
+#include "exception.h"
+#include "utils.h"
+
+namespace wwa::json_rpc {
+
+template<typename BasicJsonType>
+BasicJsonType request_parser<BasicJsonType>::entry::response_id() const
+{
+    return !this->id.is_discarded() && is_valid_request_id(this->id) ? this->id : BasicJsonType(nullptr);
+}
+
+template<typename BasicJsonType>
+expected<basic_jsonrpc_request<BasicJsonType>> request_parser<BasicJsonType>::entry::to_request()
+{
+    if (!this->jsonrpc.has_value() || !this->method.has_value()) {
+        return unexpected(exception(exception::INVALID_REQUEST, err_bad_request));
+    }
+
+    basic_jsonrpc_request<BasicJsonType> req;
+    req.jsonrpc = std::move(*this->jsonrpc);
+    req.method  = std::move(*this->method);
+    req.params  = std::move(this->params);
+    req.id      = std::move(this->id);
+    if (auto res = req.try_validate(); !res) {
+        return unexpected(std::move(res).error());
+    }
+
+    return req;
+}
+
+template<typename BasicJsonType>
+BasicJsonType request_parser<BasicJsonType>::entry::take_extra()
+{
+    return this->extra.is_null() ? BasicJsonType::object() : std::move(this->extra);
+}
+
+template<typename BasicJsonType>
+bool request_parser<BasicJsonType>::parse(std::string_view input, typename BasicJsonType::input_format_t format)
+{
+    this->m_entries.clear();
+    this->m_stack.clear();
+    this->m_target   = nullptr;
+    this->m_depth    = 0;
+    this->m_member   = member::none;
+    this->m_is_batch = false;
+    this->m_error.clear();
+
+    return BasicJsonType::sax_parse(input.begin(), input.end(), this, format);
+}
+
+template<typename BasicJsonType>
+bool request_parser<BasicJsonType>::null()
+{
+    return this->scalar(nullptr);
+}
+
+template<typename BasicJsonType>
+bool request_parser<BasicJsonType>::boolean(bool val)
+{
+    return this->scalar(val);
+}
+
+template<typename BasicJsonType>
+bool request_parser<BasicJsonType>::number_integer(typename BasicJsonType::number_integer_t val)
+{
+    return this->scalar(val);
+}
+
+template<typename BasicJsonType>
+bool request_parser<BasicJsonType>::number_unsigned(typename BasicJsonType::number_unsigned_t val)
+{
+    return this->scalar(val);
+}
+
+template<typename BasicJsonType>
+bool request_parser<BasicJsonType>::number_float(
+    typename BasicJsonType::number_float_t val, const typename BasicJsonType::string_t&
+)
+{
+    return this->scalar(val);
+}
+
+template<typename BasicJsonType>
+bool request_parser<BasicJsonType>::string(typename BasicJsonType::string_t& val)
+{
+    if (this->m_stack.empty() && this->m_depth == this->envelope_depth()) {
+        if (this->m_member == member::jsonrpc) {
+            this->m_entries.back().jsonrpc = std::move(val);
+            return true;
+        }
+
+        if (this->m_member == member::method) {
+            this->m_entries.back().method = std::move(val);
+            return true;
+        }
+    }
+
+    return this->scalar(std::move(val));
+}
+
+template<typename BasicJsonType>
+bool request_parser<BasicJsonType>::binary(typename BasicJsonType::binary_t& val)
+{
+    return this->scalar(BasicJsonType::binary(std::move(val)));
+}
+
+template<typename BasicJsonType>
+bool request_parser<BasicJsonType>::start_object(std::size_t)
+{
+    return this->start_container(BasicJsonType::value_t::object);
+}
+
+template<typename BasicJsonType>
+bool request_parser<BasicJsonType>::key(typename BasicJsonType::string_t& val)
+{
+    if (!this->m_stack.empty()) {
+        this->m_key = std::move(val);
+        return true;
+    }
+
+    auto& entry = this->m_entries.back();
+    if (val == "jsonrpc") {
+        this->m_member = member::jsonrpc;
+        entry.jsonrpc.reset();
+    }
+    else if (val == "method") {
+        this->m_member = member::method;
+        entry.method.reset();
+    }
+    else {
+        this->m_member = member::value;
+        if (val == "params") {
+            this->m_target = &entry.params;
+        }
+        else if (val == "id") {
+            this->m_target = &entry.id;
+        }
+        else {
+            this->m_target = &entry.extra[std::move(val)];
+        }
+    }
+
+    return true;
+}
+
+template<typename BasicJsonType>
+bool request_parser<BasicJsonType>::end_object()
+{
+    return this->end_container();
+}
+
+template<typename BasicJsonType>
+bool request_parser<BasicJsonType>::start_array(std::size_t)
+{
+    return this->start_container(BasicJsonType::value_t::array);
+}
+
+template<typename BasicJsonType>
+bool request_parser<BasicJsonType>::end_array()
+{
+    return this->end_container();
+}
+
+template<typename BasicJsonType>
+bool request_parser<BasicJsonType>::parse_error(
+    std::size_t, const std::string&, const typename BasicJsonType::exception& ex
+)
+{
+    this->m_error = ex.what();
+    return false;
+}
+
+template<typename BasicJsonType>
+bool request_parser<BasicJsonType>::scalar(BasicJsonType&& val)
+{
+    if (!this->m_stack.empty()) {
+        this->store(std::move(val));
+    }
+    else if (this->m_depth == 0 || (this->m_is_batch && this->m_depth == 1)) {
+        // A top-level value or a batch element that is not an object
+        this->m_entries.emplace_back();
+    }
+    else if (this->m_member == member::value) {
+        *this->m_target = std::move(val);
+    }
+
+    // Non-string values of `jsonrpc` and `method` are ignored: entry::to_request() will reject the request
+    return true;
+}
+
+template<typename BasicJsonType>
+bool request_parser<BasicJsonType>::start_container(typename BasicJsonType::value_t type)
+{
+    if (this->m_stack.empty()) {
+        if (this->m_depth == 0 && type == BasicJsonType::value_t::array) {
+            this->m_is_batch = true;
+            ++this->m_depth;
+            return true;
+        }
+
+        if (this->m_depth == 0 || (this->m_is_batch && this->m_depth == 1)) {
+            auto& entry = this->m_entries.emplace_back();
+            if (type == BasicJsonType::value_t::object) {
+                entry.is_object = true;
+                this->m_member  = member::none;
+                ++this->m_depth;
+                return true;
+            }
+
+            // A batch element that is an array: not a valid request, its contents are not needed
+            this->m_target = &this->m_scratch;
+        }
+        else if (this->m_member != member::value) {
+            this->m_target = &this->m_scratch;
+        }
+    }
+
+    this->m_stack.push_back(this->store(BasicJsonType(type)));
+    return true;
+}
+
+template<typename BasicJsonType>
+bool request_parser<BasicJsonType>::end_container()
+{
+    if (!this->m_stack.empty()) {
+        this->m_stack.pop_back();
+    }
+    else {
+        --this->m_depth;
+        this->m_member = member::none;
+    }
+
+    return true;
+}
+
+template<typename BasicJsonType>
+BasicJsonType* request_parser<BasicJsonType>::store(BasicJsonType&& val)
+{
+    if (this->m_stack.empty()) {
+        *this->m_target = std::move(val);
+        return this->m_target;
+    }
+
+    auto* parent = this->m_stack.back();
+    if (parent->is_array()) {
+        return &parent->emplace_back(std::move(val));
+    }
+
+    auto& slot = (*parent)[std::move(this->m_key)];
+    slot       = std::move(val);
+    return &slot;
+}
+
+}  // namespace wwa::json_rpc
+
+#endif /* E4A81F3C_6D27_4B95_8C0E_92D5B7A3F610 */
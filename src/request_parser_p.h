@@ -0,0 +1,210 @@
+#ifndef B1D0C6A2_5E3F_4C57_9A0E_7F2B6C4D8E91
+#define B1D0C6A2_5E3F_4C57_9A0E_7F2B6C4D8E91
+
+/**
+ * @file
+ * @brief SAX-based parser that extracts JSON RPC requests from raw text.
+ * @internal
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include "request.h"
+
+namespace wwa::json_rpc {
+
+/**
+ * @brief Parses a JSON RPC request (or a batch of requests) from raw text or a binary encoding in one pass.
+ * @internal
+ *
+ * @tparam BasicJsonType The JSON type of the parsed values (a `nlohmann::basic_json` specialization).
+ *
+ * @details The parser uses the SAX interface of nlohmann::json. Instead of building a DOM for the entire request,
+ * it extracts the envelope fields (`jsonrpc`, `method`) directly into strings and builds DOM values only for `params`,
+ * `id`, and the extra (non-standard) members of the request object.
+ *
+ * If duplicate keys are present, the last one wins (this matches the behavior of `nlohmann::json::parse()`).
+ *
+ * The bookkeeping of the parser (the entries and the stack of containers) is allocated from the memory resource
+ * passed to the constructor. The JSON values themselves use the allocator of @a BasicJsonType.
+ */
+template<typename BasicJsonType>
+class request_parser {
+public:
+    /**
+     * @brief A single entry of the parsed request.
+     *
+     * @details For a non-batch request, there is exactly one entry. For a batch request, there is one entry per
+     * element of the batch array.
+     */
+    struct entry {
+        bool is_object = false;             ///< Whether the entry is a JSON object.
+        std::optional<std::string> jsonrpc; ///< The `jsonrpc` member; `std::nullopt` if missing or not a string.
+        std::optional<std::string> method;  ///< The `method` member; `std::nullopt` if missing or not a string.
+        BasicJsonType params = BasicJsonType::value_t::discarded;  ///< The `params` member; discarded if missing.
+        BasicJsonType id     = BasicJsonType::value_t::discarded;  ///< The `id` member; discarded if missing.
+        BasicJsonType extra;  ///< Non-standard members of the request; `null` if there are none.
+
+        /**
+         * @brief Returns the request ID to use in a response.
+         *
+         * @return The request ID if it is present and valid, `null` otherwise.
+         * @see get_request_id()
+         */
+        [[nodiscard]] BasicJsonType response_id() const;
+
+        /**
+         * @brief Converts the entry into a validated JSON RPC request.
+         *
+         * @return The JSON RPC request with `null` extra fields, or the error if the request is invalid.
+         * @see details::try_parse_envelope()
+         */
+        expected<basic_jsonrpc_request<BasicJsonType>> to_request();
+
+        /**
+         * @brief Moves the extra fields out of the entry.
+         *
+         * @return The object with the non-standard members of the request.
+         */
+        BasicJsonType take_extra();
+    };
+
+    /**
+     * @brief Constructs the parser.
+     *
+     * @param resource The memory resource for the bookkeeping of the parser; it must outlive the parser.
+     */
+    explicit request_parser(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : m_entries(resource), m_stack(resource)
+    {}
+
+    /**
+     * @brief Parses @a input.
+     *
+     * @param input The raw JSON text, or the request encoded in a binary format.
+     * @param format The encoding of @a input.
+     * @retval true The input is a well-formed document.
+     * @retval false A parse error occurred; use error() to get the error message.
+     */
+    bool parse(
+        std::string_view input, typename BasicJsonType::input_format_t format = BasicJsonType::input_format_t::json
+    );
+
+    /**
+     * @brief Checks whether the parsed document is a batch request.
+     *
+     * @return Whether the top-level value is an array.
+     */
+    [[nodiscard]] bool is_batch() const noexcept { return this->m_is_batch; }
+
+    /**
+     * @brief Returns the parsed entries.
+     *
+     * @return Parsed entries.
+     */
+    [[nodiscard]] std::pmr::vector<entry>& entries() noexcept { return this->m_entries; }
+
+    /**
+     * @brief Returns the parse error message.
+     *
+     * @return The error message if parse() failed.
+     */
+    [[nodiscard]] const std::string& error() const noexcept { return this->m_error; }
+
+    /**
+     * @name SAX Interface
+     * @brief Callbacks invoked by `BasicJsonType::sax_parse()`.
+     * @see https://json.nlohmann.me/api/json_sax/
+     * @{
+     */
+    bool null();
+    bool boolean(bool val);
+    bool number_integer(typename BasicJsonType::number_integer_t val);
+    bool number_unsigned(typename BasicJsonType::number_unsigned_t val);
+    bool number_float(typename BasicJsonType::number_float_t val, const typename BasicJsonType::string_t&);
+    bool string(typename BasicJsonType::string_t& val);
+    bool binary(typename BasicJsonType::binary_t& val);
+    bool start_object(std::size_t);
+    bool key(typename BasicJsonType::string_t& val);
+    bool end_object();
+    bool start_array(std::size_t);
+    bool end_array();
+    bool parse_error(std::size_t, const std::string&, const typename BasicJsonType::exception& ex);
+    /** @} */
+
+private:
+    /**
+     * @brief The envelope member whose value is being parsed.
+     */
+    enum class member : std::uint8_t {
+        none,     ///< Not inside a request object.
+        jsonrpc,  ///< The `jsonrpc` member.
+        method,   ///< The `method` member.
+        value,    ///< `params`, `id`, or an extra member; the value is stored into `m_target`.
+    };
+
+    std::pmr::vector<entry> m_entries;         ///< Parsed entries.
+    std::pmr::vector<BasicJsonType*> m_stack;  ///< Containers of the DOM value being built.
+    BasicJsonType* m_target = nullptr;         ///< Where to store the DOM value being built.
+    BasicJsonType m_scratch;                   ///< Storage for values that are not needed.
+    std::string m_key;                         ///< The key of the next member in the DOM value being built.
+    std::string m_error;                       ///< Parse error message.
+    std::size_t m_depth = 0;                   ///< Nesting level of the batch array and request objects.
+    member m_member     = member::none;        ///< The member being parsed.
+    bool m_is_batch     = false;               ///< Whether the top-level value is an array.
+
+    /**
+     * @brief Handles a scalar value.
+     *
+     * @param val The value.
+     * @return Always `true`.
+     */
+    bool scalar(BasicJsonType&& val);
+
+    /**
+     * @brief Handles the beginning of an object or array.
+     *
+     * @param type `value_t::object` or `value_t::array`.
+     * @return Always `true`.
+     *
+     * @details The container is created only if it is a part of a DOM value: the batch array and the request objects
+     * are not materialized.
+     */
+    bool start_container(typename BasicJsonType::value_t type);
+
+    /**
+     * @brief Handles the end of an object or array.
+     *
+     * @return Always `true`.
+     */
+    bool end_container();
+
+    /**
+     * @brief Stores @a val into the DOM value being built.
+     *
+     * @param val The value.
+     * @return Pointer to the stored value.
+     */
+    BasicJsonType* store(BasicJsonType&& val);
+
+    /**
+     * @brief Returns the depth at which request objects reside.
+     *
+     * @return 1 for a non-batch request, 2 for a batch request.
+     */
+    [[nodiscard]] std::size_t envelope_depth() const noexcept { return this->m_is_batch ? 2 : 1; }
+};
+
+extern template class request_parser<nlohmann::json>;
+extern template class request_parser<nlohmann::ordered_json>;
+
+}  // namespace wwa::json_rpc
+
+#endif /* B1D0C6A2_5E3F_4C57_9A0E_7F2B6C4D8E91 */
@@ -0,0 +1,938 @@
+/**
+ * @file
+ * @brief Implementation of the socket server.
+ */
+
+#include "server.h"
+#include "server_p.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <span>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include "exception.h"
+#include "id_generator.h"
+#include "utils.h"
+
+#ifdef WWA_JSONRPC_HAVE_IO_URING
+#    include "server_uring_p.h"
+#endif
+
+namespace {
+
+/**
+ * @brief The size of the length prefix of a message.
+ * @internal
+ */
+constexpr std::size_t prefix_size = 4;
+
+/**
+ * @brief The maximum number of connections accepted at once by a reactor.
+ * @internal
+ *
+ * @details The listening sockets are level-triggered, so the connections left are accepted on the next iteration,
+ * possibly by another reactor.
+ */
+constexpr int accept_batch = 64;
+
+/**
+ * @brief Returns the `epoll` events of a listening socket.
+ * @internal
+ *
+ * @param l The listening socket.
+ * @return The events.
+ */
+std::uint32_t listener_events(const wwa::json_rpc::listener& l) noexcept
+{
+    // EPOLLEXCLUSIVE is only meaningful for the sockets shared by several reactors
+    return l.owner == wwa::json_rpc::listener::shared ? EPOLLIN | EPOLLEXCLUSIVE : EPOLLIN;
+}
+
+/**
+ * @brief Returns the response to a message that exceeds `server_options::max_message_size`.
+ * @internal
+ *
+ * @return The serialized error response.
+ */
+const std::string& too_large_response()
+{
+    static const std::string response =
+        wwa::json_rpc::generate_error_response(
+            wwa::json_rpc::exception(wwa::json_rpc::exception::INVALID_REQUEST, wwa::json_rpc::err_request_too_large)
+        )
+            .dump();
+
+    return response;
+}
+
+/**
+ * @brief Throws `std::system_error` for the current value of `errno`.
+ * @internal
+ *
+ * @param what The name of the failed function.
+ */
+[[noreturn]] void throw_errno(const char* what)
+{
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+/**
+ * @brief Decodes a 32-bit big-endian integer.
+ * @internal
+ *
+ * @param p The encoded integer.
+ * @return The integer.
+ */
+std::size_t decode_length(const char* p) noexcept
+{
+    const auto* u = reinterpret_cast<const unsigned char*>(p);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    return (static_cast<std::size_t>(u[0]) << 24U) | (static_cast<std::size_t>(u[1]) << 16U) |
+           (static_cast<std::size_t>(u[2]) << 8U) | static_cast<std::size_t>(u[3]);
+}
+
+/**
+ * @brief Encodes a 32-bit big-endian integer.
+ * @internal
+ *
+ * @param p The buffer.
+ * @param n The integer.
+ */
+void encode_length(char* p, std::size_t n) noexcept
+{
+    p[0] = static_cast<char>((n >> 24U) & 0xFFU);
+    p[1] = static_cast<char>((n >> 16U) & 0xFFU);
+    p[2] = static_cast<char>((n >> 8U) & 0xFFU);
+    p[3] = static_cast<char>(n & 0xFFU);
+}
+
+}  // namespace
+
+namespace wwa::json_rpc {
+
+reactor::reactor(message_handler handler, const server_options& options)
+    : m_options(options), m_handler(std::move(handler))
+{}
+
+reactor::~reactor() = default;
+
+void reactor::receive(connection& conn, std::string_view data)
+{
+    if (conn.input.empty()) {
+        // Fast path: the messages are parsed in the read buffer, only an incomplete one is copied
+        const auto consumed = this->consume(conn, data);
+        conn.input.assign(data.substr(consumed));
+    }
+    else {
+        conn.input.append(data);
+        const auto consumed = this->consume(conn, conn.input);
+        if (consumed == conn.input.size()) {
+            std::string().swap(conn.input);
+        }
+        else {
+            conn.input.erase(0, consumed);
+        }
+    }
+}
+
+std::size_t reactor::consume(connection& conn, std::string_view data)
+{
+    switch (this->m_options.framing) {
+        case framing_type::length_prefixed:
+            return this->consume_length_prefixed(conn, data);
+
+        case framing_type::http:
+            return this->consume_http(conn, data);
+
+        case framing_type::ndjson:
+        default:
+            return this->consume_ndjson(conn, data);
+    }
+}
+
+std::size_t reactor::consume_ndjson(connection& conn, std::string_view data)
+{
+    std::size_t consumed = 0;
+    while (consumed < data.size()) {
+        const auto rest = data.substr(consumed);
+        const auto eol  = rest.find('\n');
+        if (eol == std::string_view::npos) {
+            if (rest.size() > this->m_options.max_message_size) {
+                if (!conn.skipping_line) {
+                    this->reject();
+                    conn.skipping_line = true;
+                }
+
+                consumed = data.size();
+            }
+
+            break;
+        }
+
+        consumed += eol + 1;
+        if (std::exchange(conn.skipping_line, false)) {
+            continue;
+        }
+
+        auto line = rest.substr(0, eol);
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+
+        if (line.size() > this->m_options.max_message_size) {
+            this->reject();
+        }
+        else if (!line.empty()) {
+            this->process(line);
+        }
+    }
+
+    return consumed;
+}
+
+std::size_t reactor::consume_length_prefixed(connection& conn, std::string_view data)
+{
+    std::size_t consumed = 0;
+    while (true) {
+        const auto rest = data.substr(consumed);
+        if (conn.skip != 0) {
+            const auto n = std::min(conn.skip, rest.size());
+            conn.skip -= n;
+            consumed += n;
+            if (conn.skip != 0) {
+                break;
+            }
+
+            continue;
+        }
+
+        if (rest.size() < prefix_size) {
+            break;
+        }
+
+        const auto length = decode_length(rest.data());
+        if (length > this->m_options.max_message_size) {
+            this->reject();
+            conn.skip = length;
+            consumed += prefix_size;
+            continue;
+        }
+
+        if (rest.size() - prefix_size < length) {
+            break;
+        }
+
+        this->process(rest.substr(prefix_size, length));
+        consumed += prefix_size + length;
+    }
+
+    return consumed;
+}
+
+void reactor::process(std::string_view message)
+{
+    reactor_counters::add(this->m_counters.messages, 1);
+
+    const auto offset = this->m_output.size();
+    if (this->m_options.framing == framing_type::length_prefixed) {
+        this->m_output.append(prefix_size, '\0');
+        if (this->m_handler(message, this->m_output)) {
+            encode_length(this->m_output.data() + offset, this->m_output.size() - offset - prefix_size);
+            reactor_counters::add(this->m_counters.responses, 1);
+        }
+        else {
+            this->m_output.resize(offset);
+        }
+    }
+    else if (this->m_handler(message, this->m_output)) {
+        this->m_output.push_back('\n');
+        reactor_counters::add(this->m_counters.responses, 1);
+    }
+}
+
+bool reactor::accept_failed(int error) noexcept
+{
+    return error == EMFILE || error == ENFILE || error == ENOBUFS || error == ENOMEM;
+}
+
+bool reactor::half_close(connection& conn) noexcept
+{
+    conn.linger      = false;
+    conn.eof         = false;
+    conn.read_paused = false;
+    conn.discard     = true;
+
+    this->count_syscall();
+    return ::shutdown(conn.fd, SHUT_WR) == 0;
+}
+
+void reactor::reject()
+{
+    reactor_counters::add(this->m_counters.messages, 1);
+    reactor_counters::add(this->m_counters.responses, 1);
+
+    const auto& response = too_large_response();
+    if (this->m_options.framing == framing_type::length_prefixed) {
+        const auto offset = this->m_output.size();
+        this->m_output.append(prefix_size, '\0');
+        encode_length(this->m_output.data() + offset, response.size());
+        this->m_output.append(response);
+    }
+    else {
+        this->m_output.append(response).push_back('\n');
+    }
+}
+
+epoll_reactor::epoll_reactor(
+    message_handler handler, const server_options& options, io_object& wakeup, const std::vector<listener*>& listeners
+)
+    : reactor(std::move(handler), options), m_epoll(::epoll_create1(EPOLL_CLOEXEC)),
+      m_input(std::max<std::size_t>(options.read_size, 1))
+{
+    if (this->m_epoll == -1) {
+        throw_errno("epoll_create1");
+    }
+
+    try {
+        this->add(wakeup, EPOLLIN);
+        for (auto* l : listeners) {
+            this->add(*l, listener_events(*l));
+        }
+    }
+    catch (...) {
+        ::close(this->m_epoll);
+        throw;
+    }
+}
+
+epoll_reactor::~epoll_reactor()
+{
+    for (const auto& conn : this->m_connections) {
+        ::close(conn->fd);
+    }
+
+    ::close(this->m_epoll);
+}
+
+void epoll_reactor::add(io_object& obj, std::uint32_t events)
+{
+    epoll_event ev{};
+    ev.events   = events;
+    ev.data.ptr = &obj;
+    if (::epoll_ctl(this->m_epoll, EPOLL_CTL_ADD, obj.fd, &ev) == -1) {
+        throw_errno("epoll_ctl");
+    }
+}
+
+void epoll_reactor::run()
+{
+    std::array<epoll_event, 256> events{};
+    while (true) {
+        const int timeout = this->m_paused.empty() ? -1 : static_cast<int>(accept_retry_delay.count());
+        const int n       = ::epoll_wait(this->m_epoll, events.data(), static_cast<int>(events.size()), timeout);
+        this->count_syscall();
+        if (n == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            throw_errno("epoll_wait");
+        }
+
+        if (n == 0) {
+            this->resume_accepting();
+            continue;
+        }
+
+        for (const auto& ev : std::span(events.data(), static_cast<std::size_t>(n))) {
+            auto* obj = static_cast<io_object*>(ev.data.ptr);
+            switch (obj->type) {
+                case io_object::kind::wakeup:
+                    return;
+
+                case io_object::kind::listener:
+                    this->accept(*static_cast<listener*>(obj));
+                    break;
+
+                case io_object::kind::connection: {
+                    auto& conn = *static_cast<connection*>(obj);
+                    if ((ev.events & EPOLLERR) != 0U) {
+                        this->close(conn);
+                        break;
+                    }
+
+                    const bool drain = (ev.events & (EPOLLRDHUP | EPOLLHUP)) != 0U;
+                    if ((ev.events & EPOLLOUT) != 0U && !this->on_writable(conn)) {
+                        break;
+                    }
+
+                    if ((ev.events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP)) != 0U) {
+                        this->on_readable(conn, drain);
+                    }
+
+                    break;
+                }
+            }
+        }
+    }
+}
+
+void epoll_reactor::accept(listener& l)
+{
+    for (int i = 0; i < accept_batch; ++i) {
+        const int fd = ::accept4(l.fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        this->count_syscall();
+        if (fd == -1) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+
+            if (accept_failed(errno) && ::epoll_ctl(this->m_epoll, EPOLL_CTL_DEL, l.fd, nullptr) == 0) {
+                // The socket is level-triggered: retry when a connection is closed, not on the next iteration
+                this->m_paused.push_back(&l);
+            }
+
+            return;
+        }
+
+        if (l.tcp) {
+            const int one = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        }
+
+        auto conn   = std::make_unique<connection>();
+        conn->fd    = fd;
+        conn->type  = io_object::kind::connection;
+        conn->index = this->m_connections.size();
+
+        try {
+            this->add(*conn, EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET);
+            this->m_connections.push_back(std::move(conn));
+        }
+        catch (const std::exception&) {
+            ::close(fd);
+            continue;
+        }
+
+        reactor_counters::add(this->m_counters.connections_accepted, 1);
+    }
+}
+
+bool epoll_reactor::on_readable(connection& conn, bool drain)
+{
+    while (!conn.read_paused && !conn.eof) {
+        const auto n = ::recv(conn.fd, this->m_input.data(), this->m_input.size(), 0);
+        this->count_syscall();
+        if (n > 0) {
+            if (conn.discard) {
+                continue;
+            }
+
+            const auto size = static_cast<std::size_t>(n);
+            reactor_counters::add(this->m_counters.bytes_read, size);
+
+            try {
+                this->receive(conn, {this->m_input.data(), size});
+            }
+            catch (const std::exception&) {
+                this->m_output.clear();
+                this->close(conn);
+                return false;
+            }
+
+            if (!this->send_output(conn)) {
+                return false;
+            }
+
+            if (!drain && size < this->m_input.size()) {
+                // See epoll(7): a short read means that the socket buffer has been drained
+                break;
+            }
+        }
+        else if (n == 0) {
+            conn.eof = true;
+        }
+        else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            break;
+        }
+        else if (errno != EINTR) {
+            this->close(conn);
+            return false;
+        }
+    }
+
+    return this->close_if_done(conn);
+}
+
+bool epoll_reactor::on_writable(connection& conn)
+{
+    if (!this->send_pending(conn)) {
+        return false;
+    }
+
+    if (conn.read_paused && conn.output.size() <= this->m_options.max_pending_output) {
+        // The socket may still have unread data, and no new edge is going to report it
+        conn.read_paused = false;
+        return this->on_readable(conn, true);
+    }
+
+    return this->close_if_done(conn);
+}
+
+bool epoll_reactor::send_output(connection& conn)
+{
+    if (this->m_output.empty()) {
+        return true;
+    }
+
+    std::string_view data = this->m_output;
+    if (conn.output.empty()) {
+        const auto n = this->write(conn, data);
+        if (n < 0) {
+            this->m_output.clear();
+            return false;
+        }
+
+        data.remove_prefix(static_cast<std::size_t>(n));
+    }
+
+    // Keep the order of the responses: what cannot be sent now goes after the pending ones
+    conn.output.append(data);
+    this->m_output.clear();
+
+    if (conn.output.size() > this->m_options.max_pending_output) {
+        conn.read_paused = true;
+    }
+
+    return true;
+}
+
+bool epoll_reactor::send_pending(connection& conn)
+{
+    if (conn.output.empty()) {
+        return true;
+    }
+
+    const auto n = this->write(conn, conn.output);
+    if (n < 0) {
+        return false;
+    }
+
+    if (static_cast<std::size_t>(n) == conn.output.size()) {
+        std::string().swap(conn.output);
+    }
+    else {
+        conn.output.erase(0, static_cast<std::size_t>(n));
+    }
+
+    return true;
+}
+
+std::ptrdiff_t epoll_reactor::write(connection& conn, std::string_view data)
+{
+    std::size_t written = 0;
+    while (written < data.size()) {
+        const auto n = ::send(conn.fd, data.data() + written, data.size() - written, MSG_NOSIGNAL);
+        this->count_syscall();
+        if (n >= 0) {
+            written += static_cast<std::size_t>(n);
+        }
+        else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            break;
+        }
+        else if (errno != EINTR) {
+            this->close(conn);
+            return -1;
+        }
+    }
+
+    reactor_counters::add(this->m_counters.bytes_written, written);
+    return static_cast<std::ptrdiff_t>(written);
+}
+
+bool epoll_reactor::close_if_done(connection& conn)
+{
+    if (!conn.eof || !conn.output.empty()) {
+        return true;
+    }
+
+    if (conn.linger && this->half_close(conn)) {
+        // Whatever the client has sent so far is not going to be reported by a new edge
+        return this->on_readable(conn, true);
+    }
+
+    this->close(conn);
+    return false;
+}
+
+void epoll_reactor::resume_accepting()
+{
+    std::erase_if(this->m_paused, [this](listener* l) {
+        try {
+            this->add(*l, listener_events(*l));
+            return true;
+        }
+        catch (const std::system_error&) {
+            return false;
+        }
+    });
+}
+
+void epoll_reactor::close(connection& conn)
+{
+    ::close(conn.fd);
+
+    const auto index = conn.index;
+    if (index != this->m_connections.size() - 1) {
+        this->m_connections[index]        = std::move(this->m_connections.back());
+        this->m_connections[index]->index = index;
+    }
+
+    this->m_connections.pop_back();
+    reactor_counters::add(this->m_counters.connections_closed, 1);
+
+    if (!this->m_paused.empty()) {
+        this->resume_accepting();
+    }
+}
+
+server_private::server_private(handler_factory&& factory, const server_options& options)
+    : m_factory(std::move(factory)), m_options(options), m_wakeup{-1, io_object::kind::wakeup}
+{
+    if (this->m_options.threads == 0) {
+        this->m_options.threads = std::max(1U, std::thread::hardware_concurrency());
+    }
+
+#ifdef WWA_JSONRPC_HAVE_IO_URING
+    if (options.backend == server_backend::io_uring && uring_reactor::supported()) {
+        this->m_backend = server_backend::io_uring;
+    }
+#endif
+
+    this->m_wakeup.fd = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (this->m_wakeup.fd == -1) {
+        throw_errno("eventfd");
+    }
+}
+
+server_private::~server_private()
+{
+    this->stop();
+
+    for (const auto& l : this->m_listeners) {
+        ::close(l->fd);
+        if (!l->path.empty()) {
+            ::unlink(l->path.c_str());
+        }
+    }
+
+    ::close(this->m_wakeup.fd);
+}
+
+void server_private::ensure_stopped() const
+{
+    if (!this->m_threads.empty()) {
+        throw std::logic_error("The server is running");
+    }
+}
+
+void server_private::bind_and_listen(
+    int fd, const void* addr, std::size_t len, bool tcp, const std::string& path, std::size_t owner
+)
+{
+    if (::bind(fd, static_cast<const sockaddr*>(addr), static_cast<socklen_t>(len)) == -1 ||
+        ::listen(fd, this->m_options.backlog) == -1)
+    {
+        const int err = errno;
+        ::close(fd);
+        throw std::system_error(err, std::generic_category(), "bind");
+    }
+
+    auto l  = std::make_unique<listener>();
+    l->fd    = fd;
+    l->type  = io_object::kind::listener;
+    l->tcp   = tcp;
+    l->path  = path;
+    l->owner = owner;
+    this->m_listeners.push_back(std::move(l));
+}
+
+std::uint16_t server_private::listen_tcp(const std::string& address, std::uint16_t port)
+{
+    this->ensure_stopped();
+
+    sockaddr_storage addr{};
+    std::size_t len = 0;
+
+    auto* in4 = reinterpret_cast<sockaddr_in*>(&addr);   // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    auto* in6 = reinterpret_cast<sockaddr_in6*>(&addr);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    if (::inet_pton(AF_INET, address.c_str(), &in4->sin_addr) == 1) {
+        in4->sin_family = AF_INET;
+        in4->sin_port   = htons(port);
+        len             = sizeof(sockaddr_in);
+    }
+    else if (::inet_pton(AF_INET6, address.c_str(), &in6->sin6_addr) == 1) {
+        in6->sin6_family = AF_INET6;
+        in6->sin6_port   = htons(port);
+        len              = sizeof(sockaddr_in6);
+    }
+    else {
+        throw std::system_error(EINVAL, std::generic_category(), "inet_pton");
+    }
+
+    // In the thread-per-core mode, every reactor gets its own socket; the first one picks the port if it is 0
+    const auto count = this->m_options.thread_per_core ? this->m_options.threads : 1;
+    const auto first = this->m_listeners.size();
+    try {
+        for (std::size_t i = 0; i < count; ++i) {
+            const int fd = ::socket(addr.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+            if (fd == -1) {
+                throw_errno("socket");
+            }
+
+            const int one = 1;
+            ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+            if (count > 1 && ::setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one)) == -1) {
+                const int err = errno;
+                ::close(fd);
+                throw std::system_error(err, std::generic_category(), "setsockopt");
+            }
+
+            this->bind_and_listen(fd, &addr, len, true, {}, this->m_options.thread_per_core ? i : listener::shared);
+
+            auto addr_len = static_cast<socklen_t>(sizeof(addr));
+            if (::getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &addr_len) == -1) {  // NOLINT(*-reinterpret-cast)
+                throw_errno("getsockname");
+            }
+        }
+    }
+    catch (...) {
+        for (auto i = first; i < this->m_listeners.size(); ++i) {
+            ::close(this->m_listeners[i]->fd);
+        }
+
+        this->m_listeners.resize(first);
+        throw;
+    }
+
+    return ntohs(addr.ss_family == AF_INET ? in4->sin_port : in6->sin6_port);
+}
+
+void server_private::listen_unix(const std::string& path)
+{
+    this->ensure_stopped();
+
+    sockaddr_un addr{};
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+        throw std::system_error(ENAMETOOLONG, std::generic_category(), "bind");
+    }
+
+    addr.sun_family = AF_UNIX;
+    std::memcpy(static_cast<char*>(addr.sun_path), path.data(), path.size());
+
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd == -1) {
+        throw_errno("socket");
+    }
+
+    this->bind_and_listen(fd, &addr, sizeof(addr), false, path);
+}
+
+std::vector<listener*> server_private::listeners_of(std::size_t index) const
+{
+    std::vector<listener*> result;
+    for (const auto& l : this->m_listeners) {
+        if (l->owner == listener::shared || l->owner == index) {
+            result.push_back(l.get());
+        }
+    }
+
+    return result;
+}
+
+std::unique_ptr<reactor> server_private::make_reactor(std::size_t index)
+{
+#ifdef WWA_JSONRPC_HAVE_IO_URING
+    if (this->m_backend == server_backend::io_uring) {
+        try {
+            return std::make_unique<uring_reactor>(
+                this->m_factory(), this->m_options, this->m_wakeup, this->listeners_of(index)
+            );
+        }
+        catch (const std::system_error&) {
+            if (!this->m_reactors.empty()) {
+                throw;
+            }
+
+            // The kernel supports io_uring but refuses to create the instance, e.g., because of resource limits
+            this->m_backend = server_backend::epoll;
+        }
+    }
+#endif
+
+    return std::make_unique<epoll_reactor>(
+        this->m_factory(), this->m_options, this->m_wakeup, this->listeners_of(index)
+    );
+}
+
+void server_private::run_reactor(reactor& r, std::size_t index) const
+{
+    if (this->m_options.thread_per_core) {
+        core_id_generator gen(index);
+        const id_generator_scope scope(gen);
+        r.run();
+    }
+    else {
+        r.run();
+    }
+}
+
+void server_private::pin(std::thread& thread, std::size_t index)
+{
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (::sched_getaffinity(0, sizeof(allowed), &allowed) == -1) {
+        throw_errno("sched_getaffinity");
+    }
+
+    const auto count = static_cast<std::size_t>(CPU_COUNT(&allowed));
+    auto n           = index % std::max<std::size_t>(count, 1);
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &allowed) && n-- == 0) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpu, &set);
+            if (const int err = ::pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set); err != 0) {
+                throw std::system_error(err, std::generic_category(), "pthread_setaffinity_np");
+            }
+
+            return;
+        }
+    }
+}
+
+void server_private::start()
+{
+    this->ensure_stopped();
+
+    std::uint64_t value = 0;
+    while (::read(this->m_wakeup.fd, &value, sizeof(value)) > 0) {
+        // Reset the wakeup file descriptor after the previous stop()
+    }
+
+    try {
+        for (std::size_t i = 0; i < this->m_options.threads; ++i) {
+            this->m_reactors.push_back(this->make_reactor(i));
+        }
+
+        for (std::size_t i = 0; i < this->m_reactors.size(); ++i) {
+            this->m_threads.emplace_back([this, &r = *this->m_reactors[i], i]() { this->run_reactor(r, i); });
+            if (this->m_options.pin_threads) {
+                server_private::pin(this->m_threads.back(), i);
+            }
+        }
+    }
+    catch (...) {
+        this->stop();
+        throw;
+    }
+}
+
+void server_private::stop()
+{
+    const std::uint64_t value = 1;
+    if (::write(this->m_wakeup.fd, &value, sizeof(value)) == -1 && errno != EAGAIN) {
+        std::terminate();
+    }
+
+    for (auto& thread : this->m_threads) {
+        thread.join();
+    }
+
+    this->m_stopped                  = this->stats();
+    this->m_stopped.connections_open = 0;
+
+    this->m_threads.clear();
+    this->m_reactors.clear();
+}
+
+server_backend server_private::backend() const noexcept
+{
+    return this->m_backend;
+}
+
+server_stats server_private::stats() const noexcept
+{
+    auto result = this->m_stopped;
+
+    std::uint64_t closed = 0;
+    for (const auto& r : this->m_reactors) {
+        const auto& c = r->counters();
+        result.connections_accepted += c.connections_accepted.load(std::memory_order_relaxed);
+        closed += c.connections_closed.load(std::memory_order_relaxed);
+        result.messages += c.messages.load(std::memory_order_relaxed);
+        result.responses += c.responses.load(std::memory_order_relaxed);
+        result.bytes_read += c.bytes_read.load(std::memory_order_relaxed);
+        result.bytes_written += c.bytes_written.load(std::memory_order_relaxed);
+        result.syscalls += c.syscalls.load(std::memory_order_relaxed);
+    }
+
+    result.connections_open = result.connections_accepted - this->m_stopped.connections_accepted - closed;
+    return result;
+}
+
+server::server(handler_factory factory, const server_options& options)
+    : d_ptr(std::make_unique<server_private>(std::move(factory), options))
+{}
+
+server::~server() = default;
+
+std::uint16_t server::listen_tcp(const std::string& address, std::uint16_t port)
+{
+    return this->d_ptr->listen_tcp(address, port);
+}
+
+void server::listen_unix(const std::string& path)
+{
+    this->d_ptr->listen_unix(path);
+}
+
+void server::start()
+{
+    this->d_ptr->start();
+}
+
+void server::stop()
+{
+    this->d_ptr->stop();
+}
+
+server_backend server::backend() const noexcept
+{
+    return this->d_ptr->backend();
+}
+
+server_stats server::stats() const noexcept
+{
+    return this->d_ptr->stats();
+}
+
+}  // namespace wwa::json_rpc
@@ -0,0 +1,265 @@
+#ifndef C4E8A2F6_1D3B_4B79_9F05_6A2E7D4C18B3
+#define C4E8A2F6_1D3B_4B79_9F05_6A2E7D4C18B3
+
+/**
+ * @file
+ * @brief Defines a socket server that passes the requests received over Unix-domain and TCP sockets to a dispatcher.
+ *
+ * @details The server uses `epoll` or `io_uring` and is available on Linux only, in the `wwa_jsonrpc_server` library.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "dispatcher.h"
+#include "export.h"
+#include "stream.h"
+
+namespace wwa::json_rpc {
+
+/**
+ * @brief The framing of the messages exchanged with the clients of a `server`.
+ */
+enum class framing_type : std::uint8_t {
+    ndjson,           ///< One message per line, as in run_ndjson_stream().
+    length_prefixed,  ///< Every message is preceded by its size as a 32-bit big-endian integer.
+    http              ///< Every message is the body of an HTTP/1.1 `POST` request.
+};
+
+/**
+ * @brief The I/O backend of a `server`.
+ */
+enum class server_backend : std::uint8_t {
+    epoll,    ///< Edge-triggered `epoll` with non-blocking `recv()` and `send()`.
+    io_uring  ///< `io_uring` with multishot accept and receive into a ring of provided buffers.
+};
+
+/**
+ * @brief Options of the socket server.
+ */
+struct server_options {
+    std::size_t threads            = 0;                       ///< The number of reactor threads; `0` means one per core.
+    framing_type framing           = framing_type::ndjson;    ///< The framing of the messages.
+    std::size_t read_size          = 64UL * 1024UL;           ///< The size of the read buffer of every thread.
+    std::size_t max_message_size   = 16UL * 1024UL * 1024UL;  ///< Longer messages are rejected with `INVALID_REQUEST`.
+    std::size_t max_pending_output = 4UL * 1024UL * 1024UL;   ///< Reading pauses while more unsent bytes are queued.
+    int backlog                    = 1024;                    ///< The backlog of the listening sockets.
+    server_backend backend         = server_backend::epoll;   ///< The preferred I/O backend.
+    std::size_t ring_buffers       = 256;                     ///< `io_uring`: the number of buffers of every thread.
+    std::size_t ring_buffer_size   = 16UL * 1024UL;           ///< `io_uring`: the size of every buffer.
+    bool thread_per_core           = false;                   ///< Every thread gets its own TCP listening sockets.
+    bool pin_threads               = false;                   ///< Pins every thread to one of the allowed CPUs.
+};
+
+/**
+ * @brief Statistics of a socket server.
+ */
+struct server_stats {
+    std::uint64_t connections_accepted = 0;  ///< The number of accepted connections.
+    std::uint64_t connections_open     = 0;  ///< The number of open connections.
+    std::uint64_t messages             = 0;  ///< The number of processed messages.
+    std::uint64_t responses            = 0;  ///< The number of responses.
+    std::uint64_t bytes_read           = 0;  ///< The number of bytes read.
+    std::uint64_t bytes_written        = 0;  ///< The number of bytes written.
+    std::uint64_t syscalls             = 0;  ///< The number of system calls made by the reactor threads.
+};
+
+/**
+ * @brief Creates the message handlers of the reactor threads.
+ *
+ * @details The factory is called once per thread; a handler is only ever called by the thread it was created for.
+ */
+using handler_factory = std::function<message_handler()>;
+
+namespace details {
+
+/**
+ * @brief Returns a handler factory that passes the messages to a dispatcher.
+ * @internal
+ *
+ * @tparam Context The type of the data passed to the handlers.
+ * @tparam BasicJsonType The JSON type (a `nlohmann::basic_json` specialization).
+ * @param dispatcher The dispatcher.
+ * @param data The data passed to the handlers of the dispatcher; it is copied.
+ * @return The factory; every handler has its own arena for the bookkeeping of the requests.
+ */
+template<typename Context, typename BasicJsonType>
+handler_factory make_handler_factory(basic_dispatcher<Context, BasicJsonType>& dispatcher, const Context& data)
+{
+    return [&dispatcher, ctx = std::make_shared<const Context>(data)]() -> message_handler {
+        auto handler = std::make_shared<dispatching_handler<Context, BasicJsonType>>(dispatcher, *ctx);
+        return [ctx, handler](std::string_view message, std::string& out) { return (*handler)(message, out); };
+    };
+}
+
+}  // namespace details
+
+class server_private;
+
+/**
+ * @brief Socket server.
+ *
+ * @details The server accepts connections on any number of Unix-domain and TCP listening sockets. Every connection
+ * belongs to one of the reactor threads: each thread waits for its sockets with an edge-triggered `epoll` instance,
+ * and the listening sockets are shared by all threads (`EPOLLEXCLUSIVE`), so that an incoming connection wakes up
+ * only one of them, which accepts and keeps the connection.
+ *
+ * The sockets are non-blocking. Every thread reads into its own buffer and collects the responses in its own output
+ * buffer; a connection gets buffers of its own only to keep an incomplete message or unsent responses.
+ * These buffers are released as soon as they are empty, so an idle connection costs about a hundred bytes
+ * besides the kernel socket buffers.
+ *
+ * With `server_options::backend` set to `server_backend::io_uring`, every thread uses an `io_uring` instance
+ * instead: the connections are accepted and read with multishot requests, the data is received into a ring of
+ * `server_options::ring_buffers` buffers provided to the kernel, and the responses are sent with one request per
+ * connection at a time, so that one system call submits the sends and waits for the next completions.
+ * The server falls back to `epoll` if the kernel does not support these features (Linux 6.0 or newer is required).
+ *
+ * With `server_options::thread_per_core` set, nothing mutable is shared between the threads on the request path:
+ * listen_tcp() creates a listening socket per thread, bound to the same port with `SO_REUSEPORT`, so that
+ * the kernel spreads the connections across the threads, and every thread takes the unique request IDs from its own
+ * `core_id_generator` (see `id_generator_scope`) instead of the generator of the dispatcher. The handler table of
+ * the dispatcher is shared read-only; call `basic_dispatcher::freeze()` before starting the server. Unix-domain
+ * sockets are still shared. With `server_options::pin_threads` set, the thread `i` is pinned to the `i`-th CPU
+ * the process is allowed to run on.
+ *
+ * The messages are framed according to `server_options::framing`. The responses are sent in the order of
+ * the requests; notifications produce no output. When more than `server_options::max_pending_output` bytes
+ * cannot be sent because the client does not read them, the server stops reading from the connection until they
+ * are sent. A message longer than `server_options::max_message_size` bytes is skipped and answered with
+ * an `INVALID_REQUEST` error.
+ *
+ * With `framing_type::http`, the server speaks a minimal HTTP/1.1: every `POST` request carries a message in its
+ * body, framed by `Content-Length` or by the `chunked` transfer coding, and the response comes back in the body of
+ * a `200 OK` response, or as `204 No Content` if there is none (a notification, or a batch of notifications).
+ * The connections are kept alive unless the client asks otherwise (or speaks HTTP/1.0 without `keep-alive`), and
+ * pipelined requests are answered in order. The response header is written into the output buffer before
+ * the response is serialized after it, and the `Content-Length` field is filled in afterwards, padded with leading
+ * whitespace, so the response is never copied. `Expect: 100-continue` is honored. Other methods get `405 Method
+ * Not Allowed`; a malformed request, or a body longer than `server_options::max_message_size` bytes, gets a 4xx
+ * response, after which the connection is closed. The server closes a connection only after the client has closed
+ * its end, discarding the rest of the input, so that the client does not lose the last response to a reset.
+ *
+ * ```cpp
+ * wwa::json_rpc::dispatcher dispatcher;
+ * // dispatcher.add(...);
+ *
+ * wwa::json_rpc::server server(dispatcher);
+ * server.listen_tcp("127.0.0.1", 8080);
+ * server.listen_unix("/run/app.sock");
+ * server.start();
+ * // ...
+ * server.stop();
+ * ```
+ */
+class WWA_JSONRPC_EXPORT server {
+public:
+    /**
+     * @brief Constructs a server that uses the handlers created by @a factory.
+     *
+     * @param factory The handler factory.
+     * @param options The options.
+     */
+    explicit server(handler_factory factory, const server_options& options = {});
+
+    /**
+     * @brief Constructs a server that passes the requests to a dispatcher.
+     *
+     * @tparam Context The type of the data passed to the handlers.
+     * @tparam BasicJsonType The JSON type (a `nlohmann::basic_json` specialization).
+     * @param dispatcher The dispatcher; it is shared by all threads and must outlive the server.
+     * @param data Optional data that can be passed to the handler function (only for handlers added with @a add_ex()).
+     * @param options The options.
+     *
+     * @details The requests are processed with `basic_dispatcher::process_request_to()`, so the handlers of
+     * the dispatcher are called from several threads at the same time and must be thread-safe.
+     */
+    template<typename Context, typename BasicJsonType>
+    explicit server(
+        basic_dispatcher<Context, BasicJsonType>& dispatcher, const std::type_identity_t<Context>& data = {},
+        const server_options& options = {}
+    )
+        : server(details::make_handler_factory(dispatcher, data), options)
+    {}
+
+    /**
+     * @brief Class destructor.
+     *
+     * @details Stops the server and removes the sockets created by listen_unix().
+     */
+    ~server();
+
+    server(const server&)            = delete;
+    server& operator=(const server&) = delete;
+    server(server&&)                 = delete;
+    server& operator=(server&&)      = delete;
+
+    /**
+     * @brief Listens on a TCP socket.
+     *
+     * @param address The numeric IPv4 or IPv6 address.
+     * @param port The port; `0` selects an ephemeral port.
+     * @return The port the socket is bound to.
+     * @throws std::system_error If the address is invalid or the socket cannot be created.
+     * @throws std::logic_error If the server is running.
+     */
+    std::uint16_t listen_tcp(const std::string& address, std::uint16_t port);
+
+    /**
+     * @brief Listens on a Unix-domain socket.
+     *
+     * @param path The path of the socket; it must not exist.
+     * @throws std::system_error If the socket cannot be created.
+     * @throws std::logic_error If the server is running.
+     */
+    void listen_unix(const std::string& path);
+
+    /**
+     * @brief Starts the reactor threads.
+     *
+     * @throws std::system_error If the threads cannot be started.
+     * @throws std::logic_error If the server is running.
+     */
+    void start();
+
+    /**
+     * @brief Stops the reactor threads and closes all connections.
+     *
+     * @details The responses that have not been sent yet are lost. The listening sockets stay open, and the server
+     * can be started again. The method must not be called from a message handler.
+     */
+    void stop();
+
+    /**
+     * @brief Returns the I/O backend of the server.
+     *
+     * @return `server_options::backend`, unless `io_uring` is not supported by the kernel (or not enabled
+     * at build time), in which case the server falls back to `epoll`.
+     */
+    [[nodiscard]] server_backend backend() const noexcept;
+
+    /**
+     * @brief Returns the statistics.
+     *
+     * @return The statistics.
+     * @details This method can be called while the server is running, from any thread.
+     */
+    [[nodiscard]] server_stats stats() const noexcept;
+
+private:
+    /**
+     * @brief Pointer to the implementation (Pimpl idiom).
+     *
+     * @details This unique pointer holds the private implementation details of the server class.
+     */
+    std::unique_ptr<server_private> d_ptr;
+};
+
+}  // namespace wwa::json_rpc
+
+#endif /* C4E8A2F6_1D3B_4B79_9F05_6A2E7D4C18B3 */
@@ -0,0 +1,467 @@
+/**
+ * @file
+ * @brief Implementation of the HTTP/1.1 framing of the socket server.
+ */
+
+#include "server_p.h"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+namespace {
+
+/**
+ * @brief The maximum size of the header of a request, and of the trailer of a chunked body.
+ * @internal
+ */
+constexpr std::size_t max_head_size = 8192;
+
+/**
+ * @brief The maximum size of a chunk-size line, including the chunk extensions.
+ * @internal
+ */
+constexpr std::size_t max_chunk_line = 1024;
+
+/**
+ * @brief The number of characters reserved for the value of the `Content-Length` field of a response.
+ * @internal
+ *
+ * @details The value is right-aligned; the unused characters are whitespace after the colon.
+ */
+constexpr std::size_t length_width = 10;
+
+constexpr std::string_view status_ok                  = "200 OK";
+constexpr std::string_view status_no_content          = "204 No Content";
+constexpr std::string_view status_bad_request         = "400 Bad Request";
+constexpr std::string_view status_not_allowed         = "405 Method Not Allowed";
+constexpr std::string_view status_too_large           = "413 Content Too Large";
+constexpr std::string_view status_header_too_large    = "431 Request Header Fields Too Large";
+constexpr std::string_view status_not_implemented     = "501 Not Implemented";
+constexpr std::string_view status_version_unsupported = "505 HTTP Version Not Supported";
+
+/**
+ * @brief The head of an HTTP request.
+ * @internal
+ */
+struct http_request {
+    std::string_view method;             ///< The method.
+    std::size_t content_length = 0;      ///< The value of the `Content-Length` field.
+    bool chunked               = false;  ///< Whether the body uses the `chunked` transfer coding.
+    bool http10                = false;  ///< Whether this is an HTTP/1.0 request.
+    bool keep_alive            = true;   ///< Whether the connection is kept open after the response.
+    bool expect_continue       = false;  ///< Whether the client waits for `100 Continue` before sending the body.
+};
+
+/**
+ * @brief The result of scanning a chunked body.
+ * @internal
+ */
+struct chunked_body {
+    std::string_view status;  ///< The status of the error response; empty if the body is valid so far.
+    std::size_t length = 0;   ///< The length of the encoded body including the trailer; `0` while it is incomplete.
+    std::size_t size   = 0;   ///< The size of the decoded body.
+    std::size_t first  = 0;   ///< The offset of the data of the first chunk.
+    std::size_t chunks = 0;   ///< The number of chunks, except the last (empty) one.
+};
+
+/**
+ * @brief Compares a string with a lowercase ASCII string, ignoring the case.
+ * @internal
+ *
+ * @param s The string.
+ * @param lower The lowercase string.
+ * @return Whether the strings are equal.
+ */
+bool iequals(std::string_view s, std::string_view lower) noexcept
+{
+    return std::ranges::equal(s, lower, [](char actual, char expected) {
+        return expected == (actual >= 'A' && actual <= 'Z' ? static_cast<char>(actual - 'A' + 'a') : actual);
+    });
+}
+
+/**
+ * @brief Removes the leading and trailing whitespace.
+ * @internal
+ *
+ * @param s The string.
+ * @return The trimmed string.
+ */
+std::string_view trim(std::string_view s) noexcept
+{
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) {
+        s.remove_prefix(1);
+    }
+
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) {
+        s.remove_suffix(1);
+    }
+
+    return s;
+}
+
+/**
+ * @brief Checks whether a comma-separated list contains a token, ignoring the case.
+ * @internal
+ *
+ * @param list The list.
+ * @param token The lowercase token.
+ * @return Whether the list contains the token.
+ */
+bool has_token(std::string_view list, std::string_view token) noexcept
+{
+    while (!list.empty()) {
+        const auto comma = list.find(',');
+        if (iequals(trim(list.substr(0, comma)), token)) {
+            return true;
+        }
+
+        list = comma == std::string_view::npos ? std::string_view{} : list.substr(comma + 1);
+    }
+
+    return false;
+}
+
+/**
+ * @brief Parses the head of a request.
+ * @internal
+ *
+ * @param head The request line and the header fields, each followed by CRLF.
+ * @param req The parsed request.
+ * @return The status of the error response; empty on success.
+ */
+std::string_view parse_head(std::string_view head, http_request& req)
+{
+    const auto eol  = head.find("\r\n");
+    const auto line = head.substr(0, eol);
+    head.remove_prefix(eol + 2);
+
+    const auto sp1 = line.find(' ');
+    const auto sp2 = line.rfind(' ');
+    if (sp1 == 0 || sp1 == std::string_view::npos || sp2 == sp1) {
+        return status_bad_request;
+    }
+
+    req.method         = line.substr(0, sp1);
+    const auto version = line.substr(sp2 + 1);
+    if (version == "HTTP/1.0") {
+        req.http10 = true;
+    }
+    else if (version != "HTTP/1.1") {
+        return version.starts_with("HTTP/") ? status_version_unsupported : status_bad_request;
+    }
+
+    bool has_length = false;
+    bool close      = false;
+    bool keep_alive = false;
+    while (!head.empty()) {
+        const auto end   = head.find("\r\n");
+        const auto field = head.substr(0, end);
+        head.remove_prefix(end + 2);
+
+        // Whitespace before the colon, or at the beginning of a line (obsolete line folding), is rejected
+        const auto colon = field.find(':');
+        if (colon == 0 || colon == std::string_view::npos || field.find_first_of(" \t") < colon) {
+            return status_bad_request;
+        }
+
+        const auto name  = field.substr(0, colon);
+        const auto value = trim(field.substr(colon + 1));
+        if (iequals(name, "content-length")) {
+            std::size_t length = 0;
+            const auto* last   = value.data() + value.size();
+            const auto result  = std::from_chars(value.data(), last, length);
+            if (value.empty() || result.ec != std::errc{} || result.ptr != last ||
+                (has_length && length != req.content_length))
+            {
+                return status_bad_request;
+            }
+
+            req.content_length = length;
+            has_length         = true;
+        }
+        else if (iequals(name, "transfer-encoding")) {
+            if (!iequals(value, "chunked") || req.chunked) {
+                return status_not_implemented;
+            }
+
+            req.chunked = true;
+        }
+        else if (iequals(name, "connection")) {
+            close      = close || has_token(value, "close");
+            keep_alive = keep_alive || has_token(value, "keep-alive");
+        }
+        else if (iequals(name, "expect")) {
+            req.expect_continue = iequals(value, "100-continue");
+        }
+    }
+
+    if (req.chunked && has_length) {
+        // See RFC 9112, section 6.3: a message with both fields may be an attempt at request smuggling
+        return status_bad_request;
+    }
+
+    req.keep_alive = !close && (!req.http10 || keep_alive);
+    return {};
+}
+
+/**
+ * @brief Scans a body in the `chunked` transfer coding.
+ * @internal
+ *
+ * @param data The input following the head of the request.
+ * @param max_size The maximum size of the decoded body.
+ * @return The result.
+ */
+chunked_body scan_chunked(std::string_view data, std::size_t max_size)
+{
+    chunked_body result;
+    std::size_t pos = 0;
+    while (true) {
+        const auto eol = data.find("\r\n", pos);
+        if (eol == std::string_view::npos) {
+            if (data.size() - pos > max_chunk_line) {
+                result.status = status_bad_request;
+            }
+
+            return result;
+        }
+
+        // The chunk extensions are ignored
+        auto line = data.substr(pos, std::min(eol, data.find(';', pos)) - pos);
+        while (!line.empty() && (line.back() == ' ' || line.back() == '\t')) {
+            line.remove_suffix(1);
+        }
+
+        const auto* last = line.data() + line.size();
+        std::size_t size = 0;
+        const auto res   = std::from_chars(line.data(), last, size, 16);
+        if (line.empty() || res.ptr != last || (res.ec != std::errc{} && res.ec != std::errc::result_out_of_range)) {
+            result.status = status_bad_request;
+            return result;
+        }
+
+        if (res.ec == std::errc::result_out_of_range || size > max_size - result.size) {
+            result.status = status_too_large;
+            return result;
+        }
+
+        pos = eol + 2;
+        if (size == 0) {
+            break;
+        }
+
+        if (pos - result.size > std::max(max_size, max_head_size)) {
+            // Many tiny chunks with long extensions
+            result.status = status_too_large;
+            return result;
+        }
+
+        if (data.size() - pos < size + 2) {
+            return result;
+        }
+
+        if (data.substr(pos + size, 2) != "\r\n") {
+            result.status = status_bad_request;
+            return result;
+        }
+
+        if (result.chunks++ == 0) {
+            result.first = pos;
+        }
+
+        result.size += size;
+        pos += size + 2;
+    }
+
+    // The trailer fields are ignored
+    const auto trailer = pos;
+    while (true) {
+        const auto eol = data.find("\r\n", pos);
+        if (eol == std::string_view::npos || eol - trailer > max_head_size) {
+            if (data.size() - trailer > max_head_size) {
+                result.status = status_header_too_large;
+            }
+
+            return result;
+        }
+
+        const bool last = eol == pos;
+        pos             = eol + 2;
+        if (last) {
+            result.length = pos;
+            return result;
+        }
+    }
+}
+
+/**
+ * @brief Decodes a body in the `chunked` transfer coding.
+ * @internal
+ *
+ * @param data The body, successfully scanned by scan_chunked().
+ * @param out The buffer for the decoded body.
+ */
+void decode_chunked(std::string_view data, std::string& out)
+{
+    while (true) {
+        const auto eol   = data.find("\r\n");
+        std::size_t size = 0;
+        std::from_chars(data.data(), data.data() + eol, size, 16);
+        if (size == 0) {
+            return;
+        }
+
+        out.append(data.substr(eol + 2, size));
+        data.remove_prefix(eol + 2 + size + 2);
+    }
+}
+
+}  // namespace
+
+namespace wwa::json_rpc {
+
+std::size_t reactor::consume_http(connection& conn, std::string_view data)
+{
+    static constexpr std::string_view crlf             = "\r\n";
+    static constexpr std::string_view close_field      = "Connection: close\r\n";
+    static constexpr std::string_view keep_alive_field = "Connection: keep-alive\r\n";
+
+    const auto fail = [this, &conn](std::string_view status) {
+        this->respond_http(status, close_field);
+        conn.eof    = true;
+        conn.linger = true;
+    };
+
+    std::size_t consumed = 0;
+    while (consumed < data.size() && !conn.eof) {
+        // See RFC 9112, section 2.2: empty lines before the request line are ignored
+        if (data.substr(consumed).starts_with(crlf)) {
+            consumed += crlf.size();
+            continue;
+        }
+
+        const auto rest = data.substr(consumed);
+        const auto end  = rest.find("\r\n\r\n");
+        if (end == std::string_view::npos || end + 2 > max_head_size) {
+            if (rest.size() > max_head_size + 2) {
+                fail(status_header_too_large);
+            }
+
+            break;
+        }
+
+        http_request req;
+        if (const auto status = parse_head(rest.substr(0, end + 2), req); !status.empty()) {
+            fail(status);
+            break;
+        }
+
+        const auto body_data = rest.substr(end + 4);
+        std::string_view body;
+        std::size_t length = 0;
+        if (req.chunked) {
+            const auto scan = scan_chunked(body_data, this->m_options.max_message_size);
+            if (!scan.status.empty()) {
+                fail(scan.status);
+                break;
+            }
+
+            length = scan.length;
+            if (length != 0 && scan.chunks > 1) {
+                this->m_body.clear();
+                decode_chunked(body_data, this->m_body);
+                body = this->m_body;
+            }
+            else {
+                // A body sent in a single chunk is processed in place
+                body = body_data.substr(scan.first, scan.size);
+            }
+        }
+        else if (req.content_length > this->m_options.max_message_size) {
+            fail(status_too_large);
+            break;
+        }
+        else if (body_data.size() >= req.content_length) {
+            length = req.content_length;
+            body   = body_data.substr(0, length);
+        }
+
+        if (length == 0 && (req.chunked || req.content_length != 0)) {
+            // The body is incomplete
+            if (req.expect_continue && !req.http10 && !conn.continued) {
+                this->m_output.append("HTTP/1.1 100 Continue\r\n\r\n");
+                conn.continued = true;
+            }
+
+            break;
+        }
+
+        consumed += end + 4 + length;
+        conn.continued = false;
+
+        const auto connection_field =
+            !req.keep_alive ? close_field : (req.http10 ? keep_alive_field : std::string_view{});
+        if (req.method == "POST") {
+            this->process_http(body, connection_field);
+        }
+        else {
+            this->respond_http(status_not_allowed, std::string("Allow: POST\r\n").append(connection_field));
+        }
+
+        conn.eof    = !req.keep_alive;
+        conn.linger = conn.eof;
+    }
+
+    // Whatever follows the last request of the connection is discarded
+    return conn.eof ? data.size() : consumed;
+}
+
+void reactor::process_http(std::string_view message, std::string_view connection_field)
+{
+    static constexpr std::string_view content_type = "Content-Type: application/json\r\nContent-Length:";
+
+    reactor_counters::add(this->m_counters.messages, 1);
+
+    // The header goes first, with room for the length, and the response is serialized right after it
+    const auto offset = this->m_output.size();
+    this->m_output.append("HTTP/1.1 ").append(status_ok).append("\r\n").append(connection_field);
+    this->m_output.append(content_type);
+    const auto field = this->m_output.size();
+    this->m_output.append(length_width, ' ').append("\r\n\r\n");
+    const auto body = this->m_output.size();
+
+    if (!this->m_handler(message, this->m_output)) {
+        this->m_output.resize(offset);
+        this->respond_http(status_no_content, connection_field);
+        return;
+    }
+
+    std::array<char, 24> digits{};
+    const auto* end = std::to_chars(digits.data(), digits.data() + digits.size(), this->m_output.size() - body).ptr;
+    const auto n    = static_cast<std::size_t>(end - digits.data());
+    if (n > length_width) {
+        // A response of 10 GB or more; its header has to be moved
+        this->m_output.insert(field, n - length_width, ' ');
+    }
+
+    std::memcpy(this->m_output.data() + field + std::max(n, length_width) - n, digits.data(), n);
+    reactor_counters::add(this->m_counters.responses, 1);
+}
+
+void reactor::respond_http(std::string_view status, std::string_view fields)
+{
+    this->m_output.append("HTTP/1.1 ").append(status).append("\r\n").append(fields);
+    if (status != status_no_content) {
+        this->m_output.append("Content-Length: 0\r\n");
+    }
+
+    this->m_output.append("\r\n");
+}
+
+}  // namespace wwa::json_rpc
@@ -0,0 +1,506 @@
+#ifndef F1B7D93A_58C2_4E6D_A0B4_3C9E2F7146D8
+#define F1B7D93A_58C2_4E6D_A0B4_3C9E2F7146D8
+
+/**
+ * @file
+ * @brief Contains the private implementation details of the socket server.
+ * @internal
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "server.h"
+
+namespace wwa::json_rpc {
+
+/**
+ * @brief A file descriptor registered with `epoll`.
+ * @internal
+ *
+ * @details `epoll_event::data.ptr` points to the object, and @a kind tells what it is.
+ */
+struct io_object {
+    /**
+     * @brief The kind of the object.
+     */
+    enum class kind : std::uint8_t {
+        wakeup,      ///< The event file descriptor that tells the reactors to stop.
+        listener,    ///< A listening socket.
+        connection,  ///< A connection.
+    };
+
+    int fd;     ///< The file descriptor.
+    kind type;  ///< The kind of the object.
+};
+
+/**
+ * @brief A listening socket.
+ * @internal
+ */
+struct listener : io_object {
+    /**
+     * @brief The owner of a listening socket shared by all reactors.
+     */
+    static constexpr std::size_t shared = static_cast<std::size_t>(-1);
+
+    bool tcp;                    ///< Whether this is a TCP socket.
+    std::string path;            ///< The path of a Unix-domain socket, removed when the socket is closed.
+    std::size_t owner = shared;  ///< The index of the only reactor that accepts on the socket.
+};
+
+/**
+ * @brief A client connection.
+ * @internal
+ *
+ * @details The buffers are empty (and own no memory) unless an incomplete message has been received, or
+ * the responses could not be sent at once.
+ */
+struct connection : io_object {
+    std::string input;           ///< The beginning of an incomplete message.
+    std::string output;          ///< The responses that have not been sent yet.
+    std::size_t index  = 0;      ///< The index of the connection in `reactor::m_connections`.
+    std::size_t skip   = 0;      ///< The number of bytes of a message that is too large left to skip.
+    bool skipping_line = false;  ///< Whether the rest of a line that is too large is skipped.
+    bool read_paused   = false;  ///< Whether reading is paused until the pending responses are sent.
+    bool continued     = false;  ///< HTTP: whether `100 Continue` has been sent for the current request.
+    bool eof           = false;  ///< Whether nothing more is read: the client or the framing has ended the input.
+    bool linger        = false;  ///< HTTP: whether the connection is half-closed, not closed, after the responses.
+    bool discard       = false;  ///< Whether the input is discarded until the client closes its end.
+};
+
+/**
+ * @brief Counters of a reactor.
+ * @internal
+ *
+ * @details The counters are only modified by the thread of the reactor and can be read from any thread.
+ */
+struct reactor_counters {
+    std::atomic_uint64_t connections_accepted{0};  ///< The number of accepted connections.
+    std::atomic_uint64_t connections_closed{0};    ///< The number of closed connections.
+    std::atomic_uint64_t messages{0};              ///< The number of processed messages.
+    std::atomic_uint64_t responses{0};             ///< The number of responses.
+    std::atomic_uint64_t bytes_read{0};            ///< The number of bytes read.
+    std::atomic_uint64_t bytes_written{0};         ///< The number of bytes written.
+    std::atomic_uint64_t syscalls{0};              ///< The number of system calls made by the event loop.
+
+    /**
+     * @brief Increments a counter.
+     *
+     * @param counter The counter.
+     * @param n The increment.
+     * @details Only one thread modifies the counter, so there is no need for a read-modify-write operation.
+     */
+    static void add(std::atomic_uint64_t& counter, std::uint64_t n) noexcept
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+};
+
+/**
+ * @brief An event loop that owns a set of connections.
+ * @internal
+ *
+ * @details The base class frames the messages and passes them to the handler; the derived classes do the I/O.
+ */
+class reactor {
+public:
+    /**
+     * @brief Constructs the reactor.
+     *
+     * @param handler The message handler.
+     * @param options The options of the server.
+     */
+    reactor(message_handler handler, const server_options& options);
+
+    /**
+     * @brief Class destructor.
+     */
+    virtual ~reactor();
+
+    reactor(const reactor&)            = delete;
+    reactor& operator=(const reactor&) = delete;
+    reactor(reactor&&)                 = delete;
+    reactor& operator=(reactor&&)      = delete;
+
+    /**
+     * @brief Runs the event loop until the wakeup file descriptor becomes readable.
+     */
+    virtual void run() = 0;
+
+    /**
+     * @brief Returns the counters.
+     *
+     * @return The counters.
+     */
+    [[nodiscard]] const reactor_counters& counters() const noexcept { return this->m_counters; }
+
+protected:
+    const server_options& m_options;  ///< The options of the server.
+    std::string m_output;             ///< The responses to the messages being processed.
+    reactor_counters m_counters;      ///< The counters.
+
+    /**
+     * @brief Processes the data received from a connection and appends the responses to `m_output`.
+     *
+     * @param conn The connection.
+     * @param data The data; an incomplete message at the end is copied to `connection::input`.
+     */
+    void receive(connection& conn, std::string_view data);
+
+    /**
+     * @brief The time after which a listening socket disarmed by accept_failed() is armed again.
+     */
+    static constexpr std::chrono::milliseconds accept_retry_delay{100};
+
+    /**
+     * @brief Counts a system call.
+     */
+    void count_syscall() noexcept { reactor_counters::add(this->m_counters.syscalls, 1); }
+
+    /**
+     * @brief Checks whether a connection could not be accepted because of a shortage of resources.
+     *
+     * @param error The error code of `accept()`.
+     * @return Whether the error is `EMFILE`, `ENFILE`, `ENOBUFS`, or `ENOMEM`.
+     * @details The pending connection stays in the backlog, so the listening socket remains readable. It has to be
+     * disarmed until a connection is closed (or until `accept_retry_delay` has passed), or the reactor would spin.
+     */
+    static bool accept_failed(int error) noexcept;
+
+    /**
+     * @brief Shuts down the sending side of a connection whose input has been ended by the framing.
+     *
+     * @param conn The connection; it is switched to discarding the input.
+     * @return Whether the connection has been shut down; if not, it has to be closed.
+     *
+     * @details See RFC 9112, section 9.6: closing a socket with unread data resets the connection, and the client,
+     * which may still be sending the request, can lose the response. Therefore, the server stops sending,
+     * and closes the connection when the client closes its end.
+     */
+    bool half_close(connection& conn) noexcept;
+
+private:
+    message_handler m_handler;  ///< The message handler.
+    std::string m_body;         ///< HTTP: the decoded body of a request split into several chunks.
+
+    /**
+     * @brief Processes all complete messages at the beginning of @a data and appends the responses to `m_output`.
+     *
+     * @param conn The connection.
+     * @param data The unprocessed input.
+     * @return The number of consumed bytes.
+     */
+    std::size_t consume(connection& conn, std::string_view data);
+
+    /**
+     * @brief Consumes newline-delimited messages.
+     *
+     * @param conn The connection.
+     * @param data The unprocessed input.
+     * @return The number of consumed bytes.
+     */
+    std::size_t consume_ndjson(connection& conn, std::string_view data);
+
+    /**
+     * @brief Consumes length-prefixed messages.
+     *
+     * @param conn The connection.
+     * @param data The unprocessed input.
+     * @return The number of consumed bytes.
+     */
+    std::size_t consume_length_prefixed(connection& conn, std::string_view data);
+
+    /**
+     * @brief Consumes HTTP requests.
+     *
+     * @param conn The connection; `connection::eof` and `connection::linger` are set when the connection is to be
+     * closed after the responses.
+     * @param data The unprocessed input.
+     * @return The number of consumed bytes.
+     * @see server_http.cpp
+     */
+    std::size_t consume_http(connection& conn, std::string_view data);
+
+    /**
+     * @brief Processes a message and appends the response to `m_output`.
+     *
+     * @param message The message.
+     */
+    void process(std::string_view message);
+
+    /**
+     * @brief Processes the body of an HTTP request and appends the HTTP response to `m_output`.
+     *
+     * @param message The message.
+     * @param connection_field The `Connection` field of the response, including the line break, or an empty string.
+     */
+    void process_http(std::string_view message, std::string_view connection_field);
+
+    /**
+     * @brief Appends an HTTP response without a body to `m_output`.
+     *
+     * @param status The status code and the reason phrase.
+     * @param fields The extra fields of the response, each followed by a line break.
+     */
+    void respond_http(std::string_view status, std::string_view fields);
+
+    /**
+     * @brief Appends the response to a message that is too large to `m_output`.
+     */
+    void reject();
+};
+
+/**
+ * @brief A reactor based on edge-triggered `epoll`.
+ * @internal
+ */
+class epoll_reactor final : public reactor {
+public:
+    /**
+     * @brief Constructs the reactor.
+     *
+     * @param handler The message handler.
+     * @param options The options of the server.
+     * @param wakeup The event file descriptor that tells the reactor to stop.
+     * @param listeners The listening sockets of the reactor.
+     * @throws std::system_error If the `epoll` instance cannot be created.
+     */
+    epoll_reactor(
+        message_handler handler, const server_options& options, io_object& wakeup,
+        const std::vector<listener*>& listeners
+    );
+
+    /**
+     * @brief Closes the connections.
+     */
+    ~epoll_reactor() override;
+
+    epoll_reactor(const epoll_reactor&)            = delete;
+    epoll_reactor& operator=(const epoll_reactor&) = delete;
+    epoll_reactor(epoll_reactor&&)                 = delete;
+    epoll_reactor& operator=(epoll_reactor&&)      = delete;
+
+    /**
+     * @brief Runs the event loop until the wakeup file descriptor becomes readable.
+     */
+    void run() override;
+
+private:
+    int m_epoll;                                             ///< The `epoll` instance.
+    std::vector<char> m_input;                               ///< The read buffer.
+    std::vector<std::unique_ptr<connection>> m_connections;  ///< The connections.
+    std::vector<listener*> m_paused;                         ///< The listening sockets disarmed by accept().
+
+    /**
+     * @brief Registers a file descriptor with the `epoll` instance.
+     *
+     * @param obj The object.
+     * @param events The events.
+     * @throws std::system_error If `epoll_ctl()` fails.
+     */
+    void add(io_object& obj, std::uint32_t events);
+
+    /**
+     * @brief Accepts the pending connections.
+     *
+     * @param l The listening socket; it is disarmed if the reactor runs out of file descriptors.
+     */
+    void accept(listener& l);
+
+    /**
+     * @brief Arms the listening sockets disarmed by accept().
+     */
+    void resume_accepting();
+
+    /**
+     * @brief Reads and processes the available input of a connection.
+     *
+     * @param conn The connection.
+     * @param drain Whether to read until `read()` would block; otherwise, a short read ends the loop.
+     * @return Whether the connection is still open.
+     */
+    bool on_readable(connection& conn, bool drain);
+
+    /**
+     * @brief Sends the pending responses of a connection and resumes reading from it.
+     *
+     * @param conn The connection.
+     * @return Whether the connection is still open.
+     */
+    bool on_writable(connection& conn);
+
+    /**
+     * @brief Sends `m_output` after the pending responses of a connection.
+     *
+     * @param conn The connection.
+     * @return Whether the connection is still open.
+     */
+    bool send_output(connection& conn);
+
+    /**
+     * @brief Sends the pending responses of a connection.
+     *
+     * @param conn The connection.
+     * @return Whether the connection is still open.
+     */
+    bool send_pending(connection& conn);
+
+    /**
+     * @brief Writes data to a connection.
+     *
+     * @param conn The connection.
+     * @param data The data.
+     * @return The number of written bytes, or `-1` if the connection has failed.
+     */
+    std::ptrdiff_t write(connection& conn, std::string_view data);
+
+    /**
+     * @brief Closes a connection whose input has ended and whose responses have been sent.
+     *
+     * @param conn The connection; it is half-closed instead if `connection::linger` is set.
+     * @return Whether the connection is still open.
+     */
+    bool close_if_done(connection& conn);
+
+    /**
+     * @brief Closes a connection.
+     *
+     * @param conn The connection; the reference becomes dangling.
+     */
+    void close(connection& conn);
+};
+
+/**
+ * @brief Private implementation of the socket server.
+ * @internal
+ */
+class server_private {
+public:
+    /**
+     * @brief Constructs the implementation.
+     *
+     * @param factory The handler factory.
+     * @param options The options.
+     * @throws std::system_error If the wakeup file descriptor cannot be created.
+     */
+    server_private(handler_factory&& factory, const server_options& options);
+
+    /**
+     * @brief Stops the reactors and closes the listening sockets.
+     */
+    ~server_private();
+
+    server_private(const server_private&)            = delete;
+    server_private& operator=(const server_private&) = delete;
+    server_private(server_private&&)                 = delete;
+    server_private& operator=(server_private&&)      = delete;
+
+    /**
+     * @see server::listen_tcp()
+     */
+    std::uint16_t listen_tcp(const std::string& address, std::uint16_t port);
+
+    /**
+     * @see server::listen_unix()
+     */
+    void listen_unix(const std::string& path);
+
+    /**
+     * @see server::start()
+     */
+    void start();
+
+    /**
+     * @see server::stop()
+     */
+    void stop();
+
+    /**
+     * @see server::backend()
+     */
+    [[nodiscard]] server_backend backend() const noexcept;
+
+    /**
+     * @see server::stats()
+     */
+    [[nodiscard]] server_stats stats() const noexcept;
+
+private:
+    handler_factory m_factory;                           ///< The handler factory.
+    server_options m_options;                            ///< The options.
+    io_object m_wakeup;                                  ///< The event file descriptor that stops the reactors.
+    std::vector<std::unique_ptr<listener>> m_listeners;  ///< The listening sockets.
+    std::vector<std::unique_ptr<reactor>> m_reactors;    ///< The reactors.
+    std::vector<std::thread> m_threads;                  ///< The threads of the reactors.
+    server_stats m_stopped;                              ///< The statistics of the reactors that have been stopped.
+    server_backend m_backend = server_backend::epoll;    ///< The I/O backend.
+
+    /**
+     * @brief Creates a reactor for the selected backend.
+     *
+     * @param index The index of the reactor.
+     * @return The reactor.
+     * @throws std::system_error If the reactor cannot be created.
+     */
+    std::unique_ptr<reactor> make_reactor(std::size_t index);
+
+    /**
+     * @brief Returns the listening sockets a reactor accepts on.
+     *
+     * @param index The index of the reactor.
+     * @return The shared listening sockets and those of the reactor.
+     */
+    [[nodiscard]] std::vector<listener*> listeners_of(std::size_t index) const;
+
+    /**
+     * @brief Runs a reactor in the calling thread.
+     *
+     * @param r The reactor.
+     * @param index The index of the reactor.
+     */
+    void run_reactor(reactor& r, std::size_t index) const;
+
+    /**
+     * @brief Pins a reactor thread to a CPU.
+     *
+     * @param thread The thread.
+     * @param index The index of the reactor.
+     * @throws std::system_error If the affinity cannot be set.
+     */
+    static void pin(std::thread& thread, std::size_t index);
+
+    /**
+     * @brief Makes sure that the server is not running.
+     *
+     * @throws std::logic_error If the server is running.
+     */
+    void ensure_stopped() const;
+
+    /**
+     * @brief Binds a socket, starts listening on it and adds it to `m_listeners`.
+     *
+     * @param fd The socket; it is closed on failure.
+     * @param addr The address.
+     * @param len The size of the address.
+     * @param tcp Whether this is a TCP socket.
+     * @param path The path of a Unix-domain socket.
+     * @param owner The index of the only reactor that accepts on the socket, or `listener::shared`.
+     * @throws std::system_error If `bind()` or `listen()` fails.
+     */
+    void bind_and_listen(
+        int fd, const void* addr, std::size_t len, bool tcp, const std::string& path,
+        std::size_t owner = listener::shared
+    );
+};
+
+}  // namespace wwa::json_rpc
+
+#endif /* F1B7D93A_58C2_4E6D_A0B4_3C9E2F7146D8 */
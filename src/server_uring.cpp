@@ -0,0 +1,717 @@
+/**
+ * @file
+ * @brief Implementation of the `io_uring` backend of the socket server.
+ */
+
+#include "server_uring_p.h"
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cerrno>
+#include <exception>
+#include <limits>
+#include <system_error>
+#include <thread>
+
+#ifndef IORING_SETUP_DEFER_TASKRUN
+#    define IORING_SETUP_DEFER_TASKRUN (1U << 13)
+#endif
+
+namespace {
+
+/**
+ * @brief The kinds of requests, stored in the low bits of `io_uring_sqe::user_data`.
+ * @internal
+ *
+ * @details The rest of `user_data` is the address of the listener or the connection.
+ */
+enum op : std::uint64_t {
+    op_accept = 1,  ///< Multishot accept.
+    op_recv   = 2,  ///< Multishot receive.
+    op_send   = 3,  ///< Send.
+    op_wakeup = 4,  ///< Poll of the wakeup file descriptor.
+    op_cancel = 5,  ///< Cancellation.
+    op_retry  = 6,  ///< The timeout after which the accept requests are armed again.
+};
+
+/**
+ * @brief The mask of the request kind in `io_uring_sqe::user_data`.
+ * @internal
+ */
+constexpr std::uint64_t op_mask = 7;
+
+/**
+ * @brief The size of the submission queue.
+ * @internal
+ */
+constexpr unsigned int queue_entries = 256;
+
+/**
+ * @brief The maximum number of provided buffers.
+ * @internal
+ */
+constexpr std::size_t max_buffers = 32768;
+
+/**
+ * @brief The flags of the `io_uring` instance.
+ * @internal
+ *
+ * @details The instance is only used by the thread of the reactor, and it is enabled by that thread in run().
+ */
+constexpr unsigned int setup_flags = IORING_SETUP_CQSIZE | IORING_SETUP_SUBMIT_ALL | IORING_SETUP_COOP_TASKRUN |
+                                     IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_R_DISABLED;
+
+/**
+ * @brief Throws `std::system_error` for the current value of `errno`.
+ * @internal
+ *
+ * @param what The name of the failed function.
+ */
+[[noreturn]] void throw_errno(const char* what)
+{
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+/**
+ * @brief Creates an `io_uring` instance.
+ * @internal
+ *
+ * @param entries The size of the submission queue.
+ * @param params The parameters.
+ * @return The file descriptor, or `-1` on failure.
+ * @throws std::system_error If the thread cannot be started.
+ * @details The kernel registers the calling thread with the instance, and closing the instance then interrupts
+ * the blocking system calls of that thread (they fail with `EINTR`). The instance is therefore created by
+ * a temporary thread: the registration ends when the thread exits.
+ */
+int io_uring_setup(unsigned int entries, io_uring_params* params)
+{
+    int fd  = -1;
+    int err = 0;
+    std::thread([&fd, &err, entries, params]() {
+        fd  = static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+        err = errno;
+    }).join();
+
+    errno = err;
+    return fd;
+}
+
+int io_uring_enter(int fd, unsigned int to_submit, unsigned int min_complete, unsigned int flags) noexcept
+{
+    return static_cast<int>(::syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+int io_uring_register(int fd, unsigned int opcode, const void* arg, unsigned int nr_args) noexcept
+{
+    return static_cast<int>(::syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+}
+
+/**
+ * @brief Builds the user data of a request.
+ * @internal
+ *
+ * @param object The listener or the connection.
+ * @param kind The kind of the request.
+ * @return The user data.
+ */
+std::uint64_t make_user_data(const void* object, op kind) noexcept
+{
+    return static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(object)) | kind;  // NOLINT(*-reinterpret-cast)
+}
+
+/**
+ * @brief Maps memory.
+ * @internal
+ *
+ * @param size The size.
+ * @param fd The `io_uring` file descriptor, or `-1` for anonymous memory.
+ * @param offset The offset of the ring.
+ * @return The address.
+ * @throws std::system_error If `mmap()` fails.
+ */
+void* map(std::size_t size, int fd, off_t offset)
+{
+    const int flags = fd == -1 ? MAP_PRIVATE | MAP_ANONYMOUS : MAP_SHARED | MAP_POPULATE;
+    void* ptr       = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, flags, fd, offset);
+    if (ptr == MAP_FAILED) {  // NOLINT(*-cstyle-cast, performance-no-int-to-ptr)
+        throw_errno("mmap");
+    }
+
+    return ptr;
+}
+
+/**
+ * @brief Returns a field of a mapped ring.
+ * @internal
+ *
+ * @tparam T The type of the field.
+ * @param ring The ring.
+ * @param offset The offset of the field.
+ * @return The field.
+ */
+template<typename T>
+T* field(void* ring, std::uint32_t offset) noexcept
+{
+    return reinterpret_cast<T*>(static_cast<char*>(ring) + offset);  // NOLINT(*-reinterpret-cast)
+}
+
+}  // namespace
+
+namespace wwa::json_rpc {
+
+uring_reactor::uring_reactor(
+    message_handler handler, const server_options& options, io_object& wakeup,
+    std::vector<listener*> listeners
+)
+    : reactor(std::move(handler), options), m_wakeup(wakeup), m_listeners(std::move(listeners)),
+      m_buf_count(
+          static_cast<unsigned int>(std::bit_ceil(std::clamp<std::size_t>(options.ring_buffers, 1, max_buffers)))
+      ),
+      m_buf_size(std::clamp<std::size_t>(options.ring_buffer_size, 1, std::numeric_limits<std::uint32_t>::max()))
+{
+    io_uring_params params{};
+    params.flags      = setup_flags | IORING_SETUP_DEFER_TASKRUN;
+    params.cq_entries = queue_entries * 8;
+    this->m_ring      = io_uring_setup(queue_entries, &params);
+    if (this->m_ring == -1 && errno == EINVAL) {
+        // IORING_SETUP_DEFER_TASKRUN requires Linux 6.1
+        params            = {};
+        params.flags      = setup_flags;
+        params.cq_entries = queue_entries * 8;
+        this->m_ring      = io_uring_setup(queue_entries, &params);
+    }
+
+    if (this->m_ring == -1) {
+        throw_errno("io_uring_setup");
+    }
+
+    try {
+        this->map_rings(params);
+    }
+    catch (...) {
+        this->release();
+        throw;
+    }
+}
+
+uring_reactor::~uring_reactor()
+{
+    for (const auto& conn : this->m_connections) {
+        ::close(conn->fd);
+    }
+
+    this->release();
+}
+
+bool uring_reactor::supported() noexcept
+{
+    static const bool result = []() noexcept {
+        // IORING_SETUP_SINGLE_ISSUER appeared in Linux 6.0, together with multishot receive
+        io_uring_params params{};
+        params.flags = setup_flags & ~IORING_SETUP_CQSIZE;
+
+        int fd = -1;
+        try {
+            fd = io_uring_setup(2, &params);
+        }
+        catch (const std::system_error&) {
+            return false;
+        }
+
+        if (fd == -1) {
+            return false;
+        }
+
+        static_assert(sizeof(io_uring_probe) == 2 * sizeof(io_uring_probe_op));
+        std::array<io_uring_probe_op, 2 + 256> probe{};
+        bool ok = io_uring_register(fd, IORING_REGISTER_PROBE, probe.data(), 256) == 0;
+        for (const auto opcode :
+             {IORING_OP_ACCEPT, IORING_OP_RECV, IORING_OP_SEND, IORING_OP_POLL_ADD, IORING_OP_ASYNC_CANCEL,
+              IORING_OP_TIMEOUT}) {
+            ok = ok && (probe.at(2 + opcode).flags & IO_URING_OP_SUPPORTED) != 0;
+        }
+
+        ::close(fd);
+        return ok;
+    }();
+
+    return result;
+}
+
+void uring_reactor::map_rings(const io_uring_params& params)
+{
+    this->m_sq_ring.size = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+    this->m_cq_ring.size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    if ((params.features & IORING_FEAT_SINGLE_MMAP) != 0U) {
+        this->m_sq_ring.size = std::max(this->m_sq_ring.size, this->m_cq_ring.size);
+        this->m_sq_ring.ptr  = map(this->m_sq_ring.size, this->m_ring, IORING_OFF_SQ_RING);
+        this->m_cq_ring      = {this->m_sq_ring.ptr, 0};
+    }
+    else {
+        this->m_sq_ring.ptr = map(this->m_sq_ring.size, this->m_ring, IORING_OFF_SQ_RING);
+        this->m_cq_ring.ptr = map(this->m_cq_ring.size, this->m_ring, IORING_OFF_CQ_RING);
+    }
+
+    this->m_sqe_array.size = params.sq_entries * sizeof(io_uring_sqe);
+    this->m_sqe_array.ptr  = map(this->m_sqe_array.size, this->m_ring, IORING_OFF_SQES);
+
+    auto* sq             = this->m_sq_ring.ptr;
+    this->m_sq_head      = field<unsigned int>(sq, params.sq_off.head);
+    this->m_sq_tail      = field<unsigned int>(sq, params.sq_off.tail);
+    this->m_sq_mask      = *field<unsigned int>(sq, params.sq_off.ring_mask);
+    this->m_sq_entries   = params.sq_entries;
+    this->m_sq_local     = *this->m_sq_tail;
+    this->m_sqes         = static_cast<io_uring_sqe*>(this->m_sqe_array.ptr);
+    auto* const sq_array = field<unsigned int>(sq, params.sq_off.array);
+    for (unsigned int i = 0; i < params.sq_entries; ++i) {
+        sq_array[i] = i;
+    }
+
+    auto* cq         = this->m_cq_ring.ptr;
+    this->m_cq_head  = field<unsigned int>(cq, params.cq_off.head);
+    this->m_cq_tail  = field<unsigned int>(cq, params.cq_off.tail);
+    this->m_cq_mask  = *field<unsigned int>(cq, params.cq_off.ring_mask);
+    this->m_cqes     = field<io_uring_cqe>(cq, params.cq_off.cqes);
+
+    this->m_buf_ring.size = this->m_buf_count * sizeof(io_uring_buf);
+    this->m_buf_ring.ptr  = map(this->m_buf_ring.size, -1, 0);
+    this->m_buffers.resize(this->m_buf_count * this->m_buf_size);
+    for (unsigned int i = 0; i < this->m_buf_count; ++i) {
+        this->recycle(i);
+    }
+
+    io_uring_buf_reg reg{};
+    reg.ring_addr    = reinterpret_cast<std::uintptr_t>(this->m_buf_ring.ptr);  // NOLINT(*-reinterpret-cast)
+    reg.ring_entries = this->m_buf_count;
+    reg.bgid         = 0;
+    if (io_uring_register(this->m_ring, IORING_REGISTER_PBUF_RING, &reg, 1) == -1) {
+        throw_errno("io_uring_register");
+    }
+}
+
+void uring_reactor::release() noexcept
+{
+    for (auto* m : {&this->m_buf_ring, &this->m_sqe_array, &this->m_cq_ring, &this->m_sq_ring}) {
+        if (m->ptr != nullptr && m->size != 0) {
+            ::munmap(m->ptr, m->size);
+        }
+
+        *m = {};
+    }
+
+    if (this->m_ring != -1) {
+        ::close(this->m_ring);
+        this->m_ring = -1;
+    }
+}
+
+io_uring_sqe& uring_reactor::prepare(std::uint8_t opcode, int fd, std::uint64_t user_data)
+{
+    const auto full = [this]() {
+        return this->m_sq_local - std::atomic_ref(*this->m_sq_head).load(std::memory_order_acquire) ==
+               this->m_sq_entries;
+    };
+
+    if (full()) {
+        this->submit(0);
+        if (full()) {
+            throw std::system_error(EBUSY, std::generic_category(), "io_uring_enter");
+        }
+    }
+
+    auto& sqe     = this->m_sqes[this->m_sq_local & this->m_sq_mask];
+    sqe           = {};
+    sqe.opcode    = opcode;
+    sqe.fd        = fd;
+    sqe.user_data = user_data;
+
+    ++this->m_sq_local;
+    ++this->m_in_flight;
+    return sqe;
+}
+
+void uring_reactor::submit(unsigned int wait)
+{
+    std::atomic_ref(*this->m_sq_tail).store(this->m_sq_local, std::memory_order_release);
+
+    const auto pending = this->m_sq_local - std::atomic_ref(*this->m_sq_head).load(std::memory_order_acquire);
+    const int res      = io_uring_enter(this->m_ring, pending, wait, wait != 0 ? IORING_ENTER_GETEVENTS : 0U);
+    this->count_syscall();
+
+    // EBUSY and EAGAIN: the completions must be processed first; EINTR: a signal has interrupted the wait
+    if (res == -1 && errno != EINTR && errno != EBUSY && errno != EAGAIN) {
+        throw_errno("io_uring_enter");
+    }
+}
+
+void uring_reactor::run()
+{
+    if (io_uring_register(this->m_ring, IORING_REGISTER_ENABLE_RINGS, nullptr, 0) == -1) {
+        throw_errno("io_uring_register");
+    }
+
+    auto& poll = this->prepare(IORING_OP_POLL_ADD, this->m_wakeup.fd, make_user_data(nullptr, op_wakeup));
+    poll.poll32_events = std::endian::native == std::endian::big ? std::rotl(std::uint32_t{POLLIN}, 16) : POLLIN;
+
+    for (auto* l : this->m_listeners) {
+        this->arm_accept(*l);
+    }
+
+    while (!this->m_stopping || this->m_in_flight != 0) {
+        this->submit(1);
+
+        auto head       = *this->m_cq_head;
+        const auto tail = std::atomic_ref(*this->m_cq_tail).load(std::memory_order_acquire);
+        for (; head != tail; ++head) {
+            this->complete(this->m_cqes[head & this->m_cq_mask]);
+        }
+
+        std::atomic_ref(*this->m_cq_head).store(head, std::memory_order_release);
+    }
+}
+
+void uring_reactor::complete(const io_uring_cqe& cqe)
+{
+    if ((cqe.flags & IORING_CQE_F_MORE) == 0U) {
+        --this->m_in_flight;
+    }
+
+    auto* object = reinterpret_cast<void*>(cqe.user_data & ~op_mask);  // NOLINT(*-reinterpret-cast, *-no-int-to-ptr)
+    switch (cqe.user_data & op_mask) {
+        case op_accept:
+            this->on_accept(*static_cast<listener*>(object), cqe);
+            break;
+
+        case op_recv:
+            this->on_recv(*static_cast<uring_connection*>(object), cqe);
+            break;
+
+        case op_send:
+            this->on_send(*static_cast<uring_connection*>(object), cqe);
+            break;
+
+        case op_wakeup:
+            this->cancel_all();
+            break;
+
+        case op_retry:
+            this->m_retry_armed = false;
+            this->resume_accepting();
+            break;
+
+        default:
+            break;
+    }
+}
+
+void uring_reactor::arm_accept(listener& l)
+{
+    auto& sqe        = this->prepare(IORING_OP_ACCEPT, l.fd, make_user_data(&l, op_accept));
+    sqe.ioprio       = IORING_ACCEPT_MULTISHOT;
+    sqe.accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+}
+
+void uring_reactor::pause_accepting(listener& l)
+{
+    this->m_paused.push_back(&l);
+    if (!this->m_retry_armed) {
+        const auto ns = std::chrono::nanoseconds(accept_retry_delay).count();
+
+        this->m_retry_timeout.tv_sec  = ns / 1'000'000'000;
+        this->m_retry_timeout.tv_nsec = ns % 1'000'000'000;
+
+        auto& sqe = this->prepare(IORING_OP_TIMEOUT, -1, make_user_data(nullptr, op_retry));
+        sqe.addr  = reinterpret_cast<std::uintptr_t>(&this->m_retry_timeout);  // NOLINT(*-reinterpret-cast)
+        sqe.len   = 1;
+
+        this->m_retry_armed = true;
+    }
+}
+
+void uring_reactor::resume_accepting()
+{
+    if (this->m_stopping) {
+        return;
+    }
+
+    for (auto* l : this->m_paused) {
+        this->arm_accept(*l);
+    }
+
+    this->m_paused.clear();
+}
+
+void uring_reactor::arm_recv(uring_connection& conn)
+{
+    auto& sqe     = this->prepare(IORING_OP_RECV, conn.fd, make_user_data(&conn, op_recv));
+    sqe.ioprio    = IORING_RECV_MULTISHOT;
+    sqe.flags     = IOSQE_BUFFER_SELECT;
+    sqe.buf_group = 0;
+
+    conn.recv_armed = true;
+    ++conn.ops;
+}
+
+void uring_reactor::arm_send(uring_connection& conn)
+{
+    const auto size = std::min<std::size_t>(conn.sending.size() - conn.sent, std::numeric_limits<std::uint32_t>::max());
+
+    auto& sqe = this->prepare(IORING_OP_SEND, conn.fd, make_user_data(&conn, op_send));
+    sqe.addr  = reinterpret_cast<std::uintptr_t>(conn.sending.data() + conn.sent);  // NOLINT(*-reinterpret-cast)
+    sqe.len   = static_cast<std::uint32_t>(size);
+    // MSG_WAITALL: the kernel retries short sends itself
+    sqe.msg_flags = MSG_NOSIGNAL | MSG_WAITALL;
+
+    conn.send_in_flight = true;
+    ++conn.ops;
+}
+
+void uring_reactor::cancel_all()
+{
+    this->m_stopping = true;
+
+    auto& sqe        = this->prepare(IORING_OP_ASYNC_CANCEL, -1, make_user_data(nullptr, op_cancel));
+    sqe.cancel_flags = IORING_ASYNC_CANCEL_ANY;
+}
+
+void uring_reactor::on_accept(listener& l, const io_uring_cqe& cqe)
+{
+    if ((cqe.flags & IORING_CQE_F_MORE) == 0U && !this->m_stopping && cqe.res != -ECANCELED && cqe.res != -EINVAL) {
+        // The multishot request has been terminated. EMFILE and the like would terminate it again at once:
+        // the pending connection stays in the backlog
+        if (cqe.res < 0 && accept_failed(-cqe.res)) {
+            this->pause_accepting(l);
+        }
+        else {
+            this->arm_accept(l);
+        }
+    }
+
+    if (cqe.res < 0) {
+        return;
+    }
+
+    const int fd = cqe.res;
+    if (this->m_stopping) {
+        ::close(fd);
+        return;
+    }
+
+    if (l.tcp) {
+        const int one = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+
+    uring_connection* conn = nullptr;
+    try {
+        auto c   = std::make_unique<uring_connection>();
+        c->fd    = fd;
+        c->type  = io_object::kind::connection;
+        c->index = this->m_connections.size();
+        conn     = c.get();
+        this->m_connections.push_back(std::move(c));
+    }
+    catch (const std::exception&) {
+        ::close(fd);
+        return;
+    }
+
+    reactor_counters::add(this->m_counters.connections_accepted, 1);
+    this->arm_recv(*conn);
+}
+
+void uring_reactor::on_recv(uring_connection& conn, const io_uring_cqe& cqe)
+{
+    if ((cqe.flags & IORING_CQE_F_MORE) == 0U) {
+        conn.recv_armed = false;
+        --conn.ops;
+    }
+
+    if ((cqe.flags & IORING_CQE_F_BUFFER) != 0U) {
+        const auto id = cqe.flags >> IORING_CQE_BUFFER_SHIFT;
+        if (cqe.res > 0 && !conn.closing && !conn.eof && !conn.discard && !this->m_stopping) {
+            const auto size = static_cast<std::size_t>(cqe.res);
+            reactor_counters::add(this->m_counters.bytes_read, size);
+
+            try {
+                this->receive(conn, {this->m_buffers.data() + id * this->m_buf_size, size});
+            }
+            catch (const std::exception&) {
+                this->m_output.clear();
+                this->recycle(id);
+                this->close(conn, true);
+                return;
+            }
+
+            this->recycle(id);
+            this->send_output(conn);
+        }
+        else {
+            this->recycle(id);
+        }
+    }
+
+    if (conn.closing) {
+        this->close(conn, false);
+    }
+    else if (cqe.res == 0 || conn.eof) {
+        // The client has closed its end, or the framing has ended the connection
+        conn.eof = true;
+        this->close_if_done(conn);
+    }
+    else if (cqe.res < 0 && cqe.res != -ENOBUFS && cqe.res != -ECANCELED) {
+        this->close(conn, true);
+    }
+    else if (!conn.recv_armed && !conn.read_paused && !this->m_stopping) {
+        // ENOBUFS: all buffers were in use; the kernel also terminates a multishot receive now and then
+        this->arm_recv(conn);
+    }
+}
+
+void uring_reactor::on_send(uring_connection& conn, const io_uring_cqe& cqe)
+{
+    conn.send_in_flight = false;
+    --conn.ops;
+
+    if (conn.closing) {
+        this->close(conn, false);
+        return;
+    }
+
+    if (this->m_stopping) {
+        return;
+    }
+
+    if (cqe.res < 0) {
+        this->close(conn, true);
+        return;
+    }
+
+    reactor_counters::add(this->m_counters.bytes_written, static_cast<std::size_t>(cqe.res));
+    conn.sent += static_cast<std::size_t>(cqe.res);
+    if (conn.sent < conn.sending.size()) {
+        this->arm_send(conn);
+        return;
+    }
+
+    // Give the buffer back to the reactor rather than keeping it in an idle connection
+    conn.sending.clear();
+    conn.sent = 0;
+    if (this->m_output.capacity() < conn.sending.capacity()) {
+        this->m_output.swap(conn.sending);
+    }
+
+    std::string().swap(conn.sending);
+    if (!conn.output.empty()) {
+        conn.sending.swap(conn.output);
+        this->arm_send(conn);
+    }
+
+    if (conn.read_paused) {
+        conn.read_paused = false;
+        if (!conn.recv_armed && !conn.eof) {
+            this->arm_recv(conn);
+        }
+    }
+
+    this->close_if_done(conn);
+}
+
+void uring_reactor::recycle(unsigned int id) noexcept
+{
+    // The tail of the ring overlays the reserved field of the first buffer
+    auto* const bufs = static_cast<io_uring_buf*>(this->m_buf_ring.ptr);
+    std::atomic_ref tail(bufs[0].resv);
+
+    const auto t = tail.load(std::memory_order_relaxed);
+    auto& buf    = bufs[t & (this->m_buf_count - 1)];
+    buf.addr     = reinterpret_cast<std::uintptr_t>(this->m_buffers.data() + id * this->m_buf_size);  // NOLINT
+    buf.len      = static_cast<std::uint32_t>(this->m_buf_size);
+    buf.bid      = static_cast<std::uint16_t>(id);
+    tail.store(static_cast<std::uint16_t>(t + 1), std::memory_order_release);
+}
+
+void uring_reactor::send_output(uring_connection& conn)
+{
+    if (this->m_output.empty()) {
+        return;
+    }
+
+    if (!conn.send_in_flight) {
+        conn.sending.swap(this->m_output);
+        conn.sent = 0;
+        this->arm_send(conn);
+        return;
+    }
+
+    // Keep the order of the responses: they are sent when the send in flight completes
+    conn.output.append(this->m_output);
+    this->m_output.clear();
+
+    if (conn.output.size() > this->m_options.max_pending_output && !conn.read_paused) {
+        conn.read_paused = true;
+        if (conn.recv_armed) {
+            auto& sqe = this->prepare(IORING_OP_ASYNC_CANCEL, -1, make_user_data(nullptr, op_cancel));
+            sqe.addr  = make_user_data(&conn, op_recv);
+        }
+    }
+}
+
+void uring_reactor::close(uring_connection& conn, bool force)
+{
+    conn.closing = true;
+    if (conn.ops != 0) {
+        if (force) {
+            ::shutdown(conn.fd, SHUT_RDWR);
+        }
+
+        return;
+    }
+
+    ::close(conn.fd);
+
+    const auto index = conn.index;
+    if (index != this->m_connections.size() - 1) {
+        this->m_connections[index]        = std::move(this->m_connections.back());
+        this->m_connections[index]->index = index;
+    }
+
+    this->m_connections.pop_back();
+    reactor_counters::add(this->m_counters.connections_closed, 1);
+
+    if (!this->m_paused.empty()) {
+        this->resume_accepting();
+    }
+}
+
+void uring_reactor::close_if_done(uring_connection& conn)
+{
+    if (!conn.eof || conn.send_in_flight) {
+        return;
+    }
+
+    if (conn.linger && this->half_close(conn)) {
+        if (!conn.recv_armed && !this->m_stopping) {
+            this->arm_recv(conn);
+        }
+
+        return;
+    }
+
+    // A receive may still be armed if the framing has ended the connection
+    this->close(conn, true);
+}
+
+}  // namespace wwa::json_rpc
@@ -0,0 +1,256 @@
+#ifndef A7D2E95C_3B16_4F08_8C4A_E1F06B9D2735
+#define A7D2E95C_3B16_4F08_8C4A_E1F06B9D2735
+
+/**
+ * @file
+ * @brief Contains the `io_uring` backend of the socket server.
+ * @internal
+ */
+
+#include <linux/io_uring.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "server_p.h"
+
+namespace wwa::json_rpc {
+
+/**
+ * @brief A connection served by an `io_uring` reactor.
+ * @internal
+ *
+ * @details The responses are sent from @a sending, one request at a time; the responses produced while a send is
+ * in flight are collected in `connection::output` and sent next.
+ */
+struct uring_connection : connection {
+    std::string sending;          ///< The data of the send in flight.
+    std::size_t sent    = 0;      ///< The number of bytes of @a sending that have been sent.
+    unsigned int ops    = 0;      ///< The number of requests in flight for the connection.
+    bool recv_armed     = false;  ///< Whether a multishot receive is in flight.
+    bool send_in_flight = false;  ///< Whether a send is in flight.
+    bool closing        = false;  ///< Whether the connection is closed as soon as its requests complete.
+};
+
+/**
+ * @brief A reactor based on `io_uring`.
+ * @internal
+ *
+ * @details The connections are accepted with multishot accept requests, and read with multishot receive requests
+ * into a ring of buffers provided to the kernel; a buffer is returned to the ring as soon as its data is processed.
+ * A single `io_uring_enter()` submits the new requests and waits for the next completions.
+ */
+class uring_reactor final : public reactor {
+public:
+    /**
+     * @brief Constructs the reactor.
+     *
+     * @param handler The message handler.
+     * @param options The options of the server.
+     * @param wakeup The event file descriptor that tells the reactor to stop.
+     * @param listeners The listening sockets of the reactor.
+     * @throws std::system_error If the `io_uring` instance or the buffer ring cannot be created.
+     */
+    uring_reactor(
+        message_handler handler, const server_options& options, io_object& wakeup,
+        std::vector<listener*> listeners
+    );
+
+    /**
+     * @brief Closes the connections and the `io_uring` instance.
+     */
+    ~uring_reactor() override;
+
+    uring_reactor(const uring_reactor&)            = delete;
+    uring_reactor& operator=(const uring_reactor&) = delete;
+    uring_reactor(uring_reactor&&)                 = delete;
+    uring_reactor& operator=(uring_reactor&&)      = delete;
+
+    /**
+     * @brief Runs the event loop until the wakeup file descriptor becomes readable.
+     *
+     * @details All requests in flight are canceled before the method returns.
+     */
+    void run() override;
+
+    /**
+     * @brief Checks whether the kernel supports the features the reactor needs.
+     *
+     * @return Whether `io_uring` can be used.
+     */
+    static bool supported() noexcept;
+
+private:
+    /**
+     * @brief A memory mapping.
+     */
+    struct mapping {
+        void* ptr        = nullptr;  ///< The address.
+        std::size_t size = 0;        ///< The size.
+    };
+
+    io_object& m_wakeup;                                           ///< The file descriptor that stops the reactor.
+    std::vector<listener*> m_listeners;                            ///< The listening sockets.
+    int m_ring                = -1;                                ///< The `io_uring` file descriptor.
+    mapping m_sq_ring;                                             ///< The submission queue ring.
+    mapping m_cq_ring;                                             ///< The completion queue ring.
+    mapping m_sqe_array;                                           ///< The submission queue entries.
+    mapping m_buf_ring;                                            ///< The ring of provided buffers.
+    unsigned int* m_sq_head   = nullptr;                           ///< The head of the submission queue.
+    unsigned int* m_sq_tail   = nullptr;                           ///< The tail of the submission queue.
+    unsigned int m_sq_mask    = 0;                                 ///< The index mask of the submission queue.
+    unsigned int m_sq_entries = 0;                                 ///< The size of the submission queue.
+    unsigned int m_sq_local   = 0;                                 ///< The tail including the unpublished entries.
+    io_uring_sqe* m_sqes      = nullptr;                           ///< The submission queue entries.
+    unsigned int* m_cq_head   = nullptr;                           ///< The head of the completion queue.
+    unsigned int* m_cq_tail   = nullptr;                           ///< The tail of the completion queue.
+    unsigned int m_cq_mask    = 0;                                 ///< The index mask of the completion queue.
+    io_uring_cqe* m_cqes      = nullptr;                           ///< The completion queue entries.
+    std::vector<char> m_buffers;                                   ///< The memory of the provided buffers.
+    unsigned int m_buf_count  = 0;                                 ///< The number of provided buffers.
+    std::size_t m_buf_size    = 0;                                 ///< The size of a provided buffer.
+    std::vector<std::unique_ptr<uring_connection>> m_connections;  ///< The connections.
+    std::vector<listener*> m_paused;                               ///< The listening sockets not being accepted on.
+    __kernel_timespec m_retry_timeout{};                           ///< The timeout that arms them again.
+    std::size_t m_in_flight   = 0;                                 ///< The number of requests in flight.
+    bool m_stopping           = false;                             ///< Whether the requests are being canceled.
+    bool m_retry_armed        = false;                             ///< Whether the retry timeout is in flight.
+
+    /**
+     * @brief Maps the rings and registers the provided buffers.
+     *
+     * @param params The parameters returned by `io_uring_setup()`.
+     * @throws std::system_error On failure.
+     */
+    void map_rings(const io_uring_params& params);
+
+    /**
+     * @brief Unmaps the rings and closes the `io_uring` instance.
+     */
+    void release() noexcept;
+
+    /**
+     * @brief Returns a submission queue entry, submitting the queued entries if the queue is full.
+     *
+     * @param opcode The operation.
+     * @param fd The file descriptor.
+     * @param user_data The user data identifying the request.
+     * @return The entry, with all other fields zeroed.
+     */
+    io_uring_sqe& prepare(std::uint8_t opcode, int fd, std::uint64_t user_data);
+
+    /**
+     * @brief Submits the queued entries and waits for completions.
+     *
+     * @param wait The number of completions to wait for.
+     * @throws std::system_error If `io_uring_enter()` fails.
+     */
+    void submit(unsigned int wait);
+
+    /**
+     * @brief Processes a completion.
+     *
+     * @param cqe The completion queue entry.
+     */
+    void complete(const io_uring_cqe& cqe);
+
+    /**
+     * @brief Starts accepting connections on a listening socket.
+     *
+     * @param l The listening socket.
+     */
+    void arm_accept(listener& l);
+
+    /**
+     * @brief Stops accepting connections on a listening socket until a connection is closed, or until
+     * `accept_retry_delay` has passed.
+     *
+     * @param l The listening socket.
+     */
+    void pause_accepting(listener& l);
+
+    /**
+     * @brief Starts accepting connections on the listening sockets passed to pause_accepting().
+     */
+    void resume_accepting();
+
+    /**
+     * @brief Starts receiving data from a connection.
+     *
+     * @param conn The connection.
+     */
+    void arm_recv(uring_connection& conn);
+
+    /**
+     * @brief Sends the rest of `uring_connection::sending`.
+     *
+     * @param conn The connection.
+     */
+    void arm_send(uring_connection& conn);
+
+    /**
+     * @brief Cancels all requests in flight.
+     */
+    void cancel_all();
+
+    /**
+     * @brief Handles the completion of an accept request.
+     *
+     * @param l The listening socket.
+     * @param cqe The completion queue entry.
+     */
+    void on_accept(listener& l, const io_uring_cqe& cqe);
+
+    /**
+     * @brief Handles the completion of a receive request.
+     *
+     * @param conn The connection.
+     * @param cqe The completion queue entry.
+     */
+    void on_recv(uring_connection& conn, const io_uring_cqe& cqe);
+
+    /**
+     * @brief Handles the completion of a send request.
+     *
+     * @param conn The connection.
+     * @param cqe The completion queue entry.
+     */
+    void on_send(uring_connection& conn, const io_uring_cqe& cqe);
+
+    /**
+     * @brief Returns a provided buffer to the kernel.
+     *
+     * @param id The buffer ID.
+     */
+    void recycle(unsigned int id) noexcept;
+
+    /**
+     * @brief Sends `m_output` after the pending responses of a connection.
+     *
+     * @param conn The connection.
+     */
+    void send_output(uring_connection& conn);
+
+    /**
+     * @brief Closes a connection once it has no requests in flight.
+     *
+     * @param conn The connection.
+     * @param force Whether to shut down the socket so that the requests in flight complete.
+     */
+    void close(uring_connection& conn, bool force);
+
+    /**
+     * @brief Closes a connection if nothing more is read from it and it has nothing left to send.
+     *
+     * @param conn The connection; the reference becomes dangling if the connection is closed. It is half-closed
+     * instead if `connection::linger` is set.
+     */
+    void close_if_done(uring_connection& conn);
+};
+
+}  // namespace wwa::json_rpc
+
+#endif /* A7D2E95C_3B16_4F08_8C4A_E1F06B9D2735 */
@@ -0,0 +1,304 @@
+#ifndef A3C5E0B7_94D2_4B8E_9F61_2D7C8E4A1B35
+#define A3C5E0B7_94D2_4B8E_9F61_2D7C8E4A1B35
+
+/**
+ * @file
+ * @brief Defines a JSON RPC dispatcher whose set of methods is fixed at compile time.
+ */
+
+#include <any>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <nlohmann/json.hpp>
+
+#include "details.h"
+#include "exception.h"
+#include "expected.h"
+#include "request.h"
+#include "utils.h"
+
+namespace wwa::json_rpc {
+
+/**
+ * @brief Describes a method handler of a static_dispatcher.
+ *
+ * @tparam Name The name of the method.
+ * @tparam F The handler: a pointer to a function or a static class method, or a lambda without captures.
+ *
+ * @details The handler follows the same rules as the handlers passed to `dispatcher::add()`:
+ * it can accept any number of arguments convertible from `nlohmann::json` (or a single `const nlohmann::json&`
+ * argument to receive the raw parameters), and its return value must be convertible to `nlohmann::json` (or `void`).
+ *
+ * @see static_dispatcher
+ */
+template<details::fixed_string Name, auto F>
+struct method {
+    static constexpr std::string_view name = Name.view();                         ///< The name of the method.
+    static constexpr std::uint64_t hash    = details::hash_method_name(method::name);  ///< The hash of the name.
+    static constexpr bool with_context     = false;  ///< Whether the handler accepts the context.
+
+    /**
+     * @brief Invokes the handler.
+     *
+     * @tparam BasicJsonType The JSON type (a `nlohmann::basic_json` specialization).
+     * @param ctx The context; unused.
+     * @param params The parameters of the method (a JSON array).
+     * @return The result of the handler, or the error if the parameters cannot be converted to the arguments of
+     * the handler.
+     */
+    template<typename BasicJsonType>
+    static expected<BasicJsonType>
+    invoke(const std::pair<std::any, BasicJsonType>& ctx, const BasicJsonType& params)
+    {
+        using func_t    = std::remove_cv_t<decltype(F)>;
+        using ArgsTuple = typename details::function_traits<func_t>::args_tuple;
+
+        func_t func = F;
+        return details::create_closure<std::nullptr_t, func_t, void, ArgsTuple, BasicJsonType>(
+            nullptr, std::move(func)
+        )(ctx, params);
+    }
+};
+
+/**
+ * @brief Describes a method handler of a static_dispatcher that accepts the context.
+ *
+ * @tparam Name The name of the method.
+ * @tparam F The handler: a pointer to a function or a static class method, or a lambda without captures.
+ *
+ * @details The first argument of the handler is the context, like for the handlers passed to `dispatcher::add_ex()`;
+ * its type is `basic_static_dispatcher::context_t` of the dispatcher the method belongs to.
+ *
+ * @see static_dispatcher
+ */
+template<details::fixed_string Name, auto F>
+struct method_ex {
+    static constexpr std::string_view name = Name.view();                            ///< The name of the method.
+    static constexpr std::uint64_t hash    = details::hash_method_name(method_ex::name);  ///< The hash of the name.
+    static constexpr bool with_context     = true;  ///< Whether the handler accepts the context.
+
+    /**
+     * @brief Invokes the handler.
+     *
+     * @tparam BasicJsonType The JSON type (a `nlohmann::basic_json` specialization).
+     * @param ctx The context.
+     * @param params The parameters of the method (a JSON array).
+     * @return The result of the handler, or the error if the parameters cannot be converted to the arguments of
+     * the handler.
+     */
+    template<typename BasicJsonType>
+    static expected<BasicJsonType>
+    invoke(const std::pair<std::any, BasicJsonType>& ctx, const BasicJsonType& params)
+    {
+        using func_t    = std::remove_cv_t<decltype(F)>;
+        using ArgsTuple = typename details::function_traits<func_t>::args_tuple;
+
+        static_assert(
+            std::tuple_size_v<ArgsTuple> > 0,
+            "Handler function must accept the `context` argument. Use `method` for handlers without the `context` "
+            "argument."
+        );
+
+        func_t func = F;
+        return details::create_closure<
+            std::nullptr_t, func_t, std::pair<std::any, BasicJsonType>, ArgsTuple, BasicJsonType>(
+            nullptr, std::move(func)
+        )(ctx, params);
+    }
+};
+
+/**
+ * @brief JSON RPC dispatcher with a set of methods known at compile time.
+ *
+ * @tparam BasicJsonType The JSON type (a `nlohmann::basic_json` specialization); its `string_t` must be `std::string`.
+ * @tparam Methods The method handlers (`method` or `method_ex`).
+ *
+ * @details Unlike `dispatcher`, this class does not store the handlers in a map of `std::function` objects.
+ * The method name from the request is hashed once, and then compared against the hashes of the method names
+ * computed at compile time; the matching handler is called directly, which allows the compiler to inline it.
+ *
+ * The responses are the same as the responses of `dispatcher::process_request()` for the same requests and handlers.
+ * Because there are no virtual hooks, the class cannot be customized by inheritance; use `dispatcher` if you need
+ * `request_parsed()`, `invoke()`, or `request_failed()`.
+ *
+ * @par Sample Usage:
+ * ```cpp
+ * int sum(int a, int b) { return a + b; }
+ *
+ * wwa::json_rpc::static_dispatcher<
+ *     wwa::json_rpc::method<"sum", &sum>,
+ *     wwa::json_rpc::method<"echo", [](const nlohmann::json& params) { return params; }>
+ * > dispatcher;
+ *
+ * const auto response = dispatcher.process_request(request);
+ * ```
+ *
+ * The class is header-only, so, unlike `basic_dispatcher`, it works with any JSON type, including `basic_json`
+ * specializations with a custom allocator, without explicit instantiations.
+ */
+template<typename BasicJsonType, typename... Methods>
+class basic_static_dispatcher {
+public:
+    /** @brief The context passed to the method handlers. */
+    using context_t = std::pair<std::any, BasicJsonType>;
+
+    /**
+     * @brief Processes a JSON RPC request.
+     *
+     * @param request The JSON RPC request as a JSON object.
+     * @param data Additional information to pass to the method handlers as a part of the context.
+     * @return The response serialized into a JSON object.
+     * @retval json::value_t::discarded The request was a notification (no response is required).
+     *
+     * @see dispatcher::process_request()
+     */
+    BasicJsonType process_request(const BasicJsonType& request, const std::any& data = {}) const
+    {
+        if (!request.is_array()) {
+            return basic_static_dispatcher::process_single(request, data);
+        }
+
+        if (request.empty()) {
+            const exception e(exception::INVALID_REQUEST, err_empty_batch);
+            return generate_error_response<BasicJsonType>(e, nullptr);
+        }
+
+        auto response = BasicJsonType::array();
+        for (const auto& req : request) {
+            if (!req.is_object()) {
+                const exception e(exception::INVALID_REQUEST, err_not_jsonrpc_2_0_request);
+                response.push_back(generate_error_response<BasicJsonType>(e, nullptr));
+            }
+            else if (auto res = basic_static_dispatcher::process_single(req, data); !res.is_discarded()) {
+                response.push_back(std::move(res));
+            }
+        }
+
+        return response.empty() ? BasicJsonType(BasicJsonType::value_t::discarded) : response;
+    }
+
+    /**
+     * @brief Checks whether the dispatcher has a handler for the method.
+     *
+     * @param method The name of the method.
+     * @return Whether the method is known.
+     */
+    static constexpr bool has_method(std::string_view method) noexcept
+    {
+        return ((method == Methods::name) || ...);
+    }
+
+private:
+    static_assert(sizeof...(Methods) > 0, "basic_static_dispatcher needs at least one method");
+
+    static_assert(details::are_unique_names({Methods::name...}), "Method names must be unique");
+
+    /** @brief Whether any handler accepts the context. */
+    static constexpr bool needs_context = (Methods::with_context || ...);
+
+    /**
+     * @brief Checks whether the handler for @a method accepts the context.
+     *
+     * @param method The name of the method.
+     * @return Whether the handler is a `method_ex`; `false` if there is no such method.
+     */
+    static constexpr bool accepts_context(std::string_view method) noexcept
+    {
+        return ((method == Methods::name && Methods::with_context) || ...);
+    }
+
+    /**
+     * @brief Processes a single (non-batch) request.
+     *
+     * @param request The request.
+     * @param data Additional information to pass to the method handlers as a part of the context.
+     * @return The response; a discarded value for notifications.
+     */
+    static BasicJsonType process_single(const BasicJsonType& request, const std::any& data)
+    {
+        const auto request_id = get_request_id(request);
+        auto req              = details::try_parse_envelope(request);
+        if (!req) {
+            return generate_error_response<BasicJsonType>(req.error(), request_id);
+        }
+
+        const bool is_discarded = req->id.is_discarded();
+        try {
+            expected<BasicJsonType> response;
+            if constexpr (basic_static_dispatcher::needs_context) {
+                const context_t ctx{
+                    data, basic_static_dispatcher::accepts_context(req->method) ? details::collect_extra(request)
+                                                                                : BasicJsonType(nullptr)
+                };
+                response = basic_static_dispatcher::invoke(req->method, req->params, ctx);
+            }
+            else {
+                static const context_t empty_context;
+                response = basic_static_dispatcher::invoke(req->method, req->params, empty_context);
+            }
+
+            if (!response) {
+                return is_discarded ? BasicJsonType(BasicJsonType::value_t::discarded)
+                                    : generate_error_response<BasicJsonType>(response.error(), request_id);
+            }
+
+            if (request_id.is_null()) {
+                return BasicJsonType::value_t::discarded;
+            }
+
+            return BasicJsonType({{"jsonrpc", "2.0"}, {"result", std::move(*response)}, {"id", request_id}});
+        }
+        catch (const exception& e) {
+            return is_discarded ? BasicJsonType(BasicJsonType::value_t::discarded)
+                                : generate_error_response<BasicJsonType>(e, request_id);
+        }
+        catch (const std::exception& e) {
+            return is_discarded ? BasicJsonType(BasicJsonType::value_t::discarded)
+                                : generate_error_response<BasicJsonType>(
+                                      exception(exception::INTERNAL_ERROR, e.what()), request_id
+                                  );
+        }
+    }
+
+    /**
+     * @brief Invokes the handler for the method.
+     *
+     * @param method The name of the method.
+     * @param params The parameters of the method.
+     * @param ctx The context.
+     * @return The result of the handler, or the error (`exception::METHOD_NOT_FOUND` if there is no handler
+     * for the method).
+     */
+    static expected<BasicJsonType> invoke(std::string_view method, const BasicJsonType& params, const context_t& ctx)
+    {
+        const auto hash = details::hash_method_name(method);
+
+        expected<BasicJsonType> result;
+        const bool found =
+            ((hash == Methods::hash && method == Methods::name && (result = Methods::invoke(ctx, params), true)) ||
+             ...);
+
+        if (!found) {
+            return unexpected(method_not_found_exception());
+        }
+
+        return result;
+    }
+};
+
+/**
+ * @brief JSON RPC dispatcher with a set of methods known at compile time that uses `nlohmann::json`.
+ *
+ * @tparam Methods The method handlers (`method` or `method_ex`).
+ * @see basic_static_dispatcher
+ */
+template<typename... Methods>
+using static_dispatcher = basic_static_dispatcher<nlohmann::json, Methods...>;
+
+}  // namespace wwa::json_rpc
+
+#endif /* A3C5E0B7_94D2_4B8E_9F61_2D7C8E4A1B35 */
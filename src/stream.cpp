@@ -0,0 +1,639 @@
+/**
+ * @file
+ * @brief Implementation of the stream drivers.
+ */
+
+#include "stream.h"
+
+#include <poll.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <charconv>
+#include <climits>
+#include <cstring>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include "exception.h"
+#include "utils.h"
+
+namespace {
+
+/**
+ * @brief Waits until a file descriptor becomes ready.
+ * @internal
+ *
+ * @param fd The file descriptor.
+ * @param events `POLLIN` or `POLLOUT`.
+ * @throws std::system_error If `poll()` fails.
+ */
+void wait_for(int fd, short events)
+{
+    pollfd pfd{fd, events, 0};
+    while (::poll(&pfd, 1, -1) < 0) {
+        if (errno != EINTR) {
+            throw std::system_error(errno, std::generic_category(), "poll");
+        }
+    }
+}
+
+/**
+ * @brief Reads at most @a size bytes from a file descriptor.
+ * @internal
+ *
+ * @param fd The file descriptor.
+ * @param buf The buffer.
+ * @param size The size of the buffer.
+ * @return The number of bytes read; `0` at the end of the input.
+ * @throws std::system_error If `read()` fails.
+ */
+std::size_t read_some(int fd, char* buf, std::size_t size)
+{
+    while (true) {
+        const auto n = ::read(fd, buf, size);
+        if (n >= 0) {
+            return static_cast<std::size_t>(n);
+        }
+
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            wait_for(fd, POLLIN);
+        }
+        else if (errno != EINTR) {
+            throw std::system_error(errno, std::generic_category(), "read");
+        }
+    }
+}
+
+/**
+ * @brief Writes the whole @a data to a file descriptor.
+ * @internal
+ *
+ * @param fd The file descriptor.
+ * @param data The data.
+ * @throws std::system_error If `write()` fails.
+ */
+void write_all(int fd, std::string_view data)
+{
+    while (!data.empty()) {
+        const auto n = ::write(fd, data.data(), data.size());
+        if (n >= 0) {
+            data.remove_prefix(static_cast<std::size_t>(n));
+        }
+        else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            wait_for(fd, POLLOUT);
+        }
+        else if (errno != EINTR) {
+            throw std::system_error(errno, std::generic_category(), "write");
+        }
+    }
+}
+
+/**
+ * @brief Writes the whole data described by @a iov to a file descriptor.
+ * @internal
+ *
+ * @param fd The file descriptor.
+ * @param iov The buffers; they are modified to track the partial writes.
+ * @throws std::system_error If `writev()` fails.
+ */
+void writev_all(int fd, std::vector<iovec>& iov)
+{
+    auto* first      = iov.data();
+    auto* const last = iov.data() + iov.size();
+    while (first != last) {
+        const auto count = std::min<std::ptrdiff_t>(last - first, IOV_MAX);
+        const auto n     = ::writev(fd, first, static_cast<int>(count));
+        if (n >= 0) {
+            auto written = static_cast<std::size_t>(n);
+            while (first != last && written >= first->iov_len) {
+                written -= first->iov_len;
+                ++first;
+            }
+
+            if (written != 0) {
+                first->iov_base = static_cast<char*>(first->iov_base) + written;
+                first->iov_len -= written;
+            }
+        }
+        else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            wait_for(fd, POLLOUT);
+        }
+        else if (errno != EINTR) {
+            throw std::system_error(errno, std::generic_category(), "writev");
+        }
+    }
+}
+
+/**
+ * @brief Returns the response to a request that exceeds `stream_options::max_message_size`.
+ * @internal
+ *
+ * @return The serialized error response.
+ */
+const std::string& too_large_response()
+{
+    static const std::string response =
+        wwa::json_rpc::generate_error_response(
+            wwa::json_rpc::exception(wwa::json_rpc::exception::INVALID_REQUEST, wwa::json_rpc::err_request_too_large)
+        )
+            .dump();
+
+    return response;
+}
+
+/**
+ * @brief Returns the response to a framed message with an invalid header.
+ * @internal
+ *
+ * @return The serialized error response.
+ */
+const std::string& bad_header_response()
+{
+    static const std::string response =
+        wwa::json_rpc::generate_error_response(
+            wwa::json_rpc::exception(wwa::json_rpc::exception::PARSE_ERROR, wwa::json_rpc::err_bad_message_header)
+        )
+            .dump();
+
+    return response;
+}
+
+/**
+ * @brief Passes a message to the message handler.
+ * @internal
+ *
+ * @param handler The message handler.
+ * @param message The message.
+ * @param out The output buffer.
+ * @return Whether a response has been appended to @a out.
+ */
+bool handle_message(const wwa::json_rpc::message_handler& handler, std::string_view message, std::string& out)
+{
+    const auto offset = out.size();
+    try {
+        return handler(message, out);
+    }
+    catch (const std::exception& e) {
+        wwa::json_rpc::details::write_internal_error(out, offset, e);
+        return true;
+    }
+}
+
+/**
+ * @brief Extracts the value of the `Content-Length` field from the header of a framed message.
+ * @internal
+ *
+ * @param header The header without the terminating empty line.
+ * @param length The value of the field.
+ * @return Whether the header has a valid `Content-Length` field.
+ */
+bool parse_content_length(std::string_view header, std::size_t& length)
+{
+    static constexpr std::string_view name = "content-length";
+
+    bool found = false;
+    while (!header.empty()) {
+        const auto eol   = header.find("\r\n");
+        const auto field = header.substr(0, eol);
+        header           = eol == std::string_view::npos ? std::string_view{} : header.substr(eol + 2);
+        const auto colon = field.find(':');
+
+        if (colon != name.size() ||
+            !std::equal(name.begin(), name.end(), field.begin(), [](char expected, char actual) {
+                return expected == (actual >= 'A' && actual <= 'Z' ? static_cast<char>(actual - 'A' + 'a') : actual);
+            })) {
+            continue;
+        }
+
+        auto value = field.substr(colon + 1);
+        while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) {
+            value.remove_prefix(1);
+        }
+
+        while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) {
+            value.remove_suffix(1);
+        }
+
+        const auto* end   = value.data() + value.size();
+        const auto result = std::from_chars(value.data(), end, length);
+        if (found || value.empty() || result.ec != std::errc{} || result.ptr != end) {
+            return false;
+        }
+
+        found = true;
+    }
+
+    return found;
+}
+
+/**
+ * @brief State of a newline-delimited stream.
+ * @internal
+ */
+class ndjson_stream {
+public:
+    /**
+     * @brief Constructs the stream.
+     *
+     * @param out_fd The file descriptor to write the responses to.
+     * @param handler The message handler.
+     * @param options The options.
+     */
+    ndjson_stream(
+        int out_fd, const wwa::json_rpc::message_handler& handler, const wwa::json_rpc::stream_options& options
+    )
+        : m_out_fd(out_fd), m_handler(handler), m_options(options)
+    {}
+
+    /**
+     * @brief Processes a line.
+     *
+     * @param line The line without the newline.
+     */
+    void process(std::string_view line)
+    {
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+
+        if (line.empty()) {
+            return;
+        }
+
+        if (line.size() > this->m_options.max_message_size) {
+            this->reject();
+            return;
+        }
+
+        ++this->m_stats.messages;
+        if (handle_message(this->m_handler, line, this->m_output)) {
+            this->m_output.push_back('\n');
+            ++this->m_stats.responses;
+        }
+
+        if (this->m_output.size() >= this->m_options.write_threshold) {
+            this->flush();
+        }
+    }
+
+    /**
+     * @brief Answers a message that is too large.
+     */
+    void reject()
+    {
+        ++this->m_stats.messages;
+        ++this->m_stats.responses;
+        this->m_output.append(too_large_response()).push_back('\n');
+    }
+
+    /**
+     * @brief Writes the buffered responses.
+     */
+    void flush()
+    {
+        if (!this->m_output.empty()) {
+            write_all(this->m_out_fd, this->m_output);
+            this->m_stats.bytes_written += this->m_output.size();
+            this->m_output.clear();
+        }
+    }
+
+    /**
+     * @brief Returns the statistics.
+     *
+     * @return The statistics.
+     */
+    [[nodiscard]] wwa::json_rpc::stream_stats& stats() noexcept { return this->m_stats; }
+
+private:
+    int m_out_fd;                                     ///< The file descriptor to write the responses to.
+    const wwa::json_rpc::message_handler& m_handler;  ///< The message handler.
+    const wwa::json_rpc::stream_options& m_options;   ///< The options.
+    std::string m_output;                             ///< The buffered responses.
+    wwa::json_rpc::stream_stats m_stats;              ///< The statistics.
+};
+
+/**
+ * @brief State of a `Content-Length` framed stream.
+ * @internal
+ */
+class framed_stream {
+public:
+    /**
+     * @brief Constructs the stream.
+     *
+     * @param out_fd The file descriptor to write the responses to.
+     * @param handler The message handler.
+     * @param options The options.
+     */
+    framed_stream(
+        int out_fd, const wwa::json_rpc::message_handler& handler, const wwa::json_rpc::stream_options& options
+    )
+        : m_out_fd(out_fd), m_handler(handler), m_options(options)
+    {}
+
+    /**
+     * @brief Processes all complete messages at the beginning of @a data.
+     *
+     * @param data The unprocessed input.
+     * @return The number of consumed bytes; the rest of @a data must be passed again with more input.
+     */
+    std::size_t consume(std::string_view data)
+    {
+        std::size_t consumed = 0;
+        while (true) {
+            const auto rest = data.substr(consumed);
+
+            if (this->m_skip != 0) {
+                // The body of a message that is too large
+                const auto n = std::min(this->m_skip, rest.size());
+                this->m_skip -= n;
+                consumed += n;
+                if (this->m_skip != 0) {
+                    return consumed;
+                }
+            }
+            else if (this->m_body_size != std::string_view::npos) {
+                if (rest.size() < this->m_body_size) {
+                    return consumed;
+                }
+
+                this->process(rest.substr(0, this->m_body_size));
+                consumed += this->m_body_size;
+                this->m_body_size = std::string_view::npos;
+            }
+            else {
+                const auto pos = rest.find("\r\n\r\n");
+                if (pos == std::string_view::npos) {
+                    if (rest.size() > this->m_options.max_header_size + 3) {
+                        // Keep the last three bytes: they can be the beginning of the terminator
+                        if (!this->m_skipping_header) {
+                            this->respond(bad_header_response());
+                            this->m_skipping_header = true;
+                        }
+
+                        consumed += rest.size() - 3;
+                    }
+
+                    return consumed;
+                }
+
+                consumed += pos + 4;
+                if (std::exchange(this->m_skipping_header, false)) {
+                    continue;
+                }
+
+                std::size_t length = 0;
+                if (pos > this->m_options.max_header_size || !parse_content_length(rest.substr(0, pos), length)) {
+                    this->respond(bad_header_response());
+                }
+                else if (length > this->m_options.max_message_size) {
+                    this->respond(too_large_response());
+                    this->m_skip = length;
+                }
+                else {
+                    this->m_body_size = length;
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Returns the size of the body of the incomplete message.
+     *
+     * @return The size of the whole body, or `0` if it is unknown.
+     * @note The bytes of the body that have already been read count towards the size: consume() stops right after
+     * the header of the incomplete message, so the unconsumed input starts with its body.
+     */
+    [[nodiscard]] std::size_t expected_body_size() const noexcept
+    {
+        return this->m_body_size != std::string_view::npos ? this->m_body_size : 0;
+    }
+
+    /**
+     * @brief Writes the buffered responses.
+     */
+    void flush()
+    {
+        if (this->m_responses.empty()) {
+            return;
+        }
+
+        // The buffers may have been reallocated while the responses were being appended, so the pointers are taken now
+        this->m_iov.clear();
+        for (const auto& r : this->m_responses) {
+            this->m_iov.push_back({this->m_headers.data() + r.header_offset, r.header_size});
+            this->m_iov.push_back({this->m_output.data() + r.body_offset, r.body_size});
+        }
+
+        writev_all(this->m_out_fd, this->m_iov);
+        this->m_stats.bytes_written += this->m_headers.size() + this->m_output.size();
+        this->m_headers.clear();
+        this->m_output.clear();
+        this->m_responses.clear();
+    }
+
+    /**
+     * @brief Returns the statistics.
+     *
+     * @return The statistics.
+     */
+    [[nodiscard]] wwa::json_rpc::stream_stats& stats() noexcept { return this->m_stats; }
+
+private:
+    /**
+     * @brief Location of a buffered response.
+     */
+    struct response {
+        std::size_t header_offset;  ///< The offset of the header in `m_headers`.
+        std::size_t header_size;    ///< The size of the header.
+        std::size_t body_offset;    ///< The offset of the body in `m_output`.
+        std::size_t body_size;      ///< The size of the body.
+    };
+
+    int m_out_fd;                                      ///< The file descriptor to write the responses to.
+    const wwa::json_rpc::message_handler& m_handler;   ///< The message handler.
+    const wwa::json_rpc::stream_options& m_options;    ///< The options.
+    std::string m_output;                              ///< The bodies of the buffered responses.
+    std::string m_headers;                             ///< The headers of the buffered responses.
+    std::vector<response> m_responses;                 ///< The buffered responses.
+    std::vector<iovec> m_iov;                          ///< The buffers passed to `writev()`.
+    std::size_t m_body_size = std::string_view::npos;  ///< The size of the expected body; `npos` while in the header.
+    std::size_t m_skip      = 0;                       ///< The number of bytes of a body that is too large to skip.
+    bool m_skipping_header  = false;                   ///< Whether the rest of a header that is too large is skipped.
+    wwa::json_rpc::stream_stats m_stats;               ///< The statistics.
+
+    /**
+     * @brief Processes a message body.
+     *
+     * @param body The body.
+     */
+    void process(std::string_view body)
+    {
+        ++this->m_stats.messages;
+        const auto offset = this->m_output.size();
+        if (handle_message(this->m_handler, body, this->m_output)) {
+            this->add_response(offset);
+        }
+    }
+
+    /**
+     * @brief Answers a message that cannot be processed.
+     *
+     * @param error The serialized error response.
+     */
+    void respond(const std::string& error)
+    {
+        ++this->m_stats.messages;
+        const auto offset = this->m_output.size();
+        this->m_output.append(error);
+        this->add_response(offset);
+    }
+
+    /**
+     * @brief Frames the response appended to `m_output` at @a offset.
+     *
+     * @param offset The offset of the response body.
+     */
+    void add_response(std::size_t offset)
+    {
+        static constexpr std::string_view prefix = "Content-Length: ";
+
+        const auto size = this->m_output.size() - offset;
+        std::array<char, 24> digits{};
+        const auto* end = std::to_chars(digits.data(), digits.data() + digits.size(), size).ptr;
+
+        const auto header_offset = this->m_headers.size();
+        this->m_headers.append(prefix)
+            .append(digits.data(), static_cast<std::size_t>(end - digits.data()))
+            .append("\r\n\r\n");
+        this->m_responses.push_back({header_offset, this->m_headers.size() - header_offset, offset, size});
+        ++this->m_stats.responses;
+
+        if (this->m_output.size() >= this->m_options.write_threshold) {
+            this->flush();
+        }
+    }
+};
+
+}  // namespace
+
+namespace wwa::json_rpc {
+
+void details::write_internal_error(std::string& out, std::size_t offset, const std::exception& e)
+{
+    out.resize(offset);
+    // The message of the exception may come from the request and is not necessarily valid UTF-8
+    out.append(generate_error_response(exception(exception::INTERNAL_ERROR, e.what()))
+                   .dump(-1, ' ', false, nlohmann::json::error_handler_t::replace));
+}
+
+stream_stats run_ndjson_stream(int in_fd, int out_fd, const message_handler& handler, const stream_options& options)
+{
+    ndjson_stream stream(out_fd, handler, options);
+
+    const std::size_t read_size = options.read_size != 0 ? options.read_size : 1;
+    std::vector<char> buffer(read_size);
+    std::size_t end = 0;    // The end of the data in the buffer
+    bool skipping   = false;  // Whether the rest of a line that is too large is being skipped
+
+    while (true) {
+        stream.flush();
+
+        const auto n = read_some(in_fd, buffer.data() + end, read_size);
+        if (n == 0) {
+            break;
+        }
+
+        stream.stats().bytes_read += n;
+
+        const char* data  = buffer.data();
+        std::size_t start = 0;
+        std::size_t pos   = end;
+        end += n;
+
+        while (const auto* nl = static_cast<const char*>(std::memchr(data + pos, '\n', end - pos))) {
+            const auto eol = static_cast<std::size_t>(nl - data);
+            if (!skipping) {
+                stream.process({data + start, eol - start});
+            }
+
+            skipping = false;
+            start    = eol + 1;
+            pos      = start;
+        }
+
+        if (skipping) {
+            start = end;
+        }
+        else if (end - start > options.max_message_size) {
+            stream.reject();
+            skipping = true;
+            start    = end;
+        }
+
+        // Keep the incomplete line at the beginning of the buffer, and make room for the next read
+        end -= start;
+        if (start != 0 && end != 0) {
+            std::memmove(buffer.data(), buffer.data() + start, end);
+        }
+
+        if (buffer.size() - end < read_size) {
+            buffer.resize(end + read_size);
+        }
+    }
+
+    if (!skipping && end != 0) {
+        stream.process({buffer.data(), end});
+    }
+
+    stream.flush();
+    return stream.stats();
+}
+
+stream_stats run_framed_stream(int in_fd, int out_fd, const message_handler& handler, const stream_options& options)
+{
+    framed_stream stream(out_fd, handler, options);
+
+    const std::size_t read_size = options.read_size != 0 ? options.read_size : 1;
+    std::vector<char> buffer(read_size);
+    std::size_t end = 0;  // The end of the data in the buffer
+
+    while (true) {
+        stream.flush();
+
+        const auto n = read_some(in_fd, buffer.data() + end, read_size);
+        if (n == 0) {
+            break;
+        }
+
+        stream.stats().bytes_read += n;
+        end += n;
+
+        const auto start = stream.consume({buffer.data(), end});
+
+        // Keep the incomplete message at the beginning of the buffer, and make room for the next read
+        end -= start;
+        if (start != 0 && end != 0) {
+            std::memmove(buffer.data(), buffer.data() + start, end);
+        }
+
+        // Grow the buffer to fit a known body at once instead of in `read_size` steps; the body starts at the beginning
+        const auto needed = std::max(end + read_size, stream.expected_body_size());
+        if (buffer.size() < needed) {
+            buffer.resize(needed);
+        }
+    }
+
+    stream.flush();
+    return stream.stats();
+}
+
+}  // namespace wwa::json_rpc
@@ -0,0 +1,238 @@
+#ifndef D7A31E5C_96B2_4F0D_8C4A_2B58E1F07D93
+#define D7A31E5C_96B2_4F0D_8C4A_2B58E1F07D93
+
+/**
+ * @file
+ * @brief Drivers that feed the JSON RPC requests read from a file descriptor to a dispatcher.
+ *
+ * @details The drivers use POSIX `read()` and `write()` and are available on Unix-like systems only.
+ */
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "dispatcher.h"
+#include "export.h"
+
+namespace wwa::json_rpc {
+
+/**
+ * @brief Options of the stream drivers.
+ */
+struct stream_options {
+    std::size_t read_size        = 256UL * 1024UL;          ///< The number of bytes requested by every `read()`.
+    std::size_t write_threshold  = 256UL * 1024UL;          ///< The responses are written when they reach this size.
+    std::size_t max_message_size = 64UL * 1024UL * 1024UL;  ///< Longer messages are rejected with `INVALID_REQUEST`.
+    std::size_t max_header_size  = 8UL * 1024UL;            ///< The size limit of the header of a framed message.
+};
+
+/**
+ * @brief Statistics of a stream driver run.
+ */
+struct stream_stats {
+    std::uint64_t messages      = 0;  ///< The number of processed messages.
+    std::uint64_t responses     = 0;  ///< The number of written responses.
+    std::uint64_t bytes_read    = 0;  ///< The number of bytes read.
+    std::uint64_t bytes_written = 0;  ///< The number of bytes written.
+};
+
+/**
+ * @brief Processes a single message read by a stream driver.
+ *
+ * @details The handler receives the message and the output buffer; it appends the response (without a delimiter)
+ * to the buffer and returns whether a response has been appended. The message is only valid during the call.
+ * If the handler throws a `std::exception`, the stream drivers discard whatever it has appended and answer
+ * the message with an `INTERNAL_ERROR` response, so that a single bad message does not abort the stream.
+ */
+using message_handler = std::function<bool(std::string_view message, std::string& out)>;
+
+/**
+ * @brief Reads newline-delimited messages from a file descriptor and writes the responses to another one.
+ *
+ * @param in_fd The file descriptor to read the messages from.
+ * @param out_fd The file descriptor to write the responses to.
+ * @param handler The message handler.
+ * @param options The options.
+ * @return The statistics of the run.
+ * @throws std::system_error If a read or a write fails.
+ *
+ * @details The function reads the input in large chunks into a reusable buffer and passes every line to
+ * @a handler as a view into that buffer, without copying it. Empty lines are skipped, and a trailing `\r` is removed.
+ * The last line does not need to end with a newline. Every response is followed by a newline.
+ *
+ * The responses are collected in a buffer and written when the buffer reaches `stream_options::write_threshold` bytes,
+ * and before the function waits for more input, so that an interactive peer gets its responses without delay,
+ * and the bulk input produces large writes.
+ *
+ * A line longer than `stream_options::max_message_size` bytes is skipped and answered with an `INVALID_REQUEST` error.
+ *
+ * The function returns when it reaches the end of the input. The file descriptors can be non-blocking: the function
+ * waits for them with `poll()`.
+ */
+WWA_JSONRPC_EXPORT stream_stats
+run_ndjson_stream(int in_fd, int out_fd, const message_handler& handler, const stream_options& options = {});
+
+/**
+ * @brief Reads `Content-Length` framed messages from a file descriptor and writes the framed responses to another one.
+ *
+ * @param in_fd The file descriptor to read the messages from.
+ * @param out_fd The file descriptor to write the responses to.
+ * @param handler The message handler.
+ * @param options The options.
+ * @return The statistics of the run.
+ * @throws std::system_error If a read or a write fails.
+ *
+ * @details Every message consists of a header and a body, like in the Language Server Protocol:
+ * ```
+ * Content-Length: 52\r\n
+ * \r\n
+ * {"jsonrpc": "2.0", "method": "subtract", "params": [42, 23], "id": 1}
+ * ```
+ * The header fields are separated by `\r\n`, and the header ends with an empty line. The names of the fields are
+ * case-insensitive; all fields except `Content-Length` are ignored.
+ *
+ * The input is read into a reusable buffer; a message split across several reads is assembled there, and the body is
+ * passed to @a handler as a view into the buffer, without copying it. The responses are framed the same way.
+ * The headers and the bodies of the buffered responses are written with a single `writev()` call when the bodies reach
+ * `stream_options::write_threshold` bytes, and before the function waits for more input.
+ *
+ * A body longer than `stream_options::max_message_size` bytes is skipped and answered with an `INVALID_REQUEST` error.
+ * A header without a valid `Content-Length` field, or longer than `stream_options::max_header_size` bytes,
+ * is skipped and answered with a `PARSE_ERROR` error.
+ *
+ * The function returns when it reaches the end of the input; an incomplete message at the end is ignored.
+ * The file descriptors can be non-blocking: the function waits for them with `poll()`.
+ */
+WWA_JSONRPC_EXPORT stream_stats
+run_framed_stream(int in_fd, int out_fd, const message_handler& handler, const stream_options& options = {});
+
+namespace details {
+
+/**
+ * @brief Replaces a response that could not be produced with an `INTERNAL_ERROR` response.
+ * @internal
+ *
+ * @param out The output buffer.
+ * @param offset The size of @a out before the response was started.
+ * @param e The exception thrown while the response was produced.
+ */
+WWA_JSONRPC_EXPORT void write_internal_error(std::string& out, std::size_t offset, const std::exception& e);
+
+/**
+ * @brief A message handler that passes the messages to a dispatcher.
+ * @internal
+ *
+ * @tparam Context The type of the data passed to the handlers.
+ * @tparam BasicJsonType The JSON type (a `nlohmann::basic_json` specialization).
+ *
+ * @details The bookkeeping of the requests comes from a monotonic arena that is released after every request.
+ * A message that makes the dispatcher throw is answered with an `INTERNAL_ERROR` response.
+ */
+template<typename Context, typename BasicJsonType>
+class dispatching_handler {
+public:
+    /**
+     * @brief Constructs the handler.
+     *
+     * @param dispatcher The dispatcher.
+     * @param data The data passed to the handlers of the dispatcher.
+     */
+    dispatching_handler(basic_dispatcher<Context, BasicJsonType>& dispatcher, const Context& data)
+        : m_dispatcher(dispatcher), m_data(data)
+    {}
+
+    /**
+     * @brief Processes a message.
+     *
+     * @param message The request.
+     * @param out The output buffer.
+     * @return Whether a response has been written.
+     * @see basic_dispatcher::process_request_to()
+     */
+    bool operator()(std::string_view message, std::string& out)
+    {
+        const auto offset = out.size();
+        bool written      = true;
+        try {
+            written = this->m_dispatcher.process_request_to(message, out, this->m_data, &this->m_resource);
+        }
+        catch (const std::exception& e) {
+            write_internal_error(out, offset, e);
+        }
+
+        this->m_resource.release();
+        return written;
+    }
+
+private:
+    basic_dispatcher<Context, BasicJsonType>& m_dispatcher;  ///< The dispatcher.
+    const Context& m_data;                                   ///< The data passed to the handlers.
+    std::array<std::byte, 4096> m_buffer{};                  ///< The initial buffer of the arena.
+    std::pmr::monotonic_buffer_resource m_resource{this->m_buffer.data(), this->m_buffer.size()};  ///< The arena.
+};
+
+}  // namespace details
+
+/**
+ * @brief Processes the newline-delimited JSON RPC requests read from a file descriptor.
+ *
+ * @tparam Context The type of the data passed to the handlers.
+ * @tparam BasicJsonType The JSON type (a `nlohmann::basic_json` specialization).
+ * @param dispatcher The dispatcher.
+ * @param in_fd The file descriptor to read the requests from.
+ * @param out_fd The file descriptor to write the responses to.
+ * @param data Optional data that can be passed to the handler function (only for handlers added with @a add_ex()).
+ * @param options The options.
+ * @return The statistics of the run.
+ * @throws std::system_error If a read or a write fails.
+ *
+ * @details Every line is processed with `basic_dispatcher::process_request_to()` (notifications produce no output).
+ * The bookkeeping of the requests comes from a monotonic arena that is released after every request.
+ * @see run_ndjson_stream()
+ */
+template<typename Context, typename BasicJsonType>
+stream_stats process_ndjson_stream(
+    basic_dispatcher<Context, BasicJsonType>& dispatcher, int in_fd, int out_fd,
+    const std::type_identity_t<Context>& data = {}, const stream_options& options = {}
+)
+{
+    details::dispatching_handler<Context, BasicJsonType> handler(dispatcher, data);
+    return run_ndjson_stream(in_fd, out_fd, std::ref(handler), options);
+}
+
+/**
+ * @brief Processes the `Content-Length` framed JSON RPC requests read from a file descriptor.
+ *
+ * @tparam Context The type of the data passed to the handlers.
+ * @tparam BasicJsonType The JSON type (a `nlohmann::basic_json` specialization).
+ * @param dispatcher The dispatcher.
+ * @param in_fd The file descriptor to read the requests from.
+ * @param out_fd The file descriptor to write the responses to.
+ * @param data Optional data that can be passed to the handler function (only for handlers added with @a add_ex()).
+ * @param options The options.
+ * @return The statistics of the run.
+ * @throws std::system_error If a read or a write fails.
+ *
+ * @details Every message is processed with `basic_dispatcher::process_request_to()` (notifications produce no output).
+ * @see run_framed_stream()
+ */
+template<typename Context, typename BasicJsonType>
+stream_stats process_framed_stream(
+    basic_dispatcher<Context, BasicJsonType>& dispatcher, int in_fd, int out_fd,
+    const std::type_identity_t<Context>& data = {}, const stream_options& options = {}
+)
+{
+    details::dispatching_handler<Context, BasicJsonType> handler(dispatcher, data);
+    return run_framed_stream(in_fd, out_fd, std::ref(handler), options);
+}
+
+}  // namespace wwa::json_rpc
+
+#endif /* D7A31E5C_96B2_4F0D_8C4A_2B58E1F07D93 */
@@ -0,0 +1,654 @@
+#ifndef C7D2A8E4_5F19_4B63_9A0E_6E3B1F7C2D95
+#define C7D2A8E4_5F19_4B63_9A0E_6E3B1F7C2D95
+
+/**
+ * @file
+ * @brief Defines the coroutine type for asynchronous method handlers and the helpers to await it.
+ */
+
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "executor.h"
+
+namespace wwa::json_rpc {
+
+template<typename T>
+class task;
+
+/**
+ * @brief Contains the implementation details of the JSON RPC library.
+ * @internal
+ */
+namespace details {
+
+/**
+ * @brief Awaitable that transfers control to the coroutine awaiting a completed task.
+ * @internal
+ */
+struct task_final_awaiter {
+    [[nodiscard]] bool await_ready() const noexcept { return false; }
+
+    template<typename Promise>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> h) const noexcept
+    {
+        return h.promise().continuation();
+    }
+
+    void await_resume() const noexcept {}
+};
+
+/**
+ * @brief The part of the promise of a task that does not depend on the result type.
+ * @internal
+ */
+class task_promise_base {
+public:
+    /**
+     * @brief Tasks are lazy: the coroutine starts when the task is awaited.
+     *
+     * @return Awaitable that always suspends.
+     */
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+
+    /**
+     * @brief Resumes the awaiting coroutine when the task completes.
+     *
+     * @return Awaitable that transfers control to the awaiting coroutine.
+     */
+    auto final_suspend() const noexcept;
+
+    /**
+     * @brief Stores the exception thrown by the coroutine.
+     */
+    void unhandled_exception() noexcept { this->m_exception = std::current_exception(); }
+
+    /**
+     * @brief Sets the coroutine to resume when the task completes.
+     *
+     * @param continuation The awaiting coroutine.
+     */
+    void set_continuation(std::coroutine_handle<> continuation) noexcept { this->m_continuation = continuation; }
+
+    /**
+     * @brief Returns the coroutine to resume when the task completes.
+     *
+     * @return The awaiting coroutine; a no-op coroutine if there is none.
+     */
+    [[nodiscard]] std::coroutine_handle<> continuation() const noexcept { return this->m_continuation; }
+
+protected:
+    /**
+     * @brief Rethrows the exception thrown by the coroutine, if any.
+     */
+    void rethrow_if_failed() const
+    {
+        if (this->m_exception) {
+            std::rethrow_exception(this->m_exception);
+        }
+    }
+
+private:
+    std::coroutine_handle<> m_continuation = std::noop_coroutine();  ///< The awaiting coroutine.
+    std::exception_ptr m_exception;                                  ///< The exception thrown by the coroutine.
+};
+
+/**
+ * @brief The promise of a task that produces a value.
+ * @internal
+ *
+ * @tparam T The type of the value.
+ */
+template<typename T>
+class task_promise : public task_promise_base {
+public:
+    /**
+     * @brief Creates the task.
+     *
+     * @return The task.
+     */
+    task<T> get_return_object() noexcept
+    {
+        return task<T>(std::coroutine_handle<task_promise>::from_promise(*this));
+    }
+
+    /**
+     * @brief Stores the value returned by the coroutine.
+     *
+     * @tparam U The type of the value.
+     * @param value The value.
+     */
+    template<typename U>
+        requires std::is_convertible_v<U&&, T>
+    void return_value(U&& value)
+    {
+        this->m_value.emplace(std::forward<U>(value));
+    }
+
+    /**
+     * @brief Returns the result of the coroutine.
+     *
+     * @return The value returned by the coroutine.
+     * @throws Any exception thrown by the coroutine.
+     */
+    T result()
+    {
+        this->rethrow_if_failed();
+        return std::move(*this->m_value);
+    }
+
+private:
+    std::optional<T> m_value;  ///< The value returned by the coroutine.
+};
+
+/**
+ * @brief The promise of a task that does not produce a value.
+ * @internal
+ */
+template<>
+class task_promise<void> : public task_promise_base {
+public:
+    /**
+     * @brief Creates the task.
+     *
+     * @return The task.
+     */
+    task<void> get_return_object() noexcept;
+
+    /**
+     * @brief Handles the completion of the coroutine.
+     */
+    void return_void() const noexcept {}
+
+    /**
+     * @brief Returns the result of the coroutine.
+     *
+     * @throws Any exception thrown by the coroutine.
+     */
+    void result() const { this->rethrow_if_failed(); }
+};
+
+}  // namespace details
+
+/**
+ * @brief A lazily started coroutine that produces a value of type @a T.
+ *
+ * @tparam T The type of the value; can be `void`.
+ *
+ * @details This is the return type of asynchronous method handlers and of `dispatcher::process_request_async()`.
+ * The coroutine does not start until the task is awaited with `co_await` (or passed to sync_wait());
+ * when it completes, the awaiting coroutine is resumed on the same thread.
+ *
+ * A task can be awaited only once.
+ *
+ * @par Sample Usage:
+ * ```cpp
+ * wwa::json_rpc::task<std::string> load(int id)
+ * {
+ *     co_await wwa::json_rpc::resume_on(storage_executor);
+ *     co_return storage.load(id);
+ * }
+ *
+ * dispatcher.add("load", &load);
+ * ```
+ */
+template<typename T = void>
+class [[nodiscard]] task {
+public:
+    using promise_type = details::task_promise<T>;  ///< The promise type of the coroutine.
+    using value_type   = T;                         ///< The type of the value produced by the task.
+
+    /**
+     * @brief Constructs an empty task.
+     */
+    task() noexcept = default;
+
+    /**
+     * @brief Constructs a task from the coroutine handle.
+     *
+     * @param h The coroutine handle.
+     */
+    explicit task(std::coroutine_handle<promise_type> h) noexcept : m_handle(h) {}
+
+    /**
+     * @brief Destroys the coroutine.
+     */
+    ~task()
+    {
+        if (this->m_handle) {
+            this->m_handle.destroy();
+        }
+    }
+
+    task(const task&)            = delete;
+    task& operator=(const task&) = delete;
+
+    /**
+     * @brief Move constructor.
+     *
+     * @param other The task to move from.
+     */
+    task(task&& other) noexcept : m_handle(std::exchange(other.m_handle, {})) {}
+
+    /**
+     * @brief Move assignment operator.
+     *
+     * @param other The task to move from.
+     * @return Reference to this object.
+     */
+    task& operator=(task&& other) noexcept
+    {
+        if (this != &other) {
+            if (this->m_handle) {
+                this->m_handle.destroy();
+            }
+
+            this->m_handle = std::exchange(other.m_handle, {});
+        }
+
+        return *this;
+    }
+
+    /**
+     * @brief Makes the task awaitable.
+     *
+     * @return Awaitable that starts the coroutine and produces its result.
+     */
+    auto operator co_await() & noexcept { return awaiter{this->m_handle}; }
+
+    /**
+     * @brief Makes the task awaitable.
+     *
+     * @return Awaitable that starts the coroutine and produces its result.
+     * @overload
+     */
+    auto operator co_await() && noexcept { return awaiter{this->m_handle}; }
+
+private:
+    /**
+     * @brief Awaitable that starts the coroutine of the task.
+     */
+    struct awaiter {
+        std::coroutine_handle<promise_type> handle;  ///< The coroutine of the task.
+
+        /**
+         * @brief Checks whether the task has already completed.
+         *
+         * @return Whether the task has completed.
+         */
+        [[nodiscard]] bool await_ready() const noexcept { return this->handle.done(); }
+
+        /**
+         * @brief Starts the coroutine of the task.
+         *
+         * @param continuation The awaiting coroutine.
+         * @return The coroutine to transfer control to.
+         */
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> continuation) const noexcept
+        {
+            this->handle.promise().set_continuation(continuation);
+            return this->handle;
+        }
+
+        /**
+         * @brief Returns the result of the task.
+         *
+         * @return The value produced by the coroutine.
+         * @throws Any exception thrown by the coroutine.
+         */
+        T await_resume() const { return this->handle.promise().result(); }
+    };
+
+    std::coroutine_handle<promise_type> m_handle;  ///< The coroutine.
+};
+
+/**
+ * @brief Trait that checks whether @a T is a task.
+ *
+ * @tparam T The type to check.
+ */
+template<typename T>
+struct is_task : std::false_type {};
+
+/**
+ * @brief Specialization for tasks.
+ *
+ * @tparam T The type of the value produced by the task.
+ */
+template<typename T>
+struct is_task<task<T>> : std::true_type {};
+
+/**
+ * @brief Whether @a T is a task.
+ *
+ * @tparam T The type to check.
+ */
+template<typename T>
+inline constexpr bool is_task_v = is_task<T>::value;
+
+namespace details {
+
+inline auto task_promise_base::final_suspend() const noexcept
+{
+    return task_final_awaiter{};
+}
+
+inline task<void> task_promise<void>::get_return_object() noexcept
+{
+    return task<void>(std::coroutine_handle<task_promise>::from_promise(*this));
+}
+
+/**
+ * @brief Fire-and-forget coroutine used to drive tasks from non-coroutine code.
+ * @internal
+ *
+ * @details The coroutine is created suspended. When it finishes, it calls the completion callback of its promise;
+ * the owner is responsible for destroying it afterwards.
+ */
+class driver {
+public:
+    /**
+     * @brief The promise of the driver coroutine.
+     */
+    struct promise_type {
+        void (*on_complete)(void*) = nullptr;  ///< Completion callback.
+        void* arg                  = nullptr;  ///< The argument of the completion callback.
+
+        driver get_return_object() noexcept
+        {
+            return driver(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+
+        auto final_suspend() const noexcept
+        {
+            struct final_awaiter {
+                bool await_ready() const noexcept { return false; }
+                void await_suspend(std::coroutine_handle<promise_type> h) const noexcept
+                {
+                    h.promise().on_complete(h.promise().arg);
+                }
+
+                void await_resume() const noexcept {}
+            };
+
+            return final_awaiter{};
+        }
+
+        void return_void() const noexcept {}
+        void unhandled_exception() const noexcept { std::terminate(); }
+    };
+
+    /**
+     * @brief Constructs the driver from the coroutine handle.
+     *
+     * @param h The coroutine handle.
+     */
+    explicit driver(std::coroutine_handle<promise_type> h) noexcept : m_handle(h) {}
+
+    /**
+     * @brief Destroys the coroutine.
+     */
+    ~driver()
+    {
+        if (this->m_handle) {
+            this->m_handle.destroy();
+        }
+    }
+
+    driver(const driver&)            = delete;
+    driver& operator=(const driver&) = delete;
+
+    /**
+     * @brief Move constructor.
+     *
+     * @param other The driver to move from.
+     */
+    driver(driver&& other) noexcept : m_handle(std::exchange(other.m_handle, {})) {}
+
+    driver& operator=(driver&&) = delete;
+
+    /**
+     * @brief Starts the coroutine.
+     *
+     * @param on_complete Completion callback.
+     * @param arg The argument of the completion callback.
+     */
+    void start(void (*on_complete)(void*), void* arg) const
+    {
+        this->m_handle.promise().on_complete = on_complete;
+        this->m_handle.promise().arg         = arg;
+        this->m_handle.resume();
+    }
+
+private:
+    std::coroutine_handle<promise_type> m_handle;  ///< The coroutine.
+};
+
+/**
+ * @brief Awaits @a t and stores its outcome.
+ * @internal
+ *
+ * @tparam T The type of the value produced by the task.
+ * @param t The task.
+ * @param value Receives the value produced by the task.
+ * @param error Receives the exception thrown by the task.
+ * @return The driver coroutine.
+ */
+template<typename T>
+driver drive(task<T>& t, std::optional<T>& value, std::exception_ptr& error)
+{
+    try {
+        value.emplace(co_await t);
+    }
+    catch (...) {
+        error = std::current_exception();
+    }
+}
+
+/**
+ * @brief Awaits @a t and stores the exception it throws.
+ * @internal
+ *
+ * @param t The task.
+ * @param error Receives the exception thrown by the task.
+ * @return The driver coroutine.
+ */
+inline driver drive(task<void>& t, std::exception_ptr& error)
+{
+    try {
+        co_await t;
+    }
+    catch (...) {
+        error = std::current_exception();
+    }
+}
+
+/**
+ * @brief State shared between when_all() and the tasks it awaits.
+ * @internal
+ */
+struct when_all_state {
+    std::atomic_size_t pending{0};      ///< The number of incomplete tasks plus one for the awaiting coroutine.
+    std::coroutine_handle<> awaiting;  ///< The awaiting coroutine.
+
+    /**
+     * @brief Marks a task (or the awaiting coroutine) as done; resumes the awaiting coroutine after the last one.
+     *
+     * @param arg Pointer to the state.
+     */
+    static void arrive(void* arg)
+    {
+        auto* self = static_cast<when_all_state*>(arg);
+        if (self->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            self->awaiting.resume();
+        }
+    }
+};
+
+/**
+ * @brief Awaitable that starts all drivers and resumes the awaiting coroutine when all of them complete.
+ * @internal
+ */
+struct when_all_awaiter {
+    std::vector<driver>& drivers;  ///< The drivers.
+    when_all_state state;          ///< The shared state.
+
+    [[nodiscard]] bool await_ready() const noexcept { return this->drivers.empty(); }
+
+    bool await_suspend(std::coroutine_handle<> h)
+    {
+        this->state.awaiting = h;
+        this->state.pending.store(this->drivers.size() + 1, std::memory_order_relaxed);
+        for (const auto& d : this->drivers) {
+            d.start(&when_all_state::arrive, &this->state);
+        }
+
+        return this->state.pending.fetch_sub(1, std::memory_order_acq_rel) != 1;
+    }
+
+    void await_resume() const noexcept {}
+};
+
+}  // namespace details
+
+/**
+ * @brief Awaits all tasks concurrently.
+ *
+ * @tparam T The type of the values produced by the tasks.
+ * @param tasks The tasks.
+ * @return Task that produces the values of @a tasks in the same order.
+ * @throws Any exception thrown by the tasks (the first one in the order of @a tasks), after all of them complete.
+ *
+ * @details The tasks are started one after another; when a task suspends, the next one is started.
+ * The awaiting coroutine is resumed by the thread that completes the last task.
+ */
+template<typename T>
+task<std::vector<T>> when_all(std::vector<task<T>> tasks)
+{
+    std::vector<std::optional<T>> values(tasks.size());
+    std::vector<std::exception_ptr> errors(tasks.size());
+    std::vector<details::driver> drivers;
+    drivers.reserve(tasks.size());
+    for (std::size_t i = 0; i < tasks.size(); ++i) {
+        drivers.push_back(details::drive(tasks[i], values[i], errors[i]));
+    }
+
+    co_await details::when_all_awaiter{drivers, {}};
+
+    for (const auto& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    std::vector<T> result;
+    result.reserve(values.size());
+    for (auto& value : values) {
+        result.push_back(std::move(*value));
+    }
+
+    co_return result;
+}
+
+/**
+ * @brief Blocks the calling thread until the task completes.
+ *
+ * @tparam T The type of the value produced by the task.
+ * @param t The task.
+ * @return The value produced by the task.
+ * @throws Any exception thrown by the task.
+ *
+ * @details This function bridges synchronous and asynchronous code. It must not be called from a thread that
+ * the task needs to make progress (for example, the only thread of the executor the task resumes on).
+ */
+template<typename T>
+T sync_wait(task<T> t)
+{
+    struct state_t {
+        std::mutex mutex;
+        std::condition_variable cv;
+        bool done = false;
+
+        static void complete(void* arg)
+        {
+            auto* self = static_cast<state_t*>(arg);
+            const std::lock_guard lock(self->mutex);
+            self->done = true;
+            self->cv.notify_one();
+        }
+    } state;
+
+    std::exception_ptr error;
+    std::optional<std::conditional_t<std::is_void_v<T>, bool, T>> value;
+
+    auto d = [&]() {
+        if constexpr (std::is_void_v<T>) {
+            return details::drive(t, error);
+        }
+        else {
+            return details::drive(t, value, error);
+        }
+    }();
+
+    d.start(&state_t::complete, &state);
+
+    {
+        std::unique_lock lock(state.mutex);
+        state.cv.wait(lock, [&state]() { return state.done; });
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+
+    if constexpr (!std::is_void_v<T>) {
+        return std::move(*value);
+    }
+}
+
+/**
+ * @brief Returns an awaitable that resumes the awaiting coroutine on the executor.
+ *
+ * @param exec The executor.
+ * @return Awaitable.
+ *
+ * @par Sample Usage:
+ * ```cpp
+ * wwa::json_rpc::task<int> handler()
+ * {
+ *     co_await wwa::json_rpc::resume_on(pool);
+ *     // Now running on a thread of the pool
+ *     co_return 42;
+ * }
+ * ```
+ */
+inline auto resume_on(executor& exec) noexcept
+{
+    struct awaiter {
+        executor& exec;  ///< The executor.
+
+        [[nodiscard]] bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> h) const
+        {
+            this->exec.execute([h]() { h.resume(); });
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    return awaiter{exec};
+}
+
+}  // namespace wwa::json_rpc
+
+#endif /* C7D2A8E4_5F19_4B63_9A0E_6E3B1F7C2D95 */
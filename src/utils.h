@@ -7,17 +7,17 @@
  */
 
 #include <string>
+#include <type_traits>
 #include <nlohmann/json.hpp>
 
-#include "export.h"
+#include "exception.h"
 
 namespace wwa::json_rpc {
 
-class exception;
-
 /**
  * @brief Checks if the provided JSON value is a valid JSON RPC request ID.
  *
+ * @tparam BasicJsonType The JSON type (a `nlohmann::basic_json` specialization).
  * @param id The JSON value to check.
  * @return `true` if the JSON value is a valid request ID, `false` otherwise.
  *
@@ -27,11 +27,16 @@ class exception;
  *
  * @see https://www.jsonrpc.org/specification#request_object
  */
-WWA_JSONRPC_EXPORT bool is_valid_request_id(const nlohmann::json& id);
+template<typename BasicJsonType>
+bool is_valid_request_id(const BasicJsonType& id)
+{
+    return id.is_string() || id.is_number() || id.is_null() || id.is_discarded();
+}
 
 /**
  * @brief Get the request id object
  *
+ * @tparam BasicJsonType The JSON type (a `nlohmann::basic_json` specialization).
  * @param request JSON RPC request
  * @return Request ID
  *
@@ -39,52 +44,90 @@ WWA_JSONRPC_EXPORT bool is_valid_request_id(const nlohmann::json& id);
  * If the `id` field is not present or is not valid (see @a is_valid_request_id()),
  * it returns a `null` JSON value.
  */
-WWA_JSONRPC_EXPORT nlohmann::json get_request_id(const nlohmann::json& request);
+template<typename BasicJsonType>
+BasicJsonType get_request_id(const BasicJsonType& request)
+{
+    auto id = request.contains("id") ? request["id"] : BasicJsonType(nullptr);
+    return is_valid_request_id(id) ? id : BasicJsonType(nullptr);
+}
 
 /**
  * @brief Serializes the JSON RPC response to a string.
  *
+ * @tparam BasicJsonType The JSON type (a `nlohmann::basic_json` specialization).
  * @param response Response to serialize.
  * @return Response serialized to a string' empty string if `response.is_discarded()` is `true`.
  */
-WWA_JSONRPC_EXPORT std::string serialize_repsonse(const nlohmann::json& response);
+template<typename BasicJsonType>
+std::string serialize_repsonse(const BasicJsonType& response)
+{
+    return response.is_discarded() ? std::string{} : response.dump();
+}
 
 /**
  * @brief Checks whether @a response is an error response.
  *
+ * @tparam BasicJsonType The JSON type (a `nlohmann::basic_json` specialization).
  * @param response JSON RPC response.
  * @return Whether the response is an error response.
  */
-WWA_JSONRPC_EXPORT bool is_error_response(const nlohmann::json& response);
+template<typename BasicJsonType>
+bool is_error_response(const BasicJsonType& response)
+{
+    return response.is_object() && response.contains("error") && response["error"].is_object();
+}
 
 /**
  * @brief Gets the error code from an error response.
  *
+ * @tparam BasicJsonType The JSON type (a `nlohmann::basic_json` specialization).
  * @param response JSON RPC error response.
  * @return The error code.
  */
-WWA_JSONRPC_EXPORT int get_error_code(const nlohmann::json& response);
+template<typename BasicJsonType>
+int get_error_code(const BasicJsonType& response)
+{
+    return response.at("error").value("code", 0);
+}
 
 /**
  * @brief Gets the error message from an error response.
  *
+ * @tparam BasicJsonType The JSON type (a `nlohmann::basic_json` specialization).
  * @param response JSON RPC error response.
  * @return The error message.
  */
-WWA_JSONRPC_EXPORT std::string get_error_message(const nlohmann::json& response);
+template<typename BasicJsonType>
+std::string get_error_message(const BasicJsonType& response)
+{
+    return response.at("error").value("message", "");
+}
 
 /**
  * @brief Generates an error response.
  *
+ * @tparam BasicJsonType The JSON type of the response (a `nlohmann::basic_json` specialization).
  * @param e The exception containing the error details.
  * @param id The ID of the request.
  * @return The error response serialized into a JSON object.
  *
  * @details This method creates a JSON RPC error response based on the provided exception and request ID.
+ * @a BasicJsonType is not deduced from @a id, so that `nullptr` and other values convertible to a JSON value
+ * can be passed as the ID.
  * @see exception::to_json()
  */
-WWA_JSONRPC_EXPORT nlohmann::json
-generate_error_response(const exception& e, const nlohmann::json& id = nlohmann::json::value_t::null);
+template<typename BasicJsonType = nlohmann::json>
+BasicJsonType
+generate_error_response(const exception& e, const std::type_identity_t<BasicJsonType>& id = BasicJsonType(nullptr))
+{
+    // clang-format off
+    return {
+        {"jsonrpc", "2.0"},
+        {"error", BasicJsonType(e.to_json())},
+        {"id", id}
+    };
+    // clang-format on
+}
 
 }  // namespace wwa::json_rpc
 
@@ -0,0 +1,206 @@
+#include <any>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <span>
+#include <string>
+#include <string_view>
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+
+#include "dispatcher.h"
+
+namespace {
+
+std::atomic_size_t allocations{0};
+
+}  // namespace
+
+// NOLINTBEGIN(cppcoreguidelines-no-malloc,hicpp-no-malloc,misc-new-delete-overloads)
+void* operator new(std::size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size != 0 ? size : 1); ptr != nullptr) {
+        return ptr;
+    }
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+// NOLINTEND(cppcoreguidelines-no-malloc,hicpp-no-malloc,misc-new-delete-overloads)
+
+class invoking_dispatcher : public wwa::json_rpc::dispatcher {
+public:
+    using wwa::json_rpc::dispatcher::invoke;
+};
+
+class counting_dispatcher : public wwa::json_rpc::dispatcher {
+public:
+    [[nodiscard]] int requests() const noexcept { return this->m_requests; }
+
+protected:
+    void request_parsed(const wwa::json_rpc::jsonrpc_request&, const std::any&, std::uint64_t) override
+    {
+        ++this->m_requests;
+    }
+
+private:
+    int m_requests = 0;
+};
+
+class AllocationTest : public ::testing::TestWithParam<std::string> {
+public:
+    AllocationTest()
+    {
+        this->m_dispatcher.add("sum", [](int a, int b) { return a + b; });
+        this->m_dispatcher.add("size", [](const nlohmann::json& params) { return params.size(); });
+        this->m_dispatcher.add_ex("context", [](const wwa::json_rpc::dispatcher::context_t& ctx, int a) {
+            return a + static_cast<int>(ctx.second.size());
+        });
+
+        // A closure that does not fit into the small buffer of `std::function`
+        this->m_dispatcher.add("large", [large = std::array<int, 64>{}](int a, int b) { return a + b + large[0]; });
+    }
+
+    invoking_dispatcher& dispatcher() noexcept { return this->m_dispatcher; }
+
+private:
+    invoking_dispatcher m_dispatcher;
+};
+
+TEST_P(AllocationTest, TestInvokeDoesNotAllocate)
+{
+    const auto& method = GetParam();
+    const auto params  = nlohmann::json::array({1, 2});
+    const wwa::json_rpc::dispatcher::context_t ctx{{}, nlohmann::json::object()};
+
+    const auto before = allocations.load();
+    const auto result = this->dispatcher().invoke(method, params, ctx, 0);
+    const auto after  = allocations.load();
+
+    EXPECT_TRUE(result.is_number());
+    EXPECT_EQ(after - before, 0);
+}
+
+INSTANTIATE_TEST_SUITE_P(Invocation, AllocationTest, testing::Values("sum", "size", "large"));
+
+TEST_F(AllocationTest, TestInvokeWithContextDoesNotAllocate)
+{
+    const std::string method = "context";
+    const auto params        = nlohmann::json::array({1});
+    const wwa::json_rpc::dispatcher::context_t ctx{std::string(64, 'x'), nlohmann::json({{"auth", "secret"}})};
+
+    const auto before = allocations.load();
+    const auto result = this->dispatcher().invoke(method, params, ctx, 0);
+    const auto after  = allocations.load();
+
+    EXPECT_EQ(result, 2);
+    EXPECT_EQ(after - before, 0);
+}
+
+TEST(ZeroCopyTest, TestBoundParamsDoNotAllocate)
+{
+    invoking_dispatcher dispatcher;
+    dispatcher.add(
+        "lengths",
+        [](const std::string& s, std::string_view v, const nlohmann::json::array_t& a, std::span<const nlohmann::json> sp,
+           const nlohmann::json& j) { return s.size() + v.size() + a.size() + sp.size() + j.size(); }
+    );
+
+    const std::string method = "lengths";
+    const std::string value(1024, 'x');
+    const auto params = nlohmann::json::array({value, value, {1, 2, 3}, {4}, {{"key", value}}});
+    const wwa::json_rpc::dispatcher::context_t ctx{{}, nlohmann::json::object()};
+
+    const auto before = allocations.load();
+    const auto result = dispatcher.invoke(method, params, ctx, 0);
+    const auto after  = allocations.load();
+
+    EXPECT_EQ(result, 2053);
+    EXPECT_EQ(after - before, 0);
+}
+
+TEST(LazyExtraTest, TestExtraIsNotCollectedForPlainHandlers)
+{
+    wwa::json_rpc::dispatcher dispatcher;
+    dispatcher.add("sum", [](int a, int b) { return a + b; });
+
+    const auto plain = nlohmann::json::parse(R"({"jsonrpc": "2.0", "method": "sum", "params": [1, 2], "id": 1})");
+    const auto extra = nlohmann::json::parse(
+        R"({"jsonrpc": "2.0", "method": "sum", "params": [1, 2], "id": 1, "auth": {"user": "admin", "roles": ["a"]}})"
+    );
+
+    auto before                  = allocations.load();
+    const auto expected          = dispatcher.process_request(plain);
+    const auto plain_allocations = allocations.load() - before;
+
+    before                       = allocations.load();
+    const auto actual            = dispatcher.process_request(extra);
+    const auto extra_allocations = allocations.load() - before;
+
+    EXPECT_EQ(actual, expected);
+    EXPECT_EQ(extra_allocations, plain_allocations);
+}
+
+TEST(LazyExtraTest, TestExtraIsNotCollectedForHooksThatDoNotReadIt)
+{
+    counting_dispatcher dispatcher;
+    dispatcher.add("sum", [](int a, int b) { return a + b; });
+
+    const auto plain = nlohmann::json::parse(R"({"jsonrpc": "2.0", "method": "sum", "params": [1, 2], "id": 1})");
+    const auto extra = nlohmann::json::parse(
+        R"({"jsonrpc": "2.0", "method": "sum", "params": [1, 2], "id": 1, "auth": {"user": "admin", "roles": ["a"]}})"
+    );
+
+    auto before                  = allocations.load();
+    const auto expected          = dispatcher.process_request(plain);
+    const auto plain_allocations = allocations.load() - before;
+
+    before                       = allocations.load();
+    const auto actual            = dispatcher.process_request(extra);
+    const auto extra_allocations = allocations.load() - before;
+
+    EXPECT_EQ(actual, expected);
+    EXPECT_EQ(extra_allocations, plain_allocations);
+    EXPECT_EQ(dispatcher.requests(), 2);
+}
+
+TEST(LazyExtraTest, TestExtraIsNotCollectedNextToContextHandlers)
+{
+    wwa::json_rpc::dispatcher dispatcher;
+    dispatcher.add("sum", [](int a, int b) { return a + b; });
+    dispatcher.add_ex("auth", [](const wwa::json_rpc::dispatcher::context_t& ctx) { return ctx.second.at("auth"); });
+
+    const auto plain = nlohmann::json::parse(R"({"jsonrpc": "2.0", "method": "sum", "params": [1, 2], "id": 1})");
+    const auto extra = nlohmann::json::parse(
+        R"({"jsonrpc": "2.0", "method": "sum", "params": [1, 2], "id": 1, "auth": {"user": "admin", "roles": ["a"]}})"
+    );
+
+    auto before                  = allocations.load();
+    const auto expected          = dispatcher.process_request(plain);
+    const auto plain_allocations = allocations.load() - before;
+
+    before                       = allocations.load();
+    const auto actual            = dispatcher.process_request(extra);
+    const auto extra_allocations = allocations.load() - before;
+
+    EXPECT_EQ(actual, expected);
+    EXPECT_EQ(extra_allocations, plain_allocations);
+
+    auto request      = extra;
+    request["method"] = "auth";
+    request.erase("params");
+    EXPECT_EQ(dispatcher.process_request(request)["result"], extra["auth"]);
+}
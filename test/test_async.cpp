@@ -0,0 +1,221 @@
+#include <any>
+#include <coroutine>
+#include <cstddef>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+
+#include "dispatcher.h"
+#include "executor.h"
+#include "task.h"
+#include "utils.h"
+
+using namespace nlohmann::json_literals;
+
+namespace {
+
+/**
+ * @brief Awaitable that suspends the coroutines until a given number of them are waiting, then resumes all of them.
+ */
+class rendezvous {
+public:
+    rendezvous(std::size_t count, wwa::json_rpc::executor& exec) : m_count(count), m_executor(exec) {}
+
+    auto wait()
+    {
+        struct awaiter {
+            rendezvous& self;
+
+            [[nodiscard]] bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> h) const { this->self.arrive(h); }
+            void await_resume() const noexcept {}
+        };
+
+        return awaiter{*this};
+    }
+
+private:
+    std::size_t m_count;
+    wwa::json_rpc::executor& m_executor;
+    std::mutex m_mutex;
+    std::vector<std::coroutine_handle<>> m_waiting;
+
+    void arrive(std::coroutine_handle<> h)
+    {
+        std::vector<std::coroutine_handle<>> ready;
+
+        {
+            const std::lock_guard lock(this->m_mutex);
+            this->m_waiting.push_back(h);
+            if (this->m_waiting.size() == this->m_count) {
+                ready.swap(this->m_waiting);
+            }
+        }
+
+        for (auto handle : ready) {
+            this->m_executor.execute([handle]() { handle.resume(); });
+        }
+    }
+};
+
+}  // namespace
+
+class AsyncTest : public ::testing::Test {
+public:
+    AsyncTest()
+    {
+        this->m_dispatcher.add("sync", [](int a, int b) { return a + b; });
+        this->m_dispatcher.add("sum", [this](int a, int b) -> wwa::json_rpc::task<int> {
+            co_await wwa::json_rpc::resume_on(this->m_pool);
+            co_return a + b;
+        });
+
+        this->m_dispatcher.add("echo", [this](const nlohmann::json& params) -> wwa::json_rpc::task<nlohmann::json> {
+            co_await wwa::json_rpc::resume_on(this->m_pool);
+            co_return params;
+        });
+
+        this->m_dispatcher.add("void", [this]() -> wwa::json_rpc::task<> {
+            co_await wwa::json_rpc::resume_on(this->m_pool);
+        });
+
+        this->m_dispatcher.add("throw", [this]() -> wwa::json_rpc::task<int> {
+            co_await wwa::json_rpc::resume_on(this->m_pool);
+            throw std::runtime_error("Boom");
+        });
+
+        this->m_dispatcher.add_ex(
+            "extra",
+            [this](const wwa::json_rpc::dispatcher::context_t& ctx,
+                   const std::string& prefix) -> wwa::json_rpc::task<std::string> {
+                co_await wwa::json_rpc::resume_on(this->m_pool);
+                co_return prefix + std::any_cast<std::string>(ctx.first) + ctx.second["user"].get<std::string>();
+            }
+        );
+
+        this->m_dispatcher.add("rendezvous", [this]() -> wwa::json_rpc::task<bool> {
+            co_await this->m_rendezvous.wait();
+            co_return true;
+        });
+    }
+
+    wwa::json_rpc::dispatcher& dispatcher() noexcept { return this->m_dispatcher; }
+
+    nlohmann::json process(const nlohmann::json& request, const std::any& data = {})
+    {
+        return wwa::json_rpc::sync_wait(this->m_dispatcher.process_request_async(request, data));
+    }
+
+private:
+    wwa::json_rpc::thread_pool m_pool{4};
+    rendezvous m_rendezvous{3, m_pool};
+    wwa::json_rpc::dispatcher m_dispatcher;
+};
+
+TEST_F(AsyncTest, TestAsyncHandler)
+{
+    const auto request  = R"({"jsonrpc": "2.0", "method": "sum", "params": [2, 3], "id": 1})"_json;
+    const auto expected = R"({"jsonrpc": "2.0", "result": 5, "id": 1})"_json;
+
+    EXPECT_EQ(this->process(request), expected);
+    EXPECT_EQ(this->dispatcher().process_request(request), expected);
+    EXPECT_EQ(this->dispatcher().process_request(request.dump()), expected);
+}
+
+TEST_F(AsyncTest, TestSyncHandler)
+{
+    const auto request = R"({"jsonrpc": "2.0", "method": "sync", "params": [2, 3], "id": 1})"_json;
+    EXPECT_EQ(this->process(request), R"({"jsonrpc": "2.0", "result": 5, "id": 1})"_json);
+}
+
+TEST_F(AsyncTest, TestRawParams)
+{
+    const auto request = R"({"jsonrpc": "2.0", "method": "echo", "params": {"a": [1, 2]}, "id": "x"})"_json;
+    EXPECT_EQ(this->process(request), R"({"jsonrpc": "2.0", "result": [{"a": [1, 2]}], "id": "x"})"_json);
+}
+
+TEST_F(AsyncTest, TestVoidHandler)
+{
+    const auto request = R"({"jsonrpc": "2.0", "method": "void", "id": 2})"_json;
+    EXPECT_EQ(this->process(request), R"({"jsonrpc": "2.0", "result": null, "id": 2})"_json);
+    EXPECT_TRUE(this->process(R"({"jsonrpc": "2.0", "method": "void"})"_json).is_discarded());
+}
+
+TEST_F(AsyncTest, TestContext)
+{
+    const auto request  = R"({"jsonrpc": "2.0", "method": "extra", "params": ["> "], "id": 3, "user": "admin"})"_json;
+    const auto expected = R"({"jsonrpc": "2.0", "result": "> 127.0.0.1 admin", "id": 3})"_json;
+
+    EXPECT_EQ(this->process(request, std::string("127.0.0.1 ")), expected);
+}
+
+TEST_F(AsyncTest, TestErrors)
+{
+    const auto thrown = this->process(R"({"jsonrpc": "2.0", "method": "throw", "id": 4})"_json);
+    ASSERT_TRUE(wwa::json_rpc::is_error_response(thrown));
+    EXPECT_EQ(wwa::json_rpc::get_error_code(thrown), wwa::json_rpc::exception::INTERNAL_ERROR);
+    EXPECT_EQ(wwa::json_rpc::get_error_message(thrown), "Boom");
+
+    const auto bad_params = this->process(R"({"jsonrpc": "2.0", "method": "sum", "params": ["a", 1], "id": 5})"_json);
+    ASSERT_TRUE(wwa::json_rpc::is_error_response(bad_params));
+    EXPECT_EQ(wwa::json_rpc::get_error_code(bad_params), wwa::json_rpc::exception::INVALID_PARAMS);
+
+    const auto missing = this->process(R"({"jsonrpc": "2.0", "method": "missing", "id": 6})"_json);
+    ASSERT_TRUE(wwa::json_rpc::is_error_response(missing));
+    EXPECT_EQ(wwa::json_rpc::get_error_code(missing), wwa::json_rpc::exception::METHOD_NOT_FOUND);
+
+    EXPECT_TRUE(this->process(R"({"jsonrpc": "2.0", "method": "throw"})"_json).is_discarded());
+}
+
+TEST_F(AsyncTest, TestBatch)
+{
+    const auto request = R"([
+        {"jsonrpc": "2.0", "method": "sum", "params": [1, 2], "id": 1},
+        {"jsonrpc": "2.0", "method": "sync", "params": [3, 4], "id": 2},
+        {"jsonrpc": "2.0", "method": "void"},
+        1,
+        {"jsonrpc": "2.0", "method": "throw", "id": 3}
+    ])"_json;
+
+    const auto actual = this->process(request);
+    EXPECT_EQ(actual, this->dispatcher().process_request(request));
+    ASSERT_TRUE(actual.is_array());
+    ASSERT_EQ(actual.size(), 4);
+    EXPECT_EQ(actual[0]["result"], 3);
+    EXPECT_EQ(actual[1]["result"], 7);
+    EXPECT_TRUE(wwa::json_rpc::is_error_response(actual[2]));
+    EXPECT_TRUE(wwa::json_rpc::is_error_response(actual[3]));
+}
+
+TEST_F(AsyncTest, TestBatchElementsRunConcurrently)
+{
+    // Every handler waits until all three are waiting: this completes only if the elements are awaited concurrently
+    const auto request = R"([
+        {"jsonrpc": "2.0", "method": "rendezvous", "id": 1},
+        {"jsonrpc": "2.0", "method": "rendezvous", "id": 2},
+        {"jsonrpc": "2.0", "method": "rendezvous", "id": 3}
+    ])"_json;
+
+    const auto actual = this->process(request);
+    ASSERT_TRUE(actual.is_array());
+    ASSERT_EQ(actual.size(), 3);
+    for (std::size_t i = 0; i < 3; ++i) {
+        EXPECT_EQ(actual[i]["id"], i + 1);
+        EXPECT_TRUE(actual[i].contains("result"));
+    }
+}
+
+TEST_F(AsyncTest, TestNotificationBatch)
+{
+    const auto request = R"([
+        {"jsonrpc": "2.0", "method": "sum", "params": [1, 2]},
+        {"jsonrpc": "2.0", "method": "void"}
+    ])"_json;
+
+    EXPECT_TRUE(this->process(request).is_discarded());
+    EXPECT_EQ(this->process(nlohmann::json::array()), this->dispatcher().process_request(nlohmann::json::array()));
+}
@@ -0,0 +1,114 @@
+#include <string>
+#include <string_view>
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+
+#include "base.h"
+#include "codec.h"
+#include "exception.h"
+#include "utils.h"
+
+namespace {
+
+/**
+ * @brief A user-defined codec without the `format` member: the requests are decoded into a DOM.
+ */
+struct ubjson_dom_codec {
+    template<typename BasicJsonType>
+    static BasicJsonType decode(std::string_view input)
+    {
+        return BasicJsonType::from_ubjson(input.begin(), input.end());
+    }
+
+    template<typename BasicJsonType>
+    static void encode(const BasicJsonType& value, std::string& out)
+    {
+        BasicJsonType::to_ubjson(value, out);
+    }
+};
+
+// clang-format off
+const char* const requests[] = {  // NOLINT(*-avoid-c-arrays)
+    R"({"jsonrpc": "2.0", "method": "subtract_p", "params": [42, 23], "id": 1})",
+    R"({"jsonrpc": "2.0", "method": "subtract", "params": {"minuend": 42, "subtrahend": 23}, "id": "a"})",
+    R"({"jsonrpc": "2.0", "method": "sumv", "params": [1, 2, 3, 4, 5], "id": null})",
+    R"({"jsonrpc": "2.0", "method": "get_data", "id": 2.5})",
+    R"({"jsonrpc": "2.0", "method": "notify_hello", "params": [7]})",
+    R"({"jsonrpc": "2.0", "method": "foobar", "id": 3})",
+    R"({"jsonrpc": "2.0", "method": "subtract_p", "params": ["a", "b"], "id": 4})",
+    R"({"jsonrpc": "2.0", "method": "throwing", "id": 5})",
+    R"({"jsonrpc": "2.0", "method": 1, "params": "bar"})",
+    R"([])",
+    R"([1, 2])",
+    R"([
+        {"jsonrpc": "2.0", "method": "sum", "params": [1, 2, 4], "id": "1"},
+        {"jsonrpc": "2.0", "method": "notify_hello", "params": [7]},
+        {"foo": "boo"},
+        {"jsonrpc": "2.0", "method": "get_data", "id": "9"}
+    ])",
+    R"([
+        {"jsonrpc": "2.0", "method": "notify_hello", "params": [1]},
+        {"jsonrpc": "2.0", "method": "notification"}
+    ])"
+};
+// clang-format on
+
+}  // namespace
+
+template<typename Codec>
+class CodecTest : public BaseDispatcherTest {};
+
+using codecs = ::testing::Types<
+    wwa::json_rpc::json_codec, wwa::json_rpc::cbor_codec, wwa::json_rpc::msgpack_codec, ubjson_dom_codec>;
+TYPED_TEST_SUITE(CodecTest, codecs);
+
+TYPED_TEST(CodecTest, TestSameResponses)
+{
+    for (const auto* input : requests) {
+        const auto request  = nlohmann::json::parse(input);
+        const auto expected = this->dispatcher().process_request(request);
+
+        std::string encoded;
+        TypeParam::encode(request, encoded);
+
+        std::string out;
+        const bool written = wwa::json_rpc::process_encoded_request<TypeParam>(this->dispatcher(), encoded, out);
+        if (expected.is_discarded()) {
+            EXPECT_FALSE(written) << input;
+            EXPECT_TRUE(out.empty()) << input;
+        }
+        else {
+            ASSERT_TRUE(written) << input;
+            EXPECT_EQ(TypeParam::template decode<nlohmann::json>(out), expected) << input;
+        }
+    }
+}
+
+TYPED_TEST(CodecTest, TestRoundTrip)
+{
+    const auto value = nlohmann::json::parse(requests[1]);
+
+    std::string encoded;
+    TypeParam::encode(value, encoded);
+    EXPECT_EQ(TypeParam::template decode<nlohmann::json>(encoded), value);
+
+    // encode() appends to the buffer
+    const auto size = encoded.size();
+    TypeParam::encode(value, encoded);
+    EXPECT_EQ(encoded.size(), 2 * size);
+}
+
+TYPED_TEST(CodecTest, TestParseError)
+{
+    std::string encoded;
+    TypeParam::encode(nlohmann::json::parse(requests[0]), encoded);
+    encoded.pop_back();
+
+    std::string out;
+    ASSERT_TRUE(wwa::json_rpc::process_encoded_request<TypeParam>(this->dispatcher(), encoded, out));
+
+    const auto response = TypeParam::template decode<nlohmann::json>(out);
+    ASSERT_TRUE(wwa::json_rpc::is_error_response(response));
+    EXPECT_EQ(wwa::json_rpc::get_error_code(response), wwa::json_rpc::exception::PARSE_ERROR);
+    EXPECT_EQ(response["id"], nullptr);
+}
@@ -0,0 +1,185 @@
+#include <cctype>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <tuple>
+#include <string_view>
+#include <vector>
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+
+#include "details.h"
+#include "dispatcher.h"
+#include "utils.h"
+
+using namespace nlohmann::json_literals;
+
+namespace {
+
+/**
+ * @brief Checks that convert_value() produces the same value or the same error as `get<T>()`.
+ */
+template<typename T>
+void expect_same_as_get(const nlohmann::json& value)
+{
+    T actual{};
+    wwa::json_rpc::details::conversion_error error;
+    const bool converted = wwa::json_rpc::details::convert_value(value, actual, error);
+
+    try {
+        const auto expected = value.template get<T>();
+        EXPECT_TRUE(converted) << value.dump();
+        EXPECT_EQ(actual, expected) << value.dump();
+    }
+    catch (const nlohmann::json::exception& e) {
+        EXPECT_FALSE(converted) << value.dump();
+        EXPECT_EQ(error.message(), e.what());
+    }
+}
+
+struct point {
+    int x;
+    int y;
+};
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+void from_json(const nlohmann::json& j, point& p)
+{
+    j.at("x").get_to(p.x);
+    j.at("y").get_to(p.y);
+}
+
+}  // namespace
+
+TEST(ConversionTest, TestSameAsGet)
+{
+    const auto values = R"([
+        null, true, false, 0, -1, 42, 18446744073709551615, -9223372036854775808, 1.5, -2.75,
+        "", "string", [], [1, 2, 3], [1, "a"], [[1], [2]], ["a", "b"], [true, false], {}, {"a": 1}
+    ])"_json;
+
+    for (const auto& value : values) {
+        expect_same_as_get<bool>(value);
+        expect_same_as_get<int>(value);
+        expect_same_as_get<unsigned int>(value);
+        expect_same_as_get<std::int64_t>(value);
+        expect_same_as_get<std::uint64_t>(value);
+        expect_same_as_get<float>(value);
+        expect_same_as_get<double>(value);
+        expect_same_as_get<std::string>(value);
+        expect_same_as_get<std::string_view>(value);
+        expect_same_as_get<std::vector<int>>(value);
+        expect_same_as_get<std::vector<bool>>(value);
+        expect_same_as_get<std::vector<std::string>>(value);
+        expect_same_as_get<std::vector<std::vector<double>>>(value);
+    }
+}
+
+TEST(ConversionTest, TestStringView)
+{
+    const auto value = R"("string")"_json;
+
+    std::string_view view;
+    wwa::json_rpc::details::conversion_error error;
+    ASSERT_TRUE(wwa::json_rpc::details::convert_value(value, view, error));
+    EXPECT_EQ(view.data(), value.get_ref<const std::string&>().data());
+}
+
+TEST(ConversionTest, TestDispatch)
+{
+    wwa::json_rpc::dispatcher dispatcher;
+    dispatcher.add("join", [](std::string_view sep, const std::vector<std::string>& items, bool upper) {
+        std::string result;
+        for (const auto& item : items) {
+            if (!result.empty()) {
+                result += sep;
+            }
+
+            result += item;
+        }
+
+        if (upper) {
+            for (auto& c : result) {
+                c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+            }
+        }
+
+        return result;
+    });
+
+    dispatcher.add("dist", [](const point& p, double scale) { return (p.x + p.y) * scale; });
+
+    // clang-format off
+    const auto join_ok   = R"({"jsonrpc": "2.0", "method": "join", "params": ["-", ["a", "b"], true], "id": 1})";
+    const auto join_bad  = R"({"jsonrpc": "2.0", "method": "join", "params": ["-", ["a", 1], false], "id": 2})";
+    const auto point_ok  = R"({"jsonrpc": "2.0", "method": "dist", "params": [{"x": 1, "y": 2}, 1.5], "id": 3})";
+    const auto point_bad = R"({"jsonrpc": "2.0", "method": "dist", "params": [{"x": 1, "y": 2}, "1.5"], "id": 4})";
+    // clang-format on
+
+    EXPECT_EQ(dispatcher.process_request(join_ok)["result"], "A-B");
+    EXPECT_EQ(dispatcher.process_request(point_ok)["result"], 4.5);
+
+    auto response = dispatcher.process_request(join_bad);
+    ASSERT_TRUE(wwa::json_rpc::is_error_response(response));
+    EXPECT_EQ(wwa::json_rpc::get_error_code(response), wwa::json_rpc::exception::INVALID_PARAMS);
+    EXPECT_EQ(
+        wwa::json_rpc::get_error_message(response), "[json.exception.type_error.302] type must be string, but is number"
+    );
+
+    // Mixed with a user type: the error comes from `get()`
+    response = dispatcher.process_request(point_bad);
+    ASSERT_TRUE(wwa::json_rpc::is_error_response(response));
+    EXPECT_EQ(
+        wwa::json_rpc::get_error_message(response), "[json.exception.type_error.302] type must be number, but is string"
+    );
+}
+
+TEST(ConversionTest, TestBoundParams)
+{
+    using args_t = std::tuple<
+        const std::string&, const nlohmann::json::array_t&, std::span<const nlohmann::json>, const nlohmann::json&,
+        const std::vector<int>&>;
+
+    const auto params = R"(["string", [1, 2], [3], {"a": 1}, [4, 5]])"_json;
+
+    const auto args = wwa::json_rpc::details::convert_args<void, args_t>(params, std::make_index_sequence<5>{});
+    ASSERT_TRUE(args.has_value());
+
+    const auto& [str, array, span, object, vector] = *args;
+    EXPECT_EQ(&static_cast<const std::string&>(str), &params[0].get_ref<const std::string&>());
+    EXPECT_EQ(&static_cast<const nlohmann::json::array_t&>(array), &params[1].get_ref<const nlohmann::json::array_t&>());
+    EXPECT_EQ(span.data(), params[2].get_ref<const nlohmann::json::array_t&>().data());
+    EXPECT_EQ(&static_cast<const nlohmann::json&>(object), &params[3]);
+
+    // Other types are copied
+    EXPECT_EQ(vector, std::vector<int>({4, 5}));
+}
+
+TEST(ConversionTest, TestBoundParamsErrors)
+{
+    wwa::json_rpc::dispatcher dispatcher;
+    dispatcher.add("str", [](const std::string& s) { return s; });
+    dispatcher.add("array", [](const nlohmann::json::array_t& a, std::span<const nlohmann::json> s) {
+        return a.size() + s.size();
+    });
+
+    // clang-format off
+    const auto str_bad   = R"({"jsonrpc": "2.0", "method": "str", "params": [1], "id": 1})";
+    const auto array_ok  = R"({"jsonrpc": "2.0", "method": "array", "params": [[1, 2], [3]], "id": 2})";
+    const auto array_bad = R"({"jsonrpc": "2.0", "method": "array", "params": [[1, 2], {}], "id": 3})";
+    // clang-format on
+
+    EXPECT_EQ(dispatcher.process_request(array_ok)["result"], 3);
+
+    auto response = dispatcher.process_request(str_bad);
+    ASSERT_TRUE(wwa::json_rpc::is_error_response(response));
+    EXPECT_EQ(
+        wwa::json_rpc::get_error_message(response), "[json.exception.type_error.302] type must be string, but is number"
+    );
+
+    response = dispatcher.process_request(array_bad);
+    ASSERT_TRUE(wwa::json_rpc::is_error_response(response));
+    EXPECT_EQ(
+        wwa::json_rpc::get_error_message(response), "[json.exception.type_error.302] type must be array, but is object"
+    );
+}
@@ -6,6 +6,7 @@
 
 #include "base.h"
 #include "exception.h"
+#include "utils.h"
 
 using namespace std::string_literals;
 using namespace nlohmann::json_literals;
@@ -22,6 +23,35 @@ TEST_P(ErrorHandlingTest, TestErrorHandling)
     EXPECT_EQ(actual, expected);
 }
 
+TEST_P(ErrorHandlingTest, TestErrorHandlingRaw)
+{
+    const auto& [input, expected] = GetParam();
+
+    const auto actual = this->dispatcher().process_request(input);
+
+    EXPECT_EQ(actual, expected);
+}
+
+TEST_P(ErrorHandlingTest, TestErrorHandlingAsync)
+{
+    const auto& [input, expected] = GetParam();
+
+    const auto actual =
+        wwa::json_rpc::sync_wait(this->dispatcher().process_request_async(nlohmann::json::parse(input)));
+
+    EXPECT_EQ(actual, expected);
+}
+
+TEST_P(ErrorHandlingTest, TestErrorHandlingToBuffer)
+{
+    const auto& [input, expected] = GetParam();
+
+    std::string out;
+    ASSERT_TRUE(this->dispatcher().process_request_to(input, out));
+
+    EXPECT_EQ(nlohmann::json::parse(out), expected);
+}
+
 // clang-format off
 INSTANTIATE_TEST_SUITE_P(RequestParsingFromStandard, ErrorHandlingTest, testing::Values(
     // rpc call with invalid Request object
@@ -195,4 +225,97 @@ INSTANTIATE_TEST_SUITE_P(MethodInvocation, ErrorHandlingTest, testing::Values(
         { "jsonrpc", "2.0" }
     }))
 ));
+
+INSTANTIATE_TEST_SUITE_P(RawRequestParsing, ErrorHandlingTest, testing::Values(
+    // Non-string jsonrpc
+    std::make_tuple(R"({"jsonrpc": 2, "method": "subtract_p", "params": [2, 1], "id": 1})"s, nlohmann::json({
+        {
+            "error", {
+                { "code", wwa::json_rpc::exception::INVALID_REQUEST },
+                { "message", wwa::json_rpc::err_bad_request }
+            }
+        },
+        { "id", 1 },
+        { "jsonrpc", "2.0" }
+    })),
+    // Structured method
+    std::make_tuple(R"({"jsonrpc": "2.0", "method": {"name": "subtract_p"}, "params": [2, 1], "id": 1})"s, nlohmann::json({
+        {
+            "error", {
+                { "code", wwa::json_rpc::exception::INVALID_REQUEST },
+                { "message", wwa::json_rpc::err_bad_request }
+            }
+        },
+        { "id", 1 },
+        { "jsonrpc", "2.0" }
+    })),
+    // Duplicate keys: the last one wins
+    std::make_tuple(R"({"jsonrpc": "2.0", "method": "subtract_p", "method": "foobar", "id": [1], "id": 2})"s, nlohmann::json({
+        {
+            "error", {
+                { "code", wwa::json_rpc::exception::METHOD_NOT_FOUND },
+                { "message", wwa::json_rpc::err_method_not_found }
+            }
+        },
+        { "id", 2 },
+        { "jsonrpc", "2.0" }
+    })),
+    // Nested batch
+    std::make_tuple(R"([[{"jsonrpc": "2.0", "method": "subtract_p", "params": [2, 1], "id": 1}], 1])"s, nlohmann::json({
+        { { "error", { { "code", wwa::json_rpc::exception::INVALID_REQUEST }, { "message", wwa::json_rpc::err_not_jsonrpc_2_0_request } } }, { "id", nullptr }, { "jsonrpc", "2.0" } },
+        { { "error", { { "code", wwa::json_rpc::exception::INVALID_REQUEST }, { "message", wwa::json_rpc::err_not_jsonrpc_2_0_request } } }, { "id", nullptr }, { "jsonrpc", "2.0" } }
+    }))
+));
 // clang-format on
+
+TEST_F(BaseDispatcherTest, TestParseError)
+{
+    const auto actual =
+        this->dispatcher().process_request(R"({"jsonrpc": "2.0", "method": "foobar, "params": "bar", "baz])");
+
+    ASSERT_TRUE(wwa::json_rpc::is_error_response(actual));
+    EXPECT_EQ(wwa::json_rpc::get_error_code(actual), wwa::json_rpc::exception::PARSE_ERROR);
+    EXPECT_EQ(actual["id"], nullptr);
+}
+
+TEST(SerializationErrorTest, TestUnserializableResult)
+{
+    wwa::json_rpc::dispatcher dispatcher;
+    dispatcher.add("one", []() { return 1; });
+    dispatcher.add("bad", []() { return std::string("\xff"); });
+
+    const std::string batch =
+        R"([{"jsonrpc": "2.0", "method": "one", "id": 1}, {"jsonrpc": "2.0", "method": "bad", "id": 2}])";
+    const auto check = [](const std::string& out) {
+        ASSERT_EQ(out.substr(0, 7), "PREFIX:");
+        const auto response = nlohmann::json::parse(out.substr(7));
+        ASSERT_TRUE(response.is_array());
+        ASSERT_EQ(response.size(), 2U);
+        EXPECT_EQ(response[0], R"({"jsonrpc": "2.0", "result": 1, "id": 1})"_json);
+        EXPECT_EQ(wwa::json_rpc::get_error_code(response[1]), wwa::json_rpc::exception::INTERNAL_ERROR);
+        EXPECT_EQ(response[1]["id"], 2);
+    };
+
+    std::string out = "PREFIX:";
+    ASSERT_TRUE(dispatcher.process_request_to(batch, out));
+    check(out);
+
+    out = "PREFIX:";
+    ASSERT_TRUE(dispatcher.process_request_to(nlohmann::json::parse(batch), out));
+    check(out);
+
+    out = "PREFIX:";
+    ASSERT_TRUE(dispatcher.process_request_to(R"({"jsonrpc": "2.0", "method": "bad", "id": 2})", out));
+    auto response = nlohmann::json::parse(out.substr(7));
+    EXPECT_EQ(wwa::json_rpc::get_error_code(response), wwa::json_rpc::exception::INTERNAL_ERROR);
+    EXPECT_EQ(response["id"], 2);
+
+    // The ID cannot be serialized either
+    out = "PREFIX:";
+    ASSERT_TRUE(dispatcher.process_request_to(
+        nlohmann::json({{"jsonrpc", "2.0"}, {"method", "one"}, {"id", std::string("\xff")}}), out
+    ));
+    response = nlohmann::json::parse(out.substr(7));
+    EXPECT_EQ(wwa::json_rpc::get_error_code(response), wwa::json_rpc::exception::INTERNAL_ERROR);
+    EXPECT_EQ(response["id"], nullptr);
+}
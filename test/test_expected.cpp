@@ -0,0 +1,314 @@
+#include <any>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+
+#include "dispatcher.h"
+#include "exception.h"
+#include "expected.h"
+#include "request.h"
+#include "static_dispatcher.h"
+#include "task.h"
+#include "utils.h"
+
+using namespace nlohmann::json_literals;
+
+namespace {
+
+wwa::json_rpc::expected<int> divide(int a, int b)
+{
+    if (b == 0) {
+        return wwa::json_rpc::unexpected(
+            wwa::json_rpc::exception(wwa::json_rpc::exception::INVALID_PARAMS, "Division by zero", a)
+        );
+    }
+
+    return a / b;
+}
+
+wwa::json_rpc::expected<> check(bool ok)
+{
+    if (!ok) {
+        return wwa::json_rpc::unexpected(wwa::json_rpc::exception(-1, "Check failed"));
+    }
+
+    return {};
+}
+
+class error_recording_dispatcher : public wwa::json_rpc::dispatcher {
+public:
+    using wwa::json_rpc::dispatcher::invoke;
+    using wwa::json_rpc::dispatcher::try_invoke;
+
+    [[nodiscard]] const std::vector<int>& codes() const noexcept { return this->m_codes; }
+
+protected:
+    void request_failed(const nlohmann::json&, const std::exception* e, bool, std::uint64_t) override
+    {
+        const auto* err = dynamic_cast<const wwa::json_rpc::exception*>(e);
+        this->m_codes.push_back(err != nullptr ? err->code() : 0);
+    }
+
+private:
+    std::vector<int> m_codes;
+};
+
+class aliasing_dispatcher : public wwa::json_rpc::dispatcher {
+protected:
+    nlohmann::json invoke(
+        const std::string& method, const nlohmann::json& params, const context_t& ctx, std::uint64_t unique_id
+    ) override
+    {
+        return wwa::json_rpc::dispatcher::invoke(method == "div" ? "divide" : method, params, ctx, unique_id);
+    }
+};
+
+class async_aliasing_dispatcher : public wwa::json_rpc::dispatcher {
+protected:
+    wwa::json_rpc::task<nlohmann::json> invoke_async(
+        const std::string& method, const nlohmann::json& params, const context_t& ctx, std::uint64_t unique_id
+    ) override
+    {
+        // The name must outlive the task, so the override is a coroutine itself
+        const std::string name = method == "div" ? "divide_async" : method;
+        co_return co_await wwa::json_rpc::dispatcher::invoke_async(name, params, ctx, unique_id);
+    }
+};
+
+class quiet_dispatcher : public wwa::json_rpc::dispatcher {
+public:
+    [[nodiscard]] int invoke_calls() const noexcept { return this->m_invoke_calls; }
+
+protected:
+    nlohmann::json invoke(
+        const std::string& method, const nlohmann::json& params, const context_t& ctx, std::uint64_t unique_id
+    ) override
+    {
+        ++this->m_invoke_calls;
+        return wwa::json_rpc::dispatcher::invoke(method, params, ctx, unique_id);
+    }
+
+    wwa::json_rpc::expected<nlohmann::json>
+    try_invoke(const std::string& method, const nlohmann::json& params, const context_t& ctx, std::uint64_t) override
+    {
+        return this->call_method(method, params, ctx);
+    }
+
+    wwa::json_rpc::task<wwa::json_rpc::expected<nlohmann::json>> try_invoke_async(
+        const std::string& method, const nlohmann::json& params, const context_t& ctx, std::uint64_t
+    ) override
+    {
+        return this->call_method_async(method, params, ctx);
+    }
+
+private:
+    int m_invoke_calls = 0;
+};
+
+}  // namespace
+
+class ExpectedTest : public ::testing::Test {
+public:
+    ExpectedTest()
+    {
+        this->m_dispatcher.add("divide", &divide);
+        this->m_dispatcher.add("check", &check);
+        this->m_dispatcher.add("divide_async", [](int a, int b) -> wwa::json_rpc::task<wwa::json_rpc::expected<int>> {
+            co_return divide(a, b);
+        });
+    }
+
+    error_recording_dispatcher& dispatcher() noexcept { return this->m_dispatcher; }
+
+private:
+    error_recording_dispatcher m_dispatcher;
+};
+
+TEST_F(ExpectedTest, TestValue)
+{
+    const auto request  = R"({"jsonrpc": "2.0", "method": "divide", "params": [6, 3], "id": 1})"_json;
+    const auto expected = R"({"jsonrpc": "2.0", "result": 2, "id": 1})"_json;
+
+    EXPECT_EQ(this->dispatcher().process_request(request), expected);
+    EXPECT_EQ(this->dispatcher().process_request(request.dump()), expected);
+    EXPECT_EQ(wwa::json_rpc::sync_wait(this->dispatcher().process_request_async(request)), expected);
+    EXPECT_TRUE(this->dispatcher().codes().empty());
+}
+
+TEST_F(ExpectedTest, TestError)
+{
+    const auto request  = R"({"jsonrpc": "2.0", "method": "divide", "params": [6, 0], "id": 1})"_json;
+    const auto expected =
+        R"({"jsonrpc": "2.0", "error": {"code": -32602, "message": "Division by zero", "data": 6}, "id": 1})"_json;
+
+    EXPECT_EQ(this->dispatcher().process_request(request), expected);
+    EXPECT_EQ(this->dispatcher().process_request(request.dump()), expected);
+    EXPECT_EQ(wwa::json_rpc::sync_wait(this->dispatcher().process_request_async(request)), expected);
+
+    const std::vector<int> codes(3, wwa::json_rpc::exception::INVALID_PARAMS);
+    EXPECT_EQ(this->dispatcher().codes(), codes);
+}
+
+TEST_F(ExpectedTest, TestVoid)
+{
+    const auto ok           = R"({"jsonrpc": "2.0", "method": "check", "params": [true], "id": 1})"_json;
+    const auto failed       = R"({"jsonrpc": "2.0", "method": "check", "params": [false], "id": 1})"_json;
+    const auto notification = R"({"jsonrpc": "2.0", "method": "check", "params": [false]})"_json;
+
+    EXPECT_EQ(this->dispatcher().process_request(ok), R"({"jsonrpc": "2.0", "result": null, "id": 1})"_json);
+    EXPECT_EQ(
+        this->dispatcher().process_request(failed),
+        R"({"jsonrpc": "2.0", "error": {"code": -1, "message": "Check failed"}, "id": 1})"_json
+    );
+
+    EXPECT_TRUE(this->dispatcher().process_request(notification).is_discarded());
+}
+
+TEST_F(ExpectedTest, TestAsync)
+{
+    const auto ok  = R"({"jsonrpc": "2.0", "method": "divide_async", "params": [6, 2], "id": 1})"_json;
+    const auto err = R"({"jsonrpc": "2.0", "method": "divide_async", "params": [6, 0], "id": 2})"_json;
+
+    EXPECT_EQ(wwa::json_rpc::sync_wait(this->dispatcher().process_request_async(ok))["result"], 3);
+    EXPECT_EQ(
+        wwa::json_rpc::get_error_code(wwa::json_rpc::sync_wait(this->dispatcher().process_request_async(err))),
+        wwa::json_rpc::exception::INVALID_PARAMS
+    );
+
+    EXPECT_EQ(this->dispatcher().process_request(ok)["result"], 3);
+}
+
+TEST_F(ExpectedTest, TestInvokeReturnsErrors)
+{
+    const wwa::json_rpc::dispatcher::context_t ctx;
+
+    wwa::json_rpc::expected<nlohmann::json> result;
+    ASSERT_NO_THROW(result = this->dispatcher().try_invoke("missing", nlohmann::json::array(), ctx, 0));
+    ASSERT_FALSE(result.has_value());
+    EXPECT_EQ(result.error().code(), wwa::json_rpc::exception::METHOD_NOT_FOUND);
+
+    ASSERT_NO_THROW(result = this->dispatcher().try_invoke("divide", R"([1])"_json, ctx, 0));
+    ASSERT_FALSE(result.has_value());
+    EXPECT_EQ(result.error().code(), wwa::json_rpc::exception::INVALID_PARAMS);
+
+    ASSERT_NO_THROW(result = this->dispatcher().try_invoke("divide", R"(["a", 1])"_json, ctx, 0));
+    ASSERT_FALSE(result.has_value());
+    EXPECT_EQ(result.error().code(), wwa::json_rpc::exception::INVALID_PARAMS);
+
+    EXPECT_THROW(static_cast<void>(result.value()), wwa::json_rpc::exception);
+    EXPECT_THROW(this->dispatcher().invoke("missing", nlohmann::json::array(), ctx, 0), wwa::json_rpc::exception);
+    EXPECT_EQ(this->dispatcher().invoke("divide", R"([6, 3])"_json, ctx, 0), 2);
+}
+
+TEST(ExpectedHookTest, TestInvokeOverride)
+{
+    aliasing_dispatcher dispatcher;
+    dispatcher.add("divide", &divide);
+
+    const auto request = R"({"jsonrpc": "2.0", "method": "div", "params": [6, 3], "id": 1})"_json;
+    const auto failed  = R"({"jsonrpc": "2.0", "method": "div", "params": [6, 0], "id": 2})"_json;
+
+    EXPECT_EQ(dispatcher.process_request(request)["result"], 2);
+    EXPECT_EQ(wwa::json_rpc::sync_wait(dispatcher.process_request_async(request))["result"], 2);
+    EXPECT_EQ(
+        wwa::json_rpc::get_error_code(dispatcher.process_request(failed)), wwa::json_rpc::exception::INVALID_PARAMS
+    );
+    EXPECT_EQ(
+        wwa::json_rpc::get_error_code(dispatcher.process_request(R"({"jsonrpc": "2.0", "method": "x", "id": 3})")),
+        wwa::json_rpc::exception::METHOD_NOT_FOUND
+    );
+}
+
+TEST(ExpectedHookTest, TestInvokeAsyncOverride)
+{
+    async_aliasing_dispatcher dispatcher;
+    dispatcher.add("divide_async", [](int a, int b) -> wwa::json_rpc::task<wwa::json_rpc::expected<int>> {
+        co_return divide(a, b);
+    });
+
+    const auto request = R"({"jsonrpc": "2.0", "method": "div", "params": [6, 3], "id": 1})"_json;
+    const auto failed  = R"({"jsonrpc": "2.0", "method": "div", "params": [6, 0], "id": 2})"_json;
+
+    EXPECT_EQ(wwa::json_rpc::sync_wait(dispatcher.process_request_async(request))["result"], 2);
+    EXPECT_EQ(
+        wwa::json_rpc::get_error_code(wwa::json_rpc::sync_wait(dispatcher.process_request_async(failed))),
+        wwa::json_rpc::exception::INVALID_PARAMS
+    );
+}
+
+TEST(ExpectedHookTest, TestTryInvokeOverride)
+{
+    quiet_dispatcher dispatcher;
+    dispatcher.add("divide", &divide);
+    dispatcher.add("divide_async", [](int a, int b) -> wwa::json_rpc::task<wwa::json_rpc::expected<int>> {
+        co_return divide(a, b);
+    });
+
+    const auto ok      = R"({"jsonrpc": "2.0", "method": "divide", "params": [6, 3], "id": 1})"_json;
+    const auto failed  = R"({"jsonrpc": "2.0", "method": "divide", "params": [6, 0], "id": 2})"_json;
+    const auto async   = R"({"jsonrpc": "2.0", "method": "divide_async", "params": [6, 0], "id": 3})"_json;
+    const auto missing = R"({"jsonrpc": "2.0", "method": "x", "id": 4})"_json;
+
+    EXPECT_EQ(dispatcher.process_request(ok)["result"], 2);
+    EXPECT_EQ(
+        wwa::json_rpc::get_error_code(dispatcher.process_request(failed)), wwa::json_rpc::exception::INVALID_PARAMS
+    );
+    EXPECT_EQ(
+        wwa::json_rpc::get_error_code(wwa::json_rpc::sync_wait(dispatcher.process_request_async(async))),
+        wwa::json_rpc::exception::INVALID_PARAMS
+    );
+    EXPECT_EQ(
+        wwa::json_rpc::get_error_code(dispatcher.process_request(missing)), wwa::json_rpc::exception::METHOD_NOT_FOUND
+    );
+
+    // The errors never went through the throwing invoke()
+    EXPECT_EQ(dispatcher.invoke_calls(), 0);
+}
+
+TEST(ExpectedRequestTest, TestTryFromJson)
+{
+    // clang-format off
+    const std::vector<std::pair<nlohmann::json, int>> requests = {
+        { R"([])"_json, wwa::json_rpc::exception::INVALID_REQUEST },
+        { R"({"jsonrpc": "2.0"})"_json, wwa::json_rpc::exception::INVALID_REQUEST },
+        { R"({"jsonrpc": 2, "method": "a"})"_json, wwa::json_rpc::exception::INVALID_REQUEST },
+        { R"({"jsonrpc": "1.0", "method": "a"})"_json, wwa::json_rpc::exception::INVALID_REQUEST },
+        { R"({"jsonrpc": "2.0", "method": "a", "params": 1})"_json, wwa::json_rpc::exception::INVALID_PARAMS },
+        { R"({"jsonrpc": "2.0", "method": ""})"_json, wwa::json_rpc::exception::INVALID_REQUEST },
+        { R"({"jsonrpc": "2.0", "method": "a", "id": [1]})"_json, wwa::json_rpc::exception::INVALID_REQUEST }
+    };
+    // clang-format on
+
+    for (const auto& [request, code] : requests) {
+        const auto req = wwa::json_rpc::jsonrpc_request::try_from_json(request);
+        ASSERT_FALSE(req.has_value()) << request.dump();
+        EXPECT_EQ(req.error().code(), code) << request.dump();
+        EXPECT_THROW(wwa::json_rpc::jsonrpc_request::from_json(request), wwa::json_rpc::exception) << request.dump();
+    }
+
+    const auto request = R"({"jsonrpc": "2.0", "method": "a", "params": {"x": 1}, "id": 5, "auth": "secret"})"_json;
+    const auto req     = wwa::json_rpc::jsonrpc_request::try_from_json(request);
+
+    ASSERT_TRUE(req.has_value());
+    EXPECT_EQ(req->method, "a");
+    EXPECT_EQ(req->params, R"([{"x": 1}])"_json);
+    EXPECT_EQ(req->id, 5);
+    EXPECT_EQ(req->extra(), R"({"auth": "secret"})"_json);
+}
+
+TEST(ExpectedStaticDispatcherTest, TestStaticDispatcher)
+{
+    const wwa::json_rpc::static_dispatcher<wwa::json_rpc::method<"divide", &divide>> dispatcher;
+
+    EXPECT_EQ(
+        dispatcher.process_request(R"({"jsonrpc": "2.0", "method": "divide", "params": [6, 3], "id": 1})"_json),
+        R"({"jsonrpc": "2.0", "result": 2, "id": 1})"_json
+    );
+
+    EXPECT_EQ(
+        dispatcher.process_request(R"({"jsonrpc": "2.0", "method": "divide", "params": [6, 0], "id": 1})"_json),
+        R"({"jsonrpc": "2.0", "error": {"code": -32602, "message": "Division by zero", "data": 6}, "id": 1})"_json
+    );
+}
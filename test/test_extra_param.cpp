@@ -1,4 +1,5 @@
 #include <any>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <utility>
@@ -6,6 +7,8 @@
 #include <nlohmann/json.hpp>
 
 #include "dispatcher.h"
+#include "request.h"
+#include "task.h"
 
 class ExtraParamTest : public ::testing::Test {
 public:
@@ -22,6 +25,20 @@ struct extra_data {
     std::string ip;
 };
 
+class extra_recording_dispatcher : public wwa::json_rpc::dispatcher {
+public:
+    [[nodiscard]] const nlohmann::json& extra() const noexcept { return this->m_extra; }
+
+protected:
+    void request_parsed(const wwa::json_rpc::jsonrpc_request& request, const std::any&, std::uint64_t) override
+    {
+        this->m_extra = request.extra();
+    }
+
+private:
+    nlohmann::json m_extra;
+};
+
 using namespace nlohmann::json_literals;
 
 TEST_F(ExtraParamTest, TestClosure)
@@ -117,3 +134,116 @@ TEST_F(ExtraParamTest, TestClosureWithExtraJson)
     const auto response = this->dispatcher().process_request(request, expected_ip);
     EXPECT_EQ(response, expected);
 }
+
+TEST_F(ExtraParamTest, TestClosureWithExtraJsonRaw)
+{
+    const auto request = nlohmann::json(
+        {{"jsonrpc", "2.0"},
+         {"method", "test"},
+         {"params", {1, 2}},
+         {"id", 1},
+         {"auth", {{"token", "secret"}, {"scopes", {"read", "write"}}}},
+         {"user", "admin"}}
+    );
+
+    const std::string expected_ip = "127.0.0.1";
+
+    const auto expected_extra = nlohmann::json({{"auth", request["auth"]}, {"user", request["user"]}});
+
+    this->dispatcher().add_ex(
+        "test",
+        [&expected_ip, &expected_extra, &request](const wwa::json_rpc::dispatcher::context_t& extra, int a, int b) {
+            EXPECT_EQ(std::any_cast<std::string>(extra.first), expected_ip);
+            EXPECT_EQ(extra.second, expected_extra);
+            EXPECT_EQ(a, request["params"][0]);
+            EXPECT_EQ(b, request["params"][1]);
+        }
+    );
+
+    const auto expected = nlohmann::json({{"jsonrpc", "2.0"}, {"id", 1}, {"result", nullptr}});
+    const auto response = this->dispatcher().process_request(request.dump(), expected_ip);
+    EXPECT_EQ(response, expected);
+}
+
+TEST_F(ExtraParamTest, TestClosureWithExtraJsonMoved)
+{
+    auto request = nlohmann::json(
+        {{"jsonrpc", "2.0"},
+         {"method", "test"},
+         {"params", {1, 2}},
+         {"id", 1},
+         {"auth", {{"token", "secret"}, {"scopes", {"read", "write"}}}},
+         {"user", "admin"}}
+    );
+
+    const std::string expected_ip = "127.0.0.1";
+    const auto expected_extra     = nlohmann::json({{"auth", request["auth"]}, {"user", request["user"]}});
+
+    this->dispatcher().add_ex(
+        "test", [&expected_ip, &expected_extra](const wwa::json_rpc::dispatcher::context_t& extra, int a, int b) {
+            EXPECT_EQ(std::any_cast<std::string>(extra.first), expected_ip);
+            EXPECT_EQ(extra.second, expected_extra);
+            EXPECT_EQ(a, 1);
+            EXPECT_EQ(b, 2);
+        }
+    );
+
+    const auto expected = nlohmann::json({{"jsonrpc", "2.0"}, {"id", 1}, {"result", nullptr}});
+    const auto response = this->dispatcher().consume_request(std::move(request), expected_ip);
+    EXPECT_EQ(response, expected);
+}
+
+TEST(ExtraParamHookTest, TestRequestParsedSeesExtra)
+{
+    extra_recording_dispatcher dispatcher;
+    dispatcher.add("test", [](int a, int b) { return a + b; });
+
+    const auto request = nlohmann::json(
+        {{"jsonrpc", "2.0"}, {"method", "test"}, {"params", {1, 2}}, {"id", 1}, {"auth", "secret"}, {"user", "admin"}}
+    );
+
+    const auto expected_extra = nlohmann::json({{"auth", "secret"}, {"user", "admin"}});
+    const auto expected       = nlohmann::json({{"jsonrpc", "2.0"}, {"id", 1}, {"result", 3}});
+
+    EXPECT_EQ(dispatcher.process_request(request), expected);
+    EXPECT_EQ(dispatcher.extra(), expected_extra);
+
+    EXPECT_EQ(dispatcher.process_request(request.dump()), expected);
+    EXPECT_EQ(dispatcher.extra(), expected_extra);
+
+    EXPECT_EQ(dispatcher.process_request(nlohmann::json(request)), expected);
+    EXPECT_EQ(dispatcher.extra(), expected_extra);
+}
+
+TEST(ExtraParamHookTest, TestRequestParsedSeesExtraOfConsumedRequests)
+{
+    extra_recording_dispatcher dispatcher;
+    dispatcher.add("test", [](int a, int b) { return a + b; });
+    dispatcher.add_ex("test_ex", [](const wwa::json_rpc::dispatcher::context_t& ctx, int a, int b) {
+        return ctx.second.at("auth").get<std::string>() + std::to_string(a * b);
+    });
+
+    const auto request = nlohmann::json(
+        {{"jsonrpc", "2.0"}, {"method", "test"}, {"params", {2, 3}}, {"id", 1}, {"auth", "secret"}}
+    );
+
+    auto request_ex      = request;
+    request_ex["method"] = "test_ex";
+
+    const auto expected_extra = nlohmann::json({{"auth", "secret"}});
+
+    EXPECT_EQ(dispatcher.consume_request(nlohmann::json(request))["result"], 5);
+    EXPECT_EQ(dispatcher.extra(), expected_extra);
+
+    EXPECT_EQ(wwa::json_rpc::sync_wait(dispatcher.process_request_async(request))["result"], 5);
+    EXPECT_EQ(dispatcher.extra(), expected_extra);
+
+    EXPECT_EQ(dispatcher.process_request(nlohmann::json::array({request}))[0]["result"], 5);
+    EXPECT_EQ(dispatcher.extra(), expected_extra);
+
+    EXPECT_EQ(dispatcher.process_request(request_ex)["result"], "secret6");
+    EXPECT_EQ(dispatcher.extra(), expected_extra);
+
+    EXPECT_EQ(dispatcher.process_request(request_ex.dump())["result"], "secret6");
+    EXPECT_EQ(dispatcher.extra(), expected_extra);
+}
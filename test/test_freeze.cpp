@@ -0,0 +1,63 @@
+#include <stdexcept>
+#include <string>
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+
+#include "dispatcher.h"
+#include "exception.h"
+#include "utils.h"
+
+class FreezeTest : public ::testing::Test {
+public:
+    wwa::json_rpc::dispatcher& dispatcher() noexcept { return this->m_dispatcher; }
+
+private:
+    wwa::json_rpc::dispatcher m_dispatcher;
+};
+
+TEST_F(FreezeTest, TestAddAfterFreeze)
+{
+    this->dispatcher().add("before", []() {});
+    EXPECT_FALSE(this->dispatcher().is_frozen());
+
+    this->dispatcher().freeze();
+    this->dispatcher().freeze();
+    EXPECT_TRUE(this->dispatcher().is_frozen());
+
+    EXPECT_THROW(this->dispatcher().add("after", []() {}), std::logic_error);
+    EXPECT_THROW(
+        this->dispatcher().add_ex("after", [](const wwa::json_rpc::dispatcher::context_t&) {}), std::logic_error
+    );
+}
+
+TEST_F(FreezeTest, TestEmptyDispatcher)
+{
+    this->dispatcher().freeze();
+
+    const auto response = this->dispatcher().process_request(R"({"jsonrpc": "2.0", "method": "test", "id": 1})");
+    ASSERT_TRUE(wwa::json_rpc::is_error_response(response));
+    EXPECT_EQ(wwa::json_rpc::get_error_code(response), wwa::json_rpc::exception::METHOD_NOT_FOUND);
+}
+
+TEST_F(FreezeTest, TestManyMethods)
+{
+    constexpr int count = 1000;
+    for (int i = 0; i < count; ++i) {
+        this->dispatcher().add("method." + std::to_string(i), [i]() { return i; });
+    }
+
+    this->dispatcher().freeze();
+
+    for (int i = 0; i < count; ++i) {
+        const auto request = nlohmann::json({{"jsonrpc", "2.0"}, {"method", "method." + std::to_string(i)}, {"id", i}});
+        const auto response = this->dispatcher().process_request(request);
+        EXPECT_EQ(response, nlohmann::json({{"jsonrpc", "2.0"}, {"result", i}, {"id", i}}));
+    }
+
+    for (const auto* name : {"method.", "method.1000", "method.01", "", "Method.1"}) {
+        const auto request  = nlohmann::json({{"jsonrpc", "2.0"}, {"method", name}, {"id", 1}});
+        const auto response = this->dispatcher().process_request(request);
+        ASSERT_TRUE(wwa::json_rpc::is_error_response(response));
+        EXPECT_NE(wwa::json_rpc::get_error_code(response), 0);
+    }
+}
@@ -0,0 +1,214 @@
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+
+#include "dispatcher.h"
+#include "id_generator.h"
+
+using namespace nlohmann::json_literals;
+
+namespace {
+
+/**
+ * @brief Generator that returns the IDs starting from 1000 and counts the calls.
+ */
+class custom_id_generator : public wwa::json_rpc::id_generator {
+public:
+    std::uint64_t next() override { return this->m_next.fetch_add(1, std::memory_order_relaxed); }
+
+    [[nodiscard]] std::uint64_t calls() const noexcept { return this->m_next.load() - 1000; }
+
+private:
+    std::atomic_uint64_t m_next{1000};
+};
+
+class id_recording_dispatcher : public wwa::json_rpc::dispatcher {
+public:
+    [[nodiscard]] const std::vector<std::uint64_t>& ids() const noexcept { return this->m_ids; }
+
+protected:
+    void request_parsed(const wwa::json_rpc::jsonrpc_request&, const std::any&, std::uint64_t unique_id) override
+    {
+        this->m_ids.push_back(unique_id);
+    }
+
+private:
+    std::vector<std::uint64_t> m_ids;
+};
+
+/**
+ * @brief Takes @a per_thread IDs from @a gen in each of @a thread_count threads.
+ *
+ * @return All IDs taken, or an empty set if some ID was returned twice.
+ */
+std::set<std::uint64_t>
+take_ids(wwa::json_rpc::id_generator& gen, std::size_t thread_count, std::size_t per_thread)
+{
+    std::vector<std::vector<std::uint64_t>> ids(thread_count);
+    std::vector<std::thread> threads;
+    threads.reserve(thread_count);
+    for (std::size_t i = 0; i < thread_count; ++i) {
+        threads.emplace_back([&gen, &out = ids[i], per_thread]() {
+            out.reserve(per_thread);
+            for (std::size_t j = 0; j < per_thread; ++j) {
+                out.push_back(gen.next());
+            }
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::set<std::uint64_t> result;
+    for (const auto& v : ids) {
+        for (const auto id : v) {
+            if (!result.insert(id).second) {
+                return {};
+            }
+        }
+    }
+
+    return result;
+}
+
+}  // namespace
+
+TEST(IdGeneratorTest, TestSequential)
+{
+    wwa::json_rpc::sequential_id_generator gen;
+    EXPECT_EQ(gen.next(), 0);
+    EXPECT_EQ(gen.next(), 1);
+
+    EXPECT_EQ(take_ids(gen, 4, 1000).size(), 4000);
+}
+
+TEST(IdGeneratorTest, TestBlocks)
+{
+    wwa::json_rpc::block_id_generator gen(4);
+
+    // One thread takes consecutive IDs from its blocks
+    for (std::uint64_t i = 0; i < 10; ++i) {
+        EXPECT_EQ(gen.next(), i);
+    }
+
+    // Another thread starts a new block
+    std::uint64_t other = 0;
+    std::thread([&gen, &other]() { other = gen.next(); }).join();
+    EXPECT_EQ(other, 12);
+
+    // The current block of this thread is not affected
+    EXPECT_EQ(gen.next(), 10);
+    EXPECT_EQ(gen.next(), 11);
+    EXPECT_EQ(gen.next(), 16);
+}
+
+TEST(IdGeneratorTest, TestZeroBlockSize)
+{
+    wwa::json_rpc::block_id_generator gen(0);
+    EXPECT_EQ(gen.next(), 0);
+    EXPECT_EQ(gen.next(), 1);
+    EXPECT_EQ(gen.next(), 2);
+}
+
+TEST(IdGeneratorTest, TestBlocksThreads)
+{
+    wwa::json_rpc::block_id_generator gen(16);
+    EXPECT_EQ(take_ids(gen, 8, 1000).size(), 8000);
+}
+
+TEST(IdGeneratorTest, TestManyGenerators)
+{
+    // A thread using more generators than it caches blocks for drops blocks, but the IDs stay unique
+    std::vector<std::unique_ptr<wwa::json_rpc::block_id_generator>> generators;
+    std::vector<std::set<std::uint64_t>> seen(8);
+    for (std::size_t i = 0; i < seen.size(); ++i) {
+        generators.push_back(std::make_unique<wwa::json_rpc::block_id_generator>(4));
+    }
+
+    for (std::size_t round = 0; round < 10; ++round) {
+        for (std::size_t i = 0; i < generators.size(); ++i) {
+            EXPECT_TRUE(seen[i].insert(generators[i]->next()).second);
+        }
+    }
+}
+
+TEST(IdGeneratorTest, TestCustomGenerator)
+{
+    const auto gen = std::make_shared<custom_id_generator>();
+
+    id_recording_dispatcher dispatcher;
+    dispatcher.add("sum", [](int a, int b) { return a + b; });
+    dispatcher.set_id_generator(gen);
+
+    // clang-format off
+    const auto batch = R"([
+        {"jsonrpc": "2.0", "method": "sum", "params": [1, 2], "id": 1},
+        {"jsonrpc": "2.0", "method": "sum", "params": [3, 4]}
+    ])"_json;
+    // clang-format on
+
+    static_cast<void>(dispatcher.process_request(batch));
+    static_cast<void>(dispatcher.process_request(R"({"jsonrpc": "2.0", "method": "sum", "params": [1, 2], "id": 1})"));
+
+    // The batch itself, its two elements, and the single request
+    EXPECT_EQ(gen->calls(), 4);
+    EXPECT_EQ(dispatcher.ids(), (std::vector<std::uint64_t>{1001, 1002, 1003}));
+
+    // nullptr restores the default generator
+    dispatcher.set_id_generator(nullptr);
+    static_cast<void>(dispatcher.process_request(R"({"jsonrpc": "2.0", "method": "sum", "params": [1, 2], "id": 1})"));
+    EXPECT_EQ(gen->calls(), 4);
+    EXPECT_EQ(dispatcher.ids().size(), 4);
+}
+
+TEST(IdGeneratorTest, TestCoreGenerator)
+{
+    wwa::json_rpc::core_id_generator first(0);
+    wwa::json_rpc::core_id_generator second(1);
+    EXPECT_EQ(first.next(), 1ULL << 48U);
+    EXPECT_EQ(first.next(), (1ULL << 48U) + 1);
+    EXPECT_EQ(second.next(), 2ULL << 48U);
+}
+
+TEST(IdGeneratorTest, TestGeneratorScope)
+{
+    const auto gen = std::make_shared<custom_id_generator>();
+
+    id_recording_dispatcher dispatcher;
+    dispatcher.add("sum", [](int a, int b) { return a + b; });
+    dispatcher.set_id_generator(gen);
+
+    const auto* request = R"({"jsonrpc": "2.0", "method": "sum", "params": [1, 2], "id": 1})";
+    EXPECT_EQ(wwa::json_rpc::id_generator_scope::current(), nullptr);
+    {
+        wwa::json_rpc::core_id_generator outer(3);
+        const wwa::json_rpc::id_generator_scope outer_scope(outer);
+        static_cast<void>(dispatcher.process_request(request));
+
+        {
+            wwa::json_rpc::core_id_generator inner(7);
+            const wwa::json_rpc::id_generator_scope inner_scope(inner);
+            EXPECT_EQ(wwa::json_rpc::id_generator_scope::current(), &inner);
+            static_cast<void>(dispatcher.process_request(request));
+        }
+
+        EXPECT_EQ(wwa::json_rpc::id_generator_scope::current(), &outer);
+        static_cast<void>(dispatcher.process_request(request));
+
+        // The scope is per thread
+        std::thread([] { EXPECT_EQ(wwa::json_rpc::id_generator_scope::current(), nullptr); }).join();
+    }
+
+    EXPECT_EQ(wwa::json_rpc::id_generator_scope::current(), nullptr);
+    static_cast<void>(dispatcher.process_request(request));
+
+    EXPECT_EQ(gen->calls(), 1);
+    EXPECT_EQ(dispatcher.ids(), (std::vector<std::uint64_t>{4ULL << 48U, 8ULL << 48U, (4ULL << 48U) + 1, 1000}));
+}
@@ -1,3 +1,6 @@
+#include <any>
+#include <cstdint>
+#include <string>
 #include <tuple>
 
 #include <gtest/gtest.h>
@@ -7,6 +10,60 @@
 
 using namespace nlohmann::json_literals;
 
+namespace {
+
+/**
+ * @brief Parameter type that counts how many times it has been copied.
+ */
+struct copy_counter {
+    static inline int copies = 0;
+
+    std::string value;
+
+    copy_counter() = default;
+    copy_counter(const copy_counter& other) : value(other.value) { ++copies; }
+    copy_counter(copy_counter&&) noexcept            = default;
+    copy_counter& operator=(const copy_counter&)     = default;
+    copy_counter& operator=(copy_counter&&) noexcept = default;
+    ~copy_counter()                                  = default;
+};
+
+void from_json(const nlohmann::json& j, copy_counter& c)
+{
+    j.get_to(c.value);
+}
+
+/**
+ * @brief Dispatcher that counts the calls of the processing hooks.
+ */
+class hook_counting_dispatcher : public wwa::json_rpc::dispatcher {
+public:
+    [[nodiscard]] int single_calls() const noexcept { return this->m_single_calls; }
+    [[nodiscard]] int batch_calls() const noexcept { return this->m_batch_calls; }
+
+protected:
+    nlohmann::json do_process_request(
+        const nlohmann::json& request, const std::any& data, bool is_batch, std::uint64_t unique_id
+    ) override
+    {
+        ++this->m_single_calls;
+        return wwa::json_rpc::dispatcher::do_process_request(request, data, is_batch, unique_id);
+    }
+
+    nlohmann::json
+    process_batch_request(const nlohmann::json& request, const std::any& data, std::uint64_t unique_id) override
+    {
+        ++this->m_batch_calls;
+        return wwa::json_rpc::dispatcher::process_batch_request(request, data, unique_id);
+    }
+
+private:
+    int m_single_calls = 0;
+    int m_batch_calls  = 0;
+};
+
+}  // namespace
+
 class MethodInvocationTest : public BaseDispatcherTest,
                              public testing::WithParamInterface<std::tuple<nlohmann::json, nlohmann::json>> {};
 
@@ -18,6 +75,69 @@ TEST_P(MethodInvocationTest, TestMethodCalls)
     EXPECT_EQ(actual, expected);
 }
 
+TEST_P(MethodInvocationTest, TestMethodCallsRaw)
+{
+    const auto& [input, expected] = GetParam();
+    const auto actual             = this->dispatcher().process_request(input.dump());
+
+    EXPECT_EQ(actual, expected);
+}
+
+TEST_P(MethodInvocationTest, TestMethodCallsFrozen)
+{
+    const auto& [input, expected] = GetParam();
+
+    this->dispatcher().freeze();
+    const auto actual = this->dispatcher().process_request(input);
+
+    EXPECT_EQ(actual, expected);
+}
+
+TEST_P(MethodInvocationTest, TestMethodCallsMoved)
+{
+    const auto& [input, expected] = GetParam();
+    const auto actual             = this->dispatcher().consume_request(nlohmann::json(input));
+
+    EXPECT_EQ(actual, expected);
+}
+
+TEST_P(MethodInvocationTest, TestMethodCallsAsync)
+{
+    const auto& [input, expected] = GetParam();
+    const auto actual             = wwa::json_rpc::sync_wait(this->dispatcher().process_request_async(input));
+
+    EXPECT_EQ(actual, expected);
+}
+
+TEST_P(MethodInvocationTest, TestMethodCallsToBuffer)
+{
+    const auto& [input, expected] = GetParam();
+
+    std::string json;
+    std::string text;
+    ASSERT_TRUE(this->dispatcher().process_request_to(input, json));
+    ASSERT_TRUE(this->dispatcher().process_request_to(input.dump(), text));
+
+    EXPECT_EQ(nlohmann::json::parse(json), expected);
+    EXPECT_EQ(nlohmann::json::parse(text), expected);
+}
+
+TEST_F(BaseDispatcherTest, TestResponseLayout)
+{
+    std::string out = "prefix";
+
+    ASSERT_TRUE(this->dispatcher().process_request_to(
+        R"({"jsonrpc": "2.0", "method": "subtract_p", "params": [42, 23], "id": "a"})", out
+    ));
+    EXPECT_EQ(out, R"(prefix{"jsonrpc":"2.0","result":19,"id":"a"})");
+
+    EXPECT_FALSE(this->dispatcher().process_request_to(R"({"jsonrpc": "2.0", "method": "notification"})", out));
+    EXPECT_FALSE(this->dispatcher().process_request_to(
+        R"([{"jsonrpc": "2.0", "method": "notification"}, {"jsonrpc": "2.0", "method": "s_notification"}])", out
+    ));
+    EXPECT_EQ(out, R"(prefix{"jsonrpc":"2.0","result":19,"id":"a"})");
+}
+
 // clang-format off
 INSTANTIATE_TEST_SUITE_P(MethodInvocation, MethodInvocationTest, testing::Values(
     std::make_tuple(R"({"jsonrpc": "2.0", "method": "subtract", "params": {"minuend": 42, "subtrahend": 23}, "id": 3})"_json, R"({"jsonrpc":"2.0","result":19,"id":3})"_json),
@@ -48,3 +168,35 @@ INSTANTIATE_TEST_SUITE_P(MethodInvocation, MethodInvocationTest, testing::Values
     std::make_tuple(R"({"jsonrpc": "2.0", "method": "s_sumv", "params": [1,2,4], "id": "1"})"_json, R"({"jsonrpc":"2.0","result":7,"id":"1"})"_json)
 ));
 // clang-format on
+
+TEST(ArgumentPassingTest, TestByValueArgumentsAreMoved)
+{
+    wwa::json_rpc::dispatcher dispatcher;
+    dispatcher.add("concat", [](copy_counter a, copy_counter b) { return a.value + b.value; });
+
+    const auto request  = R"({"jsonrpc": "2.0", "method": "concat", "params": ["a", "b"], "id": 1})"_json;
+    const auto expected = R"({"jsonrpc": "2.0", "result": "ab", "id": 1})"_json;
+
+    copy_counter::copies = 0;
+    EXPECT_EQ(dispatcher.process_request(request), expected);
+    EXPECT_EQ(dispatcher.consume_request(nlohmann::json(request)), expected);
+    EXPECT_EQ(copy_counter::copies, 0);
+}
+
+TEST(ArgumentPassingTest, TestTemporaryRequestCallsHooks)
+{
+    hook_counting_dispatcher dispatcher;
+    dispatcher.add("sum", [](int a, int b) { return a + b; });
+
+    const auto single =
+        dispatcher.process_request(R"({"jsonrpc": "2.0", "method": "sum", "params": [1, 2], "id": 1})"_json);
+    EXPECT_EQ(single, R"({"jsonrpc": "2.0", "result": 3, "id": 1})"_json);
+    EXPECT_EQ(dispatcher.single_calls(), 1);
+    EXPECT_EQ(dispatcher.batch_calls(), 0);
+
+    const auto batch =
+        dispatcher.process_request(R"([{"jsonrpc": "2.0", "method": "sum", "params": [3, 4], "id": 2}])"_json);
+    EXPECT_EQ(batch, R"([{"jsonrpc": "2.0", "result": 7, "id": 2}])"_json);
+    EXPECT_EQ(dispatcher.single_calls(), 2);
+    EXPECT_EQ(dispatcher.batch_calls(), 1);
+}
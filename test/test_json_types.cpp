@@ -0,0 +1,157 @@
+#include <any>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+
+#include "dispatcher.h"
+#include "request.h"
+#include "static_dispatcher.h"
+#include "task.h"
+#include "utils.h"
+
+namespace {
+
+std::size_t allocations = 0;  // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+
+/**
+ * @brief Stateless allocator that counts the allocations.
+ */
+template<typename T>
+struct counting_allocator {
+    using value_type = T;
+
+    counting_allocator() noexcept = default;
+
+    template<typename U>
+    counting_allocator(const counting_allocator<U>&) noexcept  // NOLINT(google-explicit-constructor)
+    {}
+
+    T* allocate(std::size_t n)
+    {
+        ++allocations;
+        return std::allocator<T>{}.allocate(n);
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept { std::allocator<T>{}.deallocate(p, n); }
+
+    friend bool operator==(const counting_allocator&, const counting_allocator&) noexcept { return true; }
+};
+
+using counted_json = nlohmann::basic_json<
+    std::map, std::vector, std::string, bool, std::int64_t, std::uint64_t, double, counting_allocator>;
+
+int sum(int a, int b)
+{
+    return a + b;
+}
+
+nlohmann::ordered_json ordered_object()
+{
+    nlohmann::ordered_json result;
+    result["z"] = 1;
+    result["a"] = 2;
+    return result;
+}
+
+// clang-format off
+const std::string extra_request = R"({"jsonrpc": "2.0", "method": "extra", "id": 1, "zeta": 1, "alpha": 2, "mu": 3})";
+// clang-format on
+
+}  // namespace
+
+TEST(JsonTypesTest, TestOrderedResult)
+{
+    wwa::json_rpc::ordered_dispatcher dispatcher;
+    dispatcher.add("object", &ordered_object);
+
+    const auto request = nlohmann::ordered_json::parse(R"({"jsonrpc": "2.0", "method": "object", "id": 1})");
+    EXPECT_EQ(dispatcher.process_request(request).dump(), R"({"jsonrpc":"2.0","result":{"z":1,"a":2},"id":1})");
+
+    std::string out;
+    EXPECT_TRUE(dispatcher.process_request_to(request.dump(), out));
+    EXPECT_EQ(out, R"({"jsonrpc":"2.0","result":{"z":1,"a":2},"id":1})");
+}
+
+TEST(JsonTypesTest, TestOrderedExtra)
+{
+    wwa::json_rpc::ordered_dispatcher dispatcher;
+    dispatcher.add_ex("extra", [](const wwa::json_rpc::ordered_dispatcher::context_t& ctx) { return ctx.second; });
+
+    const auto expected = R"({"zeta":1,"alpha":2,"mu":3})";
+    EXPECT_EQ(dispatcher.process_request(extra_request)["result"].dump(), expected);
+    EXPECT_EQ(dispatcher.process_request(nlohmann::ordered_json::parse(extra_request))["result"].dump(), expected);
+
+    const auto request = nlohmann::ordered_json::parse(extra_request);
+    EXPECT_EQ(dispatcher.process_request(request)["result"].dump(), expected);
+    EXPECT_EQ(wwa::json_rpc::sync_wait(dispatcher.process_request_async(request))["result"].dump(), expected);
+}
+
+TEST(JsonTypesTest, TestOrderedBatch)
+{
+    wwa::json_rpc::ordered_dispatcher dispatcher;
+    dispatcher.add("sum", &sum);
+
+    // clang-format off
+    const auto batch = R"([
+        {"jsonrpc": "2.0", "method": "sum", "params": [1, 2], "id": 1},
+        {"jsonrpc": "2.0", "method": "missing", "id": 2},
+        {"jsonrpc": "2.0", "method": "sum", "params": [3, 4]}
+    ])";
+    // clang-format on
+
+    const auto response = dispatcher.process_request(batch);
+    ASSERT_TRUE(response.is_array());
+    ASSERT_EQ(response.size(), 2);
+    EXPECT_EQ(response[0]["result"], 3);
+    EXPECT_EQ(wwa::json_rpc::get_error_code(response[1]), wwa::json_rpc::exception::METHOD_NOT_FOUND);
+}
+
+TEST(JsonTypesTest, TestOrderedRequest)
+{
+    using request_t = wwa::json_rpc::basic_jsonrpc_request<nlohmann::ordered_json>;
+
+    const auto json = nlohmann::ordered_json::parse(extra_request);
+    const auto req  = request_t::from_json(json);
+    EXPECT_EQ(req.method, "extra");
+    EXPECT_EQ(req.id, 1);
+    EXPECT_EQ(req.extra().dump(), R"({"zeta":1,"alpha":2,"mu":3})");
+
+    auto moved = request_t::from_json(nlohmann::ordered_json::parse(extra_request));
+    EXPECT_EQ(moved.extra().dump(), R"({"zeta":1,"alpha":2,"mu":3})");
+
+    const auto invalid = nlohmann::ordered_json::parse(R"({"method": "extra"})");
+    EXPECT_THROW(request_t::from_json(invalid), wwa::json_rpc::exception);
+}
+
+TEST(JsonTypesTest, TestCustomAllocatorStatic)
+{
+    // clang-format off
+    const wwa::json_rpc::basic_static_dispatcher<
+        counted_json,
+        wwa::json_rpc::method<"sum", &sum>,
+        wwa::json_rpc::method_ex<"extra", [](const std::pair<std::any, counted_json>& ctx) { return ctx.second; }>
+    > dispatcher;
+    // clang-format on
+
+    const auto request = counted_json::parse(R"({"jsonrpc": "2.0", "method": "sum", "params": [1, 2], "id": 1})");
+
+    allocations = 0;
+
+    const auto response = dispatcher.process_request(request);
+    EXPECT_GT(allocations, 0);
+    EXPECT_EQ(response["result"], 3);
+    EXPECT_EQ(wwa::json_rpc::serialize_repsonse(response), R"({"id":1,"jsonrpc":"2.0","result":3})");
+
+    EXPECT_EQ(dispatcher.process_request(counted_json::parse(extra_request))["result"]["alpha"], 2);
+
+    const auto error = dispatcher.process_request(counted_json::parse(R"({"jsonrpc": "2.0", "method": "x", "id": 2})"));
+    ASSERT_TRUE(wwa::json_rpc::is_error_response(error));
+    EXPECT_EQ(wwa::json_rpc::get_error_code(error), wwa::json_rpc::exception::METHOD_NOT_FOUND);
+    EXPECT_EQ(error["id"], 2);
+}
@@ -0,0 +1,131 @@
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+
+#include "dispatcher.h"
+#include "executor.h"
+
+using namespace nlohmann::json_literals;
+
+namespace {
+
+/**
+ * @brief Memory resource that counts the allocations and forwards them to the default resource.
+ */
+class counting_resource : public std::pmr::memory_resource {
+public:
+    [[nodiscard]] std::size_t allocations() const noexcept { return this->m_allocations; }
+    [[nodiscard]] std::size_t outstanding() const noexcept { return this->m_outstanding; }
+
+private:
+    std::pmr::memory_resource* m_upstream = std::pmr::get_default_resource();
+    std::size_t m_allocations             = 0;
+    std::size_t m_outstanding             = 0;
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        ++this->m_allocations;
+        ++this->m_outstanding;
+        return this->m_upstream->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override
+    {
+        --this->m_outstanding;
+        this->m_upstream->deallocate(p, bytes, alignment);
+    }
+
+    [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+class MemoryResourceTest : public ::testing::Test {
+public:
+    MemoryResourceTest()
+    {
+        this->m_dispatcher.add("sum", [](int a, int b) { return a + b; });
+        this->m_dispatcher.add_ex("extra", [](const wwa::json_rpc::dispatcher::context_t& ctx) { return ctx.second; });
+    }
+
+protected:
+    wwa::json_rpc::dispatcher m_dispatcher;
+};
+
+// clang-format off
+const std::string single = R"({"jsonrpc": "2.0", "method": "sum", "params": [1, 2], "id": 1})";
+const std::string batch  = R"([
+    {"jsonrpc": "2.0", "method": "sum", "params": [1, 2], "id": 1},
+    {"jsonrpc": "2.0", "method": "sum", "params": [3, 4], "id": 2},
+    {"jsonrpc": "2.0", "method": "extra", "id": 3, "auth": "secret"},
+    {"jsonrpc": "2.0", "method": "extra", "id": 4},
+    {"jsonrpc": "2.0", "method": "missing", "id": 5},
+    1
+])";
+// clang-format on
+
+}  // namespace
+
+TEST_F(MemoryResourceTest, TestSameResponses)
+{
+    for (const auto& request : {single, batch}) {
+        counting_resource resource;
+
+        const auto expected = this->m_dispatcher.process_request(request);
+        EXPECT_EQ(this->m_dispatcher.process_request(request, {}, &resource), expected);
+
+        std::string out;
+        EXPECT_TRUE(this->m_dispatcher.process_request_to(request, out, {}, &resource));
+        EXPECT_EQ(nlohmann::json::parse(out), expected);
+
+        EXPECT_GT(resource.allocations(), 0);
+        EXPECT_EQ(resource.outstanding(), 0);
+    }
+}
+
+TEST_F(MemoryResourceTest, TestEmptyExtra)
+{
+    // The extra fields of a request without them are an empty object, not `null`
+    const auto response = this->m_dispatcher.process_request(R"({"jsonrpc": "2.0", "method": "extra", "id": 1})");
+    EXPECT_EQ(response["result"], nlohmann::json::object());
+}
+
+TEST_F(MemoryResourceTest, TestParallelBatch)
+{
+    this->m_dispatcher.set_executor(std::make_shared<wwa::json_rpc::thread_pool>(2));
+    this->m_dispatcher.set_parallel_batch_threshold(2);
+
+    counting_resource sequential;
+    counting_resource parallel;
+
+    const auto response = this->m_dispatcher.process_request(batch, {}, &parallel);
+    ASSERT_TRUE(response.is_array());
+    ASSERT_EQ(response.size(), 6);
+    EXPECT_EQ(response[2]["result"], R"({"auth": "secret"})"_json);
+
+    this->m_dispatcher.set_executor(nullptr);
+    EXPECT_EQ(this->m_dispatcher.process_request(batch, {}, &sequential), response);
+
+    // The unique IDs and the outcomes of the elements are allocated from the resource too
+    EXPECT_GT(parallel.allocations(), sequential.allocations());
+    EXPECT_EQ(parallel.outstanding(), 0);
+}
+
+TEST_F(MemoryResourceTest, TestMonotonicBuffer)
+{
+    std::array<std::byte, 4096> buffer{};
+    std::pmr::monotonic_buffer_resource resource(buffer.data(), buffer.size(), std::pmr::null_memory_resource());
+
+    std::string out;
+    for (int i = 0; i < 10; ++i) {
+        out.clear();
+        EXPECT_TRUE(this->m_dispatcher.process_request_to(batch, out, {}, &resource));
+        EXPECT_EQ(nlohmann::json::parse(out).size(), 6);
+        resource.release();
+    }
+}
@@ -0,0 +1,233 @@
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+
+#include "dispatcher.h"
+#include "exception.h"
+#include "metrics.h"
+#include "task.h"
+
+using namespace nlohmann::json_literals;
+
+class MetricsTest : public ::testing::Test {
+public:
+    MetricsTest()
+    {
+        this->m_dispatcher.add("sum", [](int a, int b) { return a + b; });
+        this->m_dispatcher.add("throw", []() -> int { throw std::runtime_error("Boom"); });
+        this->m_dispatcher.add("async", [](int a) -> wwa::json_rpc::task<int> { co_return a; });
+        this->m_dispatcher.enable_metrics();
+    }
+
+    wwa::json_rpc::dispatcher& dispatcher() noexcept { return this->m_dispatcher; }
+
+private:
+    wwa::json_rpc::dispatcher m_dispatcher;
+};
+
+TEST(LatencyHistogramTest, TestBuckets)
+{
+    using wwa::json_rpc::latency_histogram;
+
+    for (std::size_t i = 0; i < latency_histogram::bucket_count; ++i) {
+        const auto lower = latency_histogram::bucket_lower_bound(i);
+        EXPECT_EQ(latency_histogram::bucket_index(lower), i);
+
+        if (i + 1 < latency_histogram::bucket_count) {
+            const auto upper = latency_histogram::bucket_upper_bound(i);
+            EXPECT_EQ(latency_histogram::bucket_index(upper), i);
+            EXPECT_EQ(upper + 1, latency_histogram::bucket_lower_bound(i + 1));
+        }
+    }
+
+    // Small values are exact
+    EXPECT_EQ(latency_histogram::bucket_index(0), 0);
+    EXPECT_EQ(latency_histogram::bucket_index(31), 31);
+
+    // Values beyond the range go to the last bucket
+    EXPECT_EQ(latency_histogram::bucket_index(UINT64_MAX), latency_histogram::bucket_count - 1);
+}
+
+TEST(LatencyHistogramTest, TestPercentiles)
+{
+    wwa::json_rpc::latency_histogram h;
+
+    EXPECT_EQ(h.value_at_percentile(99), 0);
+    EXPECT_EQ(h.min(), 0);
+    EXPECT_EQ(h.max(), 0);
+
+    for (std::uint64_t v = 1; v <= 1000; ++v) {
+        h.record(v * 1000);
+    }
+
+    EXPECT_EQ(h.count(), 1000);
+    EXPECT_EQ(h.min(), 1000);
+    EXPECT_EQ(h.max(), 1000000);
+    EXPECT_DOUBLE_EQ(h.mean(), 500500.0);
+    EXPECT_EQ(h.value_at_percentile(100), 1000000);
+
+    // The relative error is at most 1/32
+    for (const double p : {50.0, 90.0, 99.0, 99.9}) {
+        const auto expected = static_cast<double>(p * 10000);
+        const auto actual   = static_cast<double>(h.value_at_percentile(p));
+        EXPECT_GE(actual, expected) << p;
+        EXPECT_LE(actual, expected * (1.0 + 1.0 / 32)) << p;
+    }
+
+    wwa::json_rpc::latency_histogram other;
+    other.record(5);
+    other.record(2000000);
+    h.merge(other);
+
+    EXPECT_EQ(h.count(), 1002);
+    EXPECT_EQ(h.min(), 5);
+    EXPECT_EQ(h.max(), 2000000);
+    EXPECT_EQ(h.value_at_percentile(0), 5);
+}
+
+TEST(MetricsDisabledTest, TestDisabledByDefault)
+{
+    wwa::json_rpc::dispatcher dispatcher;
+    dispatcher.add("sum", [](int a, int b) { return a + b; });
+
+    EXPECT_EQ(
+        dispatcher.process_request(R"({"jsonrpc": "2.0", "method": "sum", "params": [1, 2], "id": 1})"_json)["result"],
+        3
+    );
+
+    const auto metrics = dispatcher.metrics();
+    EXPECT_TRUE(metrics.methods.empty());
+    EXPECT_TRUE(metrics.errors.empty());
+    EXPECT_EQ(metrics.parse.count(), 0);
+    EXPECT_EQ(metrics.serialize.count(), 0);
+}
+
+TEST_F(MetricsTest, TestCallsAndErrors)
+{
+    // clang-format off
+    const auto batch = R"([
+        {"jsonrpc": "2.0", "method": "sum", "params": [1, 2], "id": 1},
+        {"jsonrpc": "2.0", "method": "sum", "params": [1, 2]},
+        {"jsonrpc": "2.0", "method": "sum", "params": ["a", 2], "id": 2},
+        {"jsonrpc": "2.0", "method": "throw", "id": 3},
+        {"jsonrpc": "2.0", "method": "missing", "id": 4},
+        1
+    ])"_json;
+    // clang-format on
+
+    const auto response = this->dispatcher().process_request(batch);
+    ASSERT_TRUE(response.is_array());
+    ASSERT_EQ(response.size(), 5);
+
+    const auto metrics = this->dispatcher().metrics();
+
+    ASSERT_EQ(metrics.methods.size(), 2);
+    ASSERT_TRUE(metrics.methods.contains("sum"));
+    ASSERT_TRUE(metrics.methods.contains("throw"));
+    EXPECT_FALSE(metrics.methods.contains("missing"));
+
+    const auto& sum = metrics.methods.find("sum")->second;
+    EXPECT_EQ(sum.calls, 3);
+    EXPECT_EQ(sum.errors, 1);
+    EXPECT_EQ(sum.invoke.count(), 3);
+
+    const auto& thrown = metrics.methods.find("throw")->second;
+    EXPECT_EQ(thrown.calls, 1);
+    EXPECT_EQ(thrown.errors, 1);
+
+    const std::map<int, std::uint64_t> errors = {
+        {wwa::json_rpc::exception::INVALID_REQUEST, 1},
+        {wwa::json_rpc::exception::METHOD_NOT_FOUND, 1},
+        {wwa::json_rpc::exception::INVALID_PARAMS, 1},
+        {wwa::json_rpc::exception::INTERNAL_ERROR, 1},
+    };
+
+    EXPECT_EQ(metrics.errors, errors);
+    EXPECT_EQ(metrics.parse.count(), 5);
+    EXPECT_EQ(metrics.serialize.count(), 5);
+}
+
+TEST_F(MetricsTest, TestRawRequests)
+{
+    std::string out;
+    EXPECT_TRUE(
+        this->dispatcher().process_request_to(R"({"jsonrpc": "2.0", "method": "sum", "params": [1, 2], "id": 1})", out)
+    );
+    EXPECT_TRUE(this->dispatcher().process_request(R"({"jsonrpc": "2.0", "method": "sum")").contains("error"));
+
+    const auto metrics = this->dispatcher().metrics();
+
+    ASSERT_TRUE(metrics.methods.contains("sum"));
+    EXPECT_EQ(metrics.methods.find("sum")->second.calls, 1);
+    EXPECT_EQ(metrics.errors, (std::map<int, std::uint64_t>{{wwa::json_rpc::exception::PARSE_ERROR, 1}}));
+
+    // Text parsing of both requests, plus the validation of the first one
+    EXPECT_EQ(metrics.parse.count(), 3);
+    EXPECT_EQ(metrics.serialize.count(), 1);
+}
+
+TEST_F(MetricsTest, TestAsync)
+{
+    const auto request = R"({"jsonrpc": "2.0", "method": "async", "params": [5], "id": 1})"_json;
+
+    EXPECT_EQ(wwa::json_rpc::sync_wait(this->dispatcher().process_request_async(request))["result"], 5);
+    EXPECT_EQ(this->dispatcher().process_request(request)["result"], 5);
+
+    const auto metrics = this->dispatcher().metrics();
+    ASSERT_TRUE(metrics.methods.contains("async"));
+    EXPECT_EQ(metrics.methods.find("async")->second.calls, 2);
+    EXPECT_EQ(metrics.methods.find("async")->second.errors, 0);
+}
+
+TEST_F(MetricsTest, TestThreads)
+{
+    constexpr std::size_t thread_count = 4;
+    constexpr std::size_t requests     = 250;
+
+    const auto request = R"({"jsonrpc": "2.0", "method": "sum", "params": [1, 2], "id": 1})"_json;
+
+    std::vector<std::thread> threads;
+    threads.reserve(thread_count);
+    for (std::size_t i = 0; i < thread_count; ++i) {
+        threads.emplace_back([this, &request]() {
+            for (std::size_t j = 0; j < requests; ++j) {
+                static_cast<void>(this->dispatcher().process_request(request));
+            }
+        });
+    }
+
+    // Reading the metrics while they are being recorded is allowed
+    static_cast<void>(this->dispatcher().metrics());
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    const auto metrics = this->dispatcher().metrics();
+    ASSERT_TRUE(metrics.methods.contains("sum"));
+    EXPECT_EQ(metrics.methods.find("sum")->second.calls, thread_count * requests);
+    EXPECT_EQ(metrics.methods.find("sum")->second.invoke.count(), thread_count * requests);
+    EXPECT_EQ(metrics.parse.count(), thread_count * requests);
+}
+
+TEST_F(MetricsTest, TestDisable)
+{
+    const auto request = R"({"jsonrpc": "2.0", "method": "sum", "params": [1, 2], "id": 1})"_json;
+    static_cast<void>(this->dispatcher().process_request(request));
+    EXPECT_FALSE(this->dispatcher().metrics().methods.empty());
+
+    this->dispatcher().enable_metrics(false);
+    static_cast<void>(this->dispatcher().process_request(request));
+    EXPECT_TRUE(this->dispatcher().metrics().methods.empty());
+
+    // Re-enabling starts from scratch
+    this->dispatcher().enable_metrics();
+    static_cast<void>(this->dispatcher().process_request(request));
+    EXPECT_EQ(this->dispatcher().metrics().methods.find("sum")->second.calls, 1);
+}
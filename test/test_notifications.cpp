@@ -17,6 +17,33 @@ TEST_P(NotificationsTest, TestNotifications)
     EXPECT_TRUE(actual.is_discarded());
 }
 
+TEST_P(NotificationsTest, TestNotificationsRaw)
+{
+    const auto& input = GetParam();
+    const auto actual = this->dispatcher().process_request(input);
+
+    EXPECT_TRUE(actual.is_discarded());
+}
+
+TEST_P(NotificationsTest, TestNotificationsAsync)
+{
+    const auto& input = GetParam();
+    const auto actual =
+        wwa::json_rpc::sync_wait(this->dispatcher().process_request_async(nlohmann::json::parse(input)));
+
+    EXPECT_TRUE(actual.is_discarded());
+}
+
+TEST_P(NotificationsTest, TestNotificationsToBuffer)
+{
+    const auto& input = GetParam();
+
+    std::string out;
+    EXPECT_FALSE(this->dispatcher().process_request_to(input, out));
+    EXPECT_FALSE(this->dispatcher().process_request_to(nlohmann::json::parse(input), out));
+    EXPECT_TRUE(out.empty());
+}
+
 // clang-format off
 INSTANTIATE_TEST_SUITE_P(Notifications, NotificationsTest, testing::Values(
     R"({"jsonrpc": "2.0", "method": "notification"})"s,
@@ -0,0 +1,174 @@
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+
+#include "dispatcher.h"
+#include "executor.h"
+
+namespace {
+
+/**
+ * @brief Executor that records the number of submitted tasks and runs them on a thread pool.
+ */
+class counting_executor : public wwa::json_rpc::executor {
+public:
+    void execute(std::function<void()> task) override
+    {
+        this->m_submitted.fetch_add(1, std::memory_order_relaxed);
+        this->m_pool.execute(std::move(task));
+    }
+
+    [[nodiscard]] std::size_t concurrency() const noexcept override { return this->m_pool.concurrency(); }
+
+    [[nodiscard]] std::size_t submitted() const noexcept { return this->m_submitted.load(); }
+
+private:
+    wwa::json_rpc::thread_pool m_pool{4};
+    std::atomic_size_t m_submitted{0};
+};
+
+/**
+ * @brief Executor that never runs the submitted tasks.
+ */
+class idle_executor : public wwa::json_rpc::executor {
+public:
+    void execute(std::function<void()>) override {}
+    [[nodiscard]] std::size_t concurrency() const noexcept override { return 4; }
+};
+
+class recording_dispatcher : public wwa::json_rpc::dispatcher {
+public:
+    std::set<std::uint64_t> ids() const
+    {
+        const std::lock_guard lock(this->m_mutex);
+        return this->m_ids;
+    }
+
+protected:
+    void request_parsed(const wwa::json_rpc::jsonrpc_request&, const std::any&, std::uint64_t unique_id) override
+    {
+        const std::lock_guard lock(this->m_mutex);
+        this->m_ids.insert(unique_id);
+    }
+
+private:
+    mutable std::mutex m_mutex;
+    std::set<std::uint64_t> m_ids;
+};
+
+nlohmann::json make_batch(std::size_t size)
+{
+    auto batch = nlohmann::json::array();
+    for (std::size_t i = 0; i < size; ++i) {
+        switch (i % 5) {
+            case 0:
+                batch.push_back({{"jsonrpc", "2.0"}, {"method", "sum"}, {"params", {i, 1}}, {"id", i}});
+                break;
+            case 1:
+                batch.push_back({{"jsonrpc", "2.0"}, {"method", "sum"}, {"params", {i, 2}}});
+                break;
+            case 2:
+                batch.push_back({{"jsonrpc", "2.0"}, {"method", "throw"}, {"id", std::to_string(i)}});
+                break;
+            case 3:
+                batch.push_back(i);
+                break;
+            default:
+                batch.push_back({{"jsonrpc", "2.0"}, {"method", "missing"}, {"id", i}});
+                break;
+        }
+    }
+
+    return batch;
+}
+
+}  // namespace
+
+class ParallelBatchTest : public ::testing::Test {
+public:
+    ParallelBatchTest()
+    {
+        for (auto* d : {&this->m_sequential, &this->m_parallel}) {
+            d->add("sum", [](std::size_t a, std::size_t b) { return a + b; });
+            d->add("throw", []() -> int { throw std::runtime_error("Boom"); });
+        }
+
+        this->m_parallel.set_executor(this->m_executor);
+        this->m_parallel.set_parallel_batch_threshold(4);
+    }
+
+protected:
+    recording_dispatcher m_sequential;
+    recording_dispatcher m_parallel;
+    std::shared_ptr<counting_executor> m_executor = std::make_shared<counting_executor>();
+};
+
+TEST_F(ParallelBatchTest, TestSameResponses)
+{
+    const auto batch    = make_batch(500);
+    const auto expected = this->m_sequential.process_request(batch);
+
+    EXPECT_EQ(this->m_parallel.process_request(batch), expected);
+    EXPECT_EQ(this->m_parallel.process_request(batch.dump()), expected);
+
+    std::string out;
+    ASSERT_TRUE(this->m_parallel.process_request_to(batch, out));
+    EXPECT_EQ(nlohmann::json::parse(out), expected);
+
+    out.clear();
+    ASSERT_TRUE(this->m_parallel.process_request_to(batch.dump(), out));
+    EXPECT_EQ(nlohmann::json::parse(out), expected);
+
+    EXPECT_GT(this->m_executor->submitted(), 0);
+}
+
+TEST_F(ParallelBatchTest, TestUniqueIds)
+{
+    const auto batch = make_batch(100);
+    this->m_parallel.process_request(batch);
+
+    // Every object element that reaches request_parsed() gets its own ID: 4 of every 5 elements are objects
+    EXPECT_EQ(this->m_parallel.ids().size(), 80);
+}
+
+TEST_F(ParallelBatchTest, TestNotificationsOnly)
+{
+    auto batch = nlohmann::json::array();
+    for (int i = 0; i < 50; ++i) {
+        batch.push_back({{"jsonrpc", "2.0"}, {"method", "sum"}, {"params", {i, i}}});
+    }
+
+    EXPECT_TRUE(this->m_parallel.process_request(batch).is_discarded());
+    EXPECT_TRUE(this->m_parallel.process_request(batch.dump()).is_discarded());
+
+    std::string out = "prefix";
+    EXPECT_FALSE(this->m_parallel.process_request_to(batch, out));
+    EXPECT_EQ(out, "prefix");
+}
+
+TEST_F(ParallelBatchTest, TestThreshold)
+{
+    const auto batch = make_batch(3);
+    EXPECT_EQ(this->m_parallel.process_request(batch), this->m_sequential.process_request(batch));
+    EXPECT_EQ(this->m_executor->submitted(), 0);
+}
+
+TEST(ParallelBatchIdleExecutorTest, TestCallerCompletesBatch)
+{
+    wwa::json_rpc::dispatcher dispatcher;
+    dispatcher.add("sum", [](std::size_t a, std::size_t b) { return a + b; });
+    dispatcher.set_executor(std::make_shared<idle_executor>());
+    dispatcher.set_parallel_batch_threshold(0);
+
+    const auto response = dispatcher.process_request(make_batch(20));
+    ASSERT_TRUE(response.is_array());
+    EXPECT_EQ(response.size(), 16);
+}
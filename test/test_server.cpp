@@ -0,0 +1,787 @@
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+
+#include "base.h"
+#include "exception.h"
+#include "server.h"
+#include "utils.h"
+
+namespace {
+
+/**
+ * @brief An HTTP response.
+ */
+struct http_response {
+    int status = 0;    ///< The status code.
+    std::string head;  ///< The status line and the header fields.
+    std::string body;  ///< The body.
+};
+
+/**
+ * @brief Blocking client socket.
+ */
+class client {
+public:
+    explicit client(std::uint16_t port) : m_fd(::socket(AF_INET, SOCK_STREAM, 0))
+    {
+        sockaddr_in addr{};
+        addr.sin_family      = AF_INET;
+        addr.sin_port        = htons(port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        this->connect(&addr, sizeof(addr));
+    }
+
+    explicit client(const std::string& path) : m_fd(::socket(AF_UNIX, SOCK_STREAM, 0))
+    {
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::strncpy(static_cast<char*>(addr.sun_path), path.c_str(), sizeof(addr.sun_path) - 1);
+        this->connect(&addr, sizeof(addr));
+    }
+
+    ~client() { ::close(this->m_fd); }
+
+    client(const client&)            = delete;
+    client& operator=(const client&) = delete;
+    client(client&&)                 = delete;
+    client& operator=(client&&)      = delete;
+
+    void send(std::string_view data) const
+    {
+        while (!data.empty()) {
+            const auto n = ::send(this->m_fd, data.data(), data.size(), MSG_NOSIGNAL);
+            ASSERT_GT(n, 0);
+            data.remove_prefix(static_cast<std::size_t>(n));
+        }
+    }
+
+    void shutdown() const { ::shutdown(this->m_fd, SHUT_WR); }
+
+    std::vector<nlohmann::json> read_lines(std::size_t count)
+    {
+        std::vector<nlohmann::json> result;
+        while (result.size() < count) {
+            const auto eol = this->m_buffer.find('\n');
+            if (eol == std::string::npos) {
+                if (!this->fill()) {
+                    break;
+                }
+
+                continue;
+            }
+
+            result.push_back(nlohmann::json::parse(this->m_buffer.substr(0, eol)));
+            this->m_buffer.erase(0, eol + 1);
+        }
+
+        return result;
+    }
+
+    std::vector<nlohmann::json> read_frames(std::size_t count)
+    {
+        std::vector<nlohmann::json> result;
+        while (result.size() < count) {
+            if (this->m_buffer.size() >= 4) {
+                const auto* p            = reinterpret_cast<const unsigned char*>(this->m_buffer.data());
+                const std::size_t length = (std::size_t{p[0]} << 24U) | (std::size_t{p[1]} << 16U) |
+                                           (std::size_t{p[2]} << 8U) | std::size_t{p[3]};
+                if (this->m_buffer.size() >= 4 + length) {
+                    result.push_back(nlohmann::json::parse(this->m_buffer.substr(4, length)));
+                    this->m_buffer.erase(0, 4 + length);
+                    continue;
+                }
+            }
+
+            if (!this->fill()) {
+                break;
+            }
+        }
+
+        return result;
+    }
+
+    /**
+     * @brief Reads HTTP responses.
+     *
+     * @param count The number of responses.
+     * @return The responses; fewer than @a count if the connection has been closed.
+     */
+    std::vector<http_response> read_http(std::size_t count)
+    {
+        std::vector<http_response> result;
+        while (result.size() < count) {
+            const auto end = this->m_buffer.find("\r\n\r\n");
+            if (end != std::string::npos) {
+                http_response response;
+                response.status = std::stoi(this->m_buffer.substr(9, 3));
+                response.head   = this->m_buffer.substr(0, end + 2);
+
+                std::size_t length = 0;
+                if (const auto pos = response.head.find("Content-Length:"); pos != std::string::npos) {
+                    length = std::stoul(response.head.substr(pos + 15));
+                }
+
+                if (this->m_buffer.size() >= end + 4 + length) {
+                    response.body = this->m_buffer.substr(end + 4, length);
+                    this->m_buffer.erase(0, end + 4 + length);
+                    result.push_back(std::move(response));
+                    continue;
+                }
+            }
+
+            if (!this->fill()) {
+                break;
+            }
+        }
+
+        return result;
+    }
+
+    /**
+     * @brief Reads until the server closes the connection.
+     *
+     * @return Whether nothing but the end of the stream has been received.
+     */
+    bool expect_eof() { return !this->fill() && this->m_buffer.empty(); }
+
+private:
+    int m_fd;
+    std::string m_buffer;
+
+    void connect(const void* addr, std::size_t len) const
+    {
+        timeval tv{10, 0};
+        ::setsockopt(this->m_fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        ASSERT_EQ(::connect(this->m_fd, static_cast<const sockaddr*>(addr), static_cast<socklen_t>(len)), 0);
+    }
+
+    bool fill()
+    {
+        std::vector<char> buf(4096);
+        const auto n = ::recv(this->m_fd, buf.data(), buf.size(), 0);
+        if (n <= 0) {
+            return false;
+        }
+
+        this->m_buffer.append(buf.data(), static_cast<std::size_t>(n));
+        return true;
+    }
+};
+
+std::string frame(std::string_view body)
+{
+    std::string result(4, '\0');
+    result[0] = static_cast<char>((body.size() >> 24U) & 0xFFU);
+    result[1] = static_cast<char>((body.size() >> 16U) & 0xFFU);
+    result[2] = static_cast<char>((body.size() >> 8U) & 0xFFU);
+    result[3] = static_cast<char>(body.size() & 0xFFU);
+    return result.append(body);
+}
+
+template<typename Predicate>
+bool wait_until(Predicate pred)
+{
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (!pred()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    return true;
+}
+
+std::string http_post(std::string_view body, std::string_view fields = {})
+{
+    return std::string("POST /rpc HTTP/1.1\r\nHost: localhost\r\n")
+        .append(fields)
+        .append("Content-Type: application/json\r\nContent-Length: ")
+        .append(std::to_string(body.size()))
+        .append("\r\n\r\n")
+        .append(body);
+}
+
+}  // namespace
+
+class ServerTest : public BaseDispatcherTest,
+                   public testing::WithParamInterface<wwa::json_rpc::server_backend> {};
+
+TEST_P(ServerTest, TestTcpNdjson)
+{
+    wwa::json_rpc::server_options options;
+    options.threads = 2;
+    options.backend = GetParam();
+
+    wwa::json_rpc::server server(this->dispatcher(), {}, options);
+    const auto port = server.listen_tcp("127.0.0.1", 0);
+    server.start();
+
+    client c(port);
+
+    // clang-format off
+    const std::string input =
+        R"({"jsonrpc": "2.0", "method": "subtract_p", "params": [42, 23], "id": 1})" "\n"
+        R"({"jsonrpc": "2.0", "method": "notify_hello", "params": [7]})" "\n"
+        "\n"
+        R"({"jsonrpc": "2.0", "method": "subtract_p", "params": [23, 42], "id": 2})" "\r\n"
+        R"({"jsonrpc": "2.0", "method": "foobar", "id": 3)" "\n"
+        R"({"jsonrpc": "2.0", "method": "get_data", "id": 4})" "\n";
+    // clang-format on
+
+    // Split the messages across several segments
+    for (std::size_t i = 0; i < input.size(); i += 7) {
+        c.send(std::string_view(input).substr(i, 7));
+    }
+
+    const auto responses = c.read_lines(4);
+    ASSERT_EQ(responses.size(), 4);
+    EXPECT_EQ(responses[0]["result"], 19);
+    EXPECT_EQ(responses[1]["result"], -19);
+    EXPECT_EQ(wwa::json_rpc::get_error_code(responses[2]), wwa::json_rpc::exception::PARSE_ERROR);
+    EXPECT_EQ(responses[3]["result"], nlohmann::json::array({"hello", 5}));
+
+    c.shutdown();
+    EXPECT_TRUE(c.expect_eof());
+    EXPECT_TRUE(wait_until([&server]() { return server.stats().connections_open == 0; }));
+
+    const auto stats = server.stats();
+    EXPECT_EQ(stats.connections_accepted, 1);
+    EXPECT_EQ(stats.messages, 5);
+    EXPECT_EQ(stats.responses, 4);
+    EXPECT_EQ(stats.bytes_read, input.size());
+}
+
+TEST_P(ServerTest, TestUnixLengthPrefixed)
+{
+    const std::string path = ::testing::TempDir() + "jsonrpc-test-" + std::to_string(::getpid()) + ".sock";
+
+    wwa::json_rpc::server_options options;
+    options.threads          = 1;
+    options.framing          = wwa::json_rpc::framing_type::length_prefixed;
+    options.max_message_size = 100;
+    options.backend          = GetParam();
+
+    {
+        wwa::json_rpc::server server(this->dispatcher(), {}, options);
+        server.listen_unix(path);
+        server.start();
+
+        client c(path);
+
+        // clang-format off
+        const std::string large = R"({"jsonrpc": "2.0", "method": "sumv", "params": [1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18], "id": 1})";
+        const std::string input =
+            frame(R"({"jsonrpc": "2.0", "method": "sumv", "params": [1, 2], "id": 1})") +
+            frame(R"({"jsonrpc": "2.0", "method": "notify_hello", "params": [7]})") +
+            frame(large) +
+            frame(R"({"jsonrpc": "2.0", "method": "subtract_p", "params": [2, 1], "id": 2})");
+        // clang-format on
+
+        for (std::size_t i = 0; i < input.size(); i += 3) {
+            c.send(std::string_view(input).substr(i, 3));
+        }
+
+        const auto responses = c.read_frames(3);
+        ASSERT_EQ(responses.size(), 3);
+        EXPECT_EQ(responses[0]["result"], 3);
+        EXPECT_EQ(wwa::json_rpc::get_error_code(responses[1]), wwa::json_rpc::exception::INVALID_REQUEST);
+        EXPECT_EQ(wwa::json_rpc::get_error_message(responses[1]), wwa::json_rpc::err_request_too_large);
+        EXPECT_EQ(responses[2]["result"], 1);
+    }
+
+    EXPECT_NE(::access(path.c_str(), F_OK), 0);
+}
+
+TEST_P(ServerTest, TestConcurrentClients)
+{
+    wwa::json_rpc::server_options options;
+    options.threads = 4;
+    options.backend = GetParam();
+
+    wwa::json_rpc::server server(this->dispatcher(), {}, options);
+    const auto port = server.listen_tcp("127.0.0.1", 0);
+    server.start();
+
+    static constexpr int clients          = 16;
+    static constexpr std::size_t requests = 500;
+
+    std::vector<std::thread> threads;
+    threads.reserve(clients);
+    for (int i = 0; i < clients; ++i) {
+        threads.emplace_back([port, i]() {
+            client c(port);
+            std::string input;
+            for (std::size_t j = 0; j < requests; ++j) {
+                input += R"({"jsonrpc": "2.0", "method": "subtract_p", "params": [)" + std::to_string(i) + ", " +
+                         std::to_string(j) + R"(], "id": )" + std::to_string(j) + "}\n";
+            }
+
+            c.send(input);
+            const auto responses = c.read_lines(requests);
+            ASSERT_EQ(responses.size(), requests);
+            for (std::size_t j = 0; j < requests; ++j) {
+                EXPECT_EQ(responses[j]["id"], j);
+                EXPECT_EQ(responses[j]["result"], i - static_cast<int>(j));
+            }
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_TRUE(wait_until([&server]() { return server.stats().connections_open == 0; }));
+    EXPECT_EQ(server.stats().connections_accepted, clients);
+    EXPECT_EQ(server.stats().responses, clients * requests);
+}
+
+TEST_P(ServerTest, TestThreadPerCore)
+{
+    const std::string path = ::testing::TempDir() + "jsonrpc-test-core-" + std::to_string(::getpid()) + ".sock";
+
+    wwa::json_rpc::server_options options;
+    options.threads         = 4;
+    options.thread_per_core = true;
+    options.pin_threads     = true;
+    options.backend         = GetParam();
+
+    this->dispatcher().freeze();
+
+    wwa::json_rpc::server server(this->dispatcher(), {}, options);
+    const auto port = server.listen_tcp("127.0.0.1", 0);
+    EXPECT_EQ(server.listen_tcp("127.0.0.1", port), port);
+    server.listen_unix(path);
+
+    static constexpr int clients          = 16;
+    static constexpr std::size_t requests = 100;
+
+    // The listening sockets survive a restart
+    for (int round = 0; round < 2; ++round) {
+        server.start();
+
+        std::vector<std::thread> threads;
+        threads.reserve(clients);
+        for (int i = 0; i < clients; ++i) {
+            threads.emplace_back([port, &path, i]() {
+                auto c = i % 4 == 0 ? std::make_unique<client>(path) : std::make_unique<client>(port);
+                std::string input;
+                for (std::size_t j = 0; j < requests; ++j) {
+                    input += R"({"jsonrpc": "2.0", "method": "subtract_p", "params": [)" + std::to_string(i) + ", " +
+                             std::to_string(j) + R"(], "id": )" + std::to_string(j) + "}\n";
+                }
+
+                c->send(input);
+                const auto responses = c->read_lines(requests);
+                ASSERT_EQ(responses.size(), requests);
+                for (std::size_t j = 0; j < requests; ++j) {
+                    EXPECT_EQ(responses[j]["id"], j);
+                    EXPECT_EQ(responses[j]["result"], i - static_cast<int>(j));
+                }
+            });
+        }
+
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        EXPECT_TRUE(wait_until([&server]() { return server.stats().connections_open == 0; }));
+        server.stop();
+    }
+
+    EXPECT_EQ(server.stats().connections_accepted, 2 * clients);
+    EXPECT_EQ(server.stats().responses, 2 * clients * requests);
+}
+
+TEST_P(ServerTest, TestHttpPipelining)
+{
+    wwa::json_rpc::server_options options;
+    options.threads = 1;
+    options.framing = wwa::json_rpc::framing_type::http;
+    options.backend = GetParam();
+
+    wwa::json_rpc::server server(this->dispatcher(), {}, options);
+    const auto port = server.listen_tcp("127.0.0.1", 0);
+    server.start();
+
+    client c(port);
+
+    // clang-format off
+    const std::string input =
+        http_post(R"({"jsonrpc": "2.0", "method": "subtract_p", "params": [42, 23], "id": 1})") +
+        http_post(R"({"jsonrpc": "2.0", "method": "notify_hello", "params": [7]})") +
+        "\r\n" +
+        http_post(R"([{"jsonrpc": "2.0", "method": "notify_hello", "params": [7]}, {"jsonrpc": "2.0", "method": "notify_hello", "params": [8]}])") +
+        "GET /rpc HTTP/1.1\r\nHost: localhost\r\n\r\n" +
+        http_post(R"({"jsonrpc": "2.0", "method": "foobar", "id": 3)") +
+        http_post(R"({"jsonrpc": "2.0", "method": "subtract_p", "params": [23, 42], "id": 2})", "Connection: close\r\n") +
+        http_post(R"({"jsonrpc": "2.0", "method": "subtract_p", "params": [1, 1], "id": 4})");
+    // clang-format on
+
+    // Split the requests across several segments
+    for (std::size_t i = 0; i < input.size(); i += 11) {
+        c.send(std::string_view(input).substr(i, 11));
+    }
+
+    const auto responses = c.read_http(6);
+    ASSERT_EQ(responses.size(), 6);
+    EXPECT_EQ(responses[0].status, 200);
+    EXPECT_NE(responses[0].head.find("Content-Type: application/json\r\n"), std::string::npos);
+    EXPECT_EQ(nlohmann::json::parse(responses[0].body)["result"], 19);
+    EXPECT_EQ(responses[1].status, 204);
+    EXPECT_EQ(responses[2].status, 204);
+    EXPECT_EQ(responses[3].status, 405);
+    EXPECT_NE(responses[3].head.find("Allow: POST\r\n"), std::string::npos);
+    EXPECT_EQ(responses[4].status, 200);
+    EXPECT_EQ(
+        wwa::json_rpc::get_error_code(nlohmann::json::parse(responses[4].body)), wwa::json_rpc::exception::PARSE_ERROR
+    );
+    EXPECT_EQ(responses[5].status, 200);
+    EXPECT_NE(responses[5].head.find("Connection: close\r\n"), std::string::npos);
+    EXPECT_EQ(nlohmann::json::parse(responses[5].body)["result"], -19);
+
+    // The request after "Connection: close" is ignored, and the server closes the connection after the client
+    EXPECT_TRUE(c.expect_eof());
+    EXPECT_EQ(server.stats().connections_open, 1);
+    c.shutdown();
+    EXPECT_TRUE(wait_until([&server]() { return server.stats().connections_open == 0; }));
+    EXPECT_EQ(server.stats().messages, 5);
+    EXPECT_EQ(server.stats().responses, 3);
+}
+
+TEST_P(ServerTest, TestHttpChunked)
+{
+    wwa::json_rpc::server_options options;
+    options.threads = 1;
+    options.framing = wwa::json_rpc::framing_type::http;
+    options.backend = GetParam();
+
+    wwa::json_rpc::server server(this->dispatcher(), {}, options);
+    const auto port = server.listen_tcp("127.0.0.1", 0);
+    server.start();
+
+    client c(port);
+
+    // The body is only sent after "100 Continue"
+    c.send("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\nExpect: 100-continue\r\n\r\n");
+    auto responses = c.read_http(1);
+    ASSERT_EQ(responses.size(), 1);
+    EXPECT_EQ(responses[0].status, 100);
+
+    // clang-format off
+    const std::string input =
+        "10;ext=1\r\n" R"({"jsonrpc": "2.0)" "\r\n"
+        "1A \r\n" R"(", "method": "subtract_p",)" "\r\n"
+        "1d\r\n" R"( "params": [42, 23], "id": 1})" "\r\n"
+        "0\r\nX-Trailer: 1\r\n\r\n"
+        "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n"
+        "45\r\n" R"({"jsonrpc": "2.0", "method": "subtract_p", "params": [2, 1], "id": 2})" "\r\n0\r\n\r\n"
+        "POST / HTTP/1.0\r\nContent-Length: 0\r\n\r\n";
+    // clang-format on
+
+    for (std::size_t i = 0; i < input.size(); i += 5) {
+        c.send(std::string_view(input).substr(i, 5));
+    }
+
+    responses = c.read_http(3);
+    ASSERT_EQ(responses.size(), 3);
+    EXPECT_EQ(nlohmann::json::parse(responses[0].body)["result"], 19);
+    EXPECT_EQ(nlohmann::json::parse(responses[1].body)["result"], 1);
+    EXPECT_EQ(
+        wwa::json_rpc::get_error_code(nlohmann::json::parse(responses[2].body)), wwa::json_rpc::exception::PARSE_ERROR
+    );
+
+    // HTTP/1.0 without keep-alive
+    EXPECT_NE(responses[2].head.find("Connection: close\r\n"), std::string::npos);
+    EXPECT_TRUE(c.expect_eof());
+}
+
+TEST_P(ServerTest, TestHttpErrors)
+{
+    wwa::json_rpc::server_options options;
+    options.threads          = 1;
+    options.framing          = wwa::json_rpc::framing_type::http;
+    options.max_message_size = 100;
+    options.backend          = GetParam();
+
+    wwa::json_rpc::server server(this->dispatcher(), {}, options);
+    const auto port = server.listen_tcp("127.0.0.1", 0);
+    server.start();
+
+    const std::vector<std::pair<std::string, int>> cases = {
+        {"POST / HTTP/1.1\r\nContent-Length: 101\r\n\r\n", 413},
+        {"POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n40\r\n" + std::string(64, ' ') + "\r\n40\r\n", 413},
+        {"POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\nxyz\r\n", 400},
+        {"POST / HTTP/1.1\r\nTransfer-Encoding: gzip\r\n\r\n", 501},
+        {"POST / HTTP/1.1\r\nContent-Length: 1\r\nTransfer-Encoding: chunked\r\n\r\n", 400},
+        {"POST / HTTP/1.1\r\nContent-Length: 1\r\nContent-Length: 2\r\n\r\n", 400},
+        {"POST / HTTP/1.1\r\nContent-Length : 1\r\n\r\n", 400},
+        {"POST / HTTP/2.0\r\n\r\n", 505},
+        {"garbage\r\n\r\n", 400},
+        {"POST / HTTP/1.1\r\nX-Large: " + std::string(9000, 'x') + "\r\n\r\n", 431},
+    };
+
+    for (const auto& [request, status] : cases) {
+        client c(port);
+        c.send(request);
+
+        const auto responses = c.read_http(1);
+        ASSERT_EQ(responses.size(), 1) << request;
+        EXPECT_EQ(responses[0].status, status) << request;
+        EXPECT_NE(responses[0].head.find("Connection: close\r\n"), std::string::npos);
+        EXPECT_TRUE(c.expect_eof());
+    }
+}
+
+TEST_P(ServerTest, TestHttpLingeringClose)
+{
+    wwa::json_rpc::server_options options;
+    options.threads          = 1;
+    options.framing          = wwa::json_rpc::framing_type::http;
+    options.max_message_size = 100;
+    options.backend          = GetParam();
+
+    wwa::json_rpc::server server(this->dispatcher(), {}, options);
+    const auto port = server.listen_tcp("127.0.0.1", 0);
+    server.start();
+
+    client c(port);
+    c.send("POST / HTTP/1.1\r\nContent-Length: 1000000\r\n\r\n" + std::string(1000, ' '));
+
+    const auto responses = c.read_http(1);
+    ASSERT_EQ(responses.size(), 1);
+    EXPECT_EQ(responses[0].status, 413);
+
+    // The rest of the body is discarded rather than answered with a reset
+    const std::string chunk(16384, ' ');
+    for (int i = 0; i < 16; ++i) {
+        c.send(chunk);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    c.shutdown();
+    EXPECT_TRUE(c.expect_eof());
+}
+
+TEST_P(ServerTest, TestSlowReader)
+{
+    wwa::json_rpc::server_options options;
+    options.threads            = 1;
+    options.max_pending_output = 1024;
+    options.backend            = GetParam();
+
+    wwa::json_rpc::server server(this->dispatcher(), {}, options);
+    const auto port = server.listen_tcp("127.0.0.1", 0);
+    server.start();
+
+    client c(port);
+
+    // Send much more than the socket buffers can hold before reading anything
+    constexpr std::size_t count = 100000;
+    std::thread writer([&c]() {
+        const std::string request = R"({"jsonrpc": "2.0", "method": "subtract_p", "params": [2, 1], "id": 1})"
+                                    "\n";
+        std::string input;
+        for (std::size_t i = 0; i < 1000; ++i) {
+            input += request;
+        }
+
+        for (std::size_t i = 0; i < count / 1000; ++i) {
+            c.send(input);
+        }
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    const auto responses = c.read_lines(count);
+    writer.join();
+
+    EXPECT_EQ(responses.size(), count);
+}
+
+TEST_P(ServerTest, TestIdleConnections)
+{
+    wwa::json_rpc::server_options options;
+    options.threads = 2;
+    options.backend = GetParam();
+
+    wwa::json_rpc::server server(this->dispatcher(), {}, options);
+    const auto port = server.listen_tcp("127.0.0.1", 0);
+    server.start();
+
+    constexpr std::size_t count = 500;
+    std::vector<std::unique_ptr<client>> clients;
+    clients.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        clients.push_back(std::make_unique<client>(port));
+    }
+
+    EXPECT_TRUE(wait_until([&server]() { return server.stats().connections_open == count; }));
+
+    // An idle connection still works
+    clients.back()->send(R"({"jsonrpc": "2.0", "method": "subtract_p", "params": [2, 1], "id": 1})"
+                         "\n");
+    const auto responses = clients.back()->read_lines(1);
+    ASSERT_EQ(responses.size(), 1);
+    EXPECT_EQ(responses[0]["result"], 1);
+
+    clients.clear();
+    EXPECT_TRUE(wait_until([&server]() { return server.stats().connections_open == 0; }));
+}
+
+TEST_P(ServerTest, TestOutOfFileDescriptors)
+{
+    wwa::json_rpc::server_options options;
+    options.threads = 1;
+    options.backend = GetParam();
+
+    wwa::json_rpc::server server(this->dispatcher(), {}, options);
+    const auto port = server.listen_tcp("127.0.0.1", 0);
+    server.start();
+
+    rlimit saved{};
+    ASSERT_EQ(::getrlimit(RLIMIT_NOFILE, &saved), 0);
+    rlimit limited = saved;
+    limited.rlim_cur = std::min<rlim_t>(saved.rlim_cur, 1024);
+    ASSERT_EQ(::setrlimit(RLIMIT_NOFILE, &limited), 0);
+
+    // Use up all file descriptors but the one of the client, so that the server cannot accept the connection
+    std::vector<int> fds;
+    for (int fd = ::open("/dev/null", O_RDONLY | O_CLOEXEC); fd != -1; fd = ::open("/dev/null", O_RDONLY | O_CLOEXEC)) {
+        fds.push_back(fd);
+    }
+
+    if (!fds.empty()) {
+        ::close(fds.back());
+        fds.pop_back();
+    }
+
+    auto c            = std::make_unique<client>(port);
+    const auto before = server.stats().syscalls;
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    const auto syscalls = server.stats().syscalls - before;
+
+    for (const int fd : fds) {
+        ::close(fd);
+    }
+
+    ::setrlimit(RLIMIT_NOFILE, &saved);
+
+    // The reactor does not spin on the listening socket while accept() fails
+    EXPECT_LT(syscalls, 100);
+    EXPECT_EQ(server.stats().connections_accepted, 0);
+
+    // ... and accepts the connection when there are file descriptors again
+    c->send(R"({"jsonrpc": "2.0", "method": "subtract_p", "params": [2, 1], "id": 1})"
+            "\n");
+    const auto responses = c->read_lines(1);
+    ASSERT_EQ(responses.size(), 1);
+    EXPECT_EQ(responses[0]["result"], 1);
+}
+
+TEST_P(ServerTest, TestRestart)
+{
+    wwa::json_rpc::server_options options;
+    options.threads = 1;
+    options.backend = GetParam();
+
+    wwa::json_rpc::server server(this->dispatcher(), {}, options);
+    const auto port = server.listen_tcp("127.0.0.1", 0);
+    server.start();
+    EXPECT_THROW(server.start(), std::logic_error);
+    EXPECT_THROW(server.listen_tcp("127.0.0.1", 0), std::logic_error);
+
+    const std::string request = R"({"jsonrpc": "2.0", "method": "subtract_p", "params": [2, 1], "id": 1})"
+                                "\n";
+    {
+        client c(port);
+        c.send(request);
+        EXPECT_EQ(c.read_lines(1).size(), 1);
+
+        server.stop();
+        EXPECT_EQ(server.stats().connections_open, 0);
+        EXPECT_TRUE(c.expect_eof());
+    }
+
+    server.start();
+    {
+        client c(port);
+        c.send(request);
+        EXPECT_EQ(c.read_lines(1).size(), 1);
+    }
+
+    EXPECT_EQ(server.stats().messages, 2);
+}
+
+TEST_P(ServerTest, TestInvalidAddress)
+{
+    wwa::json_rpc::server_options options;
+    options.backend = GetParam();
+
+    wwa::json_rpc::server server(this->dispatcher(), {}, options);
+    EXPECT_THROW(server.listen_tcp("localhost", 0), std::system_error);
+    EXPECT_THROW(server.listen_unix(std::string(200, 'x')), std::system_error);
+}
+
+TEST_P(ServerTest, TestBackend)
+{
+    wwa::json_rpc::server_options options;
+    options.threads = 1;
+    options.backend = GetParam();
+
+    wwa::json_rpc::server server(this->dispatcher(), {}, options);
+    if (GetParam() == wwa::json_rpc::server_backend::epoll) {
+        EXPECT_EQ(server.backend(), wwa::json_rpc::server_backend::epoll);
+    }
+    else if (server.backend() == wwa::json_rpc::server_backend::epoll) {
+        GTEST_SKIP() << "io_uring is not supported, the server has fallen back to epoll";
+    }
+
+    const auto port = server.listen_tcp("127.0.0.1", 0);
+    server.start();
+
+    // Several requests in one segment are processed after one wakeup, and their responses are sent at once
+    client c(port);
+    std::string input;
+    for (int i = 0; i < 10; ++i) {
+        input += R"({"jsonrpc": "2.0", "method": "subtract_p", "params": [2, 1], "id": 1})"
+                 "\n";
+    }
+
+    c.send(input);
+    EXPECT_EQ(c.read_lines(10).size(), 10);
+
+    const auto stats = server.stats();
+    EXPECT_EQ(stats.responses, 10);
+    EXPECT_GT(stats.syscalls, 0);
+    EXPECT_LT(stats.syscalls, 20);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Backends, ServerTest,
+    testing::Values(wwa::json_rpc::server_backend::epoll, wwa::json_rpc::server_backend::io_uring),
+    [](const testing::TestParamInfo<wwa::json_rpc::server_backend>& info) {
+        return info.param == wwa::json_rpc::server_backend::epoll ? "epoll" : "io_uring";
+    }
+);
@@ -0,0 +1,138 @@
+#include <any>
+#include <stdexcept>
+#include <string>
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+
+#include "dispatcher.h"
+#include "exception.h"
+#include "static_dispatcher.h"
+
+using namespace nlohmann::json_literals;
+
+namespace {
+
+int subtract(int a, int b)
+{
+    return a - b;
+}
+
+void notify() {}
+
+std::string get_ip(const wwa::json_rpc::dispatcher::context_t& ctx)
+{
+    return std::any_cast<std::string>(ctx.first);
+}
+
+int throwing()
+{
+    throw std::runtime_error("Something went wrong");
+}
+
+int invalid_params()
+{
+    throw wwa::json_rpc::exception(wwa::json_rpc::exception::INVALID_PARAMS, "Bad params");
+}
+
+// clang-format off
+using static_dispatcher_t = wwa::json_rpc::static_dispatcher<
+    wwa::json_rpc::method<"subtract", &subtract>,
+    wwa::json_rpc::method<"notify", &notify>,
+    wwa::json_rpc::method<"echo", [](const nlohmann::json& params) { return params; }>,
+    wwa::json_rpc::method_ex<"ip", &get_ip>,
+    wwa::json_rpc::method_ex<"extra", [](const wwa::json_rpc::dispatcher::context_t& ctx) { return ctx.second; }>,
+    wwa::json_rpc::method<"throwing", &throwing>,
+    wwa::json_rpc::method<"invalid_params", &invalid_params>
+>;
+// clang-format on
+
+}  // namespace
+
+class StaticDispatcherTest : public testing::TestWithParam<nlohmann::json> {
+public:
+    StaticDispatcherTest()
+    {
+        this->m_dispatcher.add("subtract", &subtract);
+        this->m_dispatcher.add("notify", &notify);
+        this->m_dispatcher.add("echo", [](const nlohmann::json& params) { return params; });
+        this->m_dispatcher.add_ex("ip", &get_ip);
+        this->m_dispatcher.add_ex("extra", [](const wwa::json_rpc::dispatcher::context_t& ctx) { return ctx.second; });
+        this->m_dispatcher.add("throwing", &throwing);
+        this->m_dispatcher.add("invalid_params", &invalid_params);
+    }
+
+    wwa::json_rpc::dispatcher& dispatcher() noexcept { return this->m_dispatcher; }
+    const static_dispatcher_t& static_dispatcher() const noexcept { return this->m_static_dispatcher; }
+
+private:
+    wwa::json_rpc::dispatcher m_dispatcher;
+    static_dispatcher_t m_static_dispatcher;
+};
+
+TEST_P(StaticDispatcherTest, TestSameResponses)
+{
+    const auto& input = GetParam();
+    const std::any data{std::string("127.0.0.1")};
+
+    const auto expected = this->dispatcher().process_request(input, data);
+    const auto actual   = this->static_dispatcher().process_request(input, data);
+
+    EXPECT_EQ(actual.is_discarded(), expected.is_discarded());
+    if (!expected.is_discarded()) {
+        EXPECT_EQ(actual, expected);
+    }
+}
+
+// clang-format off
+INSTANTIATE_TEST_SUITE_P(
+    Table, StaticDispatcherTest,
+    testing::Values(
+        R"({"jsonrpc": "2.0", "method": "subtract", "params": [42, 23], "id": 1})"_json,
+        R"({"jsonrpc": "2.0", "method": "subtract", "params": [42, 23], "id": null})"_json,
+        R"({"jsonrpc": "2.0", "method": "subtract", "params": [42, 23]})"_json,
+        R"({"jsonrpc": "2.0", "method": "subtract", "params": {"a": 42}, "id": 2})"_json,
+        R"({"jsonrpc": "2.0", "method": "subtract", "params": ["a", "b"], "id": 3})"_json,
+        R"({"jsonrpc": "2.0", "method": "subtract", "params": [1], "id": 4})"_json,
+        R"({"jsonrpc": "2.0", "method": "notify", "id": "n"})"_json,
+        R"({"jsonrpc": "2.0", "method": "notify"})"_json,
+        R"({"jsonrpc": "2.0", "method": "echo", "params": [1, "2", [3]], "id": 5})"_json,
+        R"({"jsonrpc": "2.0", "method": "echo", "params": {"x": 1}, "id": 6})"_json,
+        R"({"jsonrpc": "2.0", "method": "ip", "id": 7})"_json,
+        R"({"jsonrpc": "2.0", "method": "extra", "id": 8, "auth": "secret"})"_json,
+        R"({"jsonrpc": "2.0", "method": "throwing", "id": 9})"_json,
+        R"({"jsonrpc": "2.0", "method": "throwing"})"_json,
+        R"({"jsonrpc": "2.0", "method": "invalid_params", "id": 10})"_json,
+        R"({"jsonrpc": "2.0", "method": "missing", "id": 11})"_json,
+        R"({"jsonrpc": "2.0", "method": "subtrac", "id": 12})"_json,
+        R"({"jsonrpc": "1.0", "method": "subtract", "params": [1, 2], "id": 13})"_json,
+        R"({"jsonrpc": "2.0", "method": "", "id": 14})"_json,
+        R"({"jsonrpc": "2.0", "method": 1, "id": 15})"_json,
+        R"({"jsonrpc": "2.0", "method": "subtract", "params": 1, "id": 16})"_json,
+        R"({"jsonrpc": "2.0", "method": "subtract", "params": [1, 2], "id": [17]})"_json,
+        R"({"method": "subtract", "params": [1, 2], "id": 18})"_json,
+        R"("string")"_json,
+        R"(1)"_json,
+        R"([])"_json,
+        R"([1, 2, 3])"_json,
+        R"([{"jsonrpc": "2.0", "method": "notify"}, {"jsonrpc": "2.0", "method": "notify"}])"_json,
+        R"([
+            {"jsonrpc": "2.0", "method": "subtract", "params": [42, 23], "id": "1"},
+            {"jsonrpc": "2.0", "method": "notify"},
+            {"jsonrpc": "2.0", "method": "missing", "id": "2"},
+            {"foo": "boo"},
+            1,
+            {"jsonrpc": "2.0", "method": "extra", "id": "3", "x": [1, 2]}
+        ])"_json
+    )
+);
+// clang-format on
+
+TEST(StaticDispatcherMethodsTest, TestHasMethod)
+{
+    static_assert(static_dispatcher_t::has_method("subtract"));
+    static_assert(static_dispatcher_t::has_method("extra"));
+    static_assert(!static_dispatcher_t::has_method("missing"));
+    static_assert(!static_dispatcher_t::has_method(""));
+
+    EXPECT_TRUE(static_dispatcher_t::has_method(std::string("echo")));
+}
@@ -0,0 +1,456 @@
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+
+#include "base.h"
+#include "exception.h"
+#include "stream.h"
+#include "utils.h"
+
+namespace {
+
+/**
+ * @brief Temporary file that is removed when closed.
+ */
+class temp_file {
+public:
+    temp_file() : m_file(std::tmpfile(), &std::fclose) {}
+
+    explicit temp_file(const std::string& contents) : temp_file()
+    {
+        EXPECT_EQ(::write(this->fd(), contents.data(), contents.size()), static_cast<ssize_t>(contents.size()));
+        this->rewind();
+    }
+
+    [[nodiscard]] int fd() const noexcept { return ::fileno(this->m_file.get()); }
+
+    void rewind() const { ::lseek(this->fd(), 0, SEEK_SET); }
+
+    [[nodiscard]] std::string contents() const
+    {
+        this->rewind();
+
+        std::string result;
+        std::vector<char> buf(4096);
+        ssize_t n = 0;
+        while ((n = ::read(this->fd(), buf.data(), buf.size())) > 0) {
+            result.append(buf.data(), static_cast<std::size_t>(n));
+        }
+
+        return result;
+    }
+
+private:
+    std::unique_ptr<std::FILE, decltype(&std::fclose)> m_file;
+};
+
+std::vector<nlohmann::json> parse_lines(const std::string& output)
+{
+    std::vector<nlohmann::json> result;
+    std::istringstream stream(output);
+    std::string line;
+    while (std::getline(stream, line)) {
+        result.push_back(nlohmann::json::parse(line));
+    }
+
+    return result;
+}
+
+/**
+ * @brief Echoes the messages as JSON strings and throws for the `boom` message after writing a part of the response.
+ */
+bool throwing_handler(std::string_view message, std::string& out)
+{
+    if (message == "boom") {
+        out.append(R"({"jsonrpc": "2.0", )");
+        throw std::runtime_error("Boom \xFF");
+    }
+
+    out.append(nlohmann::json(message).dump());
+    return true;
+}
+
+}  // namespace
+
+class StreamTest : public BaseDispatcherTest {
+protected:
+    std::pair<std::string, wwa::json_rpc::stream_stats>
+    run(const std::string& input, const wwa::json_rpc::stream_options& options = {})
+    {
+        const temp_file in(input);
+        const temp_file out;
+
+        const auto stats = wwa::json_rpc::process_ndjson_stream(this->dispatcher(), in.fd(), out.fd(), {}, options);
+        return {out.contents(), stats};
+    }
+};
+
+TEST_F(StreamTest, TestResponses)
+{
+    // clang-format off
+    const std::string input =
+        R"({"jsonrpc": "2.0", "method": "subtract_p", "params": [42, 23], "id": 1})" "\n"
+        R"({"jsonrpc": "2.0", "method": "notify_hello", "params": [7]})" "\n"
+        "\n"
+        R"({"jsonrpc": "2.0", "method": "subtract_p", "params": [23, 42], "id": 2})" "\r\n"
+        R"({"jsonrpc": "2.0", "method": "foobar", "id": 3)" "\n"
+        R"([{"jsonrpc": "2.0", "method": "notify_hello", "params": [1]}, {"jsonrpc": "2.0", "method": "notification"}])" "\n"
+        R"({"jsonrpc": "2.0", "method": "get_data", "id": 4})";
+    // clang-format on
+
+    const auto [output, stats] = this->run(input);
+    const auto responses       = parse_lines(output);
+
+    ASSERT_EQ(responses.size(), 4);
+    EXPECT_EQ(responses[0]["result"], 19);
+    EXPECT_EQ(responses[1]["result"], -19);
+    EXPECT_EQ(wwa::json_rpc::get_error_code(responses[2]), wwa::json_rpc::exception::PARSE_ERROR);
+    EXPECT_EQ(responses[3]["result"], nlohmann::json::array({"hello", 5}));
+
+    EXPECT_EQ(stats.messages, 6);
+    EXPECT_EQ(stats.responses, 4);
+    EXPECT_EQ(stats.bytes_read, input.size());
+    EXPECT_EQ(stats.bytes_written, output.size());
+}
+
+TEST_F(StreamTest, TestNotificationsOnly)
+{
+    const std::string input = R"({"jsonrpc": "2.0", "method": "notify_hello", "params": [7]})"
+                              "\n";
+
+    const auto [output, stats] = this->run(input);
+
+    EXPECT_TRUE(output.empty());
+    EXPECT_EQ(stats.messages, 1);
+    EXPECT_EQ(stats.responses, 0);
+}
+
+TEST_F(StreamTest, TestSmallReads)
+{
+    std::string input;
+    for (int i = 0; i < 100; ++i) {
+        input += R"({"jsonrpc": "2.0", "method": "subtract_p", "params": [)" + std::to_string(i) + R"(, 1], "id": )" +
+                 std::to_string(i) + "}\n";
+    }
+
+    wwa::json_rpc::stream_options options;
+    options.read_size       = 7;
+    options.write_threshold = 1;
+
+    const auto [output, stats] = this->run(input, options);
+    const auto responses       = parse_lines(output);
+
+    ASSERT_EQ(responses.size(), 100);
+    for (std::size_t i = 0; i < responses.size(); ++i) {
+        EXPECT_EQ(responses[i]["id"], i);
+        EXPECT_EQ(responses[i]["result"], static_cast<int>(i) - 1);
+    }
+}
+
+TEST_F(StreamTest, TestTooLarge)
+{
+    // clang-format off
+    const std::string input =
+        R"({"jsonrpc": "2.0", "method": "sumv", "params": [1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15], "id": 1})" "\n"
+        R"({"jsonrpc": "2.0", "method": "sumv", "params": [1, 2], "id": 2})" "\n"
+        R"({"jsonrpc": "2.0", "method": "sumv", "params": [1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15], "id": 3})";
+    // clang-format on
+
+    for (const std::size_t read_size : {4, 1024}) {
+        wwa::json_rpc::stream_options options;
+        options.read_size        = read_size;
+        options.max_message_size = 64;
+
+        const auto [output, stats] = this->run(input, options);
+        const auto responses       = parse_lines(output);
+
+        ASSERT_EQ(responses.size(), 3);
+        EXPECT_EQ(wwa::json_rpc::get_error_code(responses[0]), wwa::json_rpc::exception::INVALID_REQUEST);
+        EXPECT_EQ(wwa::json_rpc::get_error_message(responses[0]), wwa::json_rpc::err_request_too_large);
+        EXPECT_EQ(responses[1]["result"], 3);
+        EXPECT_EQ(wwa::json_rpc::get_error_code(responses[2]), wwa::json_rpc::exception::INVALID_REQUEST);
+    }
+}
+
+TEST_F(StreamTest, TestHandlerExceptions)
+{
+    const temp_file in("a\nboom\nb\n");
+    const temp_file out;
+
+    const auto stats     = wwa::json_rpc::run_ndjson_stream(in.fd(), out.fd(), throwing_handler);
+    const auto responses = parse_lines(out.contents());
+
+    ASSERT_EQ(responses.size(), 3);
+    EXPECT_EQ(responses[0], "a");
+    EXPECT_EQ(wwa::json_rpc::get_error_code(responses[1]), wwa::json_rpc::exception::INTERNAL_ERROR);
+    EXPECT_TRUE(responses[1]["id"].is_null());
+    EXPECT_EQ(responses[2], "b");
+    EXPECT_EQ(stats.messages, 3);
+    EXPECT_EQ(stats.responses, 3);
+}
+
+TEST_F(StreamTest, TestUnserializableResult)
+{
+    this->dispatcher().add("bad", []() { return std::string("\xFF"); });
+
+    // clang-format off
+    const std::string input =
+        R"({"jsonrpc": "2.0", "method": "bad", "id": 1})" "\n"
+        R"([{"jsonrpc": "2.0", "method": "subtract_p", "params": [2, 1], "id": 2}, {"jsonrpc": "2.0", "method": "bad", "id": 3}])" "\n"
+        R"({"jsonrpc": "2.0", "method": "subtract_p", "params": [3, 1], "id": 4})";
+    // clang-format on
+
+    const auto [output, stats] = this->run(input);
+    const auto responses       = parse_lines(output);
+
+    ASSERT_EQ(responses.size(), 3);
+    EXPECT_EQ(wwa::json_rpc::get_error_code(responses[0]), wwa::json_rpc::exception::INTERNAL_ERROR);
+    EXPECT_EQ(responses[0]["id"], 1);
+    ASSERT_TRUE(responses[1].is_array());
+    ASSERT_EQ(responses[1].size(), 2);
+    EXPECT_EQ(responses[1][0]["result"], 1);
+    EXPECT_EQ(wwa::json_rpc::get_error_code(responses[1][1]), wwa::json_rpc::exception::INTERNAL_ERROR);
+    EXPECT_EQ(responses[2]["result"], 2);
+}
+
+TEST_F(StreamTest, TestNonBlockingPipe)
+{
+    std::array<int, 2> in{};
+    std::array<int, 2> out{};
+    ASSERT_EQ(::pipe(in.data()), 0);
+    ASSERT_EQ(::pipe(out.data()), 0);
+    ::fcntl(in[0], F_SETFL, ::fcntl(in[0], F_GETFL) | O_NONBLOCK);
+    ::fcntl(out[1], F_SETFL, ::fcntl(out[1], F_GETFL) | O_NONBLOCK);
+
+    constexpr int count = 10000;
+    std::thread writer([fd = in[1]]() {
+        const std::string request = R"({"jsonrpc": "2.0", "method": "subtract_p", "params": [2, 1], "id": 1})"
+                                    "\n";
+        for (int i = 0; i < count; ++i) {
+            EXPECT_EQ(::write(fd, request.data(), request.size()), static_cast<ssize_t>(request.size()));
+        }
+
+        ::close(fd);
+    });
+
+    std::string output;
+    std::thread reader([fd = out[0], &output]() {
+        std::vector<char> buf(4096);
+        ssize_t n = 0;
+        while ((n = ::read(fd, buf.data(), buf.size())) > 0) {
+            output.append(buf.data(), static_cast<std::size_t>(n));
+        }
+    });
+
+    const auto stats = wwa::json_rpc::process_ndjson_stream(this->dispatcher(), in[0], out[1]);
+    ::close(in[0]);
+    ::close(out[1]);
+
+    writer.join();
+    reader.join();
+    ::close(out[0]);
+
+    EXPECT_EQ(stats.messages, count);
+    EXPECT_EQ(parse_lines(output).size(), count);
+}
+
+namespace {
+
+std::string frame(const std::string& body)
+{
+    return "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body;
+}
+
+std::vector<nlohmann::json> parse_frames(std::string_view output)
+{
+    std::vector<nlohmann::json> result;
+    while (!output.empty()) {
+        const auto pos = output.find("\r\n\r\n");
+        EXPECT_NE(pos, std::string_view::npos);
+        EXPECT_EQ(output.substr(0, 16), "Content-Length: ");
+        if (pos == std::string_view::npos) {
+            break;
+        }
+
+        const auto length = std::stoul(std::string(output.substr(16, pos - 16)));
+        result.push_back(nlohmann::json::parse(output.substr(pos + 4, length)));
+        output.remove_prefix(pos + 4 + length);
+    }
+
+    return result;
+}
+
+}  // namespace
+
+class FramedStreamTest : public BaseDispatcherTest {
+protected:
+    std::pair<std::string, wwa::json_rpc::stream_stats>
+    run(const std::string& input, const wwa::json_rpc::stream_options& options = {})
+    {
+        const temp_file in(input);
+        const temp_file out;
+
+        const auto stats = wwa::json_rpc::process_framed_stream(this->dispatcher(), in.fd(), out.fd(), {}, options);
+        return {out.contents(), stats};
+    }
+};
+
+TEST_F(FramedStreamTest, TestResponses)
+{
+    const std::string get_data = R"({"jsonrpc": "2.0", "method": "get_data", "id": 2})";
+
+    // clang-format off
+    const std::string input =
+        frame(R"({"jsonrpc": "2.0", "method": "subtract_p", "params": [42, 23], "id": 1})") +
+        frame(R"({"jsonrpc": "2.0", "method": "notify_hello", "params": [7]})") +
+        "content-length:  " + std::to_string(get_data.size()) + "\r\n"
+        "Content-Type: application/vscode-jsonrpc; charset=utf-8\r\n\r\n" + get_data +
+        frame(R"({"jsonrpc": "2.0", "method": "foobar", "id": 3)");
+    // clang-format on
+
+    const auto [output, stats] = this->run(input);
+    const auto responses       = parse_frames(output);
+
+    ASSERT_EQ(responses.size(), 3);
+    EXPECT_EQ(responses[0]["result"], 19);
+    EXPECT_EQ(responses[1]["result"], nlohmann::json::array({"hello", 5}));
+    EXPECT_EQ(wwa::json_rpc::get_error_code(responses[2]), wwa::json_rpc::exception::PARSE_ERROR);
+
+    EXPECT_EQ(stats.messages, 4);
+    EXPECT_EQ(stats.responses, 3);
+    EXPECT_EQ(stats.bytes_read, input.size());
+    EXPECT_EQ(stats.bytes_written, output.size());
+}
+
+TEST_F(FramedStreamTest, TestSmallReads)
+{
+    std::string input;
+    for (int i = 0; i < 100; ++i) {
+        input += frame(
+            R"({"jsonrpc": "2.0", "method": "subtract_p", "params": [)" + std::to_string(i) + R"(, 1], "id": )" +
+            std::to_string(i) + "}"
+        );
+    }
+
+    // Incomplete message at the end of the input
+    input += "Content-Length: 100\r\n\r\n{";
+
+    for (const std::size_t read_size : {1, 7, 1024}) {
+        wwa::json_rpc::stream_options options;
+        options.read_size       = read_size;
+        options.write_threshold = 1;
+
+        const auto [output, stats] = this->run(input, options);
+        const auto responses       = parse_frames(output);
+
+        ASSERT_EQ(responses.size(), 100);
+        for (std::size_t i = 0; i < responses.size(); ++i) {
+            EXPECT_EQ(responses[i]["id"], i);
+            EXPECT_EQ(responses[i]["result"], static_cast<int>(i) - 1);
+        }
+    }
+}
+
+TEST_F(FramedStreamTest, TestBadMessages)
+{
+    // clang-format off
+    const std::string large = R"({"jsonrpc": "2.0", "method": "sumv", "params": [1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15], "id": 1})";
+    const std::string small = R"({"jsonrpc": "2.0", "method": "sumv", "params": [1, 2], "id": 2})";
+
+    const std::string input =
+        frame(large) +
+        "Content-Type: application/json\r\n\r\n" +
+        "Content-Length: 12x\r\n\r\n" +
+        "X-Padding: " + std::string(200, 'x') + "\r\n\r\n" +
+        frame(small);
+    // clang-format on
+
+    for (const std::size_t read_size : {4, 1024}) {
+        wwa::json_rpc::stream_options options;
+        options.read_size        = read_size;
+        options.max_message_size = 64;
+        options.max_header_size  = 64;
+
+        const auto [output, stats] = this->run(input, options);
+        const auto responses       = parse_frames(output);
+
+        ASSERT_EQ(responses.size(), 5);
+        EXPECT_EQ(wwa::json_rpc::get_error_code(responses[0]), wwa::json_rpc::exception::INVALID_REQUEST);
+        EXPECT_EQ(wwa::json_rpc::get_error_message(responses[0]), wwa::json_rpc::err_request_too_large);
+        for (std::size_t i = 1; i < 4; ++i) {
+            EXPECT_EQ(wwa::json_rpc::get_error_code(responses[i]), wwa::json_rpc::exception::PARSE_ERROR);
+            EXPECT_EQ(wwa::json_rpc::get_error_message(responses[i]), wwa::json_rpc::err_bad_message_header);
+        }
+
+        EXPECT_EQ(responses[4]["result"], 3);
+    }
+}
+
+TEST_F(FramedStreamTest, TestHandlerExceptions)
+{
+    const temp_file in(frame("a") + frame("boom") + frame("b"));
+    const temp_file out;
+
+    const auto stats     = wwa::json_rpc::run_framed_stream(in.fd(), out.fd(), throwing_handler);
+    const auto responses = parse_frames(out.contents());
+
+    ASSERT_EQ(responses.size(), 3);
+    EXPECT_EQ(responses[0], "a");
+    EXPECT_EQ(wwa::json_rpc::get_error_code(responses[1]), wwa::json_rpc::exception::INTERNAL_ERROR);
+    EXPECT_EQ(responses[2], "b");
+    EXPECT_EQ(stats.messages, 3);
+    EXPECT_EQ(stats.responses, 3);
+}
+
+TEST_F(FramedStreamTest, TestNonBlockingPipe)
+{
+    std::array<int, 2> in{};
+    std::array<int, 2> out{};
+    ASSERT_EQ(::pipe(in.data()), 0);
+    ASSERT_EQ(::pipe(out.data()), 0);
+    ::fcntl(in[0], F_SETFL, ::fcntl(in[0], F_GETFL) | O_NONBLOCK);
+    ::fcntl(out[1], F_SETFL, ::fcntl(out[1], F_GETFL) | O_NONBLOCK);
+
+    constexpr int count = 10000;
+    std::thread writer([fd = in[1]]() {
+        const std::string request = frame(R"({"jsonrpc": "2.0", "method": "subtract_p", "params": [2, 1], "id": 1})");
+        for (int i = 0; i < count; ++i) {
+            EXPECT_EQ(::write(fd, request.data(), request.size()), static_cast<ssize_t>(request.size()));
+        }
+
+        ::close(fd);
+    });
+
+    std::string output;
+    std::thread reader([fd = out[0], &output]() {
+        std::vector<char> buf(4096);
+        ssize_t n = 0;
+        while ((n = ::read(fd, buf.data(), buf.size())) > 0) {
+            output.append(buf.data(), static_cast<std::size_t>(n));
+        }
+    });
+
+    const auto stats = wwa::json_rpc::process_framed_stream(this->dispatcher(), in[0], out[1]);
+    ::close(in[0]);
+    ::close(out[1]);
+
+    writer.join();
+    reader.join();
+    ::close(out[0]);
+
+    EXPECT_EQ(stats.messages, count);
+    EXPECT_EQ(parse_frames(output).size(), count);
+}
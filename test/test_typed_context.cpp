@@ -0,0 +1,157 @@
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+
+#include "dispatcher.h"
+#include "request.h"
+#include "task.h"
+
+using namespace nlohmann::json_literals;
+
+namespace {
+
+/**
+ * @brief Per-connection state that cannot be copied.
+ */
+struct connection {
+    explicit connection(std::string p) : peer(std::move(p)) {}
+
+    connection(const connection&)            = delete;
+    connection& operator=(const connection&) = delete;
+    connection(connection&&)                 = delete;
+    connection& operator=(connection&&)      = delete;
+    ~connection()                            = default;
+
+    std::string peer;
+};
+
+/**
+ * @brief Copyable state for asynchronous requests.
+ */
+struct session {
+    std::string user;
+};
+
+class connection_dispatcher : public wwa::json_rpc::basic_dispatcher<connection> {
+public:
+    connection_dispatcher()
+    {
+        this->add("sum", [](int a, int b) { return a + b; });
+        this->add_ex("whoami", [](const context_t& ctx) { return ctx.first.peer; });
+        this->add_ex("same", [this](const context_t& ctx) { return &ctx.first == this->m_expected; });
+        this->add_ex("auth", &connection_dispatcher::auth, this);
+    }
+
+    void expect(const connection* conn) noexcept { this->m_expected = conn; }
+
+    [[nodiscard]] const connection* parsed() const noexcept { return this->m_parsed; }
+
+protected:
+    void request_parsed(const wwa::json_rpc::jsonrpc_request&, const connection& data, std::uint64_t) override
+    {
+        this->m_parsed = &data;
+    }
+
+private:
+    const connection* m_expected = nullptr;
+    const connection* m_parsed   = nullptr;
+
+    std::string auth(const context_t& ctx, const std::string& prefix)
+    {
+        return prefix + ctx.first.peer + ":" + ctx.second.value("auth", std::string());
+    }
+};
+
+}  // namespace
+
+TEST(TypedContextTest, TestHandlersReceiveReference)
+{
+    connection_dispatcher dispatcher;
+    const connection conn("127.0.0.1");
+    dispatcher.expect(&conn);
+
+    const auto request = R"({"jsonrpc": "2.0", "method": "same", "id": 1})"_json;
+    EXPECT_EQ(dispatcher.process_request(request, conn)["result"], true);
+    EXPECT_EQ(dispatcher.parsed(), &conn);
+
+    EXPECT_EQ(dispatcher.process_request(nlohmann::json(request), conn)["result"], true);
+    EXPECT_EQ(dispatcher.process_request(request.dump(), conn)["result"], true);
+
+    std::string out;
+    EXPECT_TRUE(dispatcher.process_request_to(request.dump(), out, conn));
+    EXPECT_EQ(nlohmann::json::parse(out)["result"], true);
+}
+
+TEST(TypedContextTest, TestContextFields)
+{
+    connection_dispatcher dispatcher;
+    const connection conn("10.0.0.1");
+
+    EXPECT_EQ(
+        dispatcher.process_request(R"({"jsonrpc": "2.0", "method": "whoami", "id": 1})", conn)["result"], "10.0.0.1"
+    );
+
+    EXPECT_EQ(
+        dispatcher.process_request(
+            R"({"jsonrpc": "2.0", "method": "auth", "params": ["peer "], "id": 1, "auth": "secret"})", conn
+        )["result"],
+        "peer 10.0.0.1:secret"
+    );
+
+    // Handlers without the context work as usual
+    EXPECT_EQ(
+        dispatcher.process_request(R"({"jsonrpc": "2.0", "method": "sum", "params": [1, 2], "id": 1})", conn)["result"],
+        3
+    );
+}
+
+TEST(TypedContextTest, TestBatch)
+{
+    connection_dispatcher dispatcher;
+    const connection conn("::1");
+
+    // clang-format off
+    const auto batch = R"([
+        {"jsonrpc": "2.0", "method": "whoami", "id": 1},
+        {"jsonrpc": "2.0", "method": "sum", "params": [1, 2], "id": 2},
+        {"jsonrpc": "2.0", "method": "missing", "id": 3}
+    ])"_json;
+    // clang-format on
+
+    const auto response = dispatcher.process_request(batch, conn);
+    ASSERT_TRUE(response.is_array());
+    ASSERT_EQ(response.size(), 3);
+    EXPECT_EQ(response[0]["result"], "::1");
+    EXPECT_EQ(response[1]["result"], 3);
+    EXPECT_EQ(response[2]["error"]["code"], wwa::json_rpc::exception::METHOD_NOT_FOUND);
+}
+
+TEST(TypedContextTest, TestAsync)
+{
+    using session_dispatcher = wwa::json_rpc::basic_dispatcher<session>;
+
+    session_dispatcher dispatcher;
+    dispatcher.add_ex("user", [](const session_dispatcher::context_t& ctx) -> wwa::json_rpc::task<std::string> {
+        co_return ctx.first.user;
+    });
+
+    const auto request = R"({"jsonrpc": "2.0", "method": "user", "id": 1})"_json;
+    EXPECT_EQ(wwa::json_rpc::sync_wait(dispatcher.process_request_async(request, session{"admin"}))["result"], "admin");
+    EXPECT_EQ(dispatcher.process_request(request, session{"guest"})["result"], "guest");
+}
+
+TEST(TypedContextTest, TestAsyncNonCopyable)
+{
+    connection_dispatcher dispatcher;
+    const connection conn("::1");
+    dispatcher.expect(&conn);
+
+    auto same = dispatcher.process_request_async(R"({"jsonrpc": "2.0", "method": "same", "id": 1})"_json, conn);
+    auto peer = dispatcher.process_request_async(R"({"jsonrpc": "2.0", "method": "whoami", "id": 2})"_json, conn);
+
+    EXPECT_EQ(wwa::json_rpc::sync_wait(std::move(same))["result"], true);
+    EXPECT_EQ(wwa::json_rpc::sync_wait(std::move(peer))["result"], "::1");
+    EXPECT_EQ(dispatcher.parsed(), &conn);
+}